@@ -25,6 +25,22 @@ APP_NAME=handshake
 CPU_NAME=nios2
 BSP_PATH=../../bsp/il2206-pre-built-ucosii
 SRC_PATH=./src
+TOOLS_PATH=../../tools
+
+# Simulation mode (./runhand.sh sim [niossim options]) runs the last build
+# on the instruction-set simulator instead of the board, see tools/niossim.c
+if [ "$1" = "sim" ]; then
+    [ $TOOLS_PATH/niossim -nt $TOOLS_PATH/niossim.c ] || cc -O2 -o $TOOLS_PATH/niossim $TOOLS_PATH/niossim.c || exit 1
+    exec $TOOLS_PATH/niossim bin/$APP_NAME.elf "${@:2}"
+fi
+
+# Host mode (./runhand.sh host [--time <seconds>]) builds and runs the program
+# natively on the POSIX port of uC/OS-II, see bsp/host/Makefile
+if [ "$1" = "host" ]; then
+    HOST_APP=$(basename "$PWD" | sed 's/^DONE_//')
+    make -C ../../bsp/host APP=$HOST_APP || exit 1
+    exec ../../bsp/host/build/$HOST_APP/$APP_NAME "${@:2}"
+fi
 
 # Project internal folders
 mkdir -p gen
@@ -56,6 +72,9 @@ nios2-app-generate-makefile \
 
 make | tee -a log.txt
 
+# Memory footprint against the stored baseline
+python3 ../$TOOLS_PATH/footprint.py ../bin/$APP_NAME.map --baseline ../footprint.json
+
 cd ..
 
 echo -e "\n**************************"
@@ -27,7 +27,6 @@ void task0(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
 
         OSSemPend(pAtomicSem0, 0, &err1);
 
@@ -36,12 +35,12 @@ void task0(void* pdata)
 
         if (state == 0)
         {
-            err2 = OSSemPost(pAtomicSem1);
+            (void) OSSemPost(pAtomicSem1);
             state = 1;
         }
         else if (state == 1)
         {
-            err2 = OSSemPost(pAtomicSem0);
+            (void) OSSemPost(pAtomicSem0);
             state = 0;
         }
     }
@@ -54,7 +53,6 @@ void task1(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
 
         OSSemPend(pAtomicSem1, 0, &err1);
 
@@ -62,12 +60,12 @@ void task1(void* pdata)
 
         if (state == 0)
         {
-            err2 = OSSemPost(pAtomicSem1);
+            (void) OSSemPost(pAtomicSem1);
             state = 1;
         }
         else if (state == 1)
         {
-            err2 = OSSemPost(pAtomicSem0);
+            (void) OSSemPost(pAtomicSem0);
             state = 0;
         }
     }
@@ -5,6 +5,7 @@
 #include "includes.h"
 #include <string.h>
 #include "altera_avalon_performance_counter.h"
+#include "prof.h"
 
 #define DEBUG 0
 
@@ -21,11 +22,48 @@ OS_STK    task1_stk[TASK_STACKSIZE];
 OS_EVENT *pAtomicSem0;
 OS_EVENT *pAtomicSem1;
 
-int pre_iteration_counter = 0;
+/* Profiling region of the semaphore post + pend + context switch */
+int cs_region;
+
+#define REPORT_EVERY 10
+
+/* Average of the samples within 0.6 .. 1.4 times the last average, the
+ * region itself keeps every sample (interrupts, the printf of the tasks) */
 int iteration_counter = 0;
+int outlier_counter = 0;
 long long int cs_overhead_ticks = 0;
 double cs_avg_ticks = 0;
 
+/* Closes the measurement that was started by the other task */
+void cs_measure_end(void)
+{
+    int raw_cs_section_ticks;
+
+    PROF_END(cs_region);
+
+    // Filter the outlier out
+    raw_cs_section_ticks = (int) prof_last(cs_region);
+    if (cs_avg_ticks != 0
+        && ((raw_cs_section_ticks > 1.4 * cs_avg_ticks) || (raw_cs_section_ticks < 0.6 * cs_avg_ticks)))
+    {
+        outlier_counter++;
+        return;
+    }
+    cs_overhead_ticks = cs_overhead_ticks + raw_cs_section_ticks;
+    iteration_counter = iteration_counter + 1;
+
+    if ((iteration_counter % REPORT_EVERY) == 0)
+    {
+        cs_avg_ticks = (double) cs_overhead_ticks / (double) iteration_counter;
+        printf("====================================================================\n");
+        prof_report();
+        printf("Current AVG = %lf (%d samples, %d outliers left out)\n",
+               cs_avg_ticks, iteration_counter, outlier_counter);
+        printf("Performance Counter Frequency : %d\n", (int) alt_get_cpu_freq());
+        printf("====================================================================\n");
+    }
+}
+
 /* Prints a message and sleeps for given time interval */
 void task0(void* pdata)
 {
@@ -33,51 +71,11 @@ void task0(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
 
         OSSemPend(pAtomicSem0, 0, &err1);
         if (state == 1)
         {
-            // int dummy = 0;
-            // while (dummy < 10000 * iteration_counter)
-            // {
-            //     dummy = dummy + 1;
-            // }
-
-            PERF_END(PERFORMANCE_COUNTER_BASE, 1);
-
-            pre_iteration_counter = iteration_counter;
-            // Filter the outlier out
-            if (cs_avg_ticks != 0)
-            {
-                // printf("----------> perf_get_section_time () = %d\n", (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1));
-                int raw_cs_section_ticks = (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1);
-
-                if ((raw_cs_section_ticks <= 1.4 * cs_avg_ticks) && (raw_cs_section_ticks >= 0.6 * cs_avg_ticks))
-                {
-                    cs_overhead_ticks = cs_overhead_ticks + raw_cs_section_ticks;
-                    iteration_counter = iteration_counter + 1;
-                }
-            }
-            else
-            {
-                // printf("----------> perf_get_section_time () = %d\n", (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1));
-                cs_overhead_ticks = cs_overhead_ticks + \
-                            (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1);
-                iteration_counter = iteration_counter + 1;
-            }
-
-            if (((iteration_counter % 10) == 0) && (pre_iteration_counter != iteration_counter))
-            {
-                cs_avg_ticks = (double) cs_overhead_ticks / (double)iteration_counter;
-                printf("====================================================================\n");
-                printf("Current AVG = %lf\n", cs_avg_ticks);
-                printf("Performance Counter Overhead in ticks: %d\n", (int) cs_overhead_ticks);
-                printf("Performance Counter Frequency : %d\n", (int) alt_get_cpu_freq());
-                printf("Timer overhead in ms:    %f\n", 1000.0 * (float)cs_overhead_ticks/(float)alt_get_cpu_freq());
-                printf("====================================================================\n");
-            }
-            PERF_STOP_MEASURING(PERFORMANCE_COUNTER_BASE);
+            cs_measure_end();
         }
 
         // print current state
@@ -86,15 +84,13 @@ void task0(void* pdata)
         if (state == 0)
         {
             state = 1;
-            PERF_RESET(PERFORMANCE_COUNTER_BASE);
-            PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
-            PERF_BEGIN(PERFORMANCE_COUNTER_BASE, 1);
-            err2 = OSSemPost(pAtomicSem1);
+            PROF_BEGIN(cs_region);
+            (void) OSSemPost(pAtomicSem1);
         }
         else if (state == 1)
         {
             state = 0;
-            err2 = OSSemPost(pAtomicSem0);
+            (void) OSSemPost(pAtomicSem0);
         }
     }
 }
@@ -106,50 +102,11 @@ void task1(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
 
         OSSemPend(pAtomicSem1, 0, &err1);
         if (state == 0)
         {
-            // int dummy = 0;
-            // while (dummy < 10000 * iteration_counter)
-            // {
-            //     dummy = dummy + 1;
-            // }
-            PERF_END(PERFORMANCE_COUNTER_BASE, 1);
-            pre_iteration_counter = iteration_counter;
-
-            // Filter the outlier out
-            if (cs_avg_ticks != 0)
-            {
-                // printf("----------> perf_get_section_time () = %d\n", (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1));
-                int raw_cs_section_ticks = (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1);
-
-                if ((raw_cs_section_ticks <= 1.4 * cs_avg_ticks) && (raw_cs_section_ticks >= 0.6 * cs_avg_ticks))
-                {
-                    cs_overhead_ticks = cs_overhead_ticks + raw_cs_section_ticks;
-                    iteration_counter = iteration_counter + 1;
-                }
-            }
-            else
-            {
-                // printf("----------> perf_get_section_time () = %d\n", (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1));
-                cs_overhead_ticks = cs_overhead_ticks + \
-                            (int)perf_get_section_time((void*)PERFORMANCE_COUNTER_BASE, 1);
-                iteration_counter = iteration_counter + 1;
-            }
-
-            if (((iteration_counter % 10) == 0) && (pre_iteration_counter != iteration_counter))
-            {
-                cs_avg_ticks = (double) cs_overhead_ticks / (double)iteration_counter;
-                printf("====================================================================\n");
-                printf("Current AVG = %lf\n", cs_avg_ticks);
-                printf("Performance Counter Overhead in ticks: %d\n", (int) cs_overhead_ticks);
-                printf("Performance Counter Frequency : %d\n", (int) alt_get_cpu_freq());
-                printf("Timer overhead in ms:    %f\n", 1000.0 * (float)cs_overhead_ticks/(float)alt_get_cpu_freq());
-                printf("====================================================================\n");
-            }
-            PERF_STOP_MEASURING(PERFORMANCE_COUNTER_BASE);
+            cs_measure_end();
         }
 
         printf("Task 1 - State %d\n", state);
@@ -157,15 +114,13 @@ void task1(void* pdata)
         if (state == 0)
         {
             state = 1;
-            err2 = OSSemPost(pAtomicSem1);
+            (void) OSSemPost(pAtomicSem1);
         }
         else if (state == 1)
         {
             state = 0;
-            PERF_RESET(PERFORMANCE_COUNTER_BASE);
-            PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
-            PERF_BEGIN(PERFORMANCE_COUNTER_BASE, 1);
-            err2 = OSSemPost(pAtomicSem0);
+            PROF_BEGIN(cs_region);
+            (void) OSSemPost(pAtomicSem0);
         }
     }
 }
@@ -174,13 +129,13 @@ void task1(void* pdata)
 /* The main function creates two task and starts multi-tasking */
 int main(void)
 {
-    // Reset the counters before every run
-    // PERF_RESET(PERFORMANCE_COUNTER_BASE);
-    //
-    // PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
-    //
-
     printf("Lab 2 - Context Switch\n");
+
+    // Resets the counters and measures the instrumentation overhead
+    prof_init();
+    cs_region = prof_register("ctx switch");
+    printf("Profiling overhead in ticks: %d\n", (int) prof_overhead());
+
     pAtomicSem0 = OSSemCreate(1);
     pAtomicSem1 = OSSemCreate(0);
 
@@ -211,7 +166,5 @@ int main(void)
     );
 
     OSStart();
-
-    // PERF_STOP_MEASURING(PERFORMANCE_COUNTER_BASE);
     return 0;
 }
@@ -51,4 +51,15 @@ typedef unsigned long long alt_u64;
 #define ALT_ALWAYS_INLINE __attribute__ ((always_inline))
 #define ALT_WEAK          __attribute__((weak))
 
+/*
+ * Functions on the tick, interrupt and scheduling paths. With ALT_HOT_CODE
+ * they are linked into the on-chip memory, which the CPU reads without wait
+ * states, and copied there by alt_load().
+ */
+#ifdef ALT_HOT_CODE
+#define ALT_HOT           __attribute__ ((section (".onchip_memory.text")))
+#else
+#define ALT_HOT
+#endif
+
 #endif /* __ALT_TYPES_H__ */
@@ -76,7 +76,11 @@ struct ALT_IRQ_HANDLER
  * instruction is present if the macro ALT_CI_INTERRUPT_VECTOR defined.
  */
 
+#ifdef ALT_HOT_CODE
+void alt_irq_handler (void) ALT_HOT;
+#else
 void alt_irq_handler (void) __attribute__ ((section (".exceptions")));
+#endif
 void alt_irq_handler (void)
 {
 #ifdef ALT_CI_INTERRUPT_VECTOR
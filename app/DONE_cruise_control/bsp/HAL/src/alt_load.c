@@ -79,6 +79,15 @@ void alt_load (void)
 		                &__ram_rodata_start,
 		                &__ram_rodata_end);
   
+#ifdef ALT_HOT_CODE
+  /*
+   * Copy the functions marked ALT_HOT (see alt_types.h) to the on-chip
+   * memory.
+   */
+
+  ALT_LOAD_SECTION_BY_NAME(onchip_memory);
+#endif
+
   /*
    * Now ensure that the caches are in synch.
    */
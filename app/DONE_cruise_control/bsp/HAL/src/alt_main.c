@@ -51,6 +51,17 @@
 
 #include "sys/alt_log_printf.h"
 
+/*
+ * Boot profiler of the application (app/common/boot_prof.c), marks the end
+ * of each HAL phase.
+ */
+#ifdef ALT_BOOT_PROF
+extern void boot_prof_mark(const char* phase);
+#define ALT_BOOT_MARK(phase) boot_prof_mark(phase)
+#else
+#define ALT_BOOT_MARK(phase)
+#endif
+
 extern void _do_ctors(void);
 extern void _do_dtors(void);
 
@@ -85,6 +96,8 @@ void alt_main (void)
   int result;
 #endif
 
+  ALT_BOOT_MARK("crt0");
+
   /* ALT LOG - please see HAL/sys/alt_log_printf.h for details */
   ALT_LOG_PRINT_BOOT("[alt_main.c] Entering alt_main, calling alt_irq_init.\r\n");
   /* Initialize the interrupt controller. */
@@ -93,6 +106,7 @@ void alt_main (void)
   /* Initialize the operating system */
   ALT_LOG_PRINT_BOOT("[alt_main.c] Done alt_irq_init, calling alt_os_init.\r\n");
   ALT_OS_INIT();
+  ALT_BOOT_MARK("alt_irq_init + OSInit");
 
   /*
    * Initialize the semaphore used to control access to the file descriptor
@@ -106,6 +120,7 @@ void alt_main (void)
   ALT_LOG_PRINT_BOOT("[alt_main.c] Calling alt_sys_init.\r\n");
   alt_sys_init();
   ALT_LOG_PRINT_BOOT("[alt_main.c] Done alt_sys_init.\r\n");
+  ALT_BOOT_MARK("alt_sys_init");
 
 #if !defined(ALT_USE_DIRECT_DRIVERS) && (defined(ALT_STDIN_PRESENT) || defined(ALT_STDOUT_PRESENT) || defined(ALT_STDERR_PRESENT))
 
@@ -146,6 +161,7 @@ void alt_main (void)
    * call to exit() unless the application is never supposed to exit.
    */
 
+  ALT_BOOT_MARK("io redirect + ctors");
   ALT_LOG_PRINT_BOOT("[alt_main.c] Calling main.\r\n");
 
 #ifdef ALT_NO_EXIT
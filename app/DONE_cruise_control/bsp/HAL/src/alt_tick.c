@@ -84,7 +84,7 @@ void alt_alarm_stop (alt_alarm* alarm)
  * alt_tick() is expected to run at interrupt level.
  */
 
-void alt_tick (void)
+void ALT_HOT alt_tick (void)
 {
   alt_alarm* next;
   alt_alarm* alarm = (alt_alarm*) alt_alarm_list.next;
@@ -118,7 +118,11 @@ OS_STK *OSTaskStkInit(void (*task)(void *pd), void *pdata, OS_STK *pstk, INT16U
 */
 void OSTaskCreateHook (OS_TCB *ptcb)
 {
+#if OS_APP_HOOKS_EN > 0
+    App_TaskCreateHook(ptcb);
+#else
     ptcb = ptcb;                       /* Prevent compiler warning */
+#endif
 }
 
 
@@ -135,7 +139,11 @@ void OSTaskCreateHook (OS_TCB *ptcb)
 */
 void OSTaskDelHook (OS_TCB *ptcb)
 {
+#if OS_APP_HOOKS_EN > 0
+    App_TaskDelHook(ptcb);
+#else
     ptcb = ptcb;                       /* Prevent compiler warning                                     */
+#endif
 }
 
 /*
@@ -153,8 +161,11 @@ void OSTaskDelHook (OS_TCB *ptcb)
 *                 task being switched out (i.e. the preempted task).
 *********************************************************************************************************
 */
-void OSTaskSwHook (void)
+void ALT_HOT OSTaskSwHook (void)
 {
+#if OS_APP_HOOKS_EN > 0
+    App_TaskSwHook();
+#endif
 }
 
 /*
@@ -169,6 +180,9 @@ void OSTaskSwHook (void)
 */
 void OSTaskStatHook (void)
 {
+#if OS_APP_HOOKS_EN > 0
+    App_TaskStatHook();
+#endif
 }
 
 /*
@@ -191,7 +205,7 @@ void OSTaskStatHook (void)
 void cticks_hook(void);
 #endif
 
-void OSTimeTickHook (void)
+void ALT_HOT OSTimeTickHook (void)
 {
 #if OS_TMR_EN > 0
     OSTmrCtr++;
@@ -205,6 +219,10 @@ void OSTimeTickHook (void)
     /* Service the Interniche timer */
     cticks_hook();
 #endif
+
+#if OS_APP_HOOKS_EN > 0
+    App_TimeTickHook();
+#endif
 }
 
 void OSInitHookBegin(void)
@@ -220,10 +238,16 @@ void OSInitHookEnd(void)
 
 void OSTaskIdleHook(void)
 {
+#if OS_APP_HOOKS_EN > 0
+    App_TaskIdleHook();
+#endif
 }
 
 void OSTCBInitHook(OS_TCB *ptcb)
 {
+#if OS_APP_HOOKS_EN > 0
+    App_TCBInitHook(ptcb);
+#endif
 }
 
 #endif
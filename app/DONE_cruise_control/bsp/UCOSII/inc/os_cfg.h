@@ -45,6 +45,7 @@ extern "C"
                                        /* ---------------------- MISCELLANEOUS ----------------------- */
 #define OS_APP_HOOKS_EN           1    /* Application-defined hooks are called from the uC/OS-II hooks */
 #define OS_EVENT_MULTI_EN         1    /* Include code for OSEventPendMulti()                          */
+#define OS_TRACE_EN               1    /* Kernel events are reported to App_TraceEvent()               */
 
                                        /* -------------------- MESSAGE MAILBOXES --------------------- */
 #define OS_MBOX_PEND_ABORT_EN     1    /*     Include code for OSMboxPendAbort()                       */
@@ -58,6 +59,12 @@ extern "C"
                                                                                                                      
 #include "system.h"
 
+/*
+ * Trim mode: options cut to what the application uses, written by
+ * tools/ostrim.py. Empty unless ./run.sh trim has been run.
+ */
+#include "os_cfg_trim.h"
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,10 @@
+/*
+ * uC/OS-II configuration of DONE_cruise_control cut to what it uses
+ *
+ * Nothing is cut: the configuration of system.h and os_cfg.h is used.
+ * tools/ostrim.py --header writes the cut one (./run.sh trim).
+ */
+#ifndef __OS_CFG_TRIM_H__
+#define __OS_CFG_TRIM_H__
+
+#endif /* __OS_CFG_TRIM_H__ */
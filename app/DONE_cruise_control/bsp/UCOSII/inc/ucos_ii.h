@@ -1293,6 +1293,14 @@ void          OS_MemCopy              (INT8U           *pdest,
                                        INT8U           *psrc,
                                        INT16U           size);
 
+#if OS_TASK_CREATE_EXT_EN > 0
+void          OS_StkClr               (OS_STK          *pstk,
+                                       INT32U           size);
+
+INT32U        OS_StkFree              (OS_STK          *pstk,
+                                       INT32U           size);
+#endif
+
 #if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0)
 void          OS_MemInit              (void);
 #endif
@@ -1400,6 +1408,52 @@ void          App_TimeTickHook        (void);
 #endif
 #endif
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                            EVENT TRACING
+*
+* Note(s): 1) When OS_TRACE_EN is set, the kernel reports the events below to App_TraceEvent() with
+*             'arg' identifying the object (index in OSEventTbl[] / OSTmrTbl[], or the ISR nesting level).
+*             Context switches are reported by the application from App_TaskSwHook().
+*********************************************************************************************************
+*/
+
+#ifndef OS_TRACE_EN
+#define OS_TRACE_EN                   0
+#endif
+
+#define OS_TRACE_EV_SWITCH            1u   /* Task switch                                              */
+#define OS_TRACE_EV_ISR_ENTER         2u   /* OSIntEnter()                                             */
+#define OS_TRACE_EV_ISR_EXIT          3u   /* OSIntExit(), before the ISR level context switch         */
+#define OS_TRACE_EV_SEM_POST          4u
+#define OS_TRACE_EV_SEM_PEND          5u
+#define OS_TRACE_EV_MBOX_POST         6u
+#define OS_TRACE_EV_MBOX_PEND         7u
+#define OS_TRACE_EV_TMR_EXPIRE        8u   /* OSTmr_Task() calls the callback of a timer               */
+#define OS_TRACE_EV_USER              9u   /* First event number free for the application              */
+
+#if OS_TRACE_EN > 0
+void          App_TraceEvent          (INT8U            type,
+                                       INT16U           arg);
+
+#define OS_TRACE_ISR_ENTER()          App_TraceEvent(OS_TRACE_EV_ISR_ENTER,  (INT16U)OSIntNesting)
+#define OS_TRACE_ISR_EXIT()           App_TraceEvent(OS_TRACE_EV_ISR_EXIT,   (INT16U)OSIntNesting)
+#define OS_TRACE_SEM_POST(pevent)     App_TraceEvent(OS_TRACE_EV_SEM_POST,   (INT16U)((pevent) - OSEventTbl))
+#define OS_TRACE_SEM_PEND(pevent)     App_TraceEvent(OS_TRACE_EV_SEM_PEND,   (INT16U)((pevent) - OSEventTbl))
+#define OS_TRACE_MBOX_POST(pevent)    App_TraceEvent(OS_TRACE_EV_MBOX_POST,  (INT16U)((pevent) - OSEventTbl))
+#define OS_TRACE_MBOX_PEND(pevent)    App_TraceEvent(OS_TRACE_EV_MBOX_PEND,  (INT16U)((pevent) - OSEventTbl))
+#define OS_TRACE_TMR_EXPIRE(ptmr)     App_TraceEvent(OS_TRACE_EV_TMR_EXPIRE, (INT16U)((ptmr) - OSTmrTbl))
+#else
+#define OS_TRACE_ISR_ENTER()
+#define OS_TRACE_ISR_EXIT()
+#define OS_TRACE_SEM_POST(pevent)
+#define OS_TRACE_SEM_PEND(pevent)
+#define OS_TRACE_MBOX_POST(pevent)
+#define OS_TRACE_MBOX_PEND(pevent)
+#define OS_TRACE_TMR_EXPIRE(ptmr)
+#endif
+
 /*
 *********************************************************************************************************
 *                                          FUNCTION PROTOTYPES
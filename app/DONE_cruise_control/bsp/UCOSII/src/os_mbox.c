@@ -271,6 +271,7 @@ OS_EVENT  *OSMboxDel (OS_EVENT *pevent, INT8U opt, INT8U *perr)
 *********************************************************************************************************
 */
 /*$PAGE*/
+void  *OSMboxPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr) ALT_HOT;
 void  *OSMboxPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
 {
     void      *pmsg;
@@ -301,6 +302,7 @@ void  *OSMboxPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
         *perr = OS_ERR_PEND_LOCKED;                   /* ... can't PEND when locked                    */
         return ((void *)0);
     }
+    OS_TRACE_MBOX_PEND(pevent);
     OS_ENTER_CRITICAL();
     pmsg = pevent->OSEventPtr;
     if (pmsg != (void *)0) {                          /* See if there is already a message             */
@@ -452,7 +454,7 @@ INT8U  OSMboxPendAbort (OS_EVENT *pevent, INT8U opt, INT8U *perr)
 */
 
 #if OS_MBOX_POST_EN > 0
-INT8U  OSMboxPost (OS_EVENT *pevent, void *pmsg)
+INT8U  ALT_HOT OSMboxPost (OS_EVENT *pevent, void *pmsg)
 {
 #if OS_CRITICAL_METHOD == 3                           /* Allocate storage for CPU status register      */
     OS_CPU_SR  cpu_sr = 0;
@@ -471,6 +473,7 @@ INT8U  OSMboxPost (OS_EVENT *pevent, void *pmsg)
     if (pevent->OSEventType != OS_EVENT_TYPE_MBOX) {  /* Validate event block type                     */
         return (OS_ERR_EVENT_TYPE);
     }
+    OS_TRACE_MBOX_POST(pevent);
     OS_ENTER_CRITICAL();
     if (pevent->OSEventGrp != 0) {                    /* See if any task pending on mailbox            */
                                                       /* Ready HPT waiting on event                    */
@@ -542,6 +545,7 @@ INT8U  OSMboxPostOpt (OS_EVENT *pevent, void *pmsg, INT8U opt)
     if (pevent->OSEventType != OS_EVENT_TYPE_MBOX) {  /* Validate event block type                     */
         return (OS_ERR_EVENT_TYPE);
     }
+    OS_TRACE_MBOX_POST(pevent);
     OS_ENTER_CRITICAL();
     if (pevent->OSEventGrp != 0) {                    /* See if any task pending on mailbox            */
         if ((opt & OS_POST_OPT_BROADCAST) != 0x00) {  /* Do we need to post msg to ALL waiting tasks ? */
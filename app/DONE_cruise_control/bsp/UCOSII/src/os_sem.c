@@ -278,7 +278,7 @@ OS_EVENT  *OSSemDel (OS_EVENT *pevent, INT8U opt, INT8U *perr)
 *********************************************************************************************************
 */
 /*$PAGE*/
-void  OSSemPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
+void  ALT_HOT OSSemPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
 {
 #if OS_CRITICAL_METHOD == 3                           /* Allocate storage for CPU status register      */
     OS_CPU_SR  cpu_sr = 0;
@@ -307,6 +307,7 @@ void  OSSemPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
         *perr = OS_ERR_PEND_LOCKED;                   /* ... can't PEND when locked                    */
         return;
     }
+    OS_TRACE_SEM_PEND(pevent);
     OS_ENTER_CRITICAL();
     if (pevent->OSEventCnt > 0) {                     /* If sem. is positive, resource available ...   */
         pevent->OSEventCnt--;                         /* ... decrement semaphore only if positive.     */
@@ -450,7 +451,7 @@ INT8U  OSSemPendAbort (OS_EVENT *pevent, INT8U opt, INT8U *perr)
 *********************************************************************************************************
 */
 
-INT8U  OSSemPost (OS_EVENT *pevent)
+INT8U  ALT_HOT OSSemPost (OS_EVENT *pevent)
 {
 #if OS_CRITICAL_METHOD == 3                           /* Allocate storage for CPU status register      */
     OS_CPU_SR  cpu_sr = 0;
@@ -466,6 +467,7 @@ INT8U  OSSemPost (OS_EVENT *pevent)
     if (pevent->OSEventType != OS_EVENT_TYPE_SEM) {   /* Validate event block type                     */
         return (OS_ERR_EVENT_TYPE);
     }
+    OS_TRACE_SEM_POST(pevent);
     OS_ENTER_CRITICAL();
     if (pevent->OSEventGrp != 0) {                    /* See if any task waiting for semaphore         */
                                                       /* Ready HPT waiting on event                    */
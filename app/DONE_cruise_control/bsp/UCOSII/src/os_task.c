@@ -900,9 +900,7 @@ INT8U  OSTaskStkChk (INT8U prio, OS_STK_DATA *p_stk_data)
     pchk  = ptcb->OSTCBStkBottom;
     OS_EXIT_CRITICAL();
 #if OS_STK_GROWTH == 1
-    while (*pchk++ == (OS_STK)0) {                    /* Compute the number of zero entries on the stk */
-        nfree++;
-    }
+    nfree = OS_StkFree(pchk, size);                   /* Compute the number of zero entries on the stk */
 #else
     while (*pchk-- == (OS_STK)0) {
         nfree++;
@@ -1078,15 +1076,9 @@ void  OS_TaskStkClr (OS_STK *pbos, INT32U size, INT16U opt)
     if ((opt & OS_TASK_OPT_STK_CHK) != 0x0000) {       /* See if stack checking has been enabled       */
         if ((opt & OS_TASK_OPT_STK_CLR) != 0x0000) {   /* See if stack needs to be cleared             */
 #if OS_STK_GROWTH == 1
-            while (size > 0) {                         /* Stack grows from HIGH to LOW memory          */
-                size--;
-                *pbos++ = (OS_STK)0;                   /* Clear from bottom of stack and up!           */
-            }
+            OS_StkClr(pbos, size);                     /* Clear from bottom of stack and up!           */
 #else
-            while (size > 0) {                         /* Stack grows from LOW to HIGH memory          */
-                size--;
-                *pbos-- = (OS_STK)0;                   /* Clear from bottom of stack and down          */
-            }
+            OS_StkClr(pbos - size + 1, size);          /* Clear from bottom of stack and down          */
 #endif
         }
     }
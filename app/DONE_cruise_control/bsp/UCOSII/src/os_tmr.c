@@ -708,7 +708,7 @@ BOOLEAN  OSTmrStop (OS_TMR  *ptmr,
 */
 
 #if OS_TMR_EN > 0
-INT8U  OSTmrSignal (void)
+INT8U  ALT_HOT OSTmrSignal (void)
 {
     INT8U  err;
 
@@ -947,7 +947,7 @@ static  void  OSTmr_InitTask (void)
 */
 
 #if OS_TMR_EN > 0
-static  void  OSTmr_Link (OS_TMR *ptmr, INT8U type)
+static  void  ALT_HOT OSTmr_Link (OS_TMR *ptmr, INT8U type)
 {
     OS_TMR       *ptmr1;
     OS_TMR_WHEEL *pspoke;
@@ -996,7 +996,7 @@ static  void  OSTmr_Link (OS_TMR *ptmr, INT8U type)
 */
 
 #if OS_TMR_EN > 0
-static  void  OSTmr_Unlink (OS_TMR *ptmr)
+static  void  ALT_HOT OSTmr_Unlink (OS_TMR *ptmr)
 {
     OS_TMR        *ptmr1;
     OS_TMR        *ptmr2;
@@ -1075,7 +1075,7 @@ static  void  OSTmr_Unlock (void)
 */
 
 #if OS_TMR_EN > 0
-static  void  OSTmr_Task (void *p_arg)
+static  void  ALT_HOT OSTmr_Task (void *p_arg)
 {
     INT8U            err;
     OS_TMR          *ptmr;
@@ -1097,6 +1097,7 @@ static  void  OSTmr_Task (void *p_arg)
             ptmr_next = (OS_TMR *)ptmr->OSTmrNext;               /* Point to next timer to update because current ... */
                                                                  /* ... timer could get unlinked from the wheel.      */
             if (OSTmrTime == ptmr->OSTmrMatch) {                 /* Process each timer that expires                   */
+                OS_TRACE_TMR_EXPIRE(ptmr);
                 pfnct = ptmr->OSTmrCallback;                     /* Execute callback function if available            */
                 if (pfnct != (OS_TMR_CALLBACK)0) {
                     (*pfnct)((void *)ptmr, ptmr->OSTmrCallbackArg);
@@ -51,9 +51,9 @@
  * alarms, see alt_tick.c for further details.
  */
 #ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
-static void alt_avalon_timer_sc_irq (void* base)
+static void ALT_HOT alt_avalon_timer_sc_irq (void* base)
 #else
-static void alt_avalon_timer_sc_irq (void* base, alt_u32 id)
+static void ALT_HOT alt_avalon_timer_sc_irq (void* base, alt_u32 id)
 #endif
 {
   alt_irq_context cpu_sr;
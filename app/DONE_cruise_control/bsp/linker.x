@@ -308,6 +308,22 @@ SECTIONS
         __bss_end = ABSOLUTE(.);
     } > sram
 
+    /*
+     *
+     * Neither cleared by crt0 nor loaded, for data that is set up at run
+     * time (e.g. task stacks cleared lazily, see BOOT_NOINIT of the boot
+     * profiler). Keeps its contents over a reset.
+     *
+     */
+
+    .noinit LOADADDR (.bss) + SIZEOF (.bss) (NOLOAD) : AT ( LOADADDR (.bss) + SIZEOF (.bss) )
+    {
+        __noinit_start = ABSOLUTE(.);
+        *(.noinit .noinit.*)
+        . = ALIGN(4);
+        __noinit_end = ABSOLUTE(.);
+    } > sram
+
     /*
      *
      * One output section mapped to the associated memory device for each of
@@ -331,10 +347,10 @@ SECTIONS
      *
      */
 
-    .onchip_memory : AT ( LOADADDR (.bss) + SIZEOF (.bss) )
+    .onchip_memory : AT ( LOADADDR (.noinit) + SIZEOF (.noinit) )
     {
         PROVIDE (_alt_partition_onchip_memory_start = ABSOLUTE(.));
-        *(.onchip_memory. onchip_memory.*)
+        *(.onchip_memory .onchip_memory.* onchip_memory.*)
         . = ALIGN(4);
         PROVIDE (_alt_partition_onchip_memory_end = ABSOLUTE(.));
     } > onchip_memory
@@ -353,7 +353,7 @@
 
 #define ALT_MAX_FD 32
 #define ALT_SYS_CLK TIMER_0
-#define ALT_TIMESTAMP_CLK none
+#define ALT_TIMESTAMP_CLK TIMER_1
 
 
 /*
@@ -581,7 +581,7 @@
 #define OS_TASK_PROFILE_EN 1
 #define OS_TASK_QUERY_EN 1
 #define OS_TASK_STAT_EN 1
-#define OS_TASK_STAT_STK_CHK_EN 1
+#define OS_TASK_STAT_STK_CHK_EN 0
 #define OS_TASK_STAT_STK_SIZE 512
 #define OS_TASK_SUSPEND_EN 1
 #define OS_TASK_SW_HOOK_EN 1
@@ -25,6 +25,39 @@ APP_NAME=cruisecontrol
 CPU_NAME=nios2
 BSP_PATH=../../bsp/il2206-pre-built-ucosii
 SRC_PATH=./src
+COMMON_PATH=../common
+TOOLS_PATH=../../tools
+
+# Simulation mode (./run.sh sim [niossim options]) runs the last build
+# on the instruction-set simulator instead of the board, see tools/niossim.c
+if [ "$1" = "sim" ]; then
+    [ $TOOLS_PATH/niossim -nt $TOOLS_PATH/niossim.c ] || cc -O2 -o $TOOLS_PATH/niossim $TOOLS_PATH/niossim.c || exit 1
+    exec $TOOLS_PATH/niossim bin/$APP_NAME.elf "${@:2}"
+fi
+
+# Host mode (./run.sh host [--time <seconds>]) builds and runs the program
+# natively on the POSIX port of uC/OS-II, see bsp/host/Makefile
+if [ "$1" = "host" ]; then
+    HOST_APP=$(basename "$PWD" | sed 's/^DONE_//')
+    make -C ../../bsp/host APP=$HOST_APP || exit 1
+    exec ../../bsp/host/build/$HOST_APP/$APP_NAME "${@:2}"
+fi
+
+# Sweep mode (./run.sh sweep [cruise_sweep options]) tunes the gains and
+# periods of the control law on the host, see tools/cruise_sweep.c
+if [ "$1" = "sweep" ]; then
+    [ $TOOLS_PATH/cruise_sweep -nt $TOOLS_PATH/cruise_sweep.c ] && [ $TOOLS_PATH/cruise_sweep -nt $SRC_PATH/cruise_law.c ] || \
+        cc -O2 -pthread -I$SRC_PATH -o $TOOLS_PATH/cruise_sweep $TOOLS_PATH/cruise_sweep.c $SRC_PATH/cruise_law.c || exit 1
+    exec $TOOLS_PATH/cruise_sweep "${@:2}"
+fi
+
+# Fleet mode (./run.sh fleet [cruise_fleet options]) drives many vehicles
+# with the control law on the host, see tools/cruise_fleet.c
+if [ "$1" = "fleet" ]; then
+    [ $TOOLS_PATH/cruise_fleet -nt $TOOLS_PATH/cruise_fleet.c ] && [ $TOOLS_PATH/cruise_fleet -nt $SRC_PATH/cruise_law.c ] || \
+        cc -O3 -march=native -fno-trapping-math -pthread -I$SRC_PATH -o $TOOLS_PATH/cruise_fleet $TOOLS_PATH/cruise_fleet.c $SRC_PATH/cruise_law.c || exit 1
+    exec $TOOLS_PATH/cruise_fleet "${@:2}"
+fi
 
 # Project internal folders
 mkdir -p gen
@@ -43,18 +76,65 @@ nios2-bsp ucosii ../bsp ../$CORE_FILE \
 	  --cpu-name $CPU_NAME \
 	  --default_sections_mapping sram \
 	  --set hal.sys_clk_timer timer_0 \
+	  --set hal.timestamp_timer timer_1 \
 	  --set hal.make.bsp_cflags_debug -g \
 	  --set hal.make.bsp_cflags_optimization -Os \
+	  --set hal.make.bsp_cflags_defined_symbols "-DALT_BOOT_PROF -DALT_HOT_CODE" \
 	  --set hal.enable_sopc_sysid_check 1 \
-	  --set ucosii.os_tmr_en 1
+	  --set ucosii.os_tmr_en 1 \
+	  --set ucosii.miscellaneous.os_task_stat_stk_chk_en 0
+
+# The edits of the generated BSP sources (../bsp.patch), unless this BSP
+# has them already
+if ! patch -d ../bsp -p1 -R --dry-run -s -f < ../bsp.patch > /dev/null; then
+    patch -d ../bsp -p1 -s -f < ../bsp.patch || exit 1
+fi
 
 nios2-app-generate-makefile \
     --bsp-dir ../bsp \
     --elf-name ../bin/$APP_NAME.elf \
     --src-dir ../$SRC_PATH \
+    --src-files ../$COMMON_PATH/task_acct.c ../$COMMON_PATH/trace.c ../$COMMON_PATH/stack_mon.c ../$COMMON_PATH/basic_task.c ../$COMMON_PATH/boot_prof.c ../$COMMON_PATH/hot_bench.c ../$COMMON_PATH/pc_prof.c ../$COMMON_PATH/mem_bench.c ../$COMMON_PATH/replay.c ../$COMMON_PATH/app_hooks.c ../$COMMON_PATH/job_wcet.c ../$COMMON_PATH/deadline.c ../$COMMON_PATH/timestamp.c \
+    --set APP_INCLUDE_DIRS ../$COMMON_PATH \
+    --set APP_CFLAGS_DEFINED_SYMBOLS -DALT_HOT_CODE \
     --set APP_CFLAGS_OPTIMIZATION -O0
 
+# Trim mode (./run.sh trim) starts from the full kernel configuration
+if [ "$1" = "trim" ]; then
+    python3 ../$TOOLS_PATH/ostrim.py .. --header ../bsp/UCOSII/inc/os_cfg_trim.h --full > /dev/null
+fi
+
+# Size the task stacks from the code just built and build again if they
+# changed; the build fails if the header still does not match the listing
+size_stacks() {
+    cp ../$SRC_PATH/stack_depth.h stack_depth.h.old
+    python3 ../$TOOLS_PATH/stackdepth.py ../bin/$APP_NAME.objdump --header ../$SRC_PATH/stack_depth.h \
+        --recursion ___vfprintf_internal_r=1
+    if ! cmp -s stack_depth.h.old ../$SRC_PATH/stack_depth.h; then
+        make | tee -a log.txt
+    fi
+    python3 ../$TOOLS_PATH/stackdepth.py ../bin/$APP_NAME.objdump --check ../$SRC_PATH/stack_depth.h || exit 1
+}
+
 make | tee -a log.txt
+size_stacks
+
+# Memory footprint against the stored baseline
+python3 ../$TOOLS_PATH/footprint.py ../bin/$APP_NAME.map --baseline ../footprint.json
+
+# Trim mode: cut the kernel configuration to what the application uses and
+# build again; the footprint is compared with the full configuration, the
+# tick cost is in the hot_code BENCH lines of both runs (bench_compare.py)
+if [ "$1" = "trim" ]; then
+    python3 ../$TOOLS_PATH/footprint.py ../bin/$APP_NAME.map --save footprint.full.json > /dev/null
+    python3 ../$TOOLS_PATH/ostrim.py .. --header ../bsp/UCOSII/inc/os_cfg_trim.h --settings trim.args
+    # A kernel object too few only shows at run time (e.g. a task that is
+    # not created): the host port builds with the same header
+    make -C ../../../bsp/host scenarios APP=$(basename "$(dirname "$PWD")" | sed 's/^DONE_//') || exit 1
+    make | tee -a log.txt
+    size_stacks
+    python3 ../$TOOLS_PATH/footprint.py ../bin/$APP_NAME.map --baseline footprint.full.json --top 10
+fi
 
 cd ..
 
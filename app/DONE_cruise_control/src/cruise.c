@@ -24,11 +24,53 @@
 #include "altera_avalon_pio_regs.h"
 #include "sys/alt_irq.h"
 #include "sys/alt_alarm.h"
+#include "sys/alt_timestamp.h"
+#include "task_acct.h"
+#include "trace.h"
+#include "stack_mon.h"
+#include "basic_task.h"
+#include "boot_prof.h"
+#include "hot_bench.h"
+#include "pc_prof.h"
+#include "mem_bench.h"
+#include "replay.h"
+#include "job_wcet.h"
+#include "deadline.h"
+#include "cruise_law.h"
 
 #define DEBUG 1
 
 #define HW_TIMER_PERIOD 100 /* 100ms */
 
+/* Per-task utilization and stack report every N hyper periods, 0 = off */
+#define REPORT_EVERY 10
+
+/* Dump the PC sampling profile with the report, see tools/pcprof.py */
+#define PC_PROF_DUMP 1
+
+/* Dump the kernel event trace on the first deadline miss */
+#define TRACE_DUMP_ON_OVERLOAD 1
+
+/* Boot timeline up to the first actuation, 0 = no mark in the control
+ * loop and no boot report */
+#define BOOT_PROF 1
+
+/* Startup reductions: stacks cleared lazily instead of by crt0 and the
+ * idle counter calibration of the previous boot, 0 = boot as before */
+#define BOOT_FAST 1
+
+/* Time the kernel memory routines once at startup, see mem_bench.h */
+#define MEM_BENCH 0
+
+/* Inputs and throttle, see replay.h: 0 = off, 1 = record (dumped on the
+ * first deadline miss and when the log is full), 2 = replay src/replay_log.h
+ * made by tools/replay2c.py */
+#define REPLAY_MODE 1
+
+/* Gains of the control law, see cruise_law.h; tools/cruise_sweep.c
+ * compares others on the host */
+static const cruise_gains_t cruise_gains = CRUISE_GAINS_DEFAULT;
+
 /* Button Patterns */
 #define GAS_PEDAL_FLAG      0x08
 #define BRAKE_PEDAL_FLAG    0x04
@@ -54,17 +96,46 @@
 //      |- Standard task stacksize
 #define TASK_STACKSIZE 2048
 
+//      |- Worst-case stack use from tools/stackdepth.py, run.sh writes it
+//         again after every build and fails if it is stale against the
+//         listing; the standard size where it has none
+#include "stack_depth.h"
+#ifndef STACK_DEPTH_STARTTASK
+#define STACK_DEPTH_STARTTASK TASK_STACKSIZE
+#endif
+#ifndef STACK_DEPTH_CONTROLTASK
+#define STACK_DEPTH_CONTROLTASK TASK_STACKSIZE
+#endif
+#ifndef STACK_DEPTH_VEHICLETASK
+#define STACK_DEPTH_VEHICLETASK TASK_STACKSIZE
+#endif
+#ifndef STACK_DEPTH_WATCHDOGTASK
+#define STACK_DEPTH_WATCHDOGTASK TASK_STACKSIZE
+#endif
+#ifndef STACK_DEPTH_EXTRALOADTASK
+#define STACK_DEPTH_EXTRALOADTASK TASK_STACKSIZE
+#endif
+#ifndef STACK_DEPTH_REPORTTASK
+#define STACK_DEPTH_REPORTTASK TASK_STACKSIZE
+#endif
+
+#if BOOT_FAST
+#define TASK_STACK_SECTION BOOT_NOINIT
+#else
+#define TASK_STACK_SECTION
+#endif
+
 // Declare stacksize for each task
 //      |- Original task stacksize
-OS_STK StartTask_Stack[TASK_STACKSIZE];
-OS_STK ControlTask_Stack[TASK_STACKSIZE];
-OS_STK VehicleTask_Stack[TASK_STACKSIZE];
+OS_STK StartTask_Stack[STACK_DEPTH_STARTTASK] TASK_STACK_SECTION;
+OS_STK ControlTask_Stack[STACK_DEPTH_CONTROLTASK] TASK_STACK_SECTION;
+OS_STK VehicleTask_Stack[STACK_DEPTH_VEHICLETASK] TASK_STACK_SECTION;
 //      |- Added task stacksize
-OS_STK SwitchIOTask_Stack[TASK_STACKSIZE];
-OS_STK KeyIOTask_Stack[TASK_STACKSIZE];
-OS_STK OverloadDetectionTask_Stack[TASK_STACKSIZE];
-OS_STK WatchdogTask_Stack[TASK_STACKSIZE];
-OS_STK ExtraLoadTask_Stack[TASK_STACKSIZE];
+//         SwitchIOTask and KeyIOTask are basic tasks, they share the
+//         stack of basic_task.c
+OS_STK WatchdogTask_Stack[STACK_DEPTH_WATCHDOGTASK] TASK_STACK_SECTION;
+OS_STK ExtraLoadTask_Stack[STACK_DEPTH_EXTRALOADTASK] TASK_STACK_SECTION;
+OS_STK ReportTask_Stack[STACK_DEPTH_REPORTTASK] TASK_STACK_SECTION;
 
 
 //-- Task Priorities
@@ -82,7 +153,9 @@ OS_STK ExtraLoadTask_Stack[TASK_STACKSIZE];
 #define KEYIOTASK_PRIO                  8
 
 #define EXTRALOADTASK_PRIO             13
-#define OVERLOADDETECTIONTASK_PRIO     15
+
+//         Lowest priority above the statistics task, prints the reports
+#define REPORTTASK_PRIO                18
 
 // // NOTE: Test config.DEBUG
 // #define STARTTASK_PRIO                  5
@@ -104,6 +177,7 @@ OS_STK ExtraLoadTask_Stack[TASK_STACKSIZE];
 #define SWITCHIO_PERIOD 150 //DEBUG 150
 #define KEYIO_PERIOD    150 //DEBUG 150
 #define HYPER_PERIOD    300
+#define REPORT_PERIOD   ((REPORT_EVERY > 0 ? REPORT_EVERY : 1) * HYPER_PERIOD)
 
 /*
  * Definition of Kernel Objects
@@ -126,9 +200,6 @@ OS_EVENT *Mbox_ExtraLoadCreation;
 //      |- Semaphores
 OS_EVENT *Sem_Vehicle;
 OS_EVENT *Sem_Control;
-OS_EVENT *Sem_SwitchIO;
-OS_EVENT *Sem_KeyIO;
-OS_EVENT *Sem_OverloadDetection;
 OS_EVENT *Sem_ExtraLoad;
 
 //      |- SW-Timers
@@ -136,14 +207,23 @@ OS_TMR *Timer_Vehicle;
 OS_TMR *Timer_Control;
 OS_TMR *Timer_SwitchIO;
 OS_TMR *Timer_KeyIO;
-OS_TMR *Timer_OverloadDetection;
 OS_TMR *Timer_ExtraLoad;
 
+// Basic tasks
+basic_task_t SwitchIO_Basic;
+basic_task_t KeyIO_Basic;
+
 /*
  * Types
  */
 enum active {on = 2, off = 1};
 
+// Deadline miss, posted to the Watchdog through Mbox_Overload
+typedef struct {
+    INT8U   prio;           // task that missed
+    alt_u32 late_us;        // past the deadline when it was seen
+} deadline_miss_t;
+
 
 /*
  * Global variables
@@ -153,24 +233,30 @@ INT16U led_green = 0; // Green LEDs
 INT32U led_red = 0;   // Red LEDs
 
 
+#if REPLAY_MODE == 2
+static const replay_entry_t replay_log[] = {
+#include "replay_log.h"
+};
+#endif
+
 /*
  * Helper functions
  */
 
 int buttons_pressed(void)
 {
-    return ~IORD_ALTERA_AVALON_PIO_DATA(D2_PIO_KEYS4_BASE);
+    return replay_input(REPLAY_KEYS, ~IORD_ALTERA_AVALON_PIO_DATA(D2_PIO_KEYS4_BASE));
 }
 
 int switches_pressed(void)
 {
-    return IORD_ALTERA_AVALON_PIO_DATA(DE2_PIO_TOGGLES18_BASE);
+    return replay_input(REPLAY_SWITCHES, IORD_ALTERA_AVALON_PIO_DATA(DE2_PIO_TOGGLES18_BASE));
 }
 
 /*
  * ISR for HW Timer
  */
-alt_u32 alarm_handler(void* context)
+alt_u32 ALT_HOT alarm_handler(void* context)
 {
     OSTmrSignal(); /* Signals a 'tick' to the SW timers */
     return delay;
@@ -308,41 +394,59 @@ void show_position(INT16U position)
 //          := Use OSSemPost() to release the Semaphore through callback funcs
 //          := when the periodic timer expires
 //          := which means that, we release the scheduled job-to-be-done
+//          := and stamp the release of the job for its deadline, see deadline.h
+//          := They are no tasks of their own: OSTmr_Task calls them, and it
+//          := pends in the middle of its loop, so it keeps its full stack
 
 void Timer_Vehicle_CallbackSemPost()
 {
-    INT8U err;
-    err = OSSemPost(Sem_Vehicle);
+    deadline_release(VEHICLETASK_PRIO);
+    (void) OSSemPost(Sem_Vehicle);
 }
 
 void Timer_Control_CallbackSemPost()
 {
-    INT8U err;
-    err = OSSemPost(Sem_Control);
+    deadline_release(CONTROLTASK_PRIO);
+    (void) OSSemPost(Sem_Control);
 }
 
-void Timer_SwitchIO_CallbackSemPost()
+//          := The IO scanning runs to completion, its timers activate
+//          := the IO tasks as basic tasks instead
+void Timer_SwitchIO_CallbackActivate()
 {
-    INT8U err;
-    err = OSSemPost(Sem_SwitchIO);
+    deadline_release(SWITCHIOTASK_PRIO);
+    (void) basic_task_activate(&SwitchIO_Basic);
 }
 
-void Timer_KeyIO_CallbackSemPost()
+void Timer_KeyIO_CallbackActivate()
 {
-    INT8U err;
-    err = OSSemPost(Sem_KeyIO);
+    deadline_release(KEYIOTASK_PRIO);
+    (void) basic_task_activate(&KeyIO_Basic);
 }
 
-void Timer_OverloadDetection_CallbackSemPost()
+void Timer_ExtraLoad_CallbackSemPost()
 {
-    INT8U err;
-    err = OSSemPost(Sem_OverloadDetection);
+    deadline_release(EXTRALOADTASK_PRIO);
+    (void) OSSemPost(Sem_ExtraLoad);
 }
 
-void Timer_ExtraLoad_CallbackSemPost()
+//          := A job finished after its deadline, or is still running past it,
+//          := called in the timer task: wake up the Watchdog with a record of
+//          := the miss. The timer task is the only one that posts: a record
+//          := is written while the mailbox is empty, into the one the Watchdog
+//          := is not reading; a second miss before it ran is only counted
+void Deadline_Miss(INT8U prio, alt_u32 late_us)
 {
-    INT8U err;
-    err = OSSemPost(Sem_ExtraLoad);
+    static deadline_miss_t miss[2];
+    static int next = 0;
+
+    if (Mbox_Overload->OSEventPtr == (void *) 0)
+    {
+        miss[next].prio = prio;
+        miss[next].late_us = late_us;
+        (void) OSMboxPost(Mbox_Overload, (void *) &miss[next]);
+        next ^= 1;
+    }
 }
 
 
@@ -357,35 +461,29 @@ void Timer_ExtraLoad_CallbackSemPost()
  */
 
  //         |- VehicleTask() Body
-void VehicleTask(void* pdata)
+void ALT_HOT VehicleTask(void* pdata)
 {
-    // constants that should not be modified
-    const unsigned int wind_factor = 1;
-    const unsigned int brake_factor = 4;
-    const unsigned int gravity_factor = 2;
-
     // variables relevant to the model and its simulation on top of the RTOS
     INT8U err;
     void* msg;
-    INT8U* throttle;
+    INT8U closed = 0;
+    INT8U* throttle = &closed;   // until the ControlTask sends one
     INT16S acceleration;
-    INT16U position = 0;
-    INT16S velocity = 0;
+    cruise_vehicle_t vehicle = { 0, 0 };    // see cruise_law.c
+    cruise_vehicle_t before;
     enum active brake_pedal = off;
     enum active engine = off;
-    INT16U local_led_green = 0; // Green LEDs
-    INT32U local_led_red = 0;   // Red LEDs
 
     printf("Vehicle task created!\n");
 
     while(1)
     {
         // Send velocity msg to Mbox
-        err = OSMboxPost(Mbox_Velocity, (void *) &velocity);
+        err = OSMboxPost(Mbox_Velocity, (void *) &vehicle.velocity);
 
         // OSTimeDlyHMSM(0,0,0,VEHICLE_PERIOD);
         // Wait for the timer releasing the semaphore
-        OSSemPend(Sem_Vehicle, 0, err);
+        OSSemPend(Sem_Vehicle, 0, &err);
 
 
         // Get vehicle components status
@@ -420,82 +518,30 @@ void VehicleTask(void* pdata)
 
 
         // vehichle cannot effort more than 80 units of throttle
-        if (*throttle > 80)
+        if (*throttle > CRUISE_THROTTLE_MAX)
         {
-            *throttle = 80;
+            *throttle = CRUISE_THROTTLE_MAX;
         }
 
-        // brakes + wind
-        if (brake_pedal == off)
-        {
-            // wind resistance
-            acceleration = - wind_factor * velocity;
-            // actuate with engines
-            if (engine == on)
-            {
-                acceleration += (*throttle);
-            }
+        // Moves on, back to the starting point past the end of the track
+        before = vehicle;
+        acceleration = cruise_vehicle_step(&vehicle, &cruise_track_lab, *throttle,
+                                           brake_pedal == on, engine == on, VEHICLE_PERIOD);
 
-            // gravity effects
-            if (400 <= position && position < 800)
-            {
-                acceleration -= gravity_factor;                 // traveling uphill
-            }
-            else if (800 <= position && position < 1200)
-            {
-                acceleration -= 2 * gravity_factor;             // traveling steep uphill
-            }
-            else if (1600 <= position && position < 2000)
-            {
-                acceleration += 2 * gravity_factor;             //traveling downhill
-            }
-            else if (2000 <= position)
-            {
-                acceleration += gravity_factor;                 // traveling steep downhill
-            }
-        }
-        else
-        {
-            // if the engine and the brakes are activated at the same time,
-            // we assume that the brake dynamics dominates, so both cases fall
-            // here.
-            acceleration = -brake_factor * velocity;
-        }
-
-        printf("Position: %d m\n", position);
-        printf("Velocity: %d m/s\n", velocity);
+        printf("Position: %d m\n", before.position);
+        printf("Velocity: %d m/s\n", before.velocity);
         printf("Accell: %d m/s2\n", acceleration);
         printf("Throttle: %d V\n", *throttle);
 
-        position = position + velocity * VEHICLE_PERIOD / 1000;
-        velocity = velocity  + acceleration * VEHICLE_PERIOD / 1000.0;
-
-        // Close the loop of the track
-        // Reset the position to the starting point
-        if (position > 2400)
-        {
-            position = 0;
-        }
-
         // Display current velocity on LCDs
-        show_velocity_on_sevenseg((INT8S) velocity);
+        show_velocity_on_sevenseg((INT8S) vehicle.velocity);
 
         // Update current position onto global Red LEDs configs.
-        show_position(position);
+        show_position(vehicle.position);
 
-        // if ( (led_red << 6) != local_led_red )
-        // {
-        //     local_led_red = led_red;
-        //     IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_REDLED18_BASE, led_red);
-        // }
         // Display Red LEDs according to the current global led_red config.
         IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_REDLED18_BASE, led_red);
 
-        // if ( led_green != local_led_green )
-        // {
-        //     local_led_green = led_green;
-        //     IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_REDLED18_BASE, led_red);
-        // }
         // Display Green LEDs according to the current global led_green config.
         IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_GREENLED9_BASE, led_green);
 
@@ -511,17 +557,13 @@ void VehicleTask(void* pdata)
  * on sensors and generates responses.
  */
  //         |- ControlTask() Body
-void ControlTask(void* pdata)
+void ALT_HOT ControlTask(void* pdata)
 {
     INT8U err;
-    INT8U throttle = 40; /* Value between 0 and 80, which is interpreted as between 0.0V and 8.0V */
+    cruise_control_t law = CRUISE_CONTROL_INIT;    // see cruise_law.c
     void* msg;
     INT16S* current_velocity;
 
-    INT8U target_velocity = 0;               // added
-
-
-
     enum active gas_pedal = off;
     enum active top_gear = off;
     enum active cruise_control = off;
@@ -529,11 +571,8 @@ void ControlTask(void* pdata)
     enum active engine = off;               // added
     enum active brake_pedal = off;          // added
 
-    enum active auto_cruise = off;         // added
-
-    INT8U Kp = 1;           // speed proportional control gain
-    INT8U dt = 1;           // time tick
-    INT16S delta_u = 0;     // second term of PI-Controller
+    int inputs, outputs;
+    alt_u32 cycle_start;
 
     printf("Control Task created!\n");
 
@@ -565,105 +604,40 @@ void ControlTask(void* pdata)
         msg = OSMboxPend(Mbox_Gas, 0, &err);
         gas_pedal = *((enum active*) msg);
 
-        // throttle = 0;
+        cycle_start = hot_bench_begin();
+
+        inputs = (engine == on ? CRUISE_ENGINE : 0)
+               | (top_gear == on ? CRUISE_TOP_GEAR : 0)
+               | (cruise_control == on ? CRUISE_BUTTON : 0)
+               | (brake_pedal == on ? CRUISE_BRAKE : 0)
+               | (gas_pedal == on ? CRUISE_GAS : 0);
+
+        // Laws 1-4: engine, auto-cruise, gas pedal and brake pedal control
+        outputs = cruise_control_step(&law, &cruise_gains, *current_velocity, inputs);
 
-        // Law - 1: Engine Control
         // The user cannot close the engine if current velocity > 0 m/s
-        if (engine == off && *current_velocity > 0)
-        {
-            engine = on;
-        }
-        // Update the global led_red config for ENGINE status
+        engine = (outputs & CRUISE_ENGINE) ? on : off;
         if (engine == on)
         {
             led_red = led_red | LED_RED_0;
         }
-
-        // Law - 2: Auto-Cruise Control
-        // Check if open Cruise Control
-        // Auto-Cruise Pre-conditions:
-        //      - cruise_control        ON
-        //      - top_gear              ON
-        //      - current_velocity      >= 20 m/s
-        //      - brake_pedal           OFF
-        //      - gas_peadl             OFF
-        if (cruise_control == on && auto_cruise == off)
-        {
-            auto_cruise = on;
-            target_velocity = (INT8U) *current_velocity;
-            if (target_velocity < 29)
-            {
-                target_velocity = 29;
-            }
-        }
-
-        if (auto_cruise == on && top_gear == on \
-                                 && *current_velocity >= 20 \
-                                 && brake_pedal == off \
-                                 && gas_pedal == off
-                                 // && cruise_control == on
-                             )
+        if (outputs & CRUISE_CRUISING)
         {
-            // Like the vehicle cruise control system in reality
-            // If the user press the Cruise Control Key,
-            // they want to fix the current velocity for cruise
-
-            // If all the pre-condition checks are passed
-            // the Cruise Control function is activated
-
-            // Starting Auto-Cruise Function
-            // Set current velocity as target_velocity
-            // target_velocity = (INT8U) *current_velocity;
-            // if (target_velocity < 29)
-            //     target_velocity = 29;
-
-            // Turn ON LED_GREEN_2 for Auto-Cruise
             led_green = led_green | LED_GREEN_2; //CruiseControll led
-
-            // Run the Control Law of Auto-Cruise
-            // Here we use a PI-controller to control the throttle
-            delta_u = Kp * (target_velocity - (INT8U) *current_velocity);
-            throttle = throttle + delta_u * dt;
         }
-        else
+        if (outputs & CRUISE_GAS_APPLIED)
         {
-            auto_cruise = off;      // DEBUG
-            target_velocity = 0;
-            delta_u = 0;
-        }
-
-        // Law - 3: Gas Pedal Control
-        // The user can only activate the Gas Pedal when the engine is ON
-        // Assumption in manual control:
-        //      - Top Gear --> 60 throttle
-        //      - Low Gear --> 30 throttle
-        //      NOTE: we do not want to touch the maximum throttle
-        if (gas_pedal == on && engine == on)
-        {
-            // Turn ON the Gas Pedal green LED
             led_green = led_green | LED_GREEN_6;
-            if(top_gear == on)
-            {
-                throttle = 60;
-            }
-            else
-            {
-                throttle = 30;
-            }
-        }
-
-        // Law - 4: Brake Pedal Control
-        // Assumption in manual control:
-        //      - Turn off the throttle if the vehicle receive Brake signal
-        if (brake_pedal == on)
-        {
-            throttle = 0;
         }
 
         // ----- Control Law End -----
 
         // Sent the controls to their Mboxes
-        err = OSMboxPost(Mbox_Throttle, (void *) &throttle);
+        err = OSMboxPost(Mbox_Throttle, (void *) &law.throttle);
+        replay_output(REPLAY_THROTTLE, law.throttle);
+#if BOOT_PROF
+        boot_prof_done("first actuation");
+#endif
         err = OSMboxPost(Mbox_Engine, (void *) &engine);
 
         // Should I return them to the MailBoxes ?
@@ -673,7 +647,8 @@ void ControlTask(void* pdata)
         // err = OSMboxPost(Mbox_Gear, (void *) &top_gear);//<---NOTE
         // err = OSMboxPost(Mbox_Cruise, (void *) &cruise_control);
 
-        show_target_velocity(target_velocity);
+        show_target_velocity(law.target_velocity);
+        hot_bench_end(HOT_BENCH_CONTROL, cycle_start);
 
         // OSTimeDlyHMSM(0,0,0, CONTROL_PERIOD);
         OSSemPend(Sem_Control, 0, &err);
@@ -681,197 +656,204 @@ void ControlTask(void* pdata)
 }
 
 //         |- SwitchIOTask() Body
+//            Basic task, one scan per activation. The signals are posted
+//            by address, so they are static.
 void SwitchIOTask(void* pdata)
 {
-    INT8U err;
 
-    enum active Signal_Engine = off;
-    enum active Signal_TopGear = off;
+    static enum active Signal_Engine = off;
+    static enum active Signal_TopGear = off;
 
-    INT16U Signal_ExtraLoadAdjustIO;
+    static INT16U Signal_ExtraLoadAdjustIO;
     int extraload_check_mask = 0x3F0;
 
     int event_SwitchIOs;
 
-    while (1)
+    // SwitchIOs scanning begin
+    // switches_pressed() return the scanned SwitchIOs config in bit-wise
+    event_SwitchIOs = switches_pressed();
+    Signal_ExtraLoadAdjustIO = 0;
+
+    /* Bit Operation Description
+     * Use Bit operation to check each SwitchIOs' status
+     * e.g.: Engine Check
+     *      ENGINE_FLAG = 0x00000001 = 2^0
+     *      Use ENGINE_FLAG as a Mask
+     *      Do AND opt. on current SwitchIOs config 'event_SwitchIOs'
+     *      Other bits related to other IOs will be filtered out
+     *      If the bit represent the ENGINE ON is 1, then signal engine on
+     *      Otherwise, signal engine OFF
+     */
+    //      |- ENGINE Signal Check
+    //         ENGINE_FLAG = 0x00000001 = 2^0 --> SW0
+    if (event_SwitchIOs & ENGINE_FLAG)
     {
-        OSSemPend(Sem_SwitchIO, 0, &err);
-        // SwitchIOs scanning begin
-        // switches_pressed() return the scanned SwitchIOs config in bit-wise
-        event_SwitchIOs = switches_pressed();
-        Signal_ExtraLoadAdjustIO = 0;
-
-        /* Bit Operation Description
-         * Use Bit operation to check each SwitchIOs' status
-         * e.g.: Engine Check
-         *      ENGINE_FLAG = 0x00000001 = 2^0
-         *      Use ENGINE_FLAG as a Mask
-         *      Do AND opt. on current SwitchIOs config 'event_SwitchIOs'
-         *      Other bits related to other IOs will be filtered out
-         *      If the bit represent the ENGINE ON is 1, then signal engine on
-         *      Otherwise, signal engine OFF
-         */
-        //      |- ENGINE Signal Check
-        //         ENGINE_FLAG = 0x00000001 = 2^0 --> SW0
-        if (event_SwitchIOs & ENGINE_FLAG)
-        {
-            // led_red = led_red | LED_RED_0;
-            Signal_Engine = on;
-        }
-        else
-        {
-            Signal_Engine = off;
-        }
-
-        //  |- GEAR Signal Check
-        //         ENGINE_FLAG = 0x00000002 = 2^1 --> SW1
-        if (event_SwitchIOs & TOP_GEAR_FLAG)
-        {
-            // If TOP_GEAR is ON --> Turn ON the LED_RED_1
-            led_red = led_red | LED_RED_1;
-            Signal_TopGear = on;
-        }
-        else
-        {
-            Signal_TopGear = off;
-        }
+        // led_red = led_red | LED_RED_0;
+        Signal_Engine = on;
+    }
+    else
+    {
+        Signal_Engine = off;
+    }
 
-        // Check total SwitchIOs config in order to detect the created
-        // extra loads through SwitchIOs [SW9, SW0]
-        // extra load checking Mask:
-        //         SW9 SW8 SW7 SW6 SW5 SW4 SW3 SW2 SW1 SW0
-        // 0x3F0 =  1   1   1   1   1   1   0   0   0   0  = 63 = 2^6 - 1
-        Signal_ExtraLoadAdjustIO = event_SwitchIOs & extraload_check_mask;
-
-        // Turn ON the extra Tasks LEDs
-        led_red = led_red | Signal_ExtraLoadAdjustIO;
-
-        // Convert the binary dummy extra tasks to Decimal base
-        // Then, the range [0, 63] can be adjusted by the 6 Keys
-        Signal_ExtraLoadAdjustIO = Signal_ExtraLoadAdjustIO >> 4;
-
-        // Sent the captured Signals to their Mboxes
-        //      |- Signal_Engine   --> Mbox_Engine
-        //      |- Signal_TopGear  --> Mbox_Gear
-        //      |- Signal_ExtraLoadAdjustIO --> Mbox_ExtraLoadCreation
-		err = OSMboxPost(Mbox_Engine, (void *) &Signal_Engine);
- 		err = OSMboxPost(Mbox_Gear, (void *) &Signal_TopGear);
-        err = OSMboxPost(Mbox_ExtraLoadCreation, (void *) &Signal_ExtraLoadAdjustIO);
+    //  |- GEAR Signal Check
+    //         ENGINE_FLAG = 0x00000002 = 2^1 --> SW1
+    if (event_SwitchIOs & TOP_GEAR_FLAG)
+    {
+        // If TOP_GEAR is ON --> Turn ON the LED_RED_1
+        led_red = led_red | LED_RED_1;
+        Signal_TopGear = on;
+    }
+    else
+    {
+        Signal_TopGear = off;
     }
+
+    // Check total SwitchIOs config in order to detect the created
+    // extra loads through SwitchIOs [SW9, SW0]
+    // extra load checking Mask:
+    //         SW9 SW8 SW7 SW6 SW5 SW4 SW3 SW2 SW1 SW0
+    // 0x3F0 =  1   1   1   1   1   1   0   0   0   0  = 63 = 2^6 - 1
+    Signal_ExtraLoadAdjustIO = event_SwitchIOs & extraload_check_mask;
+
+    // Turn ON the extra Tasks LEDs
+    led_red = led_red | Signal_ExtraLoadAdjustIO;
+
+    // Convert the binary dummy extra tasks to Decimal base
+    // Then, the range [0, 63] can be adjusted by the 6 Keys
+    Signal_ExtraLoadAdjustIO = Signal_ExtraLoadAdjustIO >> 4;
+
+    // Sent the captured Signals to their Mboxes
+    //      |- Signal_Engine   --> Mbox_Engine
+    //      |- Signal_TopGear  --> Mbox_Gear
+    //      |- Signal_ExtraLoadAdjustIO --> Mbox_ExtraLoadCreation
+    (void) OSMboxPost(Mbox_Engine, (void *) &Signal_Engine);
+    (void) OSMboxPost(Mbox_Gear, (void *) &Signal_TopGear);
+    (void) OSMboxPost(Mbox_ExtraLoadCreation, (void *) &Signal_ExtraLoadAdjustIO);
 }
 
 //         |- KeyIOTask() Body
+//            Basic task, one scan per activation
 void KeyIOTask(void* pdata)
 {
-    INT8U err;
-    enum active Signal_CruiseControl = off;
-    enum active Signal_GasPedal = off;
-    enum active Signal_BrakePedal = off;
+    static enum active Signal_CruiseControl = off;
+    static enum active Signal_GasPedal = off;
+    static enum active Signal_BrakePedal = off;
     int event_KeyIOs;
 
-    while (1)
+    // KeyIOs scanning begin
+    // switches_pressed() return the scanned KeyIOs config in bit-wise
+    event_KeyIOs = buttons_pressed();
+
+    /* Bit Operation Description
+     * Use Bit operation to check each KeyIOs' status
+     * e.g.: CRUISE CONTROL Check
+     *      CRUISE_CONTROL_FLAG = 0x02 = 2^1
+     *      Use CRUISE_CONTROL_FLAG as a Mask
+     *      Do AND opt. on current KeyIOs config 'event_KeyIOs'
+     *      Other bits related to other IOs will be filtered out
+     *      If the bit represent the CRUISE_CONTROL ON is 1
+     *      then signal Signal_CruiseControl on, otherwise, signal engine OFF
+     */
+    //      |- Cruise Control signal check
+    //         CRUISE_CONTROL_FLAG = 0x02 = 2^1 --> Key1
+    if (event_KeyIOs & CRUISE_CONTROL_FLAG)
     {
-        OSSemPend(Sem_KeyIO, 0, &err);
-        // KeyIOs scanning begin
-        // switches_pressed() return the scanned KeyIOs config in bit-wise
-        event_KeyIOs = buttons_pressed();
-
-        /* Bit Operation Description
-         * Use Bit operation to check each KeyIOs' status
-         * e.g.: CRUISE CONTROL Check
-         *      CRUISE_CONTROL_FLAG = 0x02 = 2^1
-         *      Use CRUISE_CONTROL_FLAG as a Mask
-         *      Do AND opt. on current KeyIOs config 'event_KeyIOs'
-         *      Other bits related to other IOs will be filtered out
-         *      If the bit represent the CRUISE_CONTROL ON is 1
-         *      then signal Signal_CruiseControl on, otherwise, signal engine OFF
-         */
-        //      |- Cruise Control signal check
-        //         CRUISE_CONTROL_FLAG = 0x02 = 2^1 --> Key1
-        if (event_KeyIOs & CRUISE_CONTROL_FLAG)
-        {
-            Signal_CruiseControl = on;
-        }
-        else
-        {
-            Signal_CruiseControl = off;
-        }
-
-        //      |- Brake Pedal signal check
-        //         BRAKE_PEDAL_FLAG = 0x04 = 2^2 --> Key2
-        if (event_KeyIOs & BRAKE_PEDAL_FLAG)
-        {
-            led_green = led_green | LED_GREEN_4;
-            Signal_BrakePedal = on;
-        }
-        else
-        {
-            Signal_BrakePedal = off;
-        }
-
-        //      |- Gas Pedal signal check
-        //         GAS_PEDAL_FLAG = 0x08 = 2^3 --> Key3
-        if (event_KeyIOs & GAS_PEDAL_FLAG)
-        {
-            // led_green = led_green | LED_GREEN_6;
-            Signal_GasPedal = on;
-        }
-        else
-        {
-            Signal_GasPedal = off;
-        }
+        Signal_CruiseControl = on;
+    }
+    else
+    {
+        Signal_CruiseControl = off;
+    }
 
-        // Sent the captured Signals to their Mboxes
-        //      |- Signal_CruiseControl --> Mbox_Cruise
-        //      |- Signal_BrakePedal   --> Mbox_Brake
-        //      |- Signal_GasPedal  --> Mbox_Gas
-        err = OSMboxPost(Mbox_Cruise, (void *) &Signal_CruiseControl);
-        err = OSMboxPost(Mbox_Brake, (void *) &Signal_BrakePedal);
-        err = OSMboxPost(Mbox_Gas, (void *) &Signal_GasPedal);
+    //      |- Brake Pedal signal check
+    //         BRAKE_PEDAL_FLAG = 0x04 = 2^2 --> Key2
+    if (event_KeyIOs & BRAKE_PEDAL_FLAG)
+    {
+        led_green = led_green | LED_GREEN_4;
+        Signal_BrakePedal = on;
+    }
+    else
+    {
+        Signal_BrakePedal = off;
     }
-}
 
-//         |- OverloadDetectionTask() Body
-void OverloadDetectionTask(void* pdata)
-{
-    // This OverloadDetection Task has the lowest task priority
-    // within the entire program with 300 ms as period
-    // The working mechanism of this function is as below:
-    //      | if: it can be executed once within the HYPER_PERIOD = 300 MS
-    //          |--> OK signal will be sent to the Mbox_Overload
-    //          |--> Thereby, the Watchdog can pend it from the Mbox_Overload
-    //      | else if: it cannot be executed once within the HYPER_PERIOD = 300 MS
-    //          |--> Which means, the system utilizantion reached 100% = 300 / 300
-    //          |--> because the system has no time to execute this detection
-    //          |--> Thereby, the Watchdog cannot post the OK signal from the
-    //          |--> Mbox_Overload. Then the dog will yell.
-    INT8U err;
-    int signal_ok = 1;
-    while(1)
+    //      |- Gas Pedal signal check
+    //         GAS_PEDAL_FLAG = 0x08 = 2^3 --> Key3
+    if (event_KeyIOs & GAS_PEDAL_FLAG)
     {
-        OSSemPend(Sem_OverloadDetection, 0, &err);
-        err = OSMboxPost(Mbox_Overload, (void *)signal_ok);
-	}
+        // led_green = led_green | LED_GREEN_6;
+        Signal_GasPedal = on;
+    }
+    else
+    {
+        Signal_GasPedal = off;
+    }
+
+    // Sent the captured Signals to their Mboxes
+    //      |- Signal_CruiseControl --> Mbox_Cruise
+    //      |- Signal_BrakePedal   --> Mbox_Brake
+    //      |- Signal_GasPedal  --> Mbox_Gas
+    (void) OSMboxPost(Mbox_Cruise, (void *) &Signal_CruiseControl);
+    (void) OSMboxPost(Mbox_Brake, (void *) &Signal_BrakePedal);
+    (void) OSMboxPost(Mbox_Gas, (void *) &Signal_GasPedal);
 }
 
 //         |- WatchdogTask() Body
 void WatchdogTask(void* pdata)
 {
-    // Wait for the OK signal from Mbox_Overload
-    // with 300 ms time-out
-    // if the Watchdog cannot receive the OK signal after 300 ms
-    // shoot the Overload alarm
+    // Wait for a deadline miss from Mbox_Overload, posted by
+    // Deadline_Miss() with the task that missed and how late it was,
+    // and report it
     INT8U err;
     void *msg;
+    deadline_miss_t miss;
+    INT8U name[OS_TASK_NAME_SIZE];
+    deadline_t missed;
+    int dumped = 0;
     while(1)
     {
-        msg = OSMboxPend(Mbox_Overload, 300, &err);
-        msg = OSMboxAccept(Mbox_Overload);      // just to clear it.
-        if(err == OS_ERR_TIMEOUT)
+        msg = OSMboxPend(Mbox_Overload, 0, &err);
+        if (err != OS_ERR_NONE)
         {
+            continue;
+        }
+        miss = *((deadline_miss_t*) msg);
+        if (deadline_get(miss.prio, &missed))
+        {
+            OSTaskNameGet(miss.prio, name, &err);
             printf("\n");
-            printf("--x--x--x--> Watchdog: Overload is detected!\n");
+            // A job still running past its deadline is only late so far
+            if (missed.overdue)
+            {
+                printf("--x--x--x--> Watchdog: %s is still running %u us past its deadline (%u missed of %u jobs)\n",
+                       (char *) name, (unsigned int) miss.late_us,
+                       (unsigned int) missed.misses, (unsigned int) missed.jobs);
+            }
+            else
+            {
+                printf("--x--x--x--> Watchdog: %s missed its deadline by %u us (%u missed of %u jobs)\n",
+                       (char *) name, (unsigned int) miss.late_us,
+                       (unsigned int) missed.misses, (unsigned int) missed.jobs);
+            }
             printf("\n");
+
+            // Freeze the trace to see which task overran, and export the
+            // inputs that led here to replay them
+            if (!dumped)
+            {
+                if (TRACE_DUMP_ON_OVERLOAD)
+                {
+                    trace_stop();
+                    trace_dump();
+                    trace_start();
+                }
+                if (REPLAY_MODE == 1)
+                {
+                    replay_dump();
+                }
+                dumped = 1;
+            }
         }
 	}
 }
@@ -911,6 +893,40 @@ void ExtraLoadTask(void* pdata)
 	}
 }
 
+//         |- ReportTask() Body
+//         Prints the boot timeline and the reports of the monitors, below
+//         all the watched tasks so the printing is in none of their jobs
+void ReportTask(void* pdata)
+{
+    int boot_reported = 0;
+
+    while(1)
+    {
+        OSTimeDly(REPORT_PERIOD * OS_TICKS_PER_SEC / 1000);
+
+        if (BOOT_PROF && !boot_reported && boot_prof_finished())
+        {
+            boot_prof_report();
+            boot_reported = 1;
+        }
+
+        if (REPORT_EVERY)
+        {
+            task_acct_report();
+            stack_mon_report();
+            basic_task_report();
+            job_wcet_report();
+            deadline_report();
+            hot_bench_report();
+            replay_report();
+            if (PC_PROF_DUMP)
+            {
+                pc_prof_dump();
+            }
+        }
+    }
+}
+
 
 /*
  * The task 'StartTask' creates all other tasks kernel objects and
@@ -920,10 +936,12 @@ void ExtraLoadTask(void* pdata)
 void StartTask(void* pdata)
 {
     INT8U err;
-    void* context;
+    void* context = NULL;
 
     static alt_alarm alarm;     /* Is needed for timer ISR function */
 
+    boot_prof_mark("OSStart");
+
     /* Base resolution for SW timer : HW_TIMER_PERIOD ms */
     delay = alt_ticks_per_second() * HW_TIMER_PERIOD / 1000;
     printf("delay in ticks %d\n", delay);
@@ -939,13 +957,9 @@ void StartTask(void* pdata)
     /*
     * Create and start Software Timer Tools
     */
-    BOOLEAN timer_status;
     //      |- Instantiate Semaphores
     Sem_Vehicle = OSSemCreate(0);
     Sem_Control = OSSemCreate(0);
-    Sem_SwitchIO = OSSemCreate(0);
-    Sem_KeyIO = OSSemCreate(0);
-    Sem_OverloadDetection = OSSemCreate(0);
     Sem_ExtraLoad = OSSemCreate(0);
 
     //      |- Instantiate Periodic Timers
@@ -974,7 +988,7 @@ void StartTask(void* pdata)
         0,
         SWITCHIO_PERIOD / HW_TIMER_PERIOD,
         OS_TMR_OPT_PERIODIC,
-        Timer_SwitchIO_CallbackSemPost,
+        Timer_SwitchIO_CallbackActivate,
         NULL,
         NULL,
         &err
@@ -984,17 +998,7 @@ void StartTask(void* pdata)
         0,
         KEYIO_PERIOD / HW_TIMER_PERIOD,
         OS_TMR_OPT_PERIODIC,
-        Timer_KeyIO_CallbackSemPost,
-        NULL,
-        NULL,
-        &err
-    );
-
-    Timer_OverloadDetection = OSTmrCreate(
-        0,
-        HYPER_PERIOD / HW_TIMER_PERIOD,
-        OS_TMR_OPT_PERIODIC,
-        Timer_OverloadDetection_CallbackSemPost,
+        Timer_KeyIO_CallbackActivate,
         NULL,
         NULL,
         &err
@@ -1011,12 +1015,11 @@ void StartTask(void* pdata)
     );
 
     //      |- Start Timers
-    timer_status = OSTmrStart(Timer_Vehicle, &err);
-    timer_status = OSTmrStart(Timer_Control, &err);
-    timer_status = OSTmrStart(Timer_SwitchIO, &err);
-    timer_status = OSTmrStart(Timer_KeyIO, &err);
-    timer_status = OSTmrStart(Timer_OverloadDetection, &err);
-    timer_status = OSTmrStart(Timer_ExtraLoad, &err);
+    OSTmrStart(Timer_Vehicle, &err);
+    OSTmrStart(Timer_Control, &err);
+    OSTmrStart(Timer_SwitchIO, &err);
+    OSTmrStart(Timer_KeyIO, &err);
+    OSTmrStart(Timer_ExtraLoad, &err);
 
     /*
     * Creation of Kernel Objects
@@ -1035,10 +1038,17 @@ void StartTask(void* pdata)
     Mbox_Overload = OSMboxCreate((void*) 0);
     Mbox_ExtraLoadCreation = OSMboxCreate((void*) 0);
 
+    boot_prof_mark("timers + kernel objects");
+
     /*
     * Create statistics task
     */
+#if BOOT_FAST
+    boot_stat_init();
+#else
     OSStatInit();
+#endif
+    boot_prof_mark("OSStatInit");
 
     /*
     * Creating Tasks in the system
@@ -1047,11 +1057,11 @@ void StartTask(void* pdata)
     err = OSTaskCreateExt(
         ControlTask,                            // Pointer to task code
         NULL,                                   // Pointer to argument that is passed to task
-        &ControlTask_Stack[TASK_STACKSIZE-1],   // Pointer to top of task stack
+        &ControlTask_Stack[STACK_DEPTH_CONTROLTASK-1],   // Pointer to top of task stack
         CONTROLTASK_PRIO,
         CONTROLTASK_PRIO,
         (void *)&ControlTask_Stack[0],
-        TASK_STACKSIZE,
+        STACK_DEPTH_CONTROLTASK,
         (void *) 0,
         OS_TASK_OPT_STK_CHK
     );
@@ -1060,63 +1070,29 @@ void StartTask(void* pdata)
     err = OSTaskCreateExt(
         VehicleTask,                            // Pointer to task code
         NULL,                                   // Pointer to argument that is passed to task
-        &VehicleTask_Stack[TASK_STACKSIZE-1],   // Pointer to top of task stack
+        &VehicleTask_Stack[STACK_DEPTH_VEHICLETASK-1],   // Pointer to top of task stack
         VEHICLETASK_PRIO,
         VEHICLETASK_PRIO,
         (void *)&VehicleTask_Stack[0],
-        TASK_STACKSIZE,
-        (void *) 0,
-        OS_TASK_OPT_STK_CHK
-    );
-
-    //      |- SwitchIOTask()
-    err = OSTaskCreateExt(
-        SwitchIOTask,                            // Pointer to task code
-        NULL,                                    // Pointer to argument that is passed to task
-        &SwitchIOTask_Stack[TASK_STACKSIZE-1],   // Pointer to top of task stack
-        SWITCHIOTASK_PRIO,
-        SWITCHIOTASK_PRIO,
-        (void *)&SwitchIOTask_Stack[0],
-        TASK_STACKSIZE,
+        STACK_DEPTH_VEHICLETASK,
         (void *) 0,
         OS_TASK_OPT_STK_CHK
     );
 
-    //      |- KeyIOTask()
-    err = OSTaskCreateExt(
-        KeyIOTask,                              // Pointer to task code
-        NULL,                                   // Pointer to argument that is passed to task
-        &KeyIOTask_Stack[TASK_STACKSIZE-1],     // Pointer to top of task stack
-        KEYIOTASK_PRIO,
-        KEYIOTASK_PRIO,
-        (void *)&KeyIOTask_Stack[0],
-        TASK_STACKSIZE,
-        (void *) 0,
-        OS_TASK_OPT_STK_CHK
-    );
-
-    //      |- OverloadDetectionTask()
-    err = OSTaskCreateExt(
-        OverloadDetectionTask,                              // Pointer to task code
-        NULL,                                               // Pointer to argument that is passed to task
-        &OverloadDetectionTask_Stack[TASK_STACKSIZE-1],     // Pointer to top of task stack
-        OVERLOADDETECTIONTASK_PRIO,
-        OVERLOADDETECTIONTASK_PRIO,
-        (void *)&OverloadDetectionTask_Stack[0],
-        TASK_STACKSIZE,
-        (void *) 0,
-        OS_TASK_OPT_STK_CHK
-    );
+    //      |- SwitchIOTask(), KeyIOTask()
+    //         Run to completion on the shared stack, activated by timers
+    err = basic_task_create(&SwitchIO_Basic, SwitchIOTask, NULL, SWITCHIOTASK_PRIO, 1);
+    err = basic_task_create(&KeyIO_Basic, KeyIOTask, NULL, KEYIOTASK_PRIO, 1);
 
     //      |- WatchdogTask()
     err = OSTaskCreateExt(
         WatchdogTask,                            // Pointer to task code
         NULL,                                    // Pointer to argument that is passed to task
-        &WatchdogTask_Stack[TASK_STACKSIZE-1],   // Pointer to top of task stack
+        &WatchdogTask_Stack[STACK_DEPTH_WATCHDOGTASK-1],   // Pointer to top of task stack
         WATCHDOGTASK_PRIO,
         WATCHDOGTASK_PRIO,
         (void *)&WatchdogTask_Stack[0],
-        TASK_STACKSIZE,
+        STACK_DEPTH_WATCHDOGTASK,
         (void *) 0,
         OS_TASK_OPT_STK_CHK
     );
@@ -1125,15 +1101,55 @@ void StartTask(void* pdata)
     err = OSTaskCreateExt(
         ExtraLoadTask,                            // Pointer to task code
         NULL,                                     // Pointer to argument that is passed to task
-        &ExtraLoadTask_Stack[TASK_STACKSIZE-1],   // Pointer to top of task stack
+        &ExtraLoadTask_Stack[STACK_DEPTH_EXTRALOADTASK-1],   // Pointer to top of task stack
         EXTRALOADTASK_PRIO,
         EXTRALOADTASK_PRIO,
         (void *)&ExtraLoadTask_Stack[0],
-        TASK_STACKSIZE,
+        STACK_DEPTH_EXTRALOADTASK,
+        (void *) 0,
+        OS_TASK_OPT_STK_CHK
+    );
+
+    //      |- ReportTask()
+    err = OSTaskCreateExt(
+        ReportTask,                               // Pointer to task code
+        NULL,                                     // Pointer to argument that is passed to task
+        &ReportTask_Stack[STACK_DEPTH_REPORTTASK-1],   // Pointer to top of task stack
+        REPORTTASK_PRIO,
+        REPORTTASK_PRIO,
+        (void *)&ReportTask_Stack[0],
+        STACK_DEPTH_REPORTTASK,
         (void *) 0,
         OS_TASK_OPT_STK_CHK
     );
 
+    // Task names show up in the trace dump and the accounting report
+    OSTaskNameSet(CONTROLTASK_PRIO, (INT8U *) "ControlTask", &err);
+    OSTaskNameSet(VEHICLETASK_PRIO, (INT8U *) "VehicleTask", &err);
+    OSTaskNameSet(SWITCHIOTASK_PRIO, (INT8U *) "SwitchIOTask", &err);
+    OSTaskNameSet(KEYIOTASK_PRIO, (INT8U *) "KeyIOTask", &err);
+    OSTaskNameSet(WATCHDOGTASK_PRIO, (INT8U *) "WatchdogTask", &err);
+    OSTaskNameSet(EXTRALOADTASK_PRIO, (INT8U *) "ExtraLoadTask", &err);
+    OSTaskNameSet(REPORTTASK_PRIO, (INT8U *) "ReportTask", &err);
+
+    // Execution time of every job, from the release to the next pend on it
+    job_wcet_watch(VEHICLETASK_PRIO, Sem_Vehicle);
+    job_wcet_watch(CONTROLTASK_PRIO, Sem_Control);
+    job_wcet_watch(EXTRALOADTASK_PRIO, Sem_ExtraLoad);
+    job_wcet_watch(WATCHDOGTASK_PRIO, Mbox_Overload);
+    job_wcet_watch(SWITCHIOTASK_PRIO, NULL);
+    job_wcet_watch(KEYIOTASK_PRIO, NULL);
+
+    // Deadline of every job, the end of its period; the timers run already,
+    // releases before this are not stamped
+    deadline_watch(VEHICLETASK_PRIO, Sem_Vehicle, VEHICLE_PERIOD);
+    deadline_watch(CONTROLTASK_PRIO, Sem_Control, CONTROL_PERIOD);
+    deadline_watch(SWITCHIOTASK_PRIO, NULL, SWITCHIO_PERIOD);
+    deadline_watch(KEYIOTASK_PRIO, NULL, KEYIO_PERIOD);
+    deadline_watch(EXTRALOADTASK_PRIO, Sem_ExtraLoad, HYPER_PERIOD);
+    deadline_handler(Deadline_Miss);
+
+    boot_prof_mark("task creation");
     printf("All Tasks and Kernel Objects generated!\n");
 
     /* Task deletes itself */
@@ -1150,17 +1166,33 @@ void StartTask(void* pdata)
 
 int main(void) {
     printf("--=--=--=-- Lab: Cruise Control --=--=--=--\n");
+    boot_prof_mark("banner");
+
+    trace_init();       // both start the timestamp timer, continuously
+    task_acct_init();
+    stack_mon_lazy_clear(BOOT_FAST);
+    pc_prof_start(PC_PROF_TICK, 0);
+#if REPLAY_MODE == 1
+    replay_record();
+#elif REPLAY_MODE == 2
+    replay_play(replay_log, REPLAY_ENTRIES(replay_log));
+#endif
+    boot_prof_mark("monitors");
+#if MEM_BENCH
+    mem_bench_run();
+    boot_prof_mark("mem_bench");
+#endif
 
     OSTaskCreateExt(
         StartTask,                                      // Pointer to task code
         NULL,                                           // Pointer to argument that is
                                                         // passed to task
-        (void *)&StartTask_Stack[TASK_STACKSIZE-1],     // Pointer to top
+        (void *)&StartTask_Stack[STACK_DEPTH_STARTTASK-1],     // Pointer to top
                                                         // of task stack
         STARTTASK_PRIO,
         STARTTASK_PRIO,
         (void *)&StartTask_Stack[0],
-        TASK_STACKSIZE,
+        STACK_DEPTH_STARTTASK,
         (void *) 0,
         OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR
     );
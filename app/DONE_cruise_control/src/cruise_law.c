@@ -0,0 +1,134 @@
+/* Vehicle model and control laws of the cruise control
+ *
+ * See cruise_law.h for the description.
+ */
+#include "cruise_law.h"
+
+/* Constants of the model that should not be modified */
+#define WIND_FACTOR     1
+#define BRAKE_FACTOR    4
+#define GRAVITY_FACTOR  2
+
+/* The track of the lab, see show_position() in cruise.c */
+static const cruise_grade_t lab_grades[] = {
+    {  400,  800, -GRAVITY_FACTOR },            // uphill
+    {  800, 1200, -2 * GRAVITY_FACTOR },        // steep uphill
+    { 1600, 2000, 2 * GRAVITY_FACTOR },         // downhill
+    { 2000, 2401, GRAVITY_FACTOR },             // steep downhill
+};
+
+const cruise_track_t cruise_track_lab = {
+    "lab", 2400, sizeof(lab_grades) / sizeof(lab_grades[0]), lab_grades
+};
+
+/*
+ * One activation of ControlTask at 'velocity' with the switches and keys
+ * of 'inputs', updates the throttle and the target. Returns the inputs,
+ * CRUISE_ENGINE forced on while the vehicle moves, with the outputs.
+ */
+int cruise_control_step(cruise_control_t *c, const cruise_gains_t *g,
+                        int16_t velocity, int inputs)
+{
+    int16_t delta_u;
+
+    // Law - 1: the engine cannot be closed while the velocity > 0 m/s
+    if (!(inputs & CRUISE_ENGINE) && velocity > 0)
+    {
+        inputs |= CRUISE_ENGINE;
+    }
+
+    // Law - 2: the cruise key fixes the current velocity as the target
+    if ((inputs & CRUISE_BUTTON) && !c->auto_cruise)
+    {
+        c->auto_cruise = 1;
+        c->target_velocity = (uint8_t) velocity;
+        if (c->target_velocity < g->min_target)
+        {
+            c->target_velocity = g->min_target;
+        }
+    }
+    if (c->auto_cruise && (inputs & CRUISE_TOP_GEAR)
+                       && velocity >= g->min_velocity
+                       && !(inputs & (CRUISE_BRAKE | CRUISE_GAS)))
+    {
+        delta_u = g->kp * (c->target_velocity - (uint8_t) velocity) / g->kp_div;
+        c->throttle = c->throttle + delta_u * g->dt;
+        inputs |= CRUISE_CRUISING;
+    }
+    else
+    {
+        c->auto_cruise = 0;
+        c->target_velocity = 0;
+    }
+
+    // Law - 3: the gas pedal, only with the engine on
+    if ((inputs & CRUISE_GAS) && (inputs & CRUISE_ENGINE))
+    {
+        c->throttle = (inputs & CRUISE_TOP_GEAR) ? g->gas_top : g->gas_low;
+        inputs |= CRUISE_GAS_APPLIED;
+    }
+
+    // Law - 4: the brake closes the throttle
+    if (inputs & CRUISE_BRAKE)
+    {
+        c->throttle = 0;
+    }
+    return inputs;
+}
+
+/*
+ * Acceleration of the vehicle, m/s2. If the engine and the brakes are
+ * activated at the same time the brake dynamics dominates.
+ */
+int16_t cruise_vehicle_accel(const cruise_vehicle_t *v, const cruise_track_t *t,
+                             uint8_t throttle, int brake, int engine)
+{
+    int16_t acceleration;
+    int i;
+
+    if (brake)
+    {
+        return -BRAKE_FACTOR * v->velocity;
+    }
+    acceleration = -WIND_FACTOR * v->velocity;
+    if (engine)
+    {
+        acceleration += throttle;
+    }
+    for (i = 0; i < t->grades; i++)
+    {
+        if (t->grade[i].from <= v->position && v->position < t->grade[i].to)
+        {
+            acceleration += t->grade[i].gravity;
+            break;
+        }
+    }
+    return acceleration;
+}
+
+/*
+ * Moves the vehicle for 'period_ms' at 'acceleration', the position goes
+ * back to the start past the end of the track
+ */
+void cruise_vehicle_move(cruise_vehicle_t *v, const cruise_track_t *t,
+                         int16_t acceleration, int period_ms)
+{
+    v->position = v->position + v->velocity * period_ms / 1000;
+    v->velocity = v->velocity + acceleration * period_ms / 1000.0;
+    if (v->position > t->length)
+    {
+        v->position = 0;
+    }
+}
+
+/*
+ * One period of VehicleTask, returns the acceleration it moved with
+ */
+int16_t cruise_vehicle_step(cruise_vehicle_t *v, const cruise_track_t *t,
+                            uint8_t throttle, int brake, int engine, int period_ms)
+{
+    int16_t acceleration = cruise_vehicle_accel(v, t, throttle, brake, engine);
+
+    cruise_vehicle_move(v, t, acceleration, period_ms);
+    return acceleration;
+}
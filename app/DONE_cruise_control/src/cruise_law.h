@@ -0,0 +1,97 @@
+/* Vehicle model and control laws of the cruise control
+ *
+ * Description:
+ *
+ *   The arithmetic of VehicleTask and ControlTask as step functions of
+ *   their state, without the kernel and the board, so the same code runs
+ *   in the tasks and in tools/cruise_sweep.c, which tunes the gains,
+ *   periods and tracks on the host. The types are the ones of the tasks
+ *   (INT8U throttle, INT16S velocity, INT16U position) and wrap the same
+ *   way; stdint.h only, the file builds outside of a BSP.
+ *
+ *   The parameters the tasks used to hard-code are in cruise_gains_t
+ *   (CRUISE_GAINS_DEFAULT is the lab's law) and cruise_track_t
+ *   (cruise_track_lab is the lab's track).
+ *
+ * Usage:
+ *
+ *       static const cruise_gains_t gains = CRUISE_GAINS_DEFAULT;
+ *       cruise_control_t control = CRUISE_CONTROL_INIT;
+ *       cruise_vehicle_t vehicle = { 0, 0 };
+ *       ...
+ *       outputs = cruise_control_step(&control, &gains, velocity, inputs);
+ *       ...
+ *       acceleration = cruise_vehicle_step(&vehicle, &cruise_track_lab, throttle,
+ *                                          brake, engine, VEHICLE_PERIOD);
+ */
+#ifndef __CRUISE_LAW_H__
+#define __CRUISE_LAW_H__
+
+#include <stdint.h>
+
+/* The vehicle cannot effort more than this throttle */
+#define CRUISE_THROTTLE_MAX     80
+
+/* Law parameters */
+typedef struct {
+    uint8_t kp;                 /* proportional gain */
+    uint8_t kp_div;             /* divisor of the gain, for gains below 1 */
+    uint8_t dt;                 /* time step of the law */
+    uint8_t min_target;         /* lowest cruise velocity, m/s */
+    uint8_t min_velocity;       /* cruising stops below, m/s */
+    uint8_t gas_top;            /* throttle of the gas pedal in top gear */
+    uint8_t gas_low;            /*                       and in low gear */
+} cruise_gains_t;
+
+#define CRUISE_GAINS_DEFAULT    { 1, 1, 1, 29, 20, 60, 30 }
+
+/* State of the control law */
+typedef struct {
+    uint8_t throttle;           /* 0..80, 0.0V..8.0V */
+    uint8_t target_velocity;    /* m/s, 0 when not cruising */
+    uint8_t auto_cruise;
+} cruise_control_t;
+
+#define CRUISE_CONTROL_INIT     { 40, 0, 0 }
+
+/* Inputs of cruise_control_step(), outputs are CRUISE_ENGINE and these */
+#define CRUISE_ENGINE           0x01    /* engine on (forced on while moving) */
+#define CRUISE_TOP_GEAR         0x02
+#define CRUISE_BUTTON           0x04    /* cruise control key */
+#define CRUISE_BRAKE            0x08
+#define CRUISE_GAS              0x10
+
+/* Outputs */
+#define CRUISE_CRUISING         0x20    /* the law set the throttle */
+#define CRUISE_GAS_APPLIED      0x40    /* the gas pedal set the throttle */
+
+/* Track: the grades, positions of a lap in metres from 0 to 'length' */
+typedef struct {
+    uint16_t from, to;          /* [from, to) */
+    int8_t   gravity;           /* m/s2, negative uphill */
+} cruise_grade_t;
+
+typedef struct {
+    const char           *name;
+    uint16_t              length;       /* the position wraps past it */
+    int                   grades;
+    const cruise_grade_t *grade;
+} cruise_track_t;
+
+typedef struct {
+    uint16_t position;          /* m */
+    int16_t  velocity;          /* m/s */
+} cruise_vehicle_t;
+
+extern const cruise_track_t cruise_track_lab;
+
+int     cruise_control_step(cruise_control_t *c, const cruise_gains_t *g,
+                            int16_t velocity, int inputs);
+int16_t cruise_vehicle_accel(const cruise_vehicle_t *v, const cruise_track_t *t,
+                             uint8_t throttle, int brake, int engine);
+void    cruise_vehicle_move(cruise_vehicle_t *v, const cruise_track_t *t,
+                            int16_t acceleration, int period_ms);
+int16_t cruise_vehicle_step(cruise_vehicle_t *v, const cruise_track_t *t,
+                            uint8_t throttle, int brake, int engine, int period_ms);
+
+#endif /* __CRUISE_LAW_H__ */
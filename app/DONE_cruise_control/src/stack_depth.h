@@ -0,0 +1,53 @@
+/* Worst-case stack use of the tasks in OS_STK words, with 20% margin
+ *
+ * Generated by tools/stackdepth.py from cruisecontrol.objdump, do not edit.
+ * Options: --recursion ___vfprintf_internal_r=1
+ * Includes 192 bytes for the exception entry (alt_exception).
+ *
+ * Bounds the listing alone does not prove:
+ *   ___vfprintf_internal_r calls itself at most 1 level deep
+ *   callr in OSTmr_Task: the functions given to OSTmrCreate
+ *       Timer_Control_CallbackSemPost Timer_ExtraLoad_CallbackSemPost
+ *       Timer_KeyIO_CallbackSemPost
+ *       Timer_OverloadDetection_CallbackSemPost
+ *       Timer_SwitchIO_CallbackSemPost Timer_Vehicle_CallbackSemPost
+ *   callr in __sfvwrite_r: the hooks matched by name
+ *       __sclose __sread __sseek __swrite
+ *   callr in _fflush_r: the hooks matched by name
+ *       __sclose __sread __sseek __swrite
+ *   callr in alt_irq_handler: the functions given to alt_ic_isr_register
+ *     or alt_irq_register
+ *       alt_avalon_timer_sc_irq altera_avalon_jtag_uart_irq
+ *   callr in alt_tick: the functions given to alt_alarm_start
+ *       alarm_handler altera_avalon_jtag_uart_timeout
+ *   callr in close: the hooks matched by name
+ *       altera_avalon_jtag_uart_close_fd
+ *   callr in fstat: the hooks matched by name
+ *       altera_avalon_jtag_uart_close_fd altera_avalon_jtag_uart_ioctl_fd
+ *   callr in isatty: the hooks matched by name
+ *       altera_avalon_jtag_uart_close_fd altera_avalon_jtag_uart_ioctl_fd
+ *   callr in lseek: the hooks matched by name
+ *       altera_avalon_jtag_uart_close_fd altera_avalon_jtag_uart_ioctl_fd
+ *   callr in read: the hooks matched by name
+ *       altera_avalon_jtag_uart_read_fd
+ *   callr in write: the hooks matched by name
+ *       alt_up_character_lcd_write_fd altera_avalon_jtag_uart_write_fd
+ *
+ * A task that is not listed keeps the standard size of the application.
+ */
+#ifndef __STACK_DEPTH_H__
+#define __STACK_DEPTH_H__
+
+#define STACK_DEPTH_CONTROLTASK                  216
+#define STACK_DEPTH_EXTRALOADTASK                1080
+#define STACK_DEPTH_KEYIOTASK                    96
+#define STACK_DEPTH_OSTMR_TASK                   88
+#define STACK_DEPTH_OS_TASKIDLE                  64
+#define STACK_DEPTH_OS_TASKSTAT                  80
+#define STACK_DEPTH_OVERLOADDETECTIONTASK        88
+#define STACK_DEPTH_STARTTASK                    1080
+#define STACK_DEPTH_SWITCHIOTASK                 96
+#define STACK_DEPTH_VEHICLETASK                  1088
+#define STACK_DEPTH_WATCHDOGTASK                 200
+
+#endif /* __STACK_DEPTH_H__ */
@@ -20,7 +20,8 @@ OS_EVENT *pAtomicSem0;
 OS_EVENT *pAtomicSem1;
 
 // declare the ptr to the shared memory
-INT32S CommBuf;
+// (a partition has two blocks at least, each pointer sized and aligned)
+void *CommBuf[2];
 OS_MEM *commMem;
 INT32S *pShared;
 
@@ -34,7 +35,6 @@ void task0(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
 
         OSSemPend(pAtomicSem0, 0, &err1);
 
@@ -42,13 +42,13 @@ void task0(void* pdata)
         {
             (*pShared) = -1 * (*pShared) + 1;
             printf("Sending       : %d\n", (*pShared));
-            err2 = OSSemPost(pAtomicSem1);
+            (void) OSSemPost(pAtomicSem1);
             state = 1;
         }
         else if (state == 1)
         {
             printf("Receiving     : %d\n", (*pShared));
-            err2 = OSSemPost(pAtomicSem0);
+            (void) OSSemPost(pAtomicSem0);
             state = 0;
         }
     }
@@ -61,22 +61,21 @@ void task1(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
 
         OSSemPend(pAtomicSem1, 0, &err1);
 
         (*pShared) = (*pShared) * (-1);
 
-        err2 = OSSemPost(pAtomicSem0);
+        (void) OSSemPost(pAtomicSem0);
 
         // if (state == 0)
         // {
-        //     err2 = OSSemPost(pAtomicSem1);
+        //     (void) OSSemPost(pAtomicSem1);
         //     state = 1;
         // }
         // else if (state == 1)
         // {
-        //     err2 = OSSemPost(pAtomicSem0);
+        //     (void) OSSemPost(pAtomicSem0);
         //     state = 0;
         // }
     }
@@ -92,7 +91,7 @@ int main(void)
     INT8U errCreate;
     INT8U errGet;
 
-    commMem = OSMemCreate(&CommBuf, 1, 1 * sizeof(INT32S), &errCreate);
+    commMem = OSMemCreate(CommBuf, 2, sizeof(CommBuf[0]), &errCreate);
 
     pShared = OSMemGet(commMem, &errGet);
 
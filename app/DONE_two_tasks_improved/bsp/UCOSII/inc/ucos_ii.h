@@ -1293,6 +1293,14 @@ void          OS_MemCopy              (INT8U           *pdest,
                                        INT8U           *psrc,
                                        INT16U           size);
 
+#if OS_TASK_CREATE_EXT_EN > 0
+void          OS_StkClr               (OS_STK          *pstk,
+                                       INT32U           size);
+
+INT32U        OS_StkFree              (OS_STK          *pstk,
+                                       INT32U           size);
+#endif
+
 #if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0)
 void          OS_MemInit              (void);
 #endif
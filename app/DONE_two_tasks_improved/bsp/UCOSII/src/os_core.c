@@ -1545,14 +1545,36 @@ static  void  OS_InitTCBList (void)
 * Notes      : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
 *              2) Note that we can only clear up to 64K bytes of RAM.  This is not an issue because none
 *                 of the uses of this function gets close to this limit.
-*              3) The clear is done one byte at a time since this will work on any processor irrespective
-*                 of the alignment of the destination.
+*              3) The clear is done four words per loop where the destination is word aligned, then a
+*                 word at a time, the bytes before and after that one at a time.  On a core without a
+*                 data cache every loop branch and counter update costs about as much as the store.
 *********************************************************************************************************
 */
 
 void  OS_MemClr (INT8U *pdest, INT16U size)
 {
-    while (size > 0) {
+    INT32U  *pdest32;
+
+
+    while (size > 0 && ((INT32U)pdest & 0x03) != 0) {  /* Up to the first word boundary                 */
+        *pdest++ = (INT8U)0;
+        size--;
+    }
+    pdest32 = (INT32U *)pdest;
+    while (size >= 4 * sizeof(INT32U)) {               /* Four words per loop                          */
+        pdest32[0] = (INT32U)0;
+        pdest32[1] = (INT32U)0;
+        pdest32[2] = (INT32U)0;
+        pdest32[3] = (INT32U)0;
+        pdest32   += 4;
+        size      -= 4 * sizeof(INT32U);
+    }
+    while (size >= sizeof(INT32U)) {                   /* Whole words                                  */
+        *pdest32++ = (INT32U)0;
+        size      -= sizeof(INT32U);
+    }
+    pdest = (INT8U *)pdest32;
+    while (size > 0) {                                 /* Remaining bytes                              */
         *pdest++ = (INT8U)0;
         size--;
     }
@@ -1577,14 +1599,43 @@ void  OS_MemClr (INT8U *pdest, INT16U size)
 *                 no provision to handle overlapping memory copy.  However, that's not a problem since this
 *                 is not a situation that will happen.
 *              2) Note that we can only copy up to 64K bytes of RAM
-*              3) The copy is done one byte at a time since this will work on any processor irrespective
-*                 of the alignment of the source and destination.
+*              3) When the source and the destination have the same alignment, the copy is done four
+*                 words per loop from the first word boundary on, as OS_MemClr().  Otherwise it is done
+*                 one byte at a time since this will work on any processor irrespective of the alignment
+*                 of the source and destination.
 *********************************************************************************************************
 */
 
 void  OS_MemCopy (INT8U *pdest, INT8U *psrc, INT16U size)
 {
-    while (size > 0) {
+    INT32U  *pdest32;
+    INT32U  *psrc32;
+
+
+    if ((((INT32U)pdest ^ (INT32U)psrc) & 0x03) == 0) {
+        while (size > 0 && ((INT32U)pdest & 0x03) != 0) {  /* Up to the first word boundary             */
+            *pdest++ = *psrc++;
+            size--;
+        }
+        pdest32 = (INT32U *)pdest;
+        psrc32  = (INT32U *)psrc;
+        while (size >= 4 * sizeof(INT32U)) {               /* Four words per loop                      */
+            pdest32[0] = psrc32[0];
+            pdest32[1] = psrc32[1];
+            pdest32[2] = psrc32[2];
+            pdest32[3] = psrc32[3];
+            pdest32   += 4;
+            psrc32    += 4;
+            size      -= 4 * sizeof(INT32U);
+        }
+        while (size >= sizeof(INT32U)) {                   /* Whole words                              */
+            *pdest32++ = *psrc32++;
+            size      -= sizeof(INT32U);
+        }
+        pdest = (INT8U *)pdest32;
+        psrc  = (INT8U *)psrc32;
+    }
+    while (size > 0) {                                     /* Remaining or unaligned bytes             */
         *pdest++ = *psrc++;
         size--;
     }
@@ -1592,6 +1643,85 @@ void  OS_MemCopy (INT8U *pdest, INT8U *psrc, INT16U size)
 /*$PAGE*/
 /*
 *********************************************************************************************************
+*                                        CLEAR A TASK STACK
+*
+* Description: This function is called by OS_TaskStkClr() to clear the stack of a task and can be used by
+*              stack monitors to clear part of one.
+*
+* Arguments  : pstk     is the LOWEST address of the stack elements to clear
+*
+*              size     is the number of stack elements to clear.
+*
+* Returns    : none
+*
+* Notes      : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Stack elements are always aligned, eight are cleared per loop.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_CREATE_EXT_EN > 0
+void  OS_StkClr (OS_STK *pstk, INT32U size)
+{
+    while (size >= 8) {                                /* Eight elements per loop                      */
+        pstk[0] = (OS_STK)0;
+        pstk[1] = (OS_STK)0;
+        pstk[2] = (OS_STK)0;
+        pstk[3] = (OS_STK)0;
+        pstk[4] = (OS_STK)0;
+        pstk[5] = (OS_STK)0;
+        pstk[6] = (OS_STK)0;
+        pstk[7] = (OS_STK)0;
+        pstk   += 8;
+        size   -= 8;
+    }
+    while (size > 0) {
+        *pstk++ = (OS_STK)0;
+        size--;
+    }
+}
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     COUNT THE FREE ENTRIES OF A STACK
+*
+* Description: This function is called by OSTaskStkChk() to count the stack elements that are still 0,
+*              from the lowest address up, and can be used by stack monitors to scan part of a stack.
+*
+* Arguments  : pstk     is the LOWEST address of the stack elements to scan
+*
+*              size     is the number of stack elements to scan at most.
+*
+* Returns    : the number of elements equal to 0 before the first one that is not, 'size' if all are 0.
+*
+* Notes      : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Four elements are tested per loop with one compare (their OR), the element that ends
+*                 the free part is then found one at a time.
+*********************************************************************************************************
+*/
+
+INT32U  OS_StkFree (OS_STK *pstk, INT32U size)
+{
+    OS_STK  *pchk;
+
+
+    pchk = pstk;
+    while (size >= 4) {                                /* Four elements per loop                       */
+        if ((pchk[0] | pchk[1] | pchk[2] | pchk[3]) != (OS_STK)0) {
+            break;
+        }
+        pchk += 4;
+        size -= 4;
+    }
+    while (size > 0 && *pchk == (OS_STK)0) {
+        pchk++;
+        size--;
+    }
+    return ((INT32U)(pchk - pstk));
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                              SCHEDULER
 *
 * Description: This function is called by other uC/OS-II services to determine whether a new, high
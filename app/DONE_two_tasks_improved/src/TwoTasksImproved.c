@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include "includes.h"
 #include <string.h>
+#include "stack_mon.h"
 
 #define DEBUG 1
 
@@ -22,18 +23,19 @@ OS_EVENT *pSem;
 
 // pSem = OSSemCreate(1);
 
+// High-water marks are kept by stack_mon_sample(), which only checks a few
+// words per call instead of scanning the whole stack like OSTaskStkChk()
 void printStackSize(char* name, INT8U prio)
 {
-    INT8U err;
-    OS_STK_DATA stk_data;
+    stack_mon_t mon;
 
-    err = OSTaskStkChk(prio, &stk_data);
-    if (err == OS_NO_ERR)
+    if (stack_mon_get(prio, &mon))
     {
         if (DEBUG == 1)
         {
             printf("%s (priority %d) - Used: %d; Free: %d\n",
-               name, prio, stk_data.OSUsed, stk_data.OSFree);
+               name, prio, (int) ((mon.size - mon.free) * sizeof(OS_STK)),
+               (int) (mon.free * sizeof(OS_STK)));
         }
     }
     else
@@ -53,7 +55,6 @@ void task1(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
         char text1[] = "Hello from Task1\n";
         int i;
 
@@ -65,7 +66,7 @@ void task1(void* pdata)
             putchar(text1[i]);
 
         // release the resource
-        err2 = OSSemPost(pSem);
+        (void) OSSemPost(pSem);
 
         // execute the idle time of task 1
         OSTimeDlyHMSM(0, 0, 0, 11); /* Context Switch to next task
@@ -80,7 +81,6 @@ void task2(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
         char text1[] = "Hello from Task2\n";
         int i;
 
@@ -92,7 +92,7 @@ void task2(void* pdata)
             putchar(text1[i]);
 
         // release the resource
-        err2 = OSSemPost(pSem);
+        (void) OSSemPost(pSem);
 
         // execute the idle time of task 2
         OSTimeDlyHMSM(0, 0, 0, 4); /* Context Switch to next task
@@ -108,17 +108,17 @@ void statisticTask(void* pdata)
     while (1)
     {
         INT8U err1;
-        INT8U err2;
         // *pEvent, timeout, *perr)
         OSSemPend(pSem, 0, &err1);
 
         // execute the task body
+        stack_mon_sample();
         printStackSize("Task1", TASK1_PRIORITY);
         printStackSize("Task2", TASK2_PRIORITY);
         printStackSize("StatisticTask", TASK_STAT_PRIORITY);
 
         // release the semaphore
-        err2 = OSSemPost(pSem);
+        (void) OSSemPost(pSem);
     }
 }
 
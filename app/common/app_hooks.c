@@ -0,0 +1,174 @@
+/* Application hooks for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   With OS_APP_HOOKS_EN the CPU hooks in os_cpu_c.c forward to the App_*
+ *   hooks below, which call the run-time monitors of app/common. An
+ *   application that links this file gets every monitor enabled here; set
+ *   the corresponding *_EN to 0 (e.g. with -DTASK_ACCT_EN=0) to leave one
+ *   out of the hooks.
+ *
+ *   All hooks except App_TaskStatHook() and App_TaskIdleHook() run with
+ *   interrupts disabled, keep them short. App_TraceEvent() (OS_TRACE_EN)
+ *   runs in the task or interrupt handler that calls the kernel.
+ *
+ *   App_TaskSwHook() reads the timestamp timer once and hands the time of
+ *   the switch to the monitors that need one; with HOT_BENCH_EN the time
+ *   the hook takes is a stage of hot_bench_report().
+ */
+#include "includes.h"
+#include "timestamp.h"
+
+#ifndef TASK_ACCT_EN
+#define TASK_ACCT_EN 1
+#endif
+
+#ifndef TRACE_EN
+#define TRACE_EN OS_TRACE_EN
+#endif
+
+#ifndef STACK_MON_EN
+#define STACK_MON_EN 1
+#endif
+
+#ifndef BASIC_TASK_EN
+#define BASIC_TASK_EN 1
+#endif
+
+#ifndef HOT_BENCH_EN
+#define HOT_BENCH_EN 1
+#endif
+
+#ifndef PC_PROF_EN
+#define PC_PROF_EN 1
+#endif
+
+/* job_wcet needs the cycles of task_acct, deadline the timestamp timer */
+#ifndef JOB_WCET_EN
+#define JOB_WCET_EN TASK_ACCT_EN
+#endif
+
+#ifndef DEADLINE_EN
+#define DEADLINE_EN TASK_ACCT_EN
+#endif
+
+#if TASK_ACCT_EN
+#include "task_acct.h"
+#endif
+#if TRACE_EN
+#include "trace.h"
+#endif
+#if STACK_MON_EN
+#include "stack_mon.h"
+#endif
+#if BASIC_TASK_EN
+#include "basic_task.h"
+#endif
+#if HOT_BENCH_EN
+#include "hot_bench.h"
+#endif
+#if PC_PROF_EN
+#include "pc_prof.h"
+#endif
+#if JOB_WCET_EN
+#include "job_wcet.h"
+#endif
+#if DEADLINE_EN
+#include "deadline.h"
+#endif
+
+#if OS_APP_HOOKS_EN > 0
+
+void App_TaskCreateHook(OS_TCB *ptcb)
+{
+#if STACK_MON_EN
+    stack_mon_create(ptcb);
+#endif
+    (void) ptcb;
+}
+
+void App_TaskDelHook(OS_TCB *ptcb)
+{
+    (void) ptcb;
+}
+
+void App_TaskIdleHook(void)
+{
+#if HOT_BENCH_EN
+    hot_bench_idle();
+#endif
+}
+
+void App_TaskStatHook(void)
+{
+#if TASK_ACCT_EN
+    task_acct_stat();
+#endif
+#if STACK_MON_EN
+    stack_mon_sample();
+#endif
+}
+
+#if OS_TASK_SW_HOOK_EN > 0
+void App_TaskSwHook(void)
+{
+#if TASK_ACCT_EN || DEADLINE_EN || TRACE_EN || HOT_BENCH_EN
+    alt_u32 now = timestamp_now();
+#endif
+
+#if BASIC_TASK_EN
+    basic_task_switch();
+#endif
+#if TASK_ACCT_EN
+    task_acct_switch(now);
+#endif
+#if JOB_WCET_EN
+    job_wcet_switch();
+#endif
+#if DEADLINE_EN
+    deadline_switch(now);
+#endif
+#if TRACE_EN
+    trace_switch(now);
+#endif
+#if STACK_MON_EN
+    stack_mon_switch();
+#endif
+#if HOT_BENCH_EN
+    hot_bench_end(HOT_BENCH_SW_HOOK, now);
+#endif
+}
+#endif
+
+void App_TCBInitHook(OS_TCB *ptcb)
+{
+    (void) ptcb;
+}
+
+#if OS_TIME_TICK_HOOK_EN > 0
+void App_TimeTickHook(void)
+{
+#if PC_PROF_EN
+    pc_prof_tick();
+#endif
+}
+#endif
+
+#endif /* OS_APP_HOOKS_EN */
+
+#if OS_TRACE_EN > 0
+/*
+ * Called by the kernel with every event when OS_TRACE_EN is set
+ */
+void App_TraceEvent(INT8U type, INT16U arg)
+{
+#if TRACE_EN
+    trace_event(type, arg);
+#endif
+#if DEADLINE_EN
+    deadline_event(type, arg);
+#endif
+    (void) type;
+    (void) arg;
+}
+#endif
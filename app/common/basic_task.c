@@ -0,0 +1,247 @@
+/* Run-to-completion basic tasks on a shared stack for the IL 2206 lab applications
+ *
+ * See basic_task.h for the description.
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "basic_task.h"
+
+#if OS_STK_GROWTH != 1
+#error "basic_task assumes stacks growing from HIGH to LOW memory"
+#endif
+
+#define BASIC_TASK_PRIOS (OS_LOWEST_PRIO + 1)
+
+static OS_STK basic_stack[BASIC_TASK_STACKSIZE];
+
+/* Basic task of each priority, 0 for ordinary tasks */
+static basic_task_t *basic_prio[BASIC_TASK_PRIOS];
+
+/* Unfinished job that is deepest in the shared stack */
+static basic_task_t *basic_top;
+
+/*
+ * Body of every basic task, it starts on a fresh frame for each job
+ */
+static void basic_task_entry(void *pdata)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    basic_task_t *bt = (basic_task_t *) pdata;
+
+    for (;;)
+    {
+        bt->job(bt->arg);
+
+        OS_ENTER_CRITICAL();
+        if (bt->pending > 0)
+        {
+            bt->pending--;
+            OS_EXIT_CRITICAL();
+            continue;
+        }
+        // Done, give the stack back. Interrupts stay disabled until the
+        // task is switched out so no activation can get lost in between.
+        if (basic_top == bt)
+        {
+            basic_top = bt->below;
+        }
+        else
+        {
+            // Its frame was overwritten while it waited, see below
+            bt->blocked++;
+            assert(!"job of a basic task blocked");
+        }
+        bt->state = BASIC_TASK_IDLE;
+        OSTaskSuspend(OS_PRIO_SELF);
+        OS_EXIT_CRITICAL();
+    }
+}
+
+/*
+ * The start frame of OSTaskStkInit(), built right below 'top', the first
+ * word that must not be touched. With OS_THREAD_SAFE_NEWLIB it comes with
+ * a fresh newlib context of the job.
+ */
+static OS_STK *basic_task_frame(basic_task_t *bt, OS_STK *top)
+{
+#ifdef OS_CPU_HOST
+    // The host port keeps the context outside the stack (bsp/host)
+    return OSTaskStkRestart(OSTCBPrioTbl[bt->prio], top, basic_task_entry, bt);
+#else
+    return OSTaskStkInit(basic_task_entry, bt, top, 0);
+#endif
+}
+
+/*
+ * Creates a basic task at priority 'prio'. Must not be called while a job
+ * is unfinished, the creation writes to the shared stack.
+ */
+INT8U basic_task_create(basic_task_t *bt, void (*job)(void *arg), void *arg,
+                        INT8U prio, INT8U max_pending)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    INT8U err;
+
+    if (prio >= OS_LOWEST_PRIO)
+    {
+        return OS_ERR_PRIO_INVALID;
+    }
+    bt->job = job;
+    bt->arg = arg;
+    bt->prio = prio;
+    bt->state = BASIC_TASK_IDLE;
+    bt->pending = 0;
+    bt->max_pending = max_pending;
+    bt->activations = 0;
+    bt->overruns = 0;
+    bt->blocked = 0;
+    bt->below = (basic_task_t *) 0;
+
+    // Created suspended; the frame OSTaskStkInit() puts on the shared
+    // stack is replaced on the first activation
+    OSSchedLock();
+    err = OSTaskCreateExt(basic_task_entry, bt,
+                          &basic_stack[BASIC_TASK_STACKSIZE - 1], prio, prio,
+                          &basic_stack[0], BASIC_TASK_STACKSIZE, bt,
+                          OS_TASK_OPT_NONE);
+    if (err == OS_ERR_NONE)
+    {
+        OSTaskSuspend(prio);
+        OS_ENTER_CRITICAL();
+        basic_prio[prio] = bt;
+        OS_EXIT_CRITICAL();
+        // Zero again for the high-water mark
+        memset(basic_stack, 0, sizeof(basic_stack));
+    }
+    OSSchedUnlock();
+    return err;
+}
+
+/*
+ * Activates a basic task, may be called from interrupts and timer
+ * callbacks. Returns OS_ERR_Q_FULL if the activation was lost.
+ */
+INT8U basic_task_activate(basic_task_t *bt)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (bt->job == 0)
+    {
+        // Not created yet
+        return OS_ERR_TASK_NOT_EXIST;
+    }
+    OS_ENTER_CRITICAL();
+    bt->activations++;
+    if (bt->state == BASIC_TASK_IDLE)
+    {
+        bt->state = BASIC_TASK_RELEASED;
+        OS_EXIT_CRITICAL();
+        return OSTaskResume(bt->prio);
+    }
+    if (bt->pending < bt->max_pending)
+    {
+        bt->pending++;
+        OS_EXIT_CRITICAL();
+        return OS_ERR_NONE;
+    }
+    bt->overruns++;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_Q_FULL;
+}
+
+/*
+ * Called from OSTaskSwHook(), interrupts are disabled. The stack pointer of
+ * OSTCBCur is already saved, the one of OSTCBHighRdy is loaded afterwards.
+ */
+void basic_task_switch(void)
+{
+    basic_task_t *bt;
+    OS_STK *top;
+
+    bt = basic_prio[OSTCBCur->OSTCBPrio];
+    if (bt != (basic_task_t *) 0 && bt->state == BASIC_TASK_RUNNING
+        && (OSRdyTbl[OSTCBCur->OSTCBY] & OSTCBCur->OSTCBBitX) == 0)
+    {
+        // Waits (pends, delays or is suspended) in the middle of a job,
+        // jobs above it will overwrite it.
+        // Counted for the report of a build without assertions.
+        bt->blocked++;
+        assert(!"job of a basic task blocked");
+    }
+
+    bt = basic_prio[OSTCBHighRdy->OSTCBPrio];
+    if (bt == (basic_task_t *) 0 || bt->state != BASIC_TASK_RELEASED)
+    {
+        return;
+    }
+    if (basic_top != (basic_task_t *) 0)
+    {
+        // Right below the saved context of the deepest unfinished job
+        top = OSTCBPrioTbl[basic_top->prio]->OSTCBStkPtr;
+    }
+    else
+    {
+        top = &basic_stack[BASIC_TASK_STACKSIZE];
+    }
+    OSTCBHighRdy->OSTCBStkPtr = basic_task_frame(bt, top);
+    bt->state = BASIC_TASK_RUNNING;
+    bt->below = basic_top;
+    basic_top = bt;
+}
+
+/*
+ * High-water mark of the shared stack in bytes
+ */
+INT32U basic_task_stack_used(void)
+{
+    INT32U i;
+
+    for (i = 0; i < BASIC_TASK_STACKSIZE; i++)
+    {
+        if (basic_stack[i] != (OS_STK) 0)
+        {
+            break;
+        }
+    }
+    return (BASIC_TASK_STACKSIZE - i) * sizeof(OS_STK);
+}
+
+void basic_task_report(void)
+{
+    basic_task_t bt;
+    INT8U prio;
+    INT8U name[OS_TASK_NAME_SIZE];
+    INT8U err;
+
+    printf("--Basic Tasks-- (shared stack %u bytes, used %u)\n",
+           (unsigned int) sizeof(basic_stack), (unsigned int) basic_task_stack_used());
+    printf("+------+----------------------+-------------+----------+---------+\n");
+    printf("| Prio | Task                 | Activations | Overruns | Blocked |\n");
+    printf("+------+----------------------+-------------+----------+---------+\n");
+    for (prio = 0; prio < BASIC_TASK_PRIOS; prio++)
+    {
+        if (basic_prio[prio] == (basic_task_t *) 0)
+        {
+            continue;
+        }
+        bt = *basic_prio[prio];
+#if OS_TASK_NAME_SIZE > 1
+        OSTaskNameGet(prio, name, &err);
+        if (err != OS_ERR_NONE || name[0] == '?')
+#endif
+        {
+            sprintf((char *) name, "Task %u", prio);
+        }
+        printf("| %4u | %-20.20s | %11u | %8u | %7u |\n",
+               prio, (char *) name, (unsigned int) bt.activations,
+               (unsigned int) bt.overruns, (unsigned int) bt.blocked);
+    }
+    printf("+------+----------------------+-------------+----------+---------+\n");
+}
@@ -0,0 +1,81 @@
+/* Run-to-completion basic tasks on a shared stack for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   A basic task in the OSEK sense: a job function that is activated (e.g.
+ *   from a timer callback), runs to its end and is then done until the next
+ *   activation. It never waits in the middle of its body, so it does not need
+ *   a stack of its own while it is not running.
+ *
+ *   Every basic task still is a uC/OS-II task with its own priority, so it
+ *   is scheduled (and preempted) together with the ordinary tasks. All basic
+ *   tasks run on one shared stack, BASIC_TASK_STACKSIZE words. A job can
+ *   only be preempted by tasks of higher priority, which finish before it
+ *   continues, so the shared stack is used strictly LIFO: when a basic task
+ *   is switched in for a new job, the task switch hook builds a fresh start
+ *   frame right below the deepest job that is still unfinished. A finished
+ *   job simply suspends its task; nothing of it is kept.
+ *
+ *   Rules for a job:
+ *     - never block: no OSTimeDly, no pend with a timeout or on a resource
+ *       that might be taken, no printf (newlib locks); posting is fine.
+ *       A job that blocks anyway fails an assertion; without assertions
+ *       (NDEBUG) it is only counted in 'blocked' and will corrupt the
+ *       shared stack.
+ *     - keep state that must survive the job (or is posted by pointer to a
+ *       mailbox) in static variables.
+ *
+ *   Activating a task that is released or running queues the activation, up
+ *   to 'max_pending', the job then runs again right away. Further
+ *   activations are counted as overruns.
+ *
+ * Usage:
+ *
+ *       basic_task_t io;
+ *
+ *       void io_job(void *arg) { ... }
+ *       ...
+ *       basic_task_create(&io, io_job, NULL, IO_PRIO, 1);
+ *       ...
+ *       basic_task_activate(&io);      // e.g. in a timer callback
+ *
+ *   basic_task_switch() must be called from App_TaskSwHook() (app_hooks.c).
+ *   All basic tasks have to be created before the first one is activated.
+ */
+#ifndef __BASIC_TASK_H__
+#define __BASIC_TASK_H__
+
+#include "includes.h"
+
+/* Size of the shared stack in OS_STK words */
+#ifndef BASIC_TASK_STACKSIZE
+#define BASIC_TASK_STACKSIZE    1024
+#endif
+
+enum basic_task_state {
+    BASIC_TASK_IDLE,        /* waiting for an activation */
+    BASIC_TASK_RELEASED,    /* activated, not started yet */
+    BASIC_TASK_RUNNING      /* job started, may be preempted */
+};
+
+typedef struct basic_task {
+    void               (*job)(void *arg);
+    void                *arg;
+    INT8U                prio;
+    INT8U                state;
+    INT8U                pending;       /* queued activations */
+    INT8U                max_pending;
+    INT32U               activations;
+    INT32U               overruns;      /* activations lost to max_pending */
+    INT32U               blocked;       /* times the job blocked, must stay 0 */
+    struct basic_task   *below;         /* unfinished job deeper in the stack */
+} basic_task_t;
+
+INT8U   basic_task_create(basic_task_t *bt, void (*job)(void *arg), void *arg,
+                          INT8U prio, INT8U max_pending);
+INT8U   basic_task_activate(basic_task_t *bt);
+void    basic_task_switch(void);
+INT32U  basic_task_stack_used(void);
+void    basic_task_report(void);
+
+#endif /* __BASIC_TASK_H__ */
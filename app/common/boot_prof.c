@@ -0,0 +1,160 @@
+/* Boot-time profiler for the IL 2206 lab applications
+ *
+ * See boot_prof.h for the description.
+ */
+#include <stdio.h>
+#include "boot_prof.h"
+#include "system.h"
+#include "sys/alt_timestamp.h"
+#include "timestamp.h"
+
+#define BOOT_CAL_MAGIC  0xB007CA1Bu
+
+static boot_mark_t marks[BOOT_PROF_MAX];
+static int         count;
+static int         done;
+static alt_u32     last;        /* timer reading of the last mark */
+
+enum { BOOT_CAL_NONE, BOOT_CAL_MEASURED, BOOT_CAL_CACHED, BOOT_CAL_COMPILED };
+static const char *cal_names[] = { "none", "measured", "cached", "compiled" };
+static int         cal_source;
+static INT32U      cal_value;
+
+/* Survives a reset, not a new download of a different image (see stamp) */
+static struct {
+    INT32U magic;
+    INT32U stamp;
+    INT32U idle_ctr_max;
+    INT32U check;
+} cal_cache BOOT_NOINIT;
+
+void boot_prof_mark(const char *phase)
+{
+    alt_u32 now;
+
+    if (done || count >= BOOT_PROF_MAX)
+    {
+        return;
+    }
+    if (count == 0)
+    {
+        // Keeps the time since reset if crt0 started the timer, else counts from here
+        timestamp_start();
+    }
+    now = timestamp_now();
+    marks[count].phase = phase;
+    marks[count].ts = count ? marks[count - 1].ts + (now - last) : now;
+    last = now;
+    count++;
+}
+
+void boot_prof_done(const char *phase)
+{
+    if (!done)
+    {
+        boot_prof_mark(phase);
+        done = 1;
+    }
+}
+
+int boot_prof_finished(void)
+{
+    return done;
+}
+
+/*
+ * Cycles from reset to the last mark
+ */
+alt_u32 boot_prof_total(void)
+{
+    return count ? marks[count - 1].ts : 0;
+}
+
+/*
+ * Identifies the image, the idle counter depends on the code of the idle
+ * loop and the clock
+ */
+static INT32U boot_cal_stamp(void)
+{
+    return (INT32U) OS_TaskIdle ^ (INT32U) &OSIdleCtr ^ (INT32U) OS_TICKS_PER_SEC ^ (INT32U) ALT_CPU_FREQ;
+}
+
+/*
+ * OSStatInit() without the calibration delay when the value is known
+ */
+void boot_stat_init(void)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    INT32U max = 0;
+
+#ifdef BOOT_IDLE_CTR_MAX
+    max = BOOT_IDLE_CTR_MAX;
+    cal_source = BOOT_CAL_COMPILED;
+#else
+    if (cal_cache.magic == BOOT_CAL_MAGIC && cal_cache.stamp == boot_cal_stamp()
+        && cal_cache.check == ~cal_cache.idle_ctr_max)
+    {
+        max = cal_cache.idle_ctr_max;
+        cal_source = BOOT_CAL_CACHED;
+    }
+#endif
+
+    if (max == 0)
+    {
+        OSStatInit();
+        cal_source = BOOT_CAL_MEASURED;
+        cal_cache.stamp = boot_cal_stamp();
+        cal_cache.idle_ctr_max = OSIdleCtrMax;
+        cal_cache.check = ~OSIdleCtrMax;
+        cal_cache.magic = BOOT_CAL_MAGIC;
+        cal_value = OSIdleCtrMax;
+        return;
+    }
+
+    cal_value = max;
+    OS_ENTER_CRITICAL();
+    OSIdleCtr    = 0L;
+    OSIdleCtrMax = max;
+    OSStatRdy    = OS_TRUE;
+    OS_EXIT_CRITICAL();
+}
+
+void boot_prof_report(void)
+{
+    alt_u32 freq = alt_timestamp_freq();
+    alt_u32 prev = 0, us, total_us;
+    int i;
+
+    if (freq == 0)
+    {
+        freq = ALT_CPU_FREQ;
+    }
+
+    printf("--Boot Timeline-- (us since reset)\n");
+    printf("+----+--------------------------+----------+----------+\n");
+    printf("|  # | Phase                    | Duration |    Total |\n");
+    printf("+----+--------------------------+----------+----------+\n");
+    for (i = 0; i < count; i++)
+    {
+        us = (alt_u32) ((alt_u64) (marks[i].ts - prev) * 1000000 / freq);
+        total_us = (alt_u32) ((alt_u64) marks[i].ts * 1000000 / freq);
+        printf("| %2d | %-24.24s | %8u | %8u |\n",
+               i, marks[i].phase, (unsigned int) us, (unsigned int) total_us);
+        prev = marks[i].ts;
+    }
+    printf("+----+--------------------------+----------+----------+\n");
+    printf("Idle counter calibration: %s, OSIdleCtrMax = %u (-DBOOT_IDLE_CTR_MAX=%u)\n",
+           cal_names[cal_source], (unsigned int) cal_value, (unsigned int) cal_value);
+
+    prev = 0;
+    for (i = 0; i < count; i++)
+    {
+        printf("BENCH {\"bench\":\"boot\",\"phase\":\"%s\",\"us\":%u,\"total_us\":%u}\n",
+               marks[i].phase,
+               (unsigned int) ((alt_u64) (marks[i].ts - prev) * 1000000 / freq),
+               (unsigned int) ((alt_u64) marks[i].ts * 1000000 / freq));
+        prev = marks[i].ts;
+    }
+}
@@ -0,0 +1,65 @@
+/* Boot-time profiler for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Timestamps the phases between reset and the first control cycle. With
+ *   ALT_BOOT_PROF defined for the BSP (hal.make.bsp_cflags_defined_symbols)
+ *   crt0.S starts the timestamp timer right after reset and alt_main.c
+ *   marks the end of the HAL phases; the application marks its own phases
+ *   with boot_prof_mark() and the end of the boot with boot_prof_done().
+ *   Without it the times count from the first mark.
+ *
+ *   The timer is read directly (timestamp_now()), so marks work before
+ *   alt_sys_init(). crt0.S starts it continuously like timestamp_start(),
+ *   which leaves it running, so trace_init() and task_acct_init() keep the
+ *   time since reset.
+ *
+ *   boot_prof_report() prints the timeline and one "BENCH " JSON line per
+ *   phase, so two boots can be compared with tools/bench_compare.py
+ *   --metric us.
+ *
+ *   Startup reductions:
+ *
+ *     - boot_stat_init() replaces OSStatInit(), which delays the start task
+ *       for 1/10 second to calibrate the idle counter. The value is taken
+ *       from BOOT_IDLE_CTR_MAX if defined (printed by boot_prof_report()),
+ *       else from the previous boot of the same image, kept in BOOT_NOINIT
+ *       memory; only the first boot calibrates.
+ *     - BOOT_NOINIT places a variable in .noinit, which crt0 does not clear
+ *       and the download does not load. Task stacks there are not zeroed at
+ *       boot, see stack_mon_lazy_clear().
+ *
+ * Usage:
+ *
+ *       boot_prof_mark("main");          // end of the phase "main"
+ *       ...
+ *       boot_stat_init();                 // instead of OSStatInit()
+ *       ...
+ *       boot_prof_done("first actuation");
+ *       ...
+ *       boot_prof_report();
+ */
+#ifndef __BOOT_PROF_H__
+#define __BOOT_PROF_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Maximum number of marks */
+#define BOOT_PROF_MAX   16
+
+#define BOOT_NOINIT __attribute__((section(".noinit")))
+
+typedef struct {
+    const char  *phase;     /* phase that ended here */
+    alt_u32      ts;        /* cycles since reset */
+} boot_mark_t;
+
+void    boot_prof_mark(const char *phase);
+void    boot_prof_done(const char *phase);
+int     boot_prof_finished(void);
+alt_u32 boot_prof_total(void);
+void    boot_stat_init(void);
+void    boot_prof_report(void);
+
+#endif /* __BOOT_PROF_H__ */
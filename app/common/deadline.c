@@ -0,0 +1,354 @@
+/* Per-job deadline monitoring for the IL 2206 lab applications
+ *
+ * See deadline.h for the description.
+ *
+ * deadline_switch() runs with interrupts disabled inside every context
+ * switch, deadline_release() in the timer task and deadline_event() in the
+ * task that pends. All of them only update the slot of the task; the
+ * handler is called outside of the critical section.
+ */
+#include <stdio.h>
+#include "deadline.h"
+#include "timestamp.h"
+#include "sys/alt_timestamp.h"
+
+#define DEADLINE_PRIOS  (OS_LOWEST_PRIO + 1)
+#define NO_SLOT         0xFF
+
+typedef struct {
+    OS_EVENT   *release;
+    alt_u32     deadline;   /* cycles after the release */
+    alt_u32     queue[DEADLINE_QUEUE];  /* releases of the unfinished jobs */
+    INT8U       first;      /* oldest in the queue */
+    INT8U       count;
+    INT8U       prio;
+    INT8U       counted;    /* the oldest job is counted as a miss */
+    INT8U       unreported; /* missed since the handler was called */
+    deadline_t  d;
+} deadline_slot_t;
+
+static INT8U              slot_of[DEADLINE_PRIOS];
+static deadline_slot_t    slots[DEADLINE_TASKS];
+static int                nslots;
+static int                unreported;
+static deadline_handler_t handler;
+
+/*
+ * Watches the jobs of the task at 'prio', a job completes when the task
+ * pends on 'release' (waits on anything with NULL). Returns -1 when all
+ * slots are taken or the priority is watched already.
+ */
+int deadline_watch(INT8U prio, OS_EVENT *release, INT32U deadline_ms)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    int i;
+
+    if (nslots == 0)
+    {
+        for (i = 0; i < DEADLINE_PRIOS; i++)
+        {
+            slot_of[i] = NO_SLOT;
+        }
+    }
+    if (prio >= DEADLINE_PRIOS || slot_of[prio] != NO_SLOT || nslots == DEADLINE_TASKS)
+    {
+        return -1;
+    }
+    OS_ENTER_CRITICAL();
+    slots[nslots].release = release;
+    slots[nslots].deadline = alt_timestamp_freq() / 1000 * deadline_ms;
+    slots[nslots].prio = prio;
+    slot_of[prio] = (INT8U) nslots;
+    nslots++;
+    OS_EXIT_CRITICAL();
+    return 0;
+}
+
+void deadline_handler(deadline_handler_t fn)
+{
+    handler = fn;
+}
+
+/* Interrupts are disabled */
+static void deadline_report_late(deadline_slot_t *s, alt_u32 late)
+{
+    s->d.last_late = late;
+    if (late > s->d.max_late)
+    {
+        s->d.max_late = late;
+    }
+    s->unreported = 1;
+    unreported = 1;
+}
+
+/*
+ * Completes the oldest unfinished job at 'now'. Interrupts are disabled.
+ */
+static void deadline_complete(deadline_slot_t *s, alt_u32 now)
+{
+    alt_u32 response, late, v;
+    int b;
+
+    if (s->count == 0)
+    {
+        return;
+    }
+    response = now - s->queue[s->first];
+    s->first = (INT8U) ((s->first + 1) % DEADLINE_QUEUE);
+    s->count--;
+
+    s->d.jobs++;
+    if (response > s->d.max_response)
+    {
+        s->d.max_response = response;
+    }
+    if (response > s->deadline)
+    {
+        late = response - s->deadline;
+        if (!s->counted)
+        {
+            s->d.misses++;
+        }
+        s->d.overdue = 0;
+        deadline_report_late(s, late);
+        b = 0;
+        for (v = late >> DEADLINE_SHIFT; v && b < DEADLINE_BUCKETS - 1; v >>= 1)
+        {
+            b++;
+        }
+        s->d.hist[b]++;
+    }
+    s->counted = 0;
+}
+
+/*
+ * Called from the timer callback that releases the task at 'prio', before
+ * it posts the semaphore or activates the basic task.
+ */
+void deadline_release(INT8U prio)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    alt_u32 now = timestamp_now();
+    alt_u32 per_us = alt_timestamp_freq() / 1000000;
+    deadline_slot_t *s;
+    alt_u32 elapsed, late;
+    int i, missed;
+
+    if (prio >= DEADLINE_PRIOS || nslots == 0 || slot_of[prio] == NO_SLOT)
+    {
+        return;
+    }
+    s = &slots[slot_of[prio]];
+
+    OS_ENTER_CRITICAL();
+    // Still running past its deadline: a miss, how late is known at the end
+    if (s->count > 0)
+    {
+        elapsed = now - s->queue[s->first];
+        if (elapsed > s->deadline && !s->counted)
+        {
+            s->counted = 1;
+            s->d.misses++;
+            s->d.overdue = 1;
+            deadline_report_late(s, elapsed - s->deadline);
+        }
+    }
+    if (s->count < DEADLINE_QUEUE)
+    {
+        s->queue[(s->first + s->count) % DEADLINE_QUEUE] = now;
+        s->count++;
+    }
+    else
+    {
+        s->d.lost++;
+        s->d.misses++;
+    }
+    OS_EXIT_CRITICAL();
+
+    if (!unreported || !handler)
+    {
+        return;
+    }
+    if (per_us == 0)
+    {
+        per_us = 1;
+    }
+    unreported = 0;
+    for (i = 0; i < nslots; i++)
+    {
+        OS_ENTER_CRITICAL();
+        missed = slots[i].unreported;
+        late = slots[i].d.last_late;
+        slots[i].unreported = 0;
+        OS_EXIT_CRITICAL();
+        if (missed)
+        {
+            handler(slots[i].prio, late / per_us);
+        }
+    }
+}
+
+/*
+ * Called from OSTaskSwHook() with the timestamp of the switch, interrupts
+ * are disabled
+ */
+void deadline_switch(alt_u32 now)
+{
+    OS_TCB *ptcb = OSTCBCur;
+    deadline_slot_t *s;
+
+    if (OSRunning != OS_TRUE || nslots == 0 || slot_of[ptcb->OSTCBPrio] == NO_SLOT)
+    {
+        return;
+    }
+    s = &slots[slot_of[ptcb->OSTCBPrio]];
+
+    // Preempted, waiting for something else, or all jobs completed
+    if ((ptcb->OSTCBStat == OS_STAT_RDY && ptcb->OSTCBDly == 0)
+        || (s->release && ptcb->OSTCBEventPtr != s->release)
+        || s->count == 0)
+    {
+        return;
+    }
+
+    // Waits for the next release, nothing released is left to run
+    while (s->count > 0)
+    {
+        deadline_complete(s, now);
+    }
+}
+
+#if OS_TRACE_EN > 0
+/*
+ * Called from App_TraceEvent() with every kernel event: a pend of the
+ * running task on its release object completes its oldest job.
+ */
+void deadline_event(INT8U type, INT16U arg)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    deadline_slot_t *s;
+
+    if ((type != OS_TRACE_EV_SEM_PEND && type != OS_TRACE_EV_MBOX_PEND)
+        || OSIntNesting > 0 || nslots == 0 || slot_of[OSPrioCur] == NO_SLOT)
+    {
+        return;
+    }
+    s = &slots[slot_of[OSPrioCur]];
+    if (s->release != &OSEventTbl[arg])
+    {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    deadline_complete(s, timestamp_now());
+    OS_EXIT_CRITICAL();
+}
+#endif
+
+/*
+ * Copies the statistics of a task, returns 0 if it is not watched.
+ */
+int deadline_get(INT8U prio, deadline_t *d)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (prio >= DEADLINE_PRIOS || nslots == 0 || slot_of[prio] == NO_SLOT)
+    {
+        return 0;
+    }
+    OS_ENTER_CRITICAL();
+    *d = slots[slot_of[prio]].d;
+    OS_EXIT_CRITICAL();
+    return 1;
+}
+
+static void task_name(INT8U prio, INT8U *name)
+{
+#if OS_TASK_NAME_SIZE > 1
+    INT8U err;
+
+    OSTaskNameGet(prio, name, &err);
+    if (err == OS_ERR_NONE && name[0] != '?')
+    {
+        return;
+    }
+#endif
+    sprintf((char *) name, "Task %u", prio);
+}
+
+void deadline_report(void)
+{
+    deadline_t d;
+    alt_u32 per_us = alt_timestamp_freq() / 1000000;
+    INT8U name[OS_TASK_NAME_SIZE];
+    int i, b, first, last;
+
+    if (per_us == 0)
+    {
+        per_us = 1;
+    }
+
+    printf("--Deadlines-- (us)\n");
+    printf("+------+----------------------+----------+---------+---------+-------+--------------+----------+\n");
+    printf("| Prio | Task                 | Deadline |    Jobs |  Misses |  Lost | Max response | Max late |\n");
+    printf("+------+----------------------+----------+---------+---------+-------+--------------+----------+\n");
+    for (i = 0; i < nslots; i++)
+    {
+        deadline_get(slots[i].prio, &d);
+        task_name(slots[i].prio, name);
+        printf("| %4u | %-20.20s | %8u | %7u | %7u | %5u | %12u | %8u |\n",
+               slots[i].prio, (char *) name,
+               (unsigned int) (slots[i].deadline / per_us), (unsigned int) d.jobs,
+               (unsigned int) d.misses, (unsigned int) d.lost,
+               (unsigned int) (d.max_response / per_us),
+               (unsigned int) (d.max_late / per_us));
+    }
+    printf("+------+----------------------+----------+---------+---------+-------+--------------+----------+\n");
+
+    // Lateness of the completed misses, upper bounds in us
+    for (i = 0; i < nslots; i++)
+    {
+        deadline_get(slots[i].prio, &d);
+        for (first = 0; first < DEADLINE_BUCKETS && d.hist[first] == 0; first++)
+            ;
+        for (last = DEADLINE_BUCKETS - 1; last > first && d.hist[last] == 0; last--)
+            ;
+        if (first == DEADLINE_BUCKETS)
+        {
+            continue;
+        }
+        printf("Prio %2u late:", slots[i].prio);
+        for (b = first; b <= last; b++)
+        {
+            if (b == DEADLINE_BUCKETS - 1)
+            {
+                printf(" >=%u:%u", (unsigned int) ((1UL << (DEADLINE_SHIFT + b - 1)) / per_us),
+                       (unsigned int) d.hist[b]);
+            }
+            else
+            {
+                printf(" <%u:%u", (unsigned int) ((1UL << (DEADLINE_SHIFT + b)) / per_us),
+                       (unsigned int) d.hist[b]);
+            }
+        }
+        printf("\n");
+    }
+
+    for (i = 0; i < nslots; i++)
+    {
+        deadline_get(slots[i].prio, &d);
+        task_name(slots[i].prio, name);
+        printf("BENCH {\"bench\":\"deadline\",\"task\":\"%s\",\"prio\":%u,\"jobs\":%u,"
+               "\"misses\":%u,\"lost\":%u,\"max_response_us\":%u,\"max_late_us\":%u}\n",
+               (char *) name, slots[i].prio, (unsigned int) d.jobs, (unsigned int) d.misses,
+               (unsigned int) d.lost, (unsigned int) (d.max_response / per_us),
+               (unsigned int) (d.max_late / per_us));
+    }
+}
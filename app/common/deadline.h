@@ -0,0 +1,99 @@
+/* Per-job deadline monitoring for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Every job of a watched task is released by a timer callback, which
+ *   calls deadline_release() and stamps the job, and completes when the
+ *   task pends on its release object again. A job that completes later
+ *   than 'deadline_ms' after its release is a miss, late by the time past
+ *   its deadline.
+ *
+ *   The stamps of the released jobs wait in a queue of DEADLINE_QUEUE, so
+ *   a task that falls behind (its semaphore counts up) still gets every
+ *   job timed against its own release. The kernel reports each pend to
+ *   App_TraceEvent() (OS_TRACE_EN, see app_hooks.c), which completes the
+ *   oldest job with deadline_event(), also when the semaphore was posted
+ *   already and the task does not wait. When the task does wait on its
+ *   release object (on anything with release NULL, e.g. a basic task that
+ *   suspends at the end of its body) all its jobs are complete; the switch
+ *   hook completes those that are left, at the time of the switch that
+ *   App_TaskSwHook() has read. Without the
+ *   pend events, jobs that ran back to back are completed at the end of
+ *   the last one, which overstates the lateness of the earlier ones.
+ *
+ *   A job that is still running at a later release and is past its
+ *   deadline by then is counted as a miss right away ("overdue"), so a
+ *   task that never completes is noticed; its lateness is final when it
+ *   completes. Releases that do not fit the queue are lost and counted as
+ *   misses.
+ *
+ *   Per task the module keeps the completed jobs, the misses, the longest
+ *   response time (release to completion) and a histogram of the lateness
+ *   of the completed misses in powers of two.
+ *
+ *   An optional handler is called for every task that missed, or whose
+ *   overdue job completed, since the previous call: from the next
+ *   deadline_release(), i.e. in the timer task, so it must not block,
+ *   like any timer callback. It is the place to switch to a degraded mode
+ *   or to wake up a task that reports; deadline_get() tells whether the
+ *   job is still running.
+ *
+ * Usage:
+ *
+ *   - call deadline_switch() with timestamp_now() from App_TaskSwHook(),
+ *     and deadline_event() from App_TraceEvent() (see app_hooks.c)
+ *   - register the tasks once they exist: a release of a task that is not
+ *     created yet (a timer started early) would never complete
+ *
+ *       void miss(INT8U prio, alt_u32 late_us) { ... }
+ *       ...
+ *       deadline_watch(VEHICLETASK_PRIO, Sem_Vehicle, VEHICLE_PERIOD);
+ *       deadline_handler(miss);
+ *       ...
+ *       deadline_release(VEHICLETASK_PRIO);      // in the timer callback
+ *       OSSemPost(Sem_Vehicle);
+ *       ...
+ *       deadline_report();
+ */
+#ifndef __DEADLINE_H__
+#define __DEADLINE_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Tasks that can be watched */
+#ifndef DEADLINE_TASKS
+#define DEADLINE_TASKS      12
+#endif
+
+/* Unfinished jobs per task whose release is kept */
+#ifndef DEADLINE_QUEUE
+#define DEADLINE_QUEUE      8
+#endif
+
+/* Lateness histogram: bucket 0 below 2^DEADLINE_SHIFT cycles, then one per power of two */
+#define DEADLINE_SHIFT      10
+#define DEADLINE_BUCKETS    16
+
+typedef struct {
+    INT32U  jobs;           /* completed */
+    INT32U  misses;         /* completed late, overdue or lost */
+    INT32U  lost;           /* releases that did not fit the queue */
+    alt_u32 max_response;   /* cycles from release to completion */
+    alt_u32 max_late;       /* cycles past the deadline */
+    alt_u32 last_late;      /* of the last miss, so far if it is overdue */
+    INT8U   overdue;        /* the last miss is still running */
+    INT32U  hist[DEADLINE_BUCKETS];
+} deadline_t;
+
+typedef void (*deadline_handler_t)(INT8U prio, alt_u32 late_us);
+
+int     deadline_watch(INT8U prio, OS_EVENT *release, INT32U deadline_ms);
+void    deadline_handler(deadline_handler_t handler);
+void    deadline_release(INT8U prio);
+void    deadline_switch(alt_u32 now);
+void    deadline_event(INT8U type, INT16U arg);
+int     deadline_get(INT8U prio, deadline_t *d);
+void    deadline_report(void);
+
+#endif /* __DEADLINE_H__ */
@@ -0,0 +1,138 @@
+/* Tick and control cycle benchmark for the IL 2206 lab applications
+ *
+ * See hot_bench.h for the description.
+ */
+#include <stdio.h>
+#include "hot_bench.h"
+#include "system.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_timestamp.h"
+#include "timestamp.h"
+
+static const char *stage_names[HOT_BENCH_STAGES] = { "tick", "control", "sw_hook" };
+
+static hot_bench_t stages[HOT_BENCH_STAGES];
+
+/* Last pass of the idle loop */
+static alt_u32 idle_ts;
+static alt_u32 idle_ticks;
+static INT32U  idle_ctx_sw;
+static INT8U   idle_valid;
+
+/* Shortest pass without a tick, 0 until seen */
+static alt_u32 idle_loop;
+
+static void hot_bench_add(hot_bench_t *hb, alt_u32 cycles)
+{
+    if (hb->samples == 0 || cycles < hb->min)
+    {
+        hb->min = cycles;
+    }
+    if (cycles > hb->max)
+    {
+        hb->max = cycles;
+    }
+    hb->sum += cycles;
+    hb->samples++;
+}
+
+/*
+ * Called from App_TaskIdleHook(), interrupts are enabled
+ */
+void hot_bench_idle(void)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    alt_u32 now, ticks, gap;
+    INT32U ctx_sw;
+
+    // Read together, a tick between the readings would be missed
+    OS_ENTER_CRITICAL();
+    now = timestamp_now();
+    ticks = alt_nticks();
+    ctx_sw = OSCtxSwCtr;
+    OS_EXIT_CRITICAL();
+
+    gap = now - idle_ts;
+    if (idle_valid && ctx_sw == idle_ctx_sw
+        && gap < alt_timestamp_freq() / OS_TICKS_PER_SEC)
+    {
+        if (ticks == idle_ticks)
+        {
+            if (idle_loop == 0 || gap < idle_loop)
+            {
+                idle_loop = gap;
+            }
+        }
+        else if (ticks == idle_ticks + 1 && idle_loop != 0 && gap > idle_loop)
+        {
+            hot_bench_add(&stages[HOT_BENCH_TICK], gap - idle_loop);
+        }
+    }
+    idle_ts = now;
+    idle_ticks = ticks;
+    idle_ctx_sw = ctx_sw;
+    idle_valid = 1;
+}
+
+alt_u32 hot_bench_begin(void)
+{
+    return timestamp_now();
+}
+
+void hot_bench_end(int stage, alt_u32 t0)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    alt_u32 cycles = timestamp_now() - t0;
+
+    OS_ENTER_CRITICAL();
+    hot_bench_add(&stages[stage], cycles);
+    OS_EXIT_CRITICAL();
+}
+
+void hot_bench_report(void)
+{
+    hot_bench_t hb;
+    alt_u32 avg;
+    int onchip;
+    int i;
+
+#ifdef ALT_HOT_CODE
+    onchip = 1;
+#else
+    onchip = 0;
+#endif
+
+    printf("--Hot Code-- (%s, cycles at %u Hz, idle loop %u)\n",
+           onchip ? "on-chip memory" : "SRAM",
+           (unsigned int) alt_timestamp_freq(), (unsigned int) idle_loop);
+    printf("+---------+---------+--------+--------+--------+\n");
+    printf("| Stage   | Samples |    Min |    Avg |    Max |\n");
+    printf("+---------+---------+--------+--------+--------+\n");
+    for (i = 0; i < HOT_BENCH_STAGES; i++)
+    {
+        hb = stages[i];
+        avg = hb.samples ? (alt_u32) (hb.sum / hb.samples) : 0;
+        printf("| %-7s | %7u | %6u | %6u | %6u |\n", stage_names[i],
+               (unsigned int) hb.samples, (unsigned int) hb.min,
+               (unsigned int) avg, (unsigned int) hb.max);
+    }
+    printf("+---------+---------+--------+--------+--------+\n");
+
+    for (i = 0; i < HOT_BENCH_STAGES; i++)
+    {
+        hb = stages[i];
+        if (hb.samples == 0)
+        {
+            continue;
+        }
+        printf("BENCH {\"bench\":\"hot_code\",\"stage\":\"%s\",\"onchip\":%d,"
+               "\"samples\":%u,\"min\":%u,\"avg\":%u,\"max\":%u}\n",
+               stage_names[i], onchip, (unsigned int) hb.samples,
+               (unsigned int) hb.min, (unsigned int) (hb.sum / hb.samples),
+               (unsigned int) hb.max);
+    }
+}
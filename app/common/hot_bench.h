@@ -0,0 +1,60 @@
+/* Tick and control cycle benchmark for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Measures the paths that ALT_HOT (alt_types.h) links into the on-chip
+ *   memory, so a BSP and application built with ALT_HOT_CODE can be
+ *   compared with one built without it (everything in SRAM).
+ *
+ *   tick:    hot_bench_idle(), called from App_TaskIdleHook(), reads the
+ *            timestamp timer once per pass of the idle loop. A pass in which
+ *            the clock tick interrupt came and no task switch happened took
+ *            the whole tick, from the exception entry over alt_tick(), the
+ *            alarms and OSTimeTick() to the return from OSIntExit(). The
+ *            shortest pass without a tick is the idle loop itself and is
+ *            subtracted. Ticks that make a task ready are not measured.
+ *   control: hot_bench_begin()/hot_bench_end() around the body of one
+ *            control cycle.
+ *   sw_hook: App_TaskSwHook() from its reading of the timestamp to the end
+ *            of the last monitor, once per task switch (app_hooks.c).
+ *
+ *   Times are in cycles of the timestamp timer, read with timestamp_now(). hot_bench_report() prints a
+ *   table and one "BENCH " JSON line per stage, compare two builds with
+ *   tools/bench_compare.py --metric avg (or min, max).
+ *
+ * Usage:
+ *
+ *       alt_u32 t0;
+ *       ...
+ *       t0 = hot_bench_begin();
+ *       ...                                 // control law and actuation
+ *       hot_bench_end(HOT_BENCH_CONTROL, t0);
+ *       ...
+ *       hot_bench_report();
+ */
+#ifndef __HOT_BENCH_H__
+#define __HOT_BENCH_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+enum hot_bench_stage {
+    HOT_BENCH_TICK,
+    HOT_BENCH_CONTROL,
+    HOT_BENCH_SW_HOOK,
+    HOT_BENCH_STAGES
+};
+
+typedef struct {
+    INT32U  samples;
+    alt_u32 min;
+    alt_u32 max;
+    alt_u64 sum;
+} hot_bench_t;
+
+void    hot_bench_idle(void);
+alt_u32 hot_bench_begin(void);
+void    hot_bench_end(int stage, alt_u32 t0);
+void    hot_bench_report(void);
+
+#endif /* __HOT_BENCH_H__ */
@@ -0,0 +1,210 @@
+/* Per-job execution time of the tasks for the IL 2206 lab applications
+ *
+ * See job_wcet.h for the description.
+ *
+ * job_wcet_switch() runs with interrupts disabled inside every context
+ * switch. A priority that is not watched costs one table lookup, a watched
+ * task that is only preempted a compare of its state.
+ */
+#include <stdio.h>
+#include "job_wcet.h"
+#include "sys/alt_timestamp.h"
+
+#define JOB_WCET_PRIOS  (OS_LOWEST_PRIO + 1)
+#define NO_SLOT         0xFF
+
+typedef struct {
+    OS_EVENT   *release;
+    alt_u32     start;      /* OSTCBCyclesTot when the job began */
+    INT8U       prio;
+    INT8U       started;    /* the first job ended */
+    job_wcet_t  wcet;
+} job_slot_t;
+
+static INT8U      slot_of[JOB_WCET_PRIOS];
+static job_slot_t slots[JOB_WCET_TASKS];
+static int        nslots;
+
+/*
+ * Measures the jobs of the task at 'prio', a job ends when the task waits
+ * on 'release' (on anything with NULL). Returns -1 when all slots are
+ * taken or the priority is watched already.
+ */
+int job_wcet_watch(INT8U prio, OS_EVENT *release)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    int i;
+
+    if (nslots == 0)
+    {
+        for (i = 0; i < JOB_WCET_PRIOS; i++)
+        {
+            slot_of[i] = NO_SLOT;
+        }
+    }
+    if (prio >= JOB_WCET_PRIOS || slot_of[prio] != NO_SLOT || nslots == JOB_WCET_TASKS)
+    {
+        return -1;
+    }
+    OS_ENTER_CRITICAL();
+    slots[nslots].release = release;
+    slots[nslots].prio = prio;
+    slot_of[prio] = (INT8U) nslots;
+    nslots++;
+    OS_EXIT_CRITICAL();
+    return 0;
+}
+
+/*
+ * Called from OSTaskSwHook() after task_acct_switch(), which has added the
+ * run that just ended to OSTCBCur->OSTCBCyclesTot. Interrupts are disabled.
+ */
+void job_wcet_switch(void)
+{
+    OS_TCB *ptcb = OSTCBCur;
+    job_slot_t *s;
+    alt_u32 exec, v;
+    int b;
+
+    if (OSRunning != OS_TRUE || nslots == 0 || slot_of[ptcb->OSTCBPrio] == NO_SLOT)
+    {
+        return;
+    }
+    s = &slots[slot_of[ptcb->OSTCBPrio]];
+
+    // Preempted, or waiting for something else than the next release
+    if ((ptcb->OSTCBStat == OS_STAT_RDY && ptcb->OSTCBDly == 0)
+        || (s->release && ptcb->OSTCBEventPtr != s->release))
+    {
+        return;
+    }
+
+    exec = ptcb->OSTCBCyclesTot - s->start;
+    s->start = ptcb->OSTCBCyclesTot;
+    if (!s->started)
+    {
+        s->started = 1;
+        return;
+    }
+
+    s->wcet.jobs++;
+    s->wcet.last = exec;
+    s->wcet.sum += exec;
+    if (exec > s->wcet.max)
+    {
+        s->wcet.max = exec;
+    }
+    b = 0;
+    for (v = exec >> JOB_WCET_SHIFT; v && b < JOB_WCET_BUCKETS - 1; v >>= 1)
+    {
+        b++;
+    }
+    s->wcet.hist[b]++;
+}
+
+/*
+ * Copies the statistics of a task, returns 0 if it is not watched.
+ */
+int job_wcet_get(INT8U prio, job_wcet_t *wcet)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (prio >= JOB_WCET_PRIOS || nslots == 0 || slot_of[prio] == NO_SLOT)
+    {
+        return 0;
+    }
+    OS_ENTER_CRITICAL();
+    *wcet = slots[slot_of[prio]].wcet;
+    OS_EXIT_CRITICAL();
+    return 1;
+}
+
+static void task_name(INT8U prio, INT8U *name)
+{
+#if OS_TASK_NAME_SIZE > 1
+    INT8U err;
+
+    OSTaskNameGet(prio, name, &err);
+    if (err == OS_ERR_NONE && name[0] != '?')
+    {
+        return;
+    }
+#endif
+    sprintf((char *) name, "Task %u", prio);
+}
+
+void job_wcet_report(void)
+{
+    job_wcet_t w;
+    alt_u32 per_us = alt_timestamp_freq() / 1000000;
+    INT8U name[OS_TASK_NAME_SIZE];
+    int i, b, first, last;
+
+    if (per_us == 0)
+    {
+        per_us = 1;
+    }
+
+    printf("--Job Execution Times-- (us, without preemption)\n");
+    printf("+------+----------------------+---------+---------+---------+---------+\n");
+    printf("| Prio | Task                 |    Jobs |    Last |     Avg |     Max |\n");
+    printf("+------+----------------------+---------+---------+---------+---------+\n");
+    for (i = 0; i < nslots; i++)
+    {
+        job_wcet_get(slots[i].prio, &w);
+        task_name(slots[i].prio, name);
+        printf("| %4u | %-20.20s | %7u | %7u | %7u | %7u |\n",
+               slots[i].prio, (char *) name, (unsigned int) w.jobs,
+               (unsigned int) (w.last / per_us),
+               (unsigned int) (w.jobs ? w.sum / w.jobs / per_us : 0),
+               (unsigned int) (w.max / per_us));
+    }
+    printf("+------+----------------------+---------+---------+---------+---------+\n");
+
+    // Histograms from the first to the last bucket used, upper bounds in us
+    for (i = 0; i < nslots; i++)
+    {
+        job_wcet_get(slots[i].prio, &w);
+        for (first = 0; first < JOB_WCET_BUCKETS && w.hist[first] == 0; first++)
+            ;
+        for (last = JOB_WCET_BUCKETS - 1; last > first && w.hist[last] == 0; last--)
+            ;
+        if (first == JOB_WCET_BUCKETS)
+        {
+            continue;
+        }
+        printf("Prio %2u:", slots[i].prio);
+        for (b = first; b <= last; b++)
+        {
+            if (b == JOB_WCET_BUCKETS - 1)
+            {
+                printf(" >=%u:%u", (unsigned int) ((1UL << (JOB_WCET_SHIFT + b - 1)) / per_us),
+                       (unsigned int) w.hist[b]);
+            }
+            else
+            {
+                printf(" <%u:%u", (unsigned int) ((1UL << (JOB_WCET_SHIFT + b)) / per_us),
+                       (unsigned int) w.hist[b]);
+            }
+        }
+        printf("\n");
+    }
+
+    for (i = 0; i < nslots; i++)
+    {
+        job_wcet_get(slots[i].prio, &w);
+        if (w.jobs == 0)
+        {
+            continue;
+        }
+        task_name(slots[i].prio, name);
+        printf("BENCH {\"bench\":\"wcet\",\"task\":\"%s\",\"prio\":%u,\"jobs\":%u,"
+               "\"avg_us\":%u,\"max_us\":%u}\n",
+               (char *) name, slots[i].prio, (unsigned int) w.jobs,
+               (unsigned int) (w.sum / w.jobs / per_us), (unsigned int) (w.max / per_us));
+    }
+}
@@ -0,0 +1,70 @@
+/* Per-job execution time of the tasks for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   A job of a periodic task runs from its release (the timer posts the
+ *   semaphore the task pends on) to its next pend on that semaphore. This
+ *   module measures the execution time of every job, i.e. the cycles the
+ *   task itself was running in between, without the tasks that preempted
+ *   it, and keeps per task the number of jobs, the longest (WCET
+ *   high-water mark), the average and a histogram in powers of two.
+ *
+ *   The cycles come from the accounting of task_acct (OSTCBCyclesTot on
+ *   the timestamp timer), so job_wcet_switch() does not read a clock: it
+ *   looks up the task that is switched out and, when that task now waits
+ *   for its release, closes the job. The timer runs continuously
+ *   (timestamp.h), the differences stay right when it wraps. What the
+ *   whole chain of App_TaskSwHook() costs per switch is the sw_hook stage
+ *   of hot_bench_report() and the sw_hook region of the cruise control's
+ *   bench.json (tools/bench_budget.py).
+ *
+ *   A task that waits on other objects inside its job (e.g. a mailbox
+ *   that is still empty) stays in the same job. With release NULL every
+ *   wait ends the job, which is what a basic task does when it suspends
+ *   at the end of its body. The first job of a task includes its
+ *   initialisation and is not counted. Interrupt handlers are counted in
+ *   the task they interrupt, like in task_acct.
+ *
+ * Usage:
+ *
+ *   - call job_wcet_switch() from App_TaskSwHook() after
+ *     task_acct_switch() (see app_hooks.c)
+ *   - register the tasks before they run their first job:
+ *
+ *       job_wcet_watch(VEHICLETASK_PRIO, Sem_Vehicle);
+ *       job_wcet_watch(KEYIOTASK_PRIO, NULL);          // basic task
+ *       ...
+ *       job_wcet_get(VEHICLETASK_PRIO, &wcet);         // at run time
+ *       job_wcet_report();                             // table and BENCH lines
+ *
+ *   The "BENCH " lines can be given to tools/rta.py --wcet.
+ */
+#ifndef __JOB_WCET_H__
+#define __JOB_WCET_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Tasks that can be watched */
+#ifndef JOB_WCET_TASKS
+#define JOB_WCET_TASKS      12
+#endif
+
+/* Histogram: bucket 0 below 2^JOB_WCET_SHIFT cycles, then one per power of two */
+#define JOB_WCET_SHIFT      10
+#define JOB_WCET_BUCKETS    16
+
+typedef struct {
+    INT32U  jobs;
+    alt_u32 max;        /* cycles of the longest job */
+    alt_u32 last;       /*            of the last job */
+    alt_u64 sum;
+    INT32U  hist[JOB_WCET_BUCKETS];
+} job_wcet_t;
+
+int     job_wcet_watch(INT8U prio, OS_EVENT *release);
+void    job_wcet_switch(void);
+int     job_wcet_get(INT8U prio, job_wcet_t *wcet);
+void    job_wcet_report(void);
+
+#endif /* __JOB_WCET_H__ */
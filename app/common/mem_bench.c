@@ -0,0 +1,189 @@
+/* Kernel memory routine benchmark for the IL 2206 lab applications
+ *
+ * See mem_bench.h for the description.
+ */
+#include <stdio.h>
+#include "mem_bench.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_timestamp.h"
+
+/* Built like the BSP, the application is built with -O0 */
+#define MEM_BENCH_REF __attribute__ ((noinline, optimize ("Os")))
+
+#define MEM_BENCH_WORDS (MEM_BENCH_MAX / sizeof(OS_STK))
+
+static OS_STK src_buf[MEM_BENCH_WORDS + 1];
+static OS_STK dst_buf[MEM_BENCH_WORDS + 1];
+
+static const INT16U sizes[] = { 16, 64, 256, 1024, MEM_BENCH_MAX };
+#define MEM_BENCH_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+enum mem_bench_op {
+    MEM_BENCH_CLR,
+    MEM_BENCH_COPY,
+    MEM_BENCH_STK_FILL,
+    MEM_BENCH_STK_SCAN
+};
+
+static const char *op_names[] = { "clr", "copy", "stk_fill", "stk_scan" };
+
+static alt_u32 overhead;
+
+/*
+ * The loops of the kernel before, for reference
+ */
+static void MEM_BENCH_REF ref_clr(INT8U *pdest, INT16U size)
+{
+    while (size > 0) {
+        *pdest++ = (INT8U)0;
+        size--;
+    }
+}
+
+static void MEM_BENCH_REF ref_copy(INT8U *pdest, INT8U *psrc, INT16U size)
+{
+    while (size > 0) {
+        *pdest++ = *psrc++;
+        size--;
+    }
+}
+
+static void MEM_BENCH_REF ref_stk_fill(OS_STK *pbos, INT32U size)
+{
+    while (size > 0) {
+        size--;
+        *pbos++ = (OS_STK)0;
+    }
+}
+
+static INT32U MEM_BENCH_REF ref_stk_scan(OS_STK *pchk)
+{
+    INT32U nfree = 0;
+
+    while (*pchk++ == (OS_STK)0) {
+        nfree++;
+    }
+    return nfree;
+}
+
+/*
+ * Runs one case with interrupts disabled, returns its shortest time
+ */
+static alt_u32 mem_bench_time(int op, int word, int unaligned, INT16U size)
+{
+    alt_irq_context context;
+    INT8U *dst = (INT8U *) dst_buf + unaligned;
+    INT8U *src = (INT8U *) src_buf;
+    INT32U n = size / sizeof(OS_STK);
+    alt_u32 t0, t, best = 0;
+    int rep;
+
+    for (rep = 0; rep < MEM_BENCH_REPS; rep++)
+    {
+        if (op == MEM_BENCH_STK_SCAN)
+        {
+            // n free elements, then the used part
+            OS_MemClr((INT8U *) dst_buf, n * sizeof(OS_STK));
+            dst_buf[n] = (OS_STK) 0xA5A5A5A5u;
+        }
+        context = alt_irq_disable_all();
+        t0 = alt_timestamp();
+        switch (op)
+        {
+        case MEM_BENCH_CLR:
+            if (word)
+                OS_MemClr(dst, size);
+            else
+                ref_clr(dst, size);
+            break;
+        case MEM_BENCH_COPY:
+            if (word)
+                OS_MemCopy(dst, src, size);
+            else
+                ref_copy(dst, src, size);
+            break;
+#if OS_TASK_CREATE_EXT_EN > 0
+        case MEM_BENCH_STK_FILL:
+            if (word)
+                OS_StkClr(dst_buf, n);
+            else
+                ref_stk_fill(dst_buf, n);
+            break;
+        case MEM_BENCH_STK_SCAN:
+            if (word)
+                (void) OS_StkFree(dst_buf, n + 1);
+            else
+                (void) ref_stk_scan(dst_buf);
+            break;
+#endif
+        }
+        t = alt_timestamp() - t0;
+        alt_irq_enable_all(context);
+        if (rep == 0 || t < best)
+        {
+            best = t;
+        }
+    }
+    return best > overhead ? best - overhead : 0;
+}
+
+static void mem_bench_case(int op, int unaligned, INT16U size)
+{
+    alt_u32 byte, word;
+
+    byte = mem_bench_time(op, 0, unaligned, size);
+    word = mem_bench_time(op, 1, unaligned, size);
+    printf("| %-8s | %-9s | %5u | %7u | %7u | %4u.%02u |\n", op_names[op],
+           unaligned ? "unaligned" : "aligned", size, (unsigned int) byte,
+           (unsigned int) word, word ? (unsigned int) (byte / word) : 0,
+           word ? (unsigned int) (byte * 100 / word % 100) : 0);
+    printf("BENCH {\"bench\":\"mem\",\"op\":\"%s\",\"case\":\"%s\",\"n\":%u,"
+           "\"byte\":%u,\"word\":%u}\n", op_names[op],
+           unaligned ? "unaligned" : "aligned", size,
+           (unsigned int) byte, (unsigned int) word);
+}
+
+void mem_bench_run(void)
+{
+    alt_irq_context context;
+    alt_u32 t0, t;
+    unsigned int i;
+    int rep;
+
+    for (rep = 0; rep < MEM_BENCH_REPS; rep++)
+    {
+        context = alt_irq_disable_all();
+        t0 = alt_timestamp();
+        t = alt_timestamp() - t0;
+        alt_irq_enable_all(context);
+        if (rep == 0 || t < overhead)
+        {
+            overhead = t;
+        }
+    }
+    for (i = 0; i < MEM_BENCH_WORDS; i++)
+    {
+        src_buf[i] = (OS_STK) (i * 0x01010101u);
+    }
+
+    printf("--Memory Routines-- (cycles at %u Hz, byte loop vs kernel, %s core)\n",
+           (unsigned int) alt_timestamp_freq(), NIOS2_CPU_IMPLEMENTATION);
+    printf("+----------+-----------+-------+---------+---------+---------+\n");
+    printf("| Op       | Case      | Bytes |    Byte |    Word | Speedup |\n");
+    printf("+----------+-----------+-------+---------+---------+---------+\n");
+    for (i = 0; i < MEM_BENCH_SIZES; i++)
+    {
+        mem_bench_case(MEM_BENCH_CLR, 0, sizes[i]);
+        mem_bench_case(MEM_BENCH_CLR, 1, sizes[i] - 1);
+        mem_bench_case(MEM_BENCH_COPY, 0, sizes[i]);
+        mem_bench_case(MEM_BENCH_COPY, 1, sizes[i] - 1);
+    }
+#if OS_TASK_CREATE_EXT_EN > 0
+    for (i = 0; i < MEM_BENCH_SIZES; i++)
+    {
+        mem_bench_case(MEM_BENCH_STK_FILL, 0, sizes[i]);
+        mem_bench_case(MEM_BENCH_STK_SCAN, 0, sizes[i]);
+    }
+#endif
+    printf("+----------+-----------+-------+---------+---------+---------+\n");
+}
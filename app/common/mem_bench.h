@@ -0,0 +1,45 @@
+/* Kernel memory routine benchmark for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Times the word-wide OS_MemClr(), OS_MemCopy(), OS_StkClr() and
+ *   OS_StkFree() of the kernel against the byte and element loops they
+ *   replace, which are kept here as the reference and built with -Os like
+ *   the BSP. The DE2 system has a Nios II/e: no caches, no branch
+ *   prediction, every loop iteration costs its branch and counter update.
+ *
+ *   clr, copy   'aligned' starts on a word boundary, 'unaligned' one byte
+ *               after it (copy: only the destination, so the kernel falls
+ *               back to bytes)
+ *   stk_fill    clearing 'n' stack elements, as OS_TASK_OPT_STK_CLR
+ *   stk_scan    counting 'n' free elements, as OSTaskStkChk()
+ *
+ *   Each case runs MEM_BENCH_REPS times with interrupts disabled, the
+ *   shortest run counts, minus the cost of reading the timestamp timer.
+ *   Times are in cycles of the timestamp timer (the CPU clock on the DE2
+ *   system). mem_bench_run() prints a table and one "BENCH " JSON line
+ *   per case, compare two builds with tools/bench_compare.py --metric word.
+ *
+ * Usage:
+ *
+ *       alt_timestamp_start();              // or trace_init()
+ *       mem_bench_run();                    // before OSStart(), ~20 ms
+ */
+#ifndef __MEM_BENCH_H__
+#define __MEM_BENCH_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Largest case in bytes, also the size of each of the two buffers */
+#ifndef MEM_BENCH_MAX
+#define MEM_BENCH_MAX   4096
+#endif
+
+#ifndef MEM_BENCH_REPS
+#define MEM_BENCH_REPS  4
+#endif
+
+void mem_bench_run(void);
+
+#endif /* __MEM_BENCH_H__ */
@@ -0,0 +1,324 @@
+/* Statistical PC profiler for the IL 2206 lab applications
+ *
+ * See pc_prof.h for the description.
+ *
+ * Dump format, one line per record so a terminal log can be converted:
+ *
+ *   PCPROF-BEGIN source=<tick|timer> rate=<Hz> shift=<n> samples=<n> outside=<n> saturated=<n> filter=<prio|all>
+ *   PCPROF-REGION <name> <low hex> <high hex> <first bucket>
+ *   PCPROF-TASK <prio> <samples> <name>
+ *   PS <bucket> <count>                    (buckets that are not 0)
+ *   PCPROF-END
+ */
+#include <stdio.h>
+#include <string.h>
+#include "pc_prof.h"
+#include "sys/alt_irq.h"
+#include "altera_avalon_timer_regs.h"
+#include "timestamp.h"
+
+/* Samples on the timer of alt_timestamp(), pc_prof_stop() gives it back */
+#if defined(PC_PROF_TIMER_BASE) && (PC_PROF_TIMER_BASE == ALT_TIMESTAMP_CLK_BASE)
+#define PC_PROF_ON_TIMESTAMP 1
+#else
+#define PC_PROF_ON_TIMESTAMP 0
+#endif
+
+#ifdef OS_CPU_HOST
+/* The host port saves the interrupted PC, read like ea */
+#define PC_PROF_READ_EA(dest)  ((dest) = host_irq_pc + 4)
+
+#define PC_PROF_REGIONS 1
+
+/* Provided by the host linker, there is no on-chip memory */
+extern char __executable_start[];
+extern char etext[];
+#else
+/* Exception return address, the interrupted instruction is at ea - 4 */
+#define PC_PROF_READ_EA(dest)  __asm__ ("mov %0, ea" : "=r" (dest))
+
+#define PC_PROF_REGIONS 3
+
+/* Provided by linker.x */
+extern char stext[];
+extern char etext[];
+extern char _alt_partition_onchip_memory_start[];
+extern char _alt_partition_onchip_memory_end[];
+extern char __ram_exceptions_start[];
+extern char __ram_exceptions_end[];
+#endif
+
+typedef struct {
+    const char *name;
+    alt_u32     low;
+    alt_u32     size;
+    alt_u32     first;      /* first bucket */
+} pc_prof_region_t;
+
+static alt_u16          hist[PC_PROF_BUCKETS];
+static pc_prof_region_t regions[PC_PROF_REGIONS];
+static int              nregions;
+static int              shift;
+
+static INT32U task_samples[OS_LOWEST_PRIO + 1];
+static alt_u32 samples;
+static alt_u32 outside;
+static alt_u32 saturated;
+
+static INT8U   running;
+static INT8U   source;
+static INT8U   filter = PC_PROF_ALL_TASKS;
+static alt_u32 rate;
+
+static void pc_prof_add_region(const char *name, char *low, char *high)
+{
+    if (high > low)
+    {
+        regions[nregions].name = name;
+        regions[nregions].low = (alt_u32) low;
+        regions[nregions].size = (alt_u32) (high - low);
+        nregions++;
+    }
+}
+
+/*
+ * Smallest bucket size that fits all regions into the histogram
+ */
+static void pc_prof_layout(void)
+{
+    alt_u32 total;
+    int i;
+
+    nregions = 0;
+#ifdef OS_CPU_HOST
+    pc_prof_add_region("text", __executable_start, etext);
+#else
+    pc_prof_add_region("text", stext, etext);
+    pc_prof_add_region("onchip", _alt_partition_onchip_memory_start, _alt_partition_onchip_memory_end);
+    pc_prof_add_region("exceptions", __ram_exceptions_start, __ram_exceptions_end);
+#endif
+
+    for (shift = PC_PROF_MIN_SHIFT; ; shift++)
+    {
+        total = 0;
+        for (i = 0; i < nregions; i++)
+        {
+            regions[i].first = total;
+            total += (regions[i].size + (1 << shift) - 1) >> shift;
+        }
+        if (total <= PC_PROF_BUCKETS)
+        {
+            break;
+        }
+    }
+}
+
+#ifdef PC_PROF_TIMER_BASE
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void pc_prof_timer_irq(void *context)
+#else
+static void pc_prof_timer_irq(void *context, alt_u32 id)
+#endif
+{
+    alt_u32 pc;
+
+    PC_PROF_READ_EA(pc);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(PC_PROF_TIMER_BASE, 0);
+    IORD_ALTERA_AVALON_TIMER_CONTROL(PC_PROF_TIMER_BASE);
+    pc_prof_sample(pc - 4);
+}
+#endif
+
+void pc_prof_start(INT8U src, alt_u32 hz)
+{
+    if (nregions == 0)
+    {
+        pc_prof_layout();
+    }
+    source = src;
+
+    if (src == PC_PROF_TICK)
+    {
+        rate = OS_TICKS_PER_SEC;
+        running = 1;
+        return;
+    }
+
+#ifdef PC_PROF_TIMER_BASE
+    rate = hz;
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(PC_PROF_TIMER_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_PERIODL(PC_PROF_TIMER_BASE, (PC_PROF_TIMER_FREQ / hz - 1) & 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_PERIODH(PC_PROF_TIMER_BASE, (PC_PROF_TIMER_FREQ / hz - 1) >> 16);
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+    alt_ic_isr_register(PC_PROF_TIMER_IC_ID, PC_PROF_TIMER_IRQ, pc_prof_timer_irq, NULL, NULL);
+#else
+    alt_irq_register(PC_PROF_TIMER_IRQ, NULL, pc_prof_timer_irq);
+#endif
+    running = 1;
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(PC_PROF_TIMER_BASE,
+                                     ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
+                                     ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                     ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+#else
+    (void) hz;
+    printf("pc_prof: no timer, set PC_PROF_TIMER_BASE or use PC_PROF_TICK\n");
+#endif
+}
+
+void pc_prof_stop(void)
+{
+    running = 0;
+#ifdef PC_PROF_TIMER_BASE
+    if (source == PC_PROF_TIMER)
+    {
+        IOWR_ALTERA_AVALON_TIMER_CONTROL(PC_PROF_TIMER_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+#if PC_PROF_ON_TIMESTAMP
+        // Counting continuously from the top again, without the interrupt
+        (void) timestamp_start();
+#endif
+    }
+#endif
+}
+
+void pc_prof_reset(void)
+{
+    alt_irq_context context;
+
+    context = alt_irq_disable_all();
+    memset(hist, 0, sizeof(hist));
+    memset(task_samples, 0, sizeof(task_samples));
+    samples = 0;
+    outside = 0;
+    saturated = 0;
+    alt_irq_enable_all(context);
+}
+
+/*
+ * Only samples of task 'prio' go into the histogram, PC_PROF_ALL_TASKS
+ * for all
+ */
+void pc_prof_filter(INT8U prio)
+{
+    filter = prio;
+}
+
+/*
+ * Called from App_TimeTickHook(), in the tick interrupt
+ */
+void ALT_HOT pc_prof_tick(void)
+{
+    alt_u32 pc;
+
+    if (source == PC_PROF_TICK)
+    {
+        PC_PROF_READ_EA(pc);
+        pc_prof_sample(pc - 4);
+    }
+}
+
+/*
+ * Counts one sample, called in interrupt context
+ */
+void ALT_HOT pc_prof_sample(alt_u32 pc)
+{
+    alt_u32 offset, b;
+    INT8U prio;
+    int i;
+
+    if (!running || OSRunning != OS_TRUE)
+    {
+        return;
+    }
+    prio = OSTCBCur->OSTCBPrio;
+    task_samples[prio]++;
+    samples++;
+    if (filter != PC_PROF_ALL_TASKS && prio != filter)
+    {
+        return;
+    }
+    for (i = 0; i < nregions; i++)
+    {
+        offset = pc - regions[i].low;
+        if (offset < regions[i].size)
+        {
+            b = regions[i].first + (offset >> shift);
+            if (hist[b] != 0xFFFF)
+            {
+                hist[b]++;
+            }
+            else
+            {
+                saturated++;
+            }
+            return;
+        }
+    }
+    outside++;
+}
+
+alt_u32 pc_prof_samples(void)
+{
+    return samples;
+}
+
+void pc_prof_dump(void)
+{
+    INT8U was_running = running;
+    INT8U prio;
+    INT8U name[OS_TASK_NAME_SIZE];
+    INT8U err;
+    alt_u32 b, total;
+    int i;
+
+    running = 0;
+
+    printf("PCPROF-BEGIN source=%s rate=%u shift=%d samples=%u outside=%u saturated=%u filter=",
+           source == PC_PROF_TICK ? "tick" : "timer", (unsigned int) rate, shift,
+           (unsigned int) samples, (unsigned int) outside, (unsigned int) saturated);
+    if (filter == PC_PROF_ALL_TASKS)
+    {
+        printf("all\n");
+    }
+    else
+    {
+        printf("%u\n", filter);
+    }
+
+    total = 0;
+    for (i = 0; i < nregions; i++)
+    {
+        printf("PCPROF-REGION %s %08x %08x %u\n", regions[i].name,
+               (unsigned int) regions[i].low,
+               (unsigned int) (regions[i].low + regions[i].size),
+               (unsigned int) regions[i].first);
+        total = regions[i].first + ((regions[i].size + (1 << shift) - 1) >> shift);
+    }
+
+    for (prio = 0; prio <= OS_LOWEST_PRIO; prio++)
+    {
+        if (task_samples[prio] == 0)
+        {
+            continue;
+        }
+#if OS_TASK_NAME_SIZE > 1
+        OSTaskNameGet(prio, name, &err);
+        if (err == OS_ERR_NONE && name[0] != '?')
+        {
+            printf("PCPROF-TASK %u %u %s\n", prio, (unsigned int) task_samples[prio], (char *) name);
+            continue;
+        }
+#endif
+        printf("PCPROF-TASK %u %u Task %u\n", prio, (unsigned int) task_samples[prio], prio);
+    }
+
+    for (b = 0; b < total; b++)
+    {
+        if (hist[b] != 0)
+        {
+            printf("PS %u %u\n", (unsigned int) b, hist[b]);
+        }
+    }
+    printf("PCPROF-END\n");
+
+    running = was_running;
+}
@@ -0,0 +1,89 @@
+/* Statistical PC profiler for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Samples the interrupted program counter at a fixed rate and counts it
+ *   in a histogram of PC_PROF_BUCKETS 16-bit buckets, each (1 << shift)
+ *   bytes of code, like the gprof PC sampling of alt_gmon.c but without the
+ *   mcount instrumentation, so the code profiled is the production code.
+ *   The histogram covers .text, the ALT_HOT functions in on-chip memory and
+ *   .exceptions; the bucket size is the smallest that fits all three.
+ *
+ *   The running task is counted per priority with every sample. With
+ *   pc_prof_filter() only the samples of one task go into the histogram.
+ *
+ *   Sources:
+ *
+ *     PC_PROF_TICK   pc_prof_tick() from App_TimeTickHook() (app_hooks.c),
+ *                    one sample per clock tick. Nothing is set up, but code
+ *                    that runs in step with the tick (delays, timer
+ *                    callbacks) is sampled at the same point every time.
+ *     PC_PROF_TIMER  an interrupt of its own from PC_PROF_TIMER_BASE at
+ *                    'rate' Hz; pick a rate that is not a multiple of the
+ *                    tick. The default is timer_1, which is also the
+ *                    timestamp timer of this system: while it samples,
+ *                    alt_timestamp() wraps every sample period and the
+ *                    timestamp based monitors (task_acct, trace, hot_bench)
+ *                    are wrong. Start it after them, a later
+ *                    alt_timestamp_start() stops the sampling.
+ *                    pc_prof_stop() restarts the timestamp timer with
+ *                    timestamp_start(), from 0xffffffff: intervals that
+ *                    span the sampling or its end are wrong, later ones
+ *                    are right again.
+ *
+ *   A sample is one compare per region and an increment, on the tick path
+ *   it is placed with ALT_HOT.
+ *
+ *   pc_prof_dump() prints the histogram on the JTAG UART, one line per
+ *   record. tools/pcprof.py symbolizes a captured terminal log against the
+ *   ELF (or the objdump listing in bin/) and prints a flat profile per
+ *   function and the samples per task.
+ *
+ * Usage:
+ *
+ *       pc_prof_start(PC_PROF_TICK, 0);           // after OSStart()
+ *       ...
+ *       pc_prof_dump();
+ */
+#ifndef __PC_PROF_H__
+#define __PC_PROF_H__
+
+#include "includes.h"
+#include "system.h"
+#include "alt_types.h"
+
+/* Histogram size in buckets */
+#ifndef PC_PROF_BUCKETS
+#define PC_PROF_BUCKETS     8192
+#endif
+
+/* Smallest bucket, in address bits (16 bytes = 4 instructions) */
+#ifndef PC_PROF_MIN_SHIFT
+#define PC_PROF_MIN_SHIFT   4
+#endif
+
+#if !defined(PC_PROF_TIMER_BASE) && defined(TIMER_1_BASE)
+#define PC_PROF_TIMER_BASE  TIMER_1_BASE
+#define PC_PROF_TIMER_IRQ   TIMER_1_IRQ
+#define PC_PROF_TIMER_IC_ID TIMER_1_IRQ_INTERRUPT_CONTROLLER_ID
+#define PC_PROF_TIMER_FREQ  TIMER_1_FREQ
+#endif
+
+enum pc_prof_source {
+    PC_PROF_TICK,
+    PC_PROF_TIMER
+};
+
+/* pc_prof_filter() argument for all tasks */
+#define PC_PROF_ALL_TASKS   0xFF
+
+void    pc_prof_start(INT8U source, alt_u32 rate);
+void    pc_prof_stop(void);
+void    pc_prof_reset(void);
+void    pc_prof_filter(INT8U prio);
+void    pc_prof_tick(void);
+void    pc_prof_sample(alt_u32 pc);
+alt_u32 pc_prof_samples(void);
+void    pc_prof_dump(void);
+
+#endif /* __PC_PROF_H__ */
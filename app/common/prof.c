@@ -0,0 +1,379 @@
+/* Named profiling regions for the IL 2206 lab applications
+ *
+ * See prof.h for the description of the API.
+ *
+ * The timestamp of a region is the low word of the global time counter of the
+ * performance counter (section 0), which counts CPU cycles as long as the
+ * measurement is running. prof_init() starts it and keeps it running; only
+ * prof_report() stops it for the time it takes to print.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "prof.h"
+
+#ifdef PROF_HOST
+#include <time.h>
+#define PROF_UNIT                   "ns"
+#else
+#include "altera_avalon_performance_counter.h"
+#define PROF_UNIT                   "cycles"
+#endif
+
+/*
+ * With the kernel, on the Nios II or the host port (preempted from SIGALRM),
+ * the regions are updated with interrupts disabled and nested per task. A
+ * Linux build without the kernel has a single thread and no interrupts.
+ */
+#if !defined(PROF_HOST) || defined(OS_CPU_HOST)
+#include "includes.h"
+#define PROF_KERNEL                 1
+#define PROF_TASKS                  (OS_LOWEST_PRIO + 1)
+#define PROF_TASK()                 OSPrioCur
+#define PROF_ENTER_CRITICAL()       OS_ENTER_CRITICAL()
+#define PROF_EXIT_CRITICAL()        OS_EXIT_CRITICAL()
+#else
+#define PROF_TASKS                  1
+#define PROF_TASK()                 0
+#define PROF_ENTER_CRITICAL()
+#define PROF_EXIT_CRITICAL()
+#endif
+
+/* Number of empty begin/end pairs used to measure the overhead */
+#define PROF_CAL_ROUNDS 32
+
+static prof_region_t regions[PROF_MAX_REGIONS + 1];    /* [0] is unused */
+static int           nregions;
+
+/* Open regions of every task, innermost on top */
+static int           open_stack[PROF_TASKS][PROF_MAX_DEPTH];
+static int           open_top[PROF_TASKS];
+
+static prof_cycles_t overhead_inner;    /* seen by the region itself */
+static prof_cycles_t overhead_outer;    /* seen by an enclosing region */
+
+/*
+ * Timestamp source
+ */
+prof_cycles_t prof_now(void)
+{
+#ifdef PROF_HOST
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (prof_cycles_t) ((uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec);
+#else
+    return IORD(PERFORMANCE_COUNTER_BASE, 0);
+#endif
+}
+
+static void prof_clear(void)
+{
+    int i;
+
+    for (i = 0; i <= PROF_MAX_REGIONS; i++)
+    {
+        const char *name = regions[i].name;
+
+        memset(&regions[i], 0, sizeof(regions[i]));
+        regions[i].name = name;
+        regions[i].min = (prof_cycles_t) ~0u;
+    }
+    memset(open_top, 0, sizeof(open_top));
+
+#ifndef PROF_HOST
+    PERF_RESET(PERFORMANCE_COUNTER_BASE);
+    PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
+#endif
+}
+
+static unsigned int prof_hist_bucket(prof_cycles_t t)
+{
+    unsigned int b = 0;
+
+    while ((t >>= 1) != 0 && b < PROF_HIST_BUCKETS - 1)
+    {
+        b++;
+    }
+    return b;
+}
+
+/*
+ * Measures what an empty PROF_BEGIN/PROF_END pair costs, both as seen by the
+ * region itself (inner) and by a region that encloses it (outer). Section 1 is
+ * borrowed for this, the counters are reset afterwards.
+ */
+static void prof_calibrate(void)
+{
+    int i;
+    prof_cycles_t t0, t1, stamp = (prof_cycles_t) ~0u, outer = (prof_cycles_t) ~0u;
+
+    overhead_inner = 0;
+    overhead_outer = 0;
+
+    for (i = 0; i < PROF_CAL_ROUNDS; i++)
+    {
+        t0 = prof_now();
+        t1 = prof_now();
+        if (t1 - t0 < stamp)
+        {
+            stamp = t1 - t0;
+        }
+    }
+
+    for (i = 0; i < PROF_CAL_ROUNDS; i++)
+    {
+        t0 = prof_now();
+        prof_begin(1);
+        prof_end(1);
+        t1 = prof_now();
+        if (t1 - t0 < outer)
+        {
+            outer = t1 - t0;
+        }
+    }
+
+    overhead_inner = regions[1].min;
+    overhead_outer = (outer > stamp) ? outer - stamp : 0;
+}
+
+void prof_init(void)
+{
+    memset(regions, 0, sizeof(regions));
+    nregions = 0;
+
+    prof_clear();
+    prof_calibrate();
+    prof_clear();
+}
+
+/*
+ * Returns the region id (which is also its performance counter section),
+ * or -1 when all sections are taken.
+ */
+int prof_register(const char *name)
+{
+    if (nregions >= PROF_MAX_REGIONS)
+    {
+        return -1;
+    }
+    nregions++;
+    regions[nregions].name = name;
+    return nregions;
+}
+
+void prof_begin(int region)
+{
+#ifdef PROF_KERNEL
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    prof_region_t *p;
+    int task;
+
+    if (region < 1 || region > PROF_MAX_REGIONS)
+    {
+        return;
+    }
+    p = &regions[region];
+
+    PROF_ENTER_CRITICAL();
+    if (p->depth++ == 0)
+    {
+        task = PROF_TASK();
+        p->owner = task;
+        if (open_top[task] < PROF_MAX_DEPTH)
+        {
+            open_stack[task][open_top[task]++] = region;
+        }
+        p->child = 0;
+        p->nchild = 0;
+#ifndef PROF_HOST
+        PERF_BEGIN(PERFORMANCE_COUNTER_BASE, region);
+#endif
+        p->start = prof_now();
+    }
+    PROF_EXIT_CRITICAL();
+}
+
+void prof_end(int region)
+{
+#ifdef PROF_KERNEL
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    prof_cycles_t now = prof_now();
+    prof_cycles_t t, cost, self;
+    prof_region_t *p;
+    int *stack, *top;
+    int i;
+
+    if (region < 1 || region > PROF_MAX_REGIONS)
+    {
+        return;
+    }
+    p = &regions[region];
+
+    PROF_ENTER_CRITICAL();
+    if (p->depth == 0 || --p->depth != 0)
+    {
+        PROF_EXIT_CRITICAL();
+        return;
+    }
+#ifndef PROF_HOST
+    PERF_END(PERFORMANCE_COUNTER_BASE, region);
+#endif
+
+    // Remove the instrumentation cost of this pair and of the nested pairs
+    t = now - p->start;
+    cost = overhead_inner + p->nchild * overhead_outer;
+    t = (t > cost) ? t - cost : 0;
+    self = (t > p->child) ? t - p->child : 0;
+
+    p->last = t;
+    p->samples++;
+    p->total += t;
+    p->self += self;
+    if (t < p->min)
+    {
+        p->min = t;
+    }
+    if (t > p->max)
+    {
+        p->max = t;
+    }
+    p->hist[prof_hist_bucket(t)]++;
+
+    // Close the region in the task that opened it; it is usually on top,
+    // but not when the region is ended by another task
+    stack = open_stack[p->owner];
+    top = &open_top[p->owner];
+    for (i = *top - 1; i >= 0; i--)
+    {
+        if (stack[i] == region)
+        {
+            for (; i < *top - 1; i++)
+            {
+                stack[i] = stack[i + 1];
+            }
+            (*top)--;
+            break;
+        }
+    }
+
+    // Account this sample as child time of the region that encloses it in
+    // that task
+    if (*top > 0)
+    {
+        prof_region_t *parent = &regions[stack[*top - 1]];
+
+        parent->child += t;
+        parent->nchild++;
+    }
+    PROF_EXIT_CRITICAL();
+}
+
+unsigned int prof_samples(int region)
+{
+    if (region < 1 || region > PROF_MAX_REGIONS)
+    {
+        return 0;
+    }
+    return regions[region].samples;
+}
+
+prof_cycles_t prof_last(int region)
+{
+    if (region < 1 || region > PROF_MAX_REGIONS)
+    {
+        return 0;
+    }
+    return regions[region].last;
+}
+
+prof_cycles_t prof_overhead(void)
+{
+    return overhead_inner;
+}
+
+/*
+ * Clears all statistics. Must not be called while a region is open.
+ */
+void prof_reset(void)
+{
+    prof_clear();
+}
+
+void prof_report(void)
+{
+    int i, b;
+
+#ifndef PROF_HOST
+    const char *names[8];
+
+    // perf_print_formatted_report() takes the names as varargs, pass 7
+    for (i = 1; i < 8; i++)
+    {
+        names[i] = (i <= nregions) ? regions[i].name : "-";
+    }
+    perf_print_formatted_report((void *) PERFORMANCE_COUNTER_BASE,
+                                alt_get_cpu_freq(),
+                                nregions,
+                                names[1], names[2], names[3], names[4],
+                                names[5], names[6], names[7]);
+#endif
+
+    printf("--Profiling Regions-- (%s, overhead %u/%u subtracted)\n",
+           PROF_UNIT, (unsigned int) overhead_inner, (unsigned int) overhead_outer);
+    printf("+---------------+-----------+-----------+-----------+-----------+-----------+\n");
+    printf("| Region        |  Samples  |    Min    |    Avg    |    Max    |  Self Avg |\n");
+    printf("+---------------+-----------+-----------+-----------+-----------+-----------+\n");
+    for (i = 1; i <= nregions; i++)
+    {
+        prof_region_t *p = &regions[i];
+
+        if (p->samples == 0)
+        {
+            printf("|%-15s|%11u|%11s|%11s|%11s|%11s|\n", p->name, 0, "-", "-", "-", "-");
+            continue;
+        }
+        printf("|%-15s|%11u|%11u|%11u|%11u|%11u|\n",
+               p->name,
+               p->samples,
+               (unsigned int) p->min,
+               (unsigned int) (p->total / p->samples),
+               (unsigned int) p->max,
+               (unsigned int) (p->self / p->samples));
+    }
+    printf("+---------------+-----------+-----------+-----------+-----------+-----------+\n");
+
+    // Histogram, one line per region, only the populated buckets
+    for (i = 1; i <= nregions; i++)
+    {
+        prof_region_t *p = &regions[i];
+
+        if (p->samples == 0)
+        {
+            continue;
+        }
+        printf("%s:", p->name);
+        for (b = 0; b < PROF_HIST_BUCKETS; b++)
+        {
+            if (p->hist[b] == 0)
+            {
+                continue;
+            }
+            if (b == PROF_HIST_BUCKETS - 1)
+            {
+                printf(" [%u..) %u", 1u << b, p->hist[b]);
+            }
+            else
+            {
+                printf(" [%u..%u) %u", b ? 1u << b : 0u, 1u << (b + 1), p->hist[b]);
+            }
+        }
+        printf("\n");
+    }
+
+#ifndef PROF_HOST
+    // The report stops the counter, keep on measuring
+    PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
+#endif
+}
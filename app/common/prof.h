@@ -0,0 +1,111 @@
+/* Named profiling regions for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   A thin layer on top of the Altera performance counter. Every region that
+ *   is registered with prof_register() owns one section of the counter, so the
+ *   totals and occurrence counts still show up in perf_print_formatted_report().
+ *   On top of that each region keeps its own per-sample statistics:
+ *   min / avg / max, the time spent in nested child regions and a log2
+ *   histogram of the sample lengths.
+ *
+ *   The cost of one empty PROF_BEGIN/PROF_END pair is measured once in
+ *   prof_init() and subtracted from every sample, so short regions (like a
+ *   context switch) are not dominated by the instrumentation itself.
+ *
+ *   A region may be started in one task and ended in another one, which is
+ *   exactly what is needed to time a context switch.
+ *
+ *   The open regions are kept per task (OSPrioCur): a region is the child
+ *   of the region that was open in the same task when it began, so a task
+ *   that preempts another one does not add its time to the regions of the
+ *   preempted task. An interrupt handler nests in the task it interrupts.
+ *   Regions are updated with interrupts disabled (OS_ENTER_CRITICAL()).
+ *
+ *   When built for the host (anything that is not __nios2__) the cycle counter
+ *   is replaced by clock_gettime(CLOCK_MONOTONIC) and the values are reported
+ *   in nanoseconds, so the same annotations work in a Linux build. Such a
+ *   build has no kernel and must use the regions from a single thread. The
+ *   POSIX port of the kernel (bsp/host) models the performance counter,
+ *   there the values stay in cycles.
+ *
+ * Usage:
+ *
+ *       int cs = prof_register("ctx switch");
+ *       ...
+ *       PROF_BEGIN(cs);
+ *       ...
+ *       PROF_END(cs);
+ *       ...
+ *       prof_report();
+ */
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#if !defined(__nios2__) && !defined(OS_CPU_HOST) && !defined(PROF_HOST)
+#define PROF_HOST 1
+#endif
+
+#ifdef PROF_HOST
+#include <stdint.h>
+typedef uint32_t prof_cycles_t;
+#else
+#include "system.h"
+#include "alt_types.h"
+typedef alt_u32 prof_cycles_t;
+#endif
+
+/* Set to 0 to compile every PROF_BEGIN/PROF_END away */
+#ifndef PROF_EN
+#define PROF_EN 1
+#endif
+
+/* One region per hardware section (section 0 is the global counter) */
+#ifdef PERFORMANCE_COUNTER_HOW_MANY_SECTIONS
+#define PROF_MAX_REGIONS    PERFORMANCE_COUNTER_HOW_MANY_SECTIONS
+#else
+#define PROF_MAX_REGIONS    7
+#endif
+
+/* Deepest nesting of simultaneously open regions */
+#define PROF_MAX_DEPTH      8
+
+/* Bucket i counts samples in [2^i, 2^(i+1)) cycles, bucket 0 also holds 0 */
+#define PROF_HIST_BUCKETS   16
+
+typedef struct {
+    const char    *name;
+    unsigned int   depth;       /* open count, > 1 only if re-entered */
+    prof_cycles_t  start;       /* timestamp of the outermost begin */
+    prof_cycles_t  child;       /* time of nested regions in the open sample */
+    unsigned int   nchild;      /* nested begin/end pairs in the open sample */
+    int            owner;       /* task that began the open sample */
+    prof_cycles_t  last;        /* length of the last sample */
+    unsigned int   samples;
+    prof_cycles_t  min;
+    prof_cycles_t  max;
+    unsigned long long total;
+    unsigned long long self;    /* total without nested regions */
+    unsigned int   hist[PROF_HIST_BUCKETS];
+} prof_region_t;
+
+void          prof_init(void);
+int           prof_register(const char *name);
+void          prof_begin(int region);
+void          prof_end(int region);
+unsigned int  prof_samples(int region);
+prof_cycles_t prof_last(int region);
+prof_cycles_t prof_overhead(void);
+void          prof_reset(void);
+void          prof_report(void);
+prof_cycles_t prof_now(void);
+
+#if PROF_EN
+#define PROF_BEGIN(region)  prof_begin(region)
+#define PROF_END(region)    prof_end(region)
+#else
+#define PROF_BEGIN(region)
+#define PROF_END(region)
+#endif
+
+#endif /* __PROF_H__ */
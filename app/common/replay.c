@@ -0,0 +1,205 @@
+/* Input record and replay for the IL 2206 lab applications
+ *
+ * See replay.h for the description.
+ *
+ * Dump format, one line per record so a terminal log can be converted:
+ *
+ *   REPLAY-BEGIN ticks=<ticks per second> entries=<n> lost=<n>
+ *   RP <tick> <channel> <value hex>
+ *   REPLAY-END
+ */
+#include <stdio.h>
+#include "replay.h"
+
+#define REPLAY_CHANNEL_MASK     ((1 << REPLAY_CHANNEL_BITS) - 1)
+#define REPLAY_TICK_MASK        (0xFFFFFFFF >> REPLAY_CHANNEL_BITS)
+
+#if REPLAY_CHANNELS > (1 << REPLAY_CHANNEL_BITS)
+#error "REPLAY_CHANNEL_BITS too small for the channels"
+#endif
+
+enum replay_mode { REPLAY_OFF, REPLAY_RECORDING, REPLAY_PLAYING };
+
+static const char *channel_name[REPLAY_CHANNELS] = { "keys", "switches", "throttle" };
+
+static replay_entry_t ram_log[REPLAY_SIZE];
+static const replay_entry_t *table = ram_log;
+static int      entries;                        /* in the table */
+static INT32U   lost;                           /* changes not recorded */
+static int      mode;
+
+/* Recording: the last logged value; playing: the one in effect */
+static alt_u32  current[REPLAY_CHANNELS];
+static INT8U    valid[REPLAY_CHANNELS];
+static int      cursor[REPLAY_CHANNELS];        /* playing: next entry */
+
+static INT32U   compared, mismatches;
+static alt_u32  mismatch_tick, mismatch_value, mismatch_logged;
+
+/* Interrupts must be disabled */
+static void replay_log(int chan, alt_u32 value)
+{
+    if (valid[chan] && current[chan] == value)
+    {
+        return;
+    }
+    current[chan] = value;
+    valid[chan] = 1;
+    if (entries == REPLAY_SIZE)
+    {
+        lost++;
+        return;
+    }
+    ram_log[entries].tick_chan = ((OSTime & REPLAY_TICK_MASK) << REPLAY_CHANNEL_BITS) | chan;
+    ram_log[entries].value = value;
+    entries++;
+}
+
+/*
+ * Moves the cursor of 'chan' past the entries up to the current tick,
+ * returns whether a value is in effect. Interrupts must be disabled.
+ */
+static int replay_seek(int chan)
+{
+    alt_u32 now = OSTime & REPLAY_TICK_MASK;
+    const replay_entry_t *e;
+
+    while (cursor[chan] < entries)
+    {
+        e = &table[cursor[chan]];
+        if ((e->tick_chan & REPLAY_CHANNEL_MASK) == (alt_u32) chan)
+        {
+            if ((e->tick_chan >> REPLAY_CHANNEL_BITS) > now)
+            {
+                break;
+            }
+            current[chan] = e->value;
+            valid[chan] = 1;
+        }
+        cursor[chan]++;
+    }
+    return valid[chan];
+}
+
+void replay_record(void)
+{
+    table = ram_log;
+    entries = 0;
+    lost = 0;
+    mode = REPLAY_RECORDING;
+}
+
+void replay_play(const replay_entry_t *logged, int n)
+{
+    table = logged;
+    entries = n;
+    mode = REPLAY_PLAYING;
+}
+
+/*
+ * The word to use for a sample of 'chan': 'sampled' itself, recorded, or
+ * the logged one in its place
+ */
+alt_u32 replay_input(int chan, alt_u32 sampled)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (mode == REPLAY_OFF)
+    {
+        return sampled;
+    }
+    OS_ENTER_CRITICAL();
+    if (mode == REPLAY_RECORDING)
+    {
+        replay_log(chan, sampled);
+    }
+    else if (replay_seek(chan))
+    {
+        sampled = current[chan];
+    }
+    OS_EXIT_CRITICAL();
+    return sampled;
+}
+
+/*
+ * A decision of the application, recorded or compared with the logged one
+ */
+void replay_output(int chan, alt_u32 value)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (mode == REPLAY_OFF)
+    {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    if (mode == REPLAY_RECORDING)
+    {
+        replay_log(chan, value);
+    }
+    else if (replay_seek(chan))
+    {
+        compared++;
+        if (value != current[chan] && mismatches++ == 0)
+        {
+            mismatch_tick = OSTime;
+            mismatch_value = value;
+            mismatch_logged = current[chan];
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * Prints the log. Entries recorded meanwhile are left for the next dump.
+ */
+void replay_dump(void)
+{
+    int n = entries, i;
+
+    printf("REPLAY-BEGIN ticks=%u entries=%d lost=%u\n",
+           (unsigned int) OS_TICKS_PER_SEC, n, (unsigned int) lost);
+    for (i = 0; i < n; i++)
+    {
+        printf("RP %u %s 0x%08x\n", (unsigned int) (table[i].tick_chan >> REPLAY_CHANNEL_BITS),
+               channel_name[table[i].tick_chan & REPLAY_CHANNEL_MASK], (unsigned int) table[i].value);
+    }
+    printf("REPLAY-END\n");
+}
+
+/*
+ * One line of status; a full log is dumped once, the inputs up to then
+ * are all there is
+ */
+void replay_report(void)
+{
+    static int full_dumped;
+
+    if (mode == REPLAY_RECORDING)
+    {
+        printf("Replay: recording, %d of %d entries, %u lost\n",
+               entries, REPLAY_SIZE, (unsigned int) lost);
+        if (entries == REPLAY_SIZE && !full_dumped)
+        {
+            replay_dump();
+            full_dumped = 1;
+        }
+    }
+    else if (mode == REPLAY_PLAYING)
+    {
+        printf("Replay: playing, tick %u of %u, %u decisions, %u mismatches",
+               (unsigned int) OSTime,
+               entries ? (unsigned int) (table[entries - 1].tick_chan >> REPLAY_CHANNEL_BITS) : 0,
+               (unsigned int) compared, (unsigned int) mismatches);
+        if (mismatches)
+        {
+            printf(" (first at tick %u: %u, logged %u)", (unsigned int) mismatch_tick,
+                   (unsigned int) mismatch_value, (unsigned int) mismatch_logged);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,71 @@
+/* Input record and replay for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Overload and control bugs depend on when the keys and switches were
+ *   touched, which a person cannot repeat. The recorder logs every input
+ *   word the application samples (replay_input()) and every decision it
+ *   posts (replay_output()), each with the tick, into a fixed log of
+ *   REPLAY_SIZE entries (8 bytes each) in RAM. A word is only logged when
+ *   it differs from the last one of its channel, so the log holds the input
+ *   signals, not the samples. Recording stops when the log is full.
+ *
+ *   replay_dump() prints the log on the JTAG UART. tools/replay2c.py turns
+ *   a captured terminal log into a C table, which the application passes
+ *   to replay_play(): the inputs then come from the log in place of the PIO
+ *   reads, on the board or on the host (bsp/host), and every decision is
+ *   compared with the logged one. Two builds replaying the same log run
+ *   the same workload; a mismatch of the decisions shows where a change
+ *   altered the behaviour.
+ *
+ * Usage:
+ *
+ *       keys = replay_input(REPLAY_KEYS, ~IORD_ALTERA_AVALON_PIO_DATA(...));
+ *       ...
+ *       replay_output(REPLAY_THROTTLE, throttle);
+ *       ...
+ *       replay_record();                    // before OSStart(), or
+ *       replay_play(log, REPLAY_ENTRIES(log));
+ *       ...
+ *       replay_dump();                      // e.g. on an overload
+ *       replay_report();
+ */
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Entries in the log */
+#ifndef REPLAY_SIZE
+#define REPLAY_SIZE     1024
+#endif
+
+/* Channels, inputs and decisions */
+enum replay_channel {
+    REPLAY_KEYS,
+    REPLAY_SWITCHES,
+    REPLAY_THROTTLE,
+    REPLAY_CHANNELS
+};
+
+#define REPLAY_CHANNEL_BITS     2
+
+typedef struct {
+    alt_u32 tick_chan;  /* tick << REPLAY_CHANNEL_BITS | channel */
+    alt_u32 value;
+} replay_entry_t;
+
+/* An entry of a table made by tools/replay2c.py */
+#define REPLAY_ENTRY(tick, chan, value) \
+    { ((alt_u32) (tick) << REPLAY_CHANNEL_BITS) | (chan), (value) }
+#define REPLAY_ENTRIES(log)     (sizeof(log) / sizeof((log)[0]))
+
+void    replay_record(void);
+void    replay_play(const replay_entry_t *logged, int entries);
+alt_u32 replay_input(int chan, alt_u32 sampled);
+void    replay_output(int chan, alt_u32 value);
+void    replay_dump(void);
+void    replay_report(void);
+
+#endif /* __REPLAY_H__ */
@@ -0,0 +1,285 @@
+/* Stack high-water monitor for the IL 2206 lab applications
+ *
+ * See stack_mon.h for the description.
+ */
+#include <stdio.h>
+#include "stack_mon.h"
+
+#if OS_STK_GROWTH != 1
+#error "stack_mon assumes stacks growing from HIGH to LOW memory"
+#endif
+
+#define STACK_MON_PRIOS (OS_LOWEST_PRIO + 1)
+
+static stack_mon_t mon[STACK_MON_PRIOS];
+static int lazy;
+
+/* Interrupts must be disabled */
+static void stack_mon_attach(stack_mon_t *m, OS_TCB *ptcb)
+{
+    m->bottom = ptcb->OSTCBStkBottom;
+    m->size = ptcb->OSTCBStkSize;
+    m->free = m->size;
+    m->scan = 0;
+    m->passes = 0;
+    m->canary = 0;
+    m->overflow = 0;
+    m->clearing = 0;
+    m->clear = 0;
+}
+
+/*
+ * Stacks of tasks created from now on are cleared by stack_mon_sample()
+ */
+void stack_mon_lazy_clear(int on)
+{
+    lazy = on;
+}
+
+/*
+ * Clears the next chunk below the saved stack pointer, interrupts must be
+ * disabled. Returns 1 when the stack is clear.
+ */
+static int stack_mon_clear(stack_mon_t *m, OS_TCB *ptcb)
+{
+    OS_STK *limit;
+    INT32U end, top;
+
+    if (ptcb == OSTCBCur)
+    {
+        // Our own stack: stay clear of this frame and of OS_StkClr()'s
+        limit = (OS_STK *) __builtin_frame_address(0) - 32;
+    }
+    else
+    {
+        limit = ptcb->OSTCBStkPtr;
+    }
+    top = (limit > m->bottom) ? (INT32U) (limit - m->bottom) : 0;
+    end = m->clear + STACK_MON_CLEAR_WORDS;
+    if (end > top)
+    {
+        end = top;
+    }
+    if (end > m->clear)
+    {
+        OS_StkClr(&m->bottom[m->clear], end - m->clear);
+    }
+    m->clear = end;
+    return end >= top;
+}
+
+static int stack_mon_checked(OS_TCB *ptcb)
+{
+    return ptcb->OSTCBStkBottom != (OS_STK *) 0 && (ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK) != 0;
+}
+
+/*
+ * Called from OSTaskCreateHook(), interrupts are disabled
+ */
+void stack_mon_create(OS_TCB *ptcb)
+{
+    stack_mon_t *m = &mon[ptcb->OSTCBPrio];
+
+    if (!stack_mon_checked(ptcb))
+    {
+        m->bottom = (OS_STK *) 0;
+        return;
+    }
+    stack_mon_attach(m, ptcb);
+    *m->bottom = (OS_STK) STACK_MON_CANARY;
+    m->canary = 1;
+    m->scan = 1;
+    if (lazy)
+    {
+        m->clearing = 1;
+        m->clear = 1;
+    }
+}
+
+/*
+ * Called from OSTaskSwHook() for the task being switched out, interrupts
+ * are disabled
+ */
+void stack_mon_switch(void)
+{
+    stack_mon_t *m = &mon[OSTCBCur->OSTCBPrio];
+
+    if (m->canary && *m->bottom != (OS_STK) STACK_MON_CANARY)
+    {
+        m->overflow = 1;
+        m->free = 0;
+    }
+}
+
+/*
+ * Checks the next STACK_MON_SCAN_WORDS words of every stack
+ */
+void stack_mon_sample(void)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    stack_mon_t *m;
+    OS_TCB *ptcb;
+    INT32U i, end, start;
+    INT8U prio;
+
+    for (prio = 0; prio < STACK_MON_PRIOS; prio++)
+    {
+        m = &mon[prio];
+
+        OS_ENTER_CRITICAL();
+        ptcb = OSTCBPrioTbl[prio];
+        if (ptcb == (OS_TCB *) 0 || ptcb == OS_TCB_RESERVED || !stack_mon_checked(ptcb))
+        {
+            m->bottom = (OS_STK *) 0;
+            OS_EXIT_CRITICAL();
+            continue;
+        }
+        if (m->bottom != ptcb->OSTCBStkBottom)
+        {
+            // Created without the creation hook, no canary
+            stack_mon_attach(m, ptcb);
+        }
+        start = m->canary ? 1 : 0;
+        if (m->clearing)
+        {
+            if (stack_mon_clear(m, ptcb))
+            {
+                // Count from here
+                m->clearing = 0;
+                m->free = m->size;
+                m->scan = start;
+            }
+            OS_EXIT_CRITICAL();
+            continue;
+        }
+        i = m->scan;
+        end = i + STACK_MON_SCAN_WORDS;
+        if (end > m->free)
+        {
+            end = m->free;
+        }
+        OS_EXIT_CRITICAL();
+
+        // Words are only read here, the used part of a stack only grows
+        if (i < end)
+        {
+            i += OS_StkFree(&m->bottom[i], end - i);
+        }
+
+        OS_ENTER_CRITICAL();
+        if (i < end)
+        {
+            // New high-water mark, start the next pass
+            m->free = i;
+            m->scan = start;
+            m->passes++;
+        }
+        else if (end >= m->free)
+        {
+            // Reached the known mark, it is confirmed
+            m->scan = start;
+            m->passes++;
+        }
+        else
+        {
+            m->scan = end;
+        }
+#if OS_TASK_PROFILE_EN > 0
+        ptcb->OSTCBStkUsed = (m->size - m->free) * sizeof(OS_STK);
+#endif
+        OS_EXIT_CRITICAL();
+    }
+}
+
+/*
+ * Copies the state of a task, returns 0 if the task is not monitored
+ */
+int stack_mon_get(INT8U prio, stack_mon_t *p)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (prio >= STACK_MON_PRIOS || mon[prio].bottom == (OS_STK *) 0)
+    {
+        return 0;
+    }
+    OS_ENTER_CRITICAL();
+    *p = mon[prio];
+    OS_EXIT_CRITICAL();
+    return 1;
+}
+
+/*
+ * Recommended stack size in bytes, 0 if not known (yet)
+ */
+INT32U stack_mon_recommended(INT8U prio)
+{
+    stack_mon_t m;
+    INT32U bytes;
+
+    if (!stack_mon_get(prio, &m) || m.overflow || m.passes == 0)
+    {
+        return 0;
+    }
+    bytes = (m.size - m.free + m.canary) * sizeof(OS_STK);
+    bytes = bytes * (100 + STACK_MON_MARGIN) / 100;
+    return (bytes + STACK_MON_ROUND - 1) / STACK_MON_ROUND * STACK_MON_ROUND;
+}
+
+void stack_mon_report(void)
+{
+    stack_mon_t m;
+    INT8U prio;
+    INT8U name[OS_TASK_NAME_SIZE];
+    INT8U err;
+    INT32U size, used, rec;
+    INT32U total_size = 0, total_rec = 0;
+
+    printf("--Stack Usage-- (bytes, recommended = used + %d %%)\n", STACK_MON_MARGIN);
+    printf("+------+----------------------+--------+--------+--------+-------------+\n");
+    printf("| Prio | Task                 |  Size  |  Used  |  Free  | Recommended |\n");
+    printf("+------+----------------------+--------+--------+--------+-------------+\n");
+    for (prio = 0; prio < STACK_MON_PRIOS; prio++)
+    {
+        if (!stack_mon_get(prio, &m))
+        {
+            continue;
+        }
+#if OS_TASK_NAME_SIZE > 1
+        OSTaskNameGet(prio, name, &err);
+        if (err != OS_ERR_NONE || name[0] == '?')
+#endif
+        {
+            sprintf((char *) name, "Task %u", prio);
+        }
+
+        size = m.size * sizeof(OS_STK);
+        used = (m.size - m.free) * sizeof(OS_STK);
+        rec = stack_mon_recommended(prio);
+        total_size += size;
+        total_rec += rec ? rec : size;
+
+        printf("| %4u | %-20.20s | %6u | %6u | %6u | ",
+               prio, (char *) name, (unsigned int) size, (unsigned int) used,
+               (unsigned int) (size - used));
+        if (m.overflow)
+        {
+            printf("%11s |\n", "OVERFLOW");
+        }
+        else if (rec == 0)
+        {
+            printf("%11s |\n", "scanning");
+        }
+        else
+        {
+            printf("%11u |\n", (unsigned int) rec);
+        }
+    }
+    printf("+------+----------------------+--------+--------+--------+-------------+\n");
+    printf("Total %u bytes, recommended %u, reclaimable %u\n",
+           (unsigned int) total_size, (unsigned int) total_rec,
+           (unsigned int) (total_size - total_rec));
+}
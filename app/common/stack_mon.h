@@ -0,0 +1,88 @@
+/* Stack high-water monitor for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   OSTaskStkChk() counts the free words of a stack by scanning it from the
+ *   bottom on every call. This monitor keeps the high-water mark of every
+ *   task incrementally instead: each stack_mon_sample() checks at most
+ *   STACK_MON_SCAN_WORDS words per task, resuming where the previous call
+ *   stopped. Since the used part of a stack only grows, the number of free
+ *   words found so far can only go down and one pass over the free part
+ *   confirms it. The result is also stored in OSTCBStkUsed.
+ *
+ *   When the task creation and switch hooks are connected, the lowest word
+ *   of every stack holds a canary that is checked each time the task is
+ *   switched out, so an overflow is noticed right away and not only by the
+ *   next scan. The canary word is nonzero, so OSTaskStkChk() and the stack
+ *   check of the statistics task (OS_TASK_STAT_STK_CHK_EN) can not be used
+ *   together with it.
+ *
+ *   stack_mon_report() prints the high-water mark of every task and a
+ *   recommended size with STACK_MON_MARGIN percent on top. Interrupts run
+ *   on the stack of the interrupted task, so the marks include them.
+ *
+ *   Stacks must be zero when the task is created: OS_TASK_OPT_STK_CLR or
+ *   (the usual case) a global OS_STK array in .bss.
+ *
+ *   Zeroing the stacks costs boot time, in crt0 or in OSTaskCreateExt().
+ *   After stack_mon_lazy_clear(1) the stacks of tasks created from then on
+ *   may hold anything (e.g. BOOT_NOINIT, see boot_prof.h): the task starts
+ *   right away and stack_mon_sample() clears its stack later, a chunk of
+ *   STACK_MON_CLEAR_WORDS per call, always below the saved stack pointer
+ *   of the task, which is the unused part while it is switched out. The
+ *   high-water mark then counts from the end of the clearing, usage before
+ *   that is not seen.
+ *
+ * Usage:
+ *
+ *   - call stack_mon_create() from App_TaskCreateHook() and
+ *     stack_mon_switch() from App_TaskSwHook() for the canary (optional)
+ *   - call stack_mon_sample() periodically, e.g. from App_TaskStatHook()
+ *   - print with stack_mon_report()
+ */
+#ifndef __STACK_MON_H__
+#define __STACK_MON_H__
+
+#include "includes.h"
+
+/* Words checked per task and call of stack_mon_sample() */
+#ifndef STACK_MON_SCAN_WORDS
+#define STACK_MON_SCAN_WORDS    64
+#endif
+
+/* Head room in percent for the recommended stack size */
+#ifndef STACK_MON_MARGIN
+#define STACK_MON_MARGIN        25
+#endif
+
+/* Words cleared per task and call of stack_mon_sample() with lazy clearing */
+#ifndef STACK_MON_CLEAR_WORDS
+#define STACK_MON_CLEAR_WORDS   256
+#endif
+
+/* Recommended sizes are rounded up to this number of bytes */
+#define STACK_MON_ROUND         64
+
+#define STACK_MON_CANARY        0xC0FFEE55u
+
+typedef struct {
+    OS_STK  *bottom;        /* lowest address of the stack */
+    INT32U   size;          /* in OS_STK words */
+    INT32U   free;          /* untouched words from the bottom, found so far */
+    INT32U   scan;          /* next word to check */
+    INT16U   passes;        /* completed passes over the free part */
+    INT8U    canary;        /* canary is installed */
+    INT8U    overflow;      /* canary was overwritten */
+    INT8U    clearing;      /* lazy clearing not finished */
+    INT32U   clear;         /* next word to clear */
+} stack_mon_t;
+
+void    stack_mon_lazy_clear(int on);
+void    stack_mon_create(OS_TCB *ptcb);
+void    stack_mon_switch(void);
+void    stack_mon_sample(void);
+int     stack_mon_get(INT8U prio, stack_mon_t *mon);
+INT32U  stack_mon_recommended(INT8U prio);
+void    stack_mon_report(void);
+
+#endif /* __STACK_MON_H__ */
@@ -0,0 +1,233 @@
+/* Per-task CPU accounting for the IL 2206 lab applications
+ *
+ * See task_acct.h for the description.
+ *
+ * task_acct_switch() runs with interrupts disabled inside every context
+ * switch, so it only does the minimum: one subtraction and a compare with
+ * the time App_TaskSwHook() has read. Everything else is done once per window by the statistics task.
+ */
+#include <stdio.h>
+#include "task_acct.h"
+#include "timestamp.h"
+#include "sys/alt_timestamp.h"
+#ifdef OS_CPU_HOST
+#include "host.h"
+#endif
+
+#define TASK_ACCT_PRIOS (OS_LOWEST_PRIO + 1)
+
+/* Updated by the switch hook */
+static alt_u32     max_run[TASK_ACCT_PRIOS];
+
+/* Window bookkeeping, owned by the statistics task */
+static alt_u32     last_cycles[TASK_ACCT_PRIOS];
+static INT32U      last_switches[TASK_ACCT_PRIOS];
+static alt_u32     window_start;
+static int         stat_calls;
+
+/* Result of the last closed window */
+static task_acct_t window[TASK_ACCT_PRIOS];
+static alt_u32     window_len;
+static INT32U      window_count;
+
+/*
+ * Whether the cycles are the time the tasks take. In the virtual time of
+ * the host port the idle task takes the rest of every tick at once and the
+ * tasks run at host speed, so their share of the window means nothing.
+ */
+static int task_acct_timed(void)
+{
+#ifdef OS_CPU_HOST
+    return !host_virtual_time();
+#else
+    return 1;
+#endif
+}
+
+int task_acct_init(void)
+{
+    if (timestamp_start() < 0)
+    {
+        printf("task_acct: no timestamp timer, set hal.timestamp_timer\n");
+        return -1;
+    }
+    window_start = timestamp_now();
+    return 0;
+}
+
+/*
+ * Called from OSTaskSwHook() with the timestamp of the switch: OSTCBCur is
+ * switched out, OSTCBHighRdy in. Interrupts are disabled.
+ */
+void task_acct_switch(alt_u32 now)
+{
+    alt_u32 run;
+
+    // The very first switch (OSStartHighRdy) has nothing to account
+    if (OSRunning == OS_TRUE)
+    {
+        run = now - OSTCBCur->OSTCBCyclesStart;
+        OSTCBCur->OSTCBCyclesTot += run;
+        if (run > max_run[OSTCBCur->OSTCBPrio])
+        {
+            max_run[OSTCBCur->OSTCBPrio] = run;
+        }
+    }
+    OSTCBHighRdy->OSTCBCyclesStart = now;
+}
+
+/*
+ * Called from OSTaskStatHook() every 100 ms, closes a window every
+ * TASK_ACCT_WINDOW calls.
+ */
+void task_acct_stat(void)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    alt_u32 now, elapsed, cycles;
+    INT32U switches;
+    OS_TCB *ptcb;
+    INT8U prio;
+
+    if (++stat_calls < TASK_ACCT_WINDOW)
+    {
+        return;
+    }
+    stat_calls = 0;
+
+    OS_ENTER_CRITICAL();
+    now = timestamp_now();
+    elapsed = now - window_start;
+    window_start = now;
+
+    // The statistics task itself is running, close its current run
+    OSTCBCur->OSTCBCyclesTot += now - OSTCBCur->OSTCBCyclesStart;
+    OSTCBCur->OSTCBCyclesStart = now;
+
+    for (prio = 0; prio < TASK_ACCT_PRIOS; prio++)
+    {
+        ptcb = OSTCBPrioTbl[prio];
+        if (ptcb == (OS_TCB *) 0 || ptcb == OS_TCB_RESERVED)
+        {
+            window[prio].util = 0;
+            window[prio].cycles = 0;
+            window[prio].switches = 0;
+            window[prio].max_run = 0;
+            last_cycles[prio] = 0;
+            last_switches[prio] = 0;
+            continue;
+        }
+
+        // Counters restart when a task is deleted and created again
+        cycles = ptcb->OSTCBCyclesTot - last_cycles[prio];
+        switches = ptcb->OSTCBCtxSwCtr - last_switches[prio];
+        if (ptcb->OSTCBCtxSwCtr < last_switches[prio])
+        {
+            cycles = ptcb->OSTCBCyclesTot;
+            switches = ptcb->OSTCBCtxSwCtr;
+        }
+        last_cycles[prio] = ptcb->OSTCBCyclesTot;
+        last_switches[prio] = ptcb->OSTCBCtxSwCtr;
+
+        window[prio].cycles = cycles;
+        window[prio].switches = switches;
+        window[prio].max_run = max_run[prio];
+        window[prio].util = elapsed ? (INT16U) ((alt_u64) cycles * 1000 / elapsed) : 0;
+        max_run[prio] = 0;
+    }
+    window_len = elapsed;
+    window_count++;
+
+    // Replace the idle counter estimate of OS_TaskStat()
+    if (task_acct_timed() && window_count > 1 && elapsed && window[OS_TASK_IDLE_PRIO].util <= 1000)
+    {
+        OSCPUUsage = (INT8U) (100 - window[OS_TASK_IDLE_PRIO].util / 10);
+    }
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * Copies the last window of a task, returns 0 if there is none yet.
+ */
+int task_acct_get(INT8U prio, task_acct_t *acct)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    if (prio >= TASK_ACCT_PRIOS || window_count == 0)
+    {
+        return 0;
+    }
+    OS_ENTER_CRITICAL();
+    *acct = window[prio];
+    OS_EXIT_CRITICAL();
+    return 1;
+}
+
+void task_acct_report(void)
+{
+    task_acct_t acct;
+    alt_u32 per_us = alt_timestamp_freq() / 1000000;
+    alt_u32 len = window_len;
+    INT8U prio;
+    INT8U name[OS_TASK_NAME_SIZE];
+    INT8U err;
+    unsigned int total = 0;
+
+    if (window_count == 0)
+    {
+        printf("task_acct: no window closed yet\n");
+        return;
+    }
+    if (per_us == 0)
+    {
+        per_us = 1;
+    }
+
+    printf("--Task Accounting-- (window %u us, #%u)\n",
+           (unsigned int) (len / per_us), (unsigned int) window_count);
+    printf("+------+----------------------+---------+-----------+-------------+\n");
+    printf("| Prio | Task                 |  Util %% |  Switches | Max run us  |\n");
+    printf("+------+----------------------+---------+-----------+-------------+\n");
+    for (prio = 0; prio < TASK_ACCT_PRIOS; prio++)
+    {
+        if (OSTCBPrioTbl[prio] == (OS_TCB *) 0 || OSTCBPrioTbl[prio] == OS_TCB_RESERVED)
+        {
+            continue;
+        }
+        task_acct_get(prio, &acct);
+#if OS_TASK_NAME_SIZE > 1
+        OSTaskNameGet(prio, name, &err);
+        if (err != OS_ERR_NONE || name[0] == '?')
+#endif
+        {
+            sprintf((char *) name, "Task %u", prio);
+        }
+        if (!task_acct_timed())
+        {
+            printf("| %4u | %-20.20s |   n/a   | %9u | %11u |\n",
+                   prio, (char *) name,
+                   (unsigned int) acct.switches,
+                   (unsigned int) (acct.max_run / per_us));
+            continue;
+        }
+        printf("| %4u | %-20.20s | %3u.%1u   | %9u | %11u |\n",
+               prio, (char *) name,
+               acct.util / 10, acct.util % 10,
+               (unsigned int) acct.switches,
+               (unsigned int) (acct.max_run / per_us));
+        total += acct.util;
+    }
+    printf("+------+----------------------+---------+-----------+-------------+\n");
+    if (!task_acct_timed())
+    {
+        printf("CPU usage: n/a in virtual time\n");
+        return;
+    }
+    printf("CPU usage: %u %% (tasks %u.%u %%, idle excluded)\n",
+           (unsigned int) OSCPUUsage,
+           (total - window[OS_TASK_IDLE_PRIO].util) / 10,
+           (total - window[OS_TASK_IDLE_PRIO].util) % 10);
+}
@@ -0,0 +1,58 @@
+/* Per-task CPU accounting for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   uC/OS-II keeps profiling fields in every TCB when OS_TASK_PROFILE_EN is
+ *   set (OSTCBCyclesTot, OSTCBCyclesStart, OSTCBCtxSwCtr), but only the
+ *   switch counter is maintained by the kernel itself. This module fills in
+ *   the cycle fields from the task switch hook, using the HAL timestamp
+ *   driver on timer_1 (ALT_TIMESTAMP_CLK) as a cycle accurate clock, and
+ *   records the longest uninterrupted run of every task. The timer runs
+ *   continuously (see timestamp.h), the cycle counts wrap every 2^32
+ *   cycles, which does not matter for the differences of a window.
+ *
+ *   Every TASK_ACCT_WINDOW calls of the statistics task hook (i.e. every
+ *   TASK_ACCT_WINDOW * 100 ms) a window is closed: the utilization, number
+ *   of switches and longest run of every task in that window are stored for
+ *   task_acct_report(). OSCPUUsage is overwritten with the measured value
+ *   (100 % minus the share of the idle task), which is far more precise than
+ *   the idle counter estimate of OS_TaskStat().
+ *
+ *   Time spent in interrupt handlers is accounted to the interrupted task.
+ *   In the virtual time of the host port (--virtual) the idle task skips
+ *   to the next tick at once, the utilization is printed as n/a there and
+ *   OSCPUUsage is left to OS_TaskStat().
+ *
+ * Usage:
+ *
+ *   - set hal.timestamp_timer to timer_1 in the BSP
+ *   - call task_acct_switch() with timestamp_now() from App_TaskSwHook()
+ *     and task_acct_stat() from App_TaskStatHook() (see app_hooks.c)
+ *   - call task_acct_init() before OSStart() and OSStatInit() afterwards
+ *   - print with task_acct_report() from any task
+ */
+#ifndef __TASK_ACCT_H__
+#define __TASK_ACCT_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Statistic task periods (100 ms) per accounting window */
+#ifndef TASK_ACCT_WINDOW
+#define TASK_ACCT_WINDOW    10
+#endif
+
+typedef struct {
+    INT32U  switches;   /* times the task was switched in */
+    alt_u32 cycles;     /* cycles the task was running */
+    alt_u32 max_run;    /* longest run without being switched out */
+    INT16U  util;       /* per mille of the window */
+} task_acct_t;
+
+int     task_acct_init(void);
+void    task_acct_switch(alt_u32 now);
+void    task_acct_stat(void);
+int     task_acct_get(INT8U prio, task_acct_t *acct);
+void    task_acct_report(void);
+
+#endif /* __TASK_ACCT_H__ */
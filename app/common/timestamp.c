@@ -0,0 +1,31 @@
+/* Continuous timestamp timer for the IL 2206 lab applications
+ *
+ * See timestamp.h for the description.
+ *
+ * Same register writes as alt_timestamp_start() and crt0.S, with CONT.
+ */
+#include "timestamp.h"
+
+int timestamp_start(void)
+{
+#if (ALT_TIMESTAMP_CLK_BASE != none_BASE)
+    void *base = (void *) ALT_TIMESTAMP_CLK_BASE;
+
+    // Counting continuously from the top already, e.g. since reset
+    if ((IORD_ALTERA_AVALON_TIMER_STATUS(base) & ALTERA_AVALON_TIMER_STATUS_RUN_MSK)
+        && (IORD_ALTERA_AVALON_TIMER_CONTROL(base) & ALTERA_AVALON_TIMER_CONTROL_CONT_MSK)
+        && (IORD_ALTERA_AVALON_TIMER_PERIODL(base) & 0xFFFF) == 0xFFFF
+        && (IORD_ALTERA_AVALON_TIMER_PERIODH(base) & 0xFFFF) == 0xFFFF)
+    {
+        return 0;
+    }
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(base, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_PERIODL(base, 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_PERIODH(base, 0xFFFF);
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(base, ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                           ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+    return 0;
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,56 @@
+/* Continuous timestamp timer for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   alt_timestamp_start() of the HAL driver starts the timestamp timer
+ *   (timer_1, ALT_TIMESTAMP_CLK) with START only: it counts down from
+ *   0xffffffff once and stops after 2^32 cycles, 86 s at 50 MHz, after
+ *   which alt_timestamp() returns the same value forever. timestamp_start()
+ *   sets CONT as well, so the timer reloads and keeps counting; readings
+ *   wrap every 2^32 cycles and the difference of two of them is right for
+ *   any interval shorter than that.
+ *
+ *   A timer that already counts continuously from 0xffffffff is left
+ *   alone, so the time since reset that crt0.S started with ALT_BOOT_PROF
+ *   is kept. All users of the timestamp start it here (task_acct_init(),
+ *   trace_init(), boot_prof_mark()); a later alt_timestamp_start() would
+ *   turn it back into a one-shot timer.
+ *
+ *   timestamp_now() is alt_timestamp() without the call and the checks,
+ *   it also works before alt_sys_init().
+ *
+ * Usage:
+ *
+ *   - set hal.timestamp_timer to timer_1 in the BSP
+ *
+ *       timestamp_start();              // returns -1 without a timer
+ *       ...
+ *       t0 = timestamp_now();
+ *       ...
+ *       cycles = timestamp_now() - t0;  // also across a wrap
+ */
+#ifndef __TIMESTAMP_H__
+#define __TIMESTAMP_H__
+
+#include "system.h"
+#include "alt_types.h"
+#include "altera_avalon_timer.h"
+#include "altera_avalon_timer_regs.h"
+
+int timestamp_start(void);
+
+#if (ALT_TIMESTAMP_CLK_BASE != none_BASE)
+
+/*
+ * Cycles counted since the timer was started, modulo 2^32
+ */
+static inline alt_u32 timestamp_now(void)
+{
+    IOWR_ALTERA_AVALON_TIMER_SNAPL(ALT_TIMESTAMP_CLK_BASE, 0);
+    return 0xFFFFFFFF - (((IORD_ALTERA_AVALON_TIMER_SNAPH(ALT_TIMESTAMP_CLK_BASE) & ALTERA_AVALON_TIMER_SNAPH_MSK) << 16)
+                         | (IORD_ALTERA_AVALON_TIMER_SNAPL(ALT_TIMESTAMP_CLK_BASE) & ALTERA_AVALON_TIMER_SNAPL_MSK));
+}
+
+#endif /* timestamp available */
+
+#endif /* __TIMESTAMP_H__ */
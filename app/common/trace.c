@@ -0,0 +1,197 @@
+/* Kernel event trace for the IL 2206 lab applications
+ *
+ * See trace.h for the description.
+ *
+ * Dump format, one line per record so a terminal log can be converted:
+ *
+ *   TRACE-BEGIN freq=<Hz> events=<n> lost=<n> overhead=<cycles>
+ *   TRACE-TASK <prio> <name>
+ *   TRACE-EVENT <name> <index>
+ *   TE <timestamp hex> <type> <prio> <arg>
+ *   TRACE-END
+ */
+#include <stdio.h>
+#include "trace.h"
+#include "timestamp.h"
+#include "sys/alt_timestamp.h"
+
+#define TRACE_MASK          (TRACE_SIZE - 1)
+#define TRACE_CAL_ROUNDS    16
+
+#if (TRACE_SIZE & TRACE_MASK) != 0
+#error "TRACE_SIZE must be a power of two"
+#endif
+
+static trace_event_t ring[TRACE_SIZE];
+static alt_u32       head;              /* events recorded so far */
+static int           recording;
+static alt_u32       overhead;
+
+/* Interrupts must be disabled */
+static inline void trace_put(alt_u32 ts, INT8U type, INT8U prio, INT16U arg)
+{
+    trace_event_t *e;
+
+    if (recording)
+    {
+        e = &ring[head++ & TRACE_MASK];
+        e->ts = ts;
+        e->type = type;
+        e->prio = prio;
+        e->arg = arg;
+    }
+}
+
+/*
+ * Called from App_TraceEvent() with every kernel event (OS_TRACE_EN)
+ */
+void trace_event(INT8U type, INT16U arg)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    OS_ENTER_CRITICAL();
+    trace_put(timestamp_now(), type, OSIntNesting ? TRACE_PRIO_ISR : OSPrioCur, arg);
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * Called from OSTaskSwHook() with the timestamp of the switch, interrupts
+ * are disabled
+ */
+void trace_switch(alt_u32 now)
+{
+    trace_put(now, OS_TRACE_EV_SWITCH, OSTCBHighRdy->OSTCBPrio, OSTCBCur->OSTCBPrio);
+}
+
+void trace_user(INT8U type, INT16U arg)
+{
+    trace_event(type, arg);
+}
+
+/*
+ * Measures the cost of one kernel event, with everything App_TraceEvent()
+ * calls, with the same timestamp counter
+ */
+static void trace_calibrate(void)
+{
+    int i;
+    alt_u32 t0, t1, stamp = ~0u, event = ~0u;
+
+    for (i = 0; i < TRACE_CAL_ROUNDS; i++)
+    {
+        t0 = timestamp_now();
+        t1 = timestamp_now();
+        if (t1 - t0 < stamp)
+        {
+            stamp = t1 - t0;
+        }
+
+        t0 = timestamp_now();
+        App_TraceEvent(OS_TRACE_EV_USER, 0);
+        t1 = timestamp_now();
+        if (t1 - t0 < event)
+        {
+            event = t1 - t0;
+        }
+    }
+    overhead = (event > stamp) ? event - stamp : 0;
+}
+
+void trace_init(void)
+{
+    if (timestamp_start() < 0)
+    {
+        printf("trace: no timestamp timer, set hal.timestamp_timer\n");
+        return;
+    }
+    recording = 1;
+    trace_calibrate();
+    head = 0;
+}
+
+void trace_start(void)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+
+    OS_ENTER_CRITICAL();
+    head = 0;
+    recording = 1;
+    OS_EXIT_CRITICAL();
+}
+
+void trace_stop(void)
+{
+    recording = 0;
+}
+
+alt_u32 trace_overhead(void)
+{
+    return overhead;
+}
+
+/*
+ * Prints the ring, oldest event first. Recording is paused meanwhile.
+ */
+void trace_dump(void)
+{
+    int was_recording = recording;
+    alt_u32 n, first, i;
+    INT8U prio;
+    INT8U name[OS_TASK_NAME_SIZE];
+    INT8U err;
+
+    recording = 0;
+
+    n = (head < TRACE_SIZE) ? head : TRACE_SIZE;
+    first = head - n;
+
+    printf("TRACE-BEGIN freq=%u events=%u lost=%u overhead=%u\n",
+           (unsigned int) alt_timestamp_freq(), (unsigned int) n,
+           (unsigned int) (head - n), (unsigned int) overhead);
+
+    for (prio = 0; prio <= OS_LOWEST_PRIO; prio++)
+    {
+        if (OSTCBPrioTbl[prio] == (OS_TCB *) 0 || OSTCBPrioTbl[prio] == OS_TCB_RESERVED)
+        {
+            continue;
+        }
+#if OS_TASK_NAME_SIZE > 1
+        OSTaskNameGet(prio, name, &err);
+        if (err == OS_ERR_NONE && name[0] != '?')
+        {
+            printf("TRACE-TASK %u %s\n", prio, (char *) name);
+            continue;
+        }
+#endif
+        printf("TRACE-TASK %u Task %u\n", prio, prio);
+    }
+
+#if OS_EVENT_NAME_SIZE > 1
+    for (i = 0; i < OS_MAX_EVENTS; i++)
+    {
+        if (OSEventTbl[i].OSEventType == OS_EVENT_TYPE_UNUSED)
+        {
+            continue;
+        }
+        OSEventNameGet(&OSEventTbl[i], name, &err);
+        if (err == OS_ERR_NONE && name[0] != '?')
+        {
+            printf("TRACE-EVENT %s %u\n", (char *) name, (unsigned int) i);
+        }
+    }
+#endif
+
+    for (i = first; i != head; i++)
+    {
+        trace_event_t *e = &ring[i & TRACE_MASK];
+
+        printf("TE %08x %u %u %u\n", (unsigned int) e->ts, e->type, e->prio, e->arg);
+    }
+    printf("TRACE-END\n");
+
+    recording = was_recording;
+}
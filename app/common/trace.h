@@ -0,0 +1,60 @@
+/* Kernel event trace for the IL 2206 lab applications
+ *
+ * Description:
+ *
+ *   Records task switches, ISR enter/exit, semaphore and mailbox post/pend
+ *   and software timer expiries into a fixed ring of TRACE_SIZE compact
+ *   events (8 bytes each) in RAM. The kernel reports its events through
+ *   App_TraceEvent() when OS_TRACE_EN is set in os_cfg.h, which calls
+ *   trace_event(); task switches are recorded from App_TaskSwHook() (see
+ *   app_hooks.c).
+ *
+ *   Every event is timestamped with the timer_1 timestamp counter (CPU
+ *   cycles), which runs continuously (timestamp.h) and wraps every 2^32
+ *   cycles. The events keep the low 32 bits; tools/trace2chrome.py adds a
+ *   wrap whenever a timestamp is below the previous one, which is right as
+ *   long as no two events are 86 s apart (the timer task alone runs every
+ *   100 ms). Recording is a fixed sequence without loops; its cost is
+ *   measured in trace_init() and printed with the dump.
+ *
+ *   trace_stop() freezes the ring, e.g. when an overload is detected, and
+ *   trace_dump() prints it on the JTAG UART. tools/trace2chrome.py turns a
+ *   captured terminal log into a Chrome trace (chrome://tracing, Perfetto).
+ *
+ * Usage:
+ *
+ *   - set hal.timestamp_timer to timer_1 and OS_TRACE_EN to 1 in the BSP
+ *   - call trace_init() before OSStart()
+ *   - trace_stop(); trace_dump(); when something interesting happened
+ */
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "includes.h"
+#include "alt_types.h"
+
+/* Number of events in the ring, must be a power of two */
+#ifndef TRACE_SIZE
+#define TRACE_SIZE      1024
+#endif
+
+/* Priority recorded for events raised in interrupt context */
+#define TRACE_PRIO_ISR  0xFF
+
+typedef struct {
+    alt_u32 ts;         /* timer_1 timestamp */
+    INT8U   type;       /* OS_TRACE_EV_xxx */
+    INT8U   prio;       /* running task, or the task switched in */
+    INT16U  arg;        /* object index, or the task switched out */
+} trace_event_t;
+
+void    trace_init(void);
+void    trace_start(void);
+void    trace_stop(void);
+void    trace_switch(alt_u32 now);
+void    trace_event(INT8U type, INT16U arg);
+void    trace_user(INT8U type, INT16U arg);
+alt_u32 trace_overhead(void);
+void    trace_dump(void);
+
+#endif /* __TRACE_H__ */
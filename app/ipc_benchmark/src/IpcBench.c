@@ -0,0 +1,326 @@
+// File: IpcBench.c
+//
+// Kernel IPC latency benchmark.
+//
+// For every uC/OS-II primitive (semaphore, mailbox, queue, event flag,
+// mutex, task suspend/resume) a controller task wakes up the highest priority
+// of N waiting tasks and measures with the performance counter:
+//
+//      latency    := post() called --> first instruction of the woken task
+//      round trip := post() called --> controller gets the reply (Sem_Done)
+//      throughput := round trips per second back to back, the CPU frequency
+//                    over the mean round trip
+//
+// The waiters run either above or below the controller priority, which decides
+// if the post preempts the controller right away or only when it blocks.
+// Every configuration is printed as one line starting with "BENCH " followed
+// by a JSON object, so a captured terminal log can be compared with
+// tools/bench_compare.py.
+//
+// Note: the wait lists of uC/OS-II are priority bitmaps, waking a task from a
+// semaphore, mailbox or queue does not depend on the number of waiters. The
+// event flag group keeps a linked list of waiters and OSFlagPost() walks it,
+// so this is where N makes a difference. A mutex can only hand over to one
+// waiter at a time, it is measured with a single waiter.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "system.h"
+#include "includes.h"
+#include "altera_avalon_performance_counter.h"
+#include "prof.h"
+
+#define DEBUG 0
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#define   MAX_WAITERS          4
+OS_STK    controller_stk[TASK_STACKSIZE];
+OS_STK    waiter_stk[MAX_WAITERS][TASK_STACKSIZE];
+
+/* Definition of Task Priorities */
+#define MUTEX_PIP_PRIORITY       4  // priority inheritance priority
+#define WAITER_HIGH_PRIORITY     6  // first waiter when above the controller
+#define CONTROLLER_PRIORITY     12
+#define WAITER_LOW_PRIORITY     13  // first waiter when below the controller
+
+/* Samples per configuration */
+#define SAMPLES 256
+
+enum order {above, below};
+
+typedef struct {
+    const char *name;
+    int max_waiters;
+    void (*create)(void);
+    void (*destroy)(void);
+    void (*prepare)(void);      // controller, before each sample (optional)
+    void (*post)(void);         // controller, wakes waiter 0
+    void (*wait)(int idx);      // waiter, blocks until woken
+    void (*release)(int idx);   // waiter, after replying (optional)
+} ipc_primitive_t;
+
+OS_EVENT    *Sem_Done;
+OS_EVENT    *Sem_Arm;
+OS_EVENT    *Sem_Bench;
+OS_EVENT    *Mbox_Bench;
+OS_EVENT    *Q_Bench;
+OS_EVENT    *Mutex_Bench;
+OS_FLAG_GRP *Flag_Bench;
+
+#define Q_SIZE 4
+void *q_storage[Q_SIZE];
+
+INT8U waiter_prio[MAX_WAITERS];
+const ipc_primitive_t *current;
+
+volatile prof_cycles_t wake_stamp;
+prof_cycles_t latency[SAMPLES];
+prof_cycles_t round_trip[SAMPLES];
+
+/*
+ * Primitives
+ */
+
+//      |- Semaphore
+void sem_create(void)   { Sem_Bench = OSSemCreate(0); }
+void sem_destroy(void)  { INT8U err; OSSemDel(Sem_Bench, OS_DEL_ALWAYS, &err); }
+void sem_post(void)     { OSSemPost(Sem_Bench); }
+void sem_wait(int idx)  { INT8U err; OSSemPend(Sem_Bench, 0, &err); }
+
+//      |- Mailbox
+void mbox_create(void)  { Mbox_Bench = OSMboxCreate(NULL); }
+void mbox_destroy(void) { INT8U err; OSMboxDel(Mbox_Bench, OS_DEL_ALWAYS, &err); }
+void mbox_post(void)    { OSMboxPost(Mbox_Bench, (void *) 1); }
+void mbox_wait(int idx) { INT8U err; OSMboxPend(Mbox_Bench, 0, &err); }
+
+//      |- Queue
+void q_create(void)     { Q_Bench = OSQCreate(q_storage, Q_SIZE); }
+void q_destroy(void)    { INT8U err; OSQDel(Q_Bench, OS_DEL_ALWAYS, &err); }
+void q_post(void)       { OSQPost(Q_Bench, (void *) 1); }
+void q_wait(int idx)    { INT8U err; OSQPend(Q_Bench, 0, &err); }
+
+//      |- Event flags, one bit per waiter
+void flag_create(void)  { INT8U err; Flag_Bench = OSFlagCreate(0, &err); }
+void flag_destroy(void) { INT8U err; OSFlagDel(Flag_Bench, OS_DEL_ALWAYS, &err); }
+void flag_post(void)    { INT8U err; OSFlagPost(Flag_Bench, 0x0001, OS_FLAG_SET, &err); }
+void flag_wait(int idx)
+{
+    INT8U err;
+    OSFlagPend(Flag_Bench, (OS_FLAGS) (1 << idx), OS_FLAG_WAIT_SET_ALL + OS_FLAG_CONSUME, 0, &err);
+}
+
+//      |- Mutex, the controller owns it and hands it over
+void mutex_create(void)
+{
+    INT8U err;
+    Mutex_Bench = OSMutexCreate(MUTEX_PIP_PRIORITY, &err);
+    Sem_Arm = OSSemCreate(0);
+}
+void mutex_destroy(void)
+{
+    INT8U err;
+    OSMutexDel(Mutex_Bench, OS_DEL_ALWAYS, &err);
+    OSSemDel(Sem_Arm, OS_DEL_ALWAYS, &err);
+}
+void mutex_prepare(void)
+{
+    INT8U err;
+    OSMutexPend(Mutex_Bench, 0, &err);
+    OSSemPost(Sem_Arm);
+}
+void mutex_post(void)   { OSMutexPost(Mutex_Bench); }
+void mutex_wait(int idx)
+{
+    INT8U err;
+    OSSemPend(Sem_Arm, 0, &err);
+    OSMutexPend(Mutex_Bench, 0, &err);
+}
+void mutex_release(int idx) { OSMutexPost(Mutex_Bench); }
+
+//      |- Task suspend / resume
+void none(void)         { }
+void task_post(void)    { OSTaskResume(waiter_prio[0]); }
+void task_wait(int idx) { OSTaskSuspend(OS_PRIO_SELF); }
+
+const ipc_primitive_t primitives[] = {
+    {"OSSem",   MAX_WAITERS, sem_create,   sem_destroy,   NULL,          sem_post,   sem_wait,   NULL},
+    {"OSMbox",  MAX_WAITERS, mbox_create,  mbox_destroy,  NULL,          mbox_post,  mbox_wait,  NULL},
+    {"OSQ",     MAX_WAITERS, q_create,     q_destroy,     NULL,          q_post,     q_wait,     NULL},
+    {"OSFlag",  MAX_WAITERS, flag_create,  flag_destroy,  NULL,          flag_post,  flag_wait,  NULL},
+    {"OSMutex", 1,           mutex_create, mutex_destroy, mutex_prepare, mutex_post, mutex_wait, mutex_release},
+    {"OSTask",  MAX_WAITERS, none,         none,          NULL,          task_post,  task_wait,  NULL},
+};
+
+#define NUM_PRIMITIVES (sizeof(primitives) / sizeof(primitives[0]))
+
+/*
+ * Statistics
+ */
+int cmp_cycles(const void *a, const void *b)
+{
+    prof_cycles_t x = *(const prof_cycles_t *) a;
+    prof_cycles_t y = *(const prof_cycles_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/* samples must be sorted */
+prof_cycles_t percentile(prof_cycles_t *samples, int n, int pct)
+{
+    return samples[(n - 1) * pct / 100];
+}
+
+void report(const ipc_primitive_t *prim, int waiters, enum order order)
+{
+    unsigned long long rt_total = 0;
+    unsigned int ops_per_sec;
+    int i;
+
+    qsort(latency, SAMPLES, sizeof(latency[0]), cmp_cycles);
+    qsort(round_trip, SAMPLES, sizeof(round_trip[0]), cmp_cycles);
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        rt_total += round_trip[i];
+    }
+    ops_per_sec = rt_total ? (unsigned int) ((unsigned long long) alt_get_cpu_freq() * SAMPLES / rt_total) : 0;
+
+    printf("BENCH {\"primitive\":\"%s\",\"waiters\":%d,\"order\":\"%s\",\"samples\":%d,"
+           "\"min\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u,"
+           "\"rt_p50\":%u,\"rt_p99\":%u,\"rt_avg\":%u,\"ops_per_sec\":%u}\n",
+           prim->name, waiters, order == above ? "above" : "below", SAMPLES,
+           (unsigned int) latency[0],
+           (unsigned int) percentile(latency, SAMPLES, 50),
+           (unsigned int) percentile(latency, SAMPLES, 90),
+           (unsigned int) percentile(latency, SAMPLES, 99),
+           (unsigned int) latency[SAMPLES - 1],
+           (unsigned int) percentile(round_trip, SAMPLES, 50),
+           (unsigned int) percentile(round_trip, SAMPLES, 99),
+           (unsigned int) (rt_total / SAMPLES), ops_per_sec);
+}
+
+/*
+ * Tasks
+ */
+
+/* Blocks on the primitive under test and replies when woken */
+void waiter(void* pdata)
+{
+    int idx = (int) pdata;
+
+    while (1)
+    {
+        current->wait(idx);
+        wake_stamp = prof_now();
+
+        (void) OSSemPost(Sem_Done);
+        if (current->release)
+        {
+            current->release(idx);
+        }
+    }
+}
+
+void run(const ipc_primitive_t *prim, int waiters, enum order order)
+{
+    INT8U err;
+    int i;
+    prof_cycles_t t_post, t_back;
+
+    current = prim;
+    prim->create();
+
+    for (i = 0; i < waiters; i++)
+    {
+        waiter_prio[i] = (order == above ? WAITER_HIGH_PRIORITY : WAITER_LOW_PRIORITY) + i;
+        OSTaskCreateExt(
+            waiter,                               // Pointer to task code
+            (void *) i,                           // Index of the waiter
+            &waiter_stk[i][TASK_STACKSIZE-1],     // Pointer to top of task stack
+            waiter_prio[i],                       // Desired Task priority
+            waiter_prio[i],                       // Task ID
+            &waiter_stk[i][0],                    // Pointer to bottom of task stack
+            TASK_STACKSIZE,                       // Stacksize
+            NULL,                                 // Pointer to user supplied memory (not needed)
+            OS_TASK_OPT_STK_CHK                   // Stack Checking enabled
+        );
+    }
+
+    for (i = 0; i < SAMPLES; i++)
+    {
+        if (prim->prepare)
+        {
+            prim->prepare();
+        }
+
+        // Let the waiters (in particular the ones below us) block again
+        OSTimeDly(1);
+
+        t_post = prof_now();
+        prim->post();
+        OSSemPend(Sem_Done, 0, &err);
+        t_back = prof_now();
+
+        latency[i] = wake_stamp - t_post;
+        round_trip[i] = t_back - t_post;
+    }
+
+    OSTimeDly(1);
+    for (i = 0; i < waiters; i++)
+    {
+        OSTaskDel(waiter_prio[i]);
+    }
+    prim->destroy();
+
+    report(prim, waiters, order);
+}
+
+void controller(void* pdata)
+{
+    unsigned int p;
+    int waiters;
+
+    printf("BENCH {\"config\":{\"os_version\":%d,\"cpu_freq\":%u,\"ticks_per_sec\":%d,"
+           "\"overhead\":%u}}\n",
+           OSVersion(), (unsigned int) alt_get_cpu_freq(), (int) OS_TICKS_PER_SEC,
+           (unsigned int) prof_overhead());
+
+    for (p = 0; p < NUM_PRIMITIVES; p++)
+    {
+        for (waiters = 1; waiters <= primitives[p].max_waiters; waiters *= 2)
+        {
+            run(&primitives[p], waiters, above);
+            run(&primitives[p], waiters, below);
+        }
+    }
+
+    printf("BENCH {\"done\":true}\n");
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The main function creates the controller task and starts multi-tasking */
+int main(void)
+{
+    printf("IPC Latency Benchmark\n");
+
+    prof_init();
+    Sem_Done = OSSemCreate(0);
+
+    OSTaskCreateExt(
+        controller,                         // Pointer to task code
+        NULL,                               // Pointer to argument passed to task
+        &controller_stk[TASK_STACKSIZE-1],  // Pointer to top of task stack
+        CONTROLLER_PRIORITY,                // Desired Task priority
+        CONTROLLER_PRIORITY,                // Task ID
+        &controller_stk[0],                 // Pointer to bottom of task stack
+        TASK_STACKSIZE,                     // Stacksize
+        NULL,                               // Pointer to user supplied memory (not needed)
+        OS_TASK_OPT_STK_CHK |               // Stack Checking enabled
+        OS_TASK_OPT_STK_CLR                 // Stack Cleared
+    );
+
+    OSStart();
+    return 0;
+}
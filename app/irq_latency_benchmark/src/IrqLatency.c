@@ -0,0 +1,347 @@
+// File: IrqLatency.c
+//
+// Interrupt-to-task latency of the periodic release chain of the cruise
+// control application:
+//
+//      timer_0 IRQ --> alt_irq_handler --> alt_tick --> alarm_handler
+//                  --> OSTmrSignal --> OSTmr_Task --> timer callback
+//                  --> OSSemPost --> VehicleTask
+//
+// The task set, priorities and periods are the ones of cruise.c. Every stage
+// is timestamped with the global time counter of the performance counter. The
+// moment the timer_0 IRQ was raised is not visible to software; it is derived
+// in alarm_handler from the timer_0 snapshot, since the counter reloads with
+// TIMER_0_LOAD_VALUE at the timeout and counts down with the CPU clock.
+//
+// The ExtraLoadTask busy load is stepped through LOAD_LEVELS. For every level
+// the per-stage latency distribution is printed as "BENCH " JSON lines, so
+// runs can be compared with tools/bench_compare.py.
+//
+// The load runs below VehicleTask like in cruise.c, where as a task it cannot
+// delay the chain. It is an interrupt level load instead: it keeps interrupts
+// disabled in chunks of LOAD_MASK_US, like a kernel or driver critical
+// section, so a timer_0 IRQ that comes while it runs waits for the rest of
+// the chunk (irq->alarm_handler) and the chain behind it starts later.
+//
+// Note: the uC/OS-II tick hook also calls OSTmrSignal() (OS_TMR_CFG_TICKS_PER_SEC),
+// so OSTmr_Task is signalled from two places. It takes the signals in order
+// and counts OSTmrTime up by one for each, so alarm_handler knows the timer
+// time its signal is handled at. Releases at any other timer time were not
+// caused by the signal of alarm_handler, are not part of the chain and are
+// skipped.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "system.h"
+#include "includes.h"
+#include "altera_avalon_timer_regs.h"
+#include "altera_avalon_performance_counter.h"
+#include "sys/alt_alarm.h"
+#include "prof.h"
+
+#define DEBUG 0
+
+#define HW_TIMER_PERIOD 100 /* 100ms */
+
+/* Definition of Task Stacks */
+#define TASK_STACKSIZE 2048
+OS_STK StartTask_Stack[TASK_STACKSIZE];
+OS_STK VehicleTask_Stack[TASK_STACKSIZE];
+OS_STK ExtraLoadTask_Stack[TASK_STACKSIZE];
+
+/* Definition of Task Priorities, same as cruise.c */
+#define STARTTASK_PRIO                  5
+#define VEHICLETASK_PRIO               10
+#define EXTRALOADTASK_PRIO             13
+
+/* Definition of Task Periods, same as cruise.c */
+#define VEHICLE_PERIOD  300
+#define HYPER_PERIOD    300
+
+/* Samples per load level */
+#define SAMPLES 64
+
+/* Longest time the load keeps interrupts disabled */
+#define LOAD_MASK_US    50
+
+const int load_levels[] = {0, 20, 40, 60, 80, 90};
+#define LOAD_LEVELS (sizeof(load_levels) / sizeof(load_levels[0]))
+
+/* Stages of the release chain */
+enum stage {
+    STAGE_IRQ,          // timer_0 timeout, derived from the snapshot
+    STAGE_ALARM,        // alarm_handler() entered
+    STAGE_SIGNAL,       // OSTmrSignal() returned
+    STAGE_CALLBACK,     // timer callback entered in OSTmr_Task
+    STAGE_POST,         // OSSemPost() called
+    STAGE_TASK,         // VehicleTask returned from OSSemPend()
+    STAGES
+};
+
+const char *stage_names[STAGES] = {
+    "irq->alarm_handler",       // alt_irq_handler + alt_tick
+    "alarm_handler->signaled",  // OSTmrSignal
+    "signaled->callback",       // ISR exit, switch to OSTmr_Task, OSTmr_Task
+    "callback->post",
+    "post->task",               // OSSemPost + switch to VehicleTask
+    "irq->task",                // the whole chain
+};
+
+OS_EVENT *Sem_Vehicle;
+OS_EVENT *Sem_ExtraLoad;
+OS_TMR   *Timer_Vehicle;
+OS_TMR   *Timer_ExtraLoad;
+
+int delay; // Delay of HW-timer
+
+volatile prof_cycles_t stamp[STAGES];
+volatile INT32U alarm_tmr_time;     // OSTmrTime the last alarm_handler signal is handled at, 0 unknown
+volatile int release_valid;
+
+volatile int load_level;
+int skipped;
+
+prof_cycles_t samples[STAGES][SAMPLES];
+
+/*
+ * Statistics
+ */
+int cmp_cycles(const void *a, const void *b)
+{
+    prof_cycles_t x = *(const prof_cycles_t *) a;
+    prof_cycles_t y = *(const prof_cycles_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+void report(int load)
+{
+    int s;
+
+    for (s = 0; s < STAGES; s++)
+    {
+        prof_cycles_t *v = samples[s];
+
+        qsort(v, SAMPLES, sizeof(v[0]), cmp_cycles);
+        printf("BENCH {\"bench\":\"irq_latency\",\"load\":%d,\"stage\":\"%s\",\"samples\":%d,"
+               "\"min\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}\n",
+               load, stage_names[s], SAMPLES,
+               (unsigned int) v[0],
+               (unsigned int) v[(SAMPLES - 1) * 50 / 100],
+               (unsigned int) v[(SAMPLES - 1) * 90 / 100],
+               (unsigned int) v[(SAMPLES - 1) * 99 / 100],
+               (unsigned int) v[SAMPLES - 1]);
+    }
+    printf("BENCH {\"bench\":\"irq_latency\",\"load\":%d,\"skipped\":%d}\n", load, skipped);
+}
+
+/*
+ * ISR for HW Timer
+ */
+alt_u32 alarm_handler(void* context)
+{
+    prof_cycles_t now = prof_now();
+    alt_u32 snap;
+    int waiting;
+
+    // Cycles since the timeout = how far the counter has counted down
+    IOWR_ALTERA_AVALON_TIMER_SNAPL(TIMER_0_BASE, 0);
+    snap = IORD_ALTERA_AVALON_TIMER_SNAPL(TIMER_0_BASE) & ALTERA_AVALON_TIMER_SNAPL_MSK;
+    snap |= (IORD_ALTERA_AVALON_TIMER_SNAPH(TIMER_0_BASE) & ALTERA_AVALON_TIMER_SNAPH_MSK) << 16;
+
+    stamp[STAGE_IRQ] = now - (TIMER_0_LOAD_VALUE - snap);
+    stamp[STAGE_ALARM] = now;
+
+    waiting = (OSTmrSemSignal->OSEventGrp != 0);
+    OSTmrSignal(); /* Signals a 'tick' to the SW timers */
+
+    stamp[STAGE_SIGNAL] = prof_now();
+
+    // OSTmr_Task counts OSTmrTime up once per signal, in order
+    if (waiting)
+    {
+        // This signal went straight to it
+        alarm_tmr_time = OSTmrTime + 1;
+    }
+    else if (OSTCBCur->OSTCBPrio == OS_TASK_TMR_PRIO)
+    {
+        // Interrupted, it may have taken a signal without counting it yet
+        alarm_tmr_time = 0;
+    }
+    else
+    {
+        // After the signals still counted in its semaphore, this one included
+        alarm_tmr_time = OSTmrTime + OSTmrSemSignal->OSEventCnt;
+    }
+    return delay;
+}
+
+/*
+ * Timer callbacks, run by OSTmr_Task
+ */
+void Timer_Vehicle_CallbackSemPost()
+{
+    stamp[STAGE_CALLBACK] = prof_now();
+
+    // Only releases caused by the alarm_handler signal belong to the chain,
+    // the stamps are of the last alarm
+    release_valid = (OSTmrTime == alarm_tmr_time);
+
+    stamp[STAGE_POST] = prof_now();
+    (void) OSSemPost(Sem_Vehicle);
+}
+
+void Timer_ExtraLoad_CallbackSemPost()
+{
+    (void) OSSemPost(Sem_ExtraLoad);
+}
+
+/*
+ * Tasks
+ */
+
+/* Stands in for the VehicleTask, collects the chain and steps the load */
+void VehicleTask(void* pdata)
+{
+    INT8U err;
+    int n = 0;
+
+    while (1)
+    {
+        OSSemPend(Sem_Vehicle, 0, &err);
+        stamp[STAGE_TASK] = prof_now();
+
+        if (!release_valid)
+        {
+            skipped++;
+            continue;
+        }
+
+        samples[0][n] = stamp[STAGE_ALARM]    - stamp[STAGE_IRQ];
+        samples[1][n] = stamp[STAGE_SIGNAL]   - stamp[STAGE_ALARM];
+        samples[2][n] = stamp[STAGE_CALLBACK] - stamp[STAGE_SIGNAL];
+        samples[3][n] = stamp[STAGE_POST]     - stamp[STAGE_CALLBACK];
+        samples[4][n] = stamp[STAGE_TASK]     - stamp[STAGE_POST];
+        samples[5][n] = stamp[STAGE_TASK]     - stamp[STAGE_IRQ];
+
+        if (++n == SAMPLES)
+        {
+            report(load_levels[load_level]);
+            n = 0;
+            skipped = 0;
+            if (++load_level == LOAD_LEVELS)
+            {
+                printf("BENCH {\"done\":true}\n");
+                OSTaskDel(OS_PRIO_SELF);
+            }
+        }
+    }
+}
+
+/* Same share of the hyper period as the ExtraLoadTask of cruise.c, with
+ * interrupts disabled for up to LOAD_MASK_US at a time */
+void ExtraLoadTask(void* pdata)
+{
+#if OS_CRITICAL_METHOD == 3
+    OS_CPU_SR cpu_sr = 0;
+#endif
+    INT8U err;
+    int overload_percentage;
+    prof_cycles_t busy, mask, left, t0;
+
+    mask = alt_get_cpu_freq() / 1000000 * LOAD_MASK_US;
+    while (1)
+    {
+        OSSemPend(Sem_ExtraLoad, 0, &err);
+
+        overload_percentage = load_levels[load_level % LOAD_LEVELS];
+        busy = alt_get_cpu_freq() / 1000 * HYPER_PERIOD / 100 * overload_percentage;
+        left = prof_now();
+
+        // dummy overloading waiting time, in critical sections
+        while (prof_now() - left < busy)
+        {
+            OS_ENTER_CRITICAL();
+            t0 = prof_now();
+            while (prof_now() - t0 < mask);
+            OS_EXIT_CRITICAL();
+        }
+    }
+}
+
+void StartTask(void* pdata)
+{
+    INT8U err;
+    void* context = NULL;
+
+    static alt_alarm alarm;     /* Is needed for timer ISR function */
+
+    /* Base resolution for SW timer : HW_TIMER_PERIOD ms */
+    delay = alt_ticks_per_second() * HW_TIMER_PERIOD / 1000;
+
+    if (alt_alarm_start(&alarm, delay, alarm_handler, context) < 0)
+    {
+        printf("No system clock available!\n");
+    }
+
+    Sem_Vehicle = OSSemCreate(0);
+    Sem_ExtraLoad = OSSemCreate(0);
+
+    Timer_Vehicle = OSTmrCreate(0, VEHICLE_PERIOD / HW_TIMER_PERIOD, OS_TMR_OPT_PERIODIC,
+                                Timer_Vehicle_CallbackSemPost, NULL, NULL, &err);
+    Timer_ExtraLoad = OSTmrCreate(0, HYPER_PERIOD / HW_TIMER_PERIOD, OS_TMR_OPT_PERIODIC,
+                                  Timer_ExtraLoad_CallbackSemPost, NULL, NULL, &err);
+    OSTmrStart(Timer_Vehicle, &err);
+    OSTmrStart(Timer_ExtraLoad, &err);
+
+    OSTaskCreateExt(
+        VehicleTask,
+        NULL,
+        &VehicleTask_Stack[TASK_STACKSIZE-1],
+        VEHICLETASK_PRIO,
+        VEHICLETASK_PRIO,
+        (void *)&VehicleTask_Stack[0],
+        TASK_STACKSIZE,
+        (void *) 0,
+        OS_TASK_OPT_STK_CHK
+    );
+
+    OSTaskCreateExt(
+        ExtraLoadTask,
+        NULL,
+        &ExtraLoadTask_Stack[TASK_STACKSIZE-1],
+        EXTRALOADTASK_PRIO,
+        EXTRALOADTASK_PRIO,
+        (void *)&ExtraLoadTask_Stack[0],
+        TASK_STACKSIZE,
+        (void *) 0,
+        OS_TASK_OPT_STK_CHK
+    );
+
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+int main(void)
+{
+    printf("Interrupt-to-Task Latency Benchmark\n");
+
+    prof_init();
+    printf("BENCH {\"config\":{\"cpu_freq\":%u,\"timer_load\":%u,\"overhead\":%u}}\n",
+           (unsigned int) alt_get_cpu_freq(), (unsigned int) TIMER_0_LOAD_VALUE,
+           (unsigned int) prof_overhead());
+
+    OSTaskCreateExt(
+        StartTask,
+        NULL,
+        (void *)&StartTask_Stack[TASK_STACKSIZE-1],
+        STARTTASK_PRIO,
+        STARTTASK_PRIO,
+        (void *)&StartTask_Stack[0],
+        TASK_STACKSIZE,
+        (void *) 0,
+        OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR
+    );
+
+    OSStart();
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef __ALT_TYPES_H__
+#define __ALT_TYPES_H__
+
+/*
+ * Types of the HAL for the POSIX host port: the sizes of the Nios II
+ * (alt_u32 is 32 bits also on a 64-bit host). There is no on-chip memory,
+ * ALT_HOT places nothing.
+ */
+#ifndef ALT_ASM_SRC
+typedef signed char  alt_8;
+typedef unsigned char  alt_u8;
+typedef signed short alt_16;
+typedef unsigned short alt_u16;
+typedef signed int alt_32;
+typedef unsigned int alt_u32;
+typedef long long alt_64;
+typedef unsigned long long alt_u64;
+#endif
+
+#define ALT_INLINE        __inline__
+#define ALT_ALWAYS_INLINE __attribute__ ((always_inline))
+#define ALT_WEAK          __attribute__((weak))
+#define ALT_HOT
+
+#endif /* __ALT_TYPES_H__ */
@@ -0,0 +1,56 @@
+/* Services of the POSIX host port (host_hal.c, host_io.c)
+ *
+ * For host only code: drivers of the virtual board, test harnesses. The
+ * applications see the board through io.h and the HAL like on the DE2.
+ */
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include "alt_types.h"
+
+/* CPU cycles at ALT_CPU_FREQ since the start, the time base of the timers;
+ * in virtual time the ticks so far and the CPU time since the last one */
+alt_u64 host_cycles(void);
+
+/* Whether the run is in virtual time (--virtual) */
+int host_virtual_time(void);
+
+/* Waits for the next tick, from the idle task; in virtual time it is taken
+ * at once */
+void host_idle(void);
+
+/* Ends the run, from a task or the tick */
+void host_exit(int status);
+
+/* Sets the input pins of the PIO at 'base', with its edge capture and
+ * interrupt; returns -1 if there is no input PIO there */
+int host_pio_input(alt_u32 base, alt_u32 value);
+
+/* Resets the devices of system.h */
+void host_io_init(void);
+
+/* Starts the counter of the system clock timer, at the cycle of the tick
+ * before the first one */
+void host_io_sysclk_start(alt_u64 cycle);
+
+/* Virtual board (host_board.c): loads the input script, creates the trace
+ * and opens the expected one, each optional; returns -1 on an error */
+int host_board_open(const char *script, const char *trace, const char *expect);
+
+/* Applies the events of the script that are due, from the tick */
+void host_board_tick(void);
+
+/* Traces a change of the output PIO 'name' */
+void host_board_output(const char *name, alt_u32 value);
+
+/* Ends the trace, returns 'status' or 1 if it differs from the expected */
+int host_board_close(int status);
+
+/* Regions (host_region.c, build with REGIONS=1): adds the region
+ * NAME=FUNC[,FUNC...], returns -1 if it is malformed */
+int host_region_add(const char *arg);
+
+/* Prints the regions as BENCH lines, at the end of the run */
+void host_region_report(void);
+
+#endif /* __HOST_H__ */
@@ -0,0 +1,80 @@
+#ifndef __INCLUDES_H__
+#define __INCLUDES_H__
+
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*
+*                        (c) Copyright 1992-1998, Jean J. Labrosse, Plantation, FL
+*                                           All Rights Reserved
+*
+*                                           MASTER INCLUDE FILE
+*
+* Copy of HAL/inc/includes.h for the POSIX host port: the quoted includes below have to find the
+* os_cpu.h of the port, not the one next to the original. Output through stdio is not reentrant on
+* the host, printf() and friends run with the tick blocked (host_hal.c), like the JTAG UART driver
+* serializes them on the board.
+*********************************************************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#include    "os_cpu.h"
+#include    "os_cfg.h"
+#include    "ucos_ii.h"
+
+#include    <stdio.h>
+
+int    host_printf(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
+int    host_puts(const char *s);
+int    host_putchar(int c);
+
+#define printf   host_printf
+#define puts     host_puts
+#define putchar  host_putchar
+
+#ifdef      ONT_GLOBALS
+#define     ONT_EXT
+#else
+#define     ONT_EXT  extern
+#endif
+
+/*
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef struct {
+    char    TaskName[30];
+    INT16U  TaskCtr;
+    INT16U  TaskExecTime;
+    INT32U  TaskTotExecTime;
+} TASK_USER_DATA;
+
+/*
+*********************************************************************************************************
+*                                              VARIABLES
+*********************************************************************************************************
+*/
+
+ONT_EXT  TASK_USER_DATA  TaskUserData[10];
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void   DispTaskStat(INT8U id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __INCLUDES_H__ */
+
@@ -0,0 +1,52 @@
+#ifndef __IO_H__
+#define __IO_H__
+
+/*
+ * Device access of the POSIX host port
+ *
+ * The IORD/IOWR macros of the HAL, on the registers modelled by host_io.c
+ * at the addresses of system.h. The bus is 32 bits wide like on the DE2
+ * system, a base may be an address or a pointer (altera_avalon_timer_ts).
+ */
+
+#include <stdint.h>
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+extern alt_u32 host_io_read (alt_u32 addr, int size);
+extern void    host_io_write (alt_u32 addr, alt_u32 data, int size);
+
+#define __IO_CALC_ADDRESS_DYNAMIC(BASE, OFFSET) \
+  ((alt_u32) (uintptr_t) (BASE) + (OFFSET))
+
+#define IORD_32DIRECT(BASE, OFFSET) \
+  host_io_read (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 4)
+#define IORD_16DIRECT(BASE, OFFSET) \
+  host_io_read (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 2)
+#define IORD_8DIRECT(BASE, OFFSET) \
+  host_io_read (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 1)
+
+#define IOWR_32DIRECT(BASE, OFFSET, DATA) \
+  host_io_write (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), (alt_u32) (DATA), 4)
+#define IOWR_16DIRECT(BASE, OFFSET, DATA) \
+  host_io_write (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), (alt_u32) (DATA), 2)
+#define IOWR_8DIRECT(BASE, OFFSET, DATA) \
+  host_io_write (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), (alt_u32) (DATA), 1)
+
+#define __IO_CALC_ADDRESS_NATIVE(BASE, REGNUM) \
+  ((alt_u32) (uintptr_t) (BASE) + (REGNUM) * 4)
+
+#define IORD(BASE, REGNUM) \
+  host_io_read (__IO_CALC_ADDRESS_NATIVE ((BASE), (REGNUM)), 4)
+#define IOWR(BASE, REGNUM, DATA) \
+  host_io_write (__IO_CALC_ADDRESS_NATIVE ((BASE), (REGNUM)), (alt_u32) (DATA), 4)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IO_H__ */
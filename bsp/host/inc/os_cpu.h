@@ -0,0 +1,81 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*
+*                                         POSIX (Linux) host port
+*
+* Native builds of the IL 2206 lab applications, see os_cpu_c.c. The data types are the ones of the
+* Nios II port with their sizes (INT32U is 32 bits also on a 64-bit host), so the kernel and the
+* applications compute the same values as on the board.
+*
+* Critical sections block the tick signal (SIGALRM), like the Nios II port disables interrupts.
+*********************************************************************************************************
+*/
+
+#ifndef __OS_CPU_H__
+#define __OS_CPU_H__
+
+#include "sys/alt_irq.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#ifdef  OS_CPU_GLOBALS
+#define OS_CPU_EXT
+#else
+#define OS_CPU_EXT  extern
+#endif
+
+/*
+*********************************************************************************************************
+*                                              DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef unsigned char   BOOLEAN;
+typedef unsigned char   INT8U;                    /* Unsigned  8 bit quantity                           */
+typedef signed   char   INT8S;                    /* Signed    8 bit quantity                           */
+typedef unsigned short  INT16U;                   /* Unsigned 16 bit quantity                           */
+typedef signed   short  INT16S;                   /* Signed   16 bit quantity                           */
+typedef unsigned int    INT32U;                   /* Unsigned 32 bit quantity                           */
+typedef signed   int    INT32S;                   /* Signed   32 bit quantity                           */
+typedef float           FP32;                     /* Single precision floating point                    */
+typedef double          FP64;                     /* Double precision floating point                    */
+
+typedef unsigned int    OS_STK;                   /* Each stack entry is 32-bit wide                    */
+
+/*
+*********************************************************************************************************
+*                                              PORT DEFINES
+*********************************************************************************************************
+*/
+
+#define  OS_STK_GROWTH      1                     /* Stack grows from HIGH to LOW memory                */
+
+#define  OS_TASK_SW         OSCtxSw
+
+#define  OS_CRITICAL_METHOD 3
+
+#define  OS_CPU_SR alt_irq_context
+#define  OS_ENTER_CRITICAL() \
+         cpu_sr = alt_irq_disable_all ()
+#define  OS_EXIT_CRITICAL() \
+         alt_irq_enable_all (cpu_sr);
+
+/* Prototypes */
+void OSStartHighRdy(void);
+void OSCtxSw(void);
+void OSIntCtxSw(void);
+
+/* Restarts the (not running) task of 'ptcb' at 'task', for basic_task.c */
+struct os_tcb;
+OS_STK *OSTaskStkRestart(struct os_tcb *ptcb, OS_STK *ptos, void (*task)(void *pd), void *pdata);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OS_CPU_H__ */
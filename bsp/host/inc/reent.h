@@ -0,0 +1,17 @@
+#ifndef __REENT_H__
+#define __REENT_H__
+
+/*
+ * The newlib reentrancy context for the POSIX host port. The C library of
+ * the host keeps its state per thread and all tasks run on one thread, so
+ * a context is not used; OS_THREAD_SAFE_NEWLIB code only needs the type.
+ */
+
+struct _reent
+{
+  int _errno;
+};
+
+#define _REENT_INIT_PTR(var) ((void) (var))
+
+#endif /* __REENT_H__ */
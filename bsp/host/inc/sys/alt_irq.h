@@ -0,0 +1,127 @@
+#ifndef __ALT_IRQ_H__
+#define __ALT_IRQ_H__
+
+/*
+ * Interrupts of the POSIX host port (see os_cpu_c.c)
+ *
+ * The host has one interrupt, the tick signal SIGALRM. Its handler requests
+ * the tick and then takes the interrupts, the tick and the registered ISRs
+ * of the devices that request one (host_io.c), so a device interrupt is
+ * taken at the next tick.
+ *
+ * The global interrupt enable is a flag like status.PIE of the Nios II, not
+ * the signal mask, which costs a system call to change: while it is clear
+ * the signal only leaves its request, and alt_irq_enable_all() takes the
+ * interrupts that are pending when it sets it again. Tasks only switch with
+ * interrupts disabled, so the flag goes with the task like the status
+ * register.
+ */
+
+#include <stddef.h>
+#include <signal.h>
+#include "system.h"
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#define ALT_IRQ_ENABLED  1
+#define ALT_IRQ_DISABLED 0
+
+#define ALT_NIRQ 32
+
+#define HOST_IRQ_SIGNAL SIGALRM
+
+typedef int alt_irq_context;
+
+/* ISR Prototype */
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+typedef void (*alt_isr_func)(void* isr_context);
+#else
+typedef void (*alt_isr_func)(void* isr_context, alt_u32 id);
+#endif
+
+/* Interrupted program counter, valid in the tick interrupt */
+extern alt_u32 host_irq_pc;
+
+/* Interrupt requests of the devices and the ones enabled, by number */
+extern volatile alt_u32 host_irq_pending;
+extern alt_u32 host_irq_enabled;
+
+/* Global interrupt enable, cleared */
+extern volatile int host_irq_off;
+
+/* Takes the pending interrupts (host_hal.c) */
+extern void host_irq_take (void);
+
+/* The signal handler runs in the same thread, only the compiler reorders */
+#define HOST_IRQ_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
+static ALT_INLINE int ALT_ALWAYS_INLINE alt_irq_enabled (void)
+{
+  return !host_irq_off;
+}
+
+static ALT_INLINE alt_irq_context ALT_ALWAYS_INLINE
+       alt_irq_disable_all (void)
+{
+  alt_irq_context context = !host_irq_off;
+
+  host_irq_off = 1;
+  HOST_IRQ_BARRIER ();
+  return context;
+}
+
+static ALT_INLINE void ALT_ALWAYS_INLINE
+       alt_irq_enable_all (alt_irq_context context)
+{
+  if (context)
+  {
+    HOST_IRQ_BARRIER ();
+    host_irq_off = 0;
+    if (host_irq_pending & host_irq_enabled)
+      host_irq_take ();
+  }
+}
+
+static ALT_INLINE void ALT_ALWAYS_INLINE
+       alt_irq_cpu_enable_interrupts (void)
+{
+  alt_irq_enable_all (ALT_IRQ_ENABLED);
+}
+
+extern void alt_irq_init (const void* base);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+extern int alt_ic_isr_register(alt_u32 ic_id,
+                        alt_u32 irq,
+                        alt_isr_func isr,
+                        void *isr_context,
+                        void *flags);
+int alt_ic_irq_enable (alt_u32 ic_id, alt_u32 irq);
+int alt_ic_irq_disable(alt_u32 ic_id, alt_u32 irq);
+alt_u32 alt_ic_irq_enabled(alt_u32 ic_id, alt_u32 irq);
+#else
+extern int alt_irq_register (alt_u32 id,
+                             void*   context,
+                             alt_isr_func handler);
+#endif
+
+/* Sets the request of a device, atomic to the signal handler */
+static ALT_INLINE void ALT_ALWAYS_INLINE host_irq_set (int irq, int level)
+{
+  if (irq < 0)
+    return;
+  if (level)
+    __atomic_or_fetch (&host_irq_pending, 1u << irq, __ATOMIC_RELAXED);
+  else
+    __atomic_and_fetch (&host_irq_pending, ~(1u << irq), __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_IRQ_H__ */
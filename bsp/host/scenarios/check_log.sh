@@ -0,0 +1,28 @@
+#!/bin/sh
+# @file: check_log.sh
+#
+# Checks the output of a scenario run against a <name>.check file: every
+# line that is not empty or a '#' comment is an extended regular
+# expression (grep -E) that must match a line of the log, in the order of
+# the check file, each after the line the previous one matched. The
+# board trace only sees the outputs, this is for what the application
+# prints (reports, watchdog messages).
+#
+#   check_log.sh scenarios/cruise_control/long.check build/cruise_control/long.log
+
+check=$1
+log=$2
+at=0
+
+while IFS= read -r pattern; do
+    case "$pattern" in
+        ''|'#'*) continue ;;
+    esac
+    n=$(tail -n +$((at + 1)) "$log" | grep -n -E -m 1 -- "$pattern" | cut -d: -f1)
+    if [ -z "$n" ]; then
+        echo "$check: no line after $at of $log matches: $pattern"
+        exit 1
+    fi
+    at=$((at + n))
+done < "$check"
+exit 0
@@ -0,0 +1,362 @@
+/* Virtual DE2 board of the POSIX host port
+ *
+ * Drives the keys and switches from a script and traces the outputs, the
+ * LEDs and the seven segment displays, so that a driving scenario runs
+ * headless and its trace can be compared with an expected one.
+ *
+ * The time of both is virtual, the system clock ticks since the start
+ * (alt_nticks()) in milliseconds: the events of the script are applied by
+ * the tick, before alt_tick(), at the first tick at or after their time,
+ * and an output is stamped with the tick it was written in.
+ *
+ * Script, one event a line, '#' starts a comment:
+ *
+ *   <ms> key <0-3> down|up     KEY0..KEY3 (active low on the PIO)
+ *   <ms> sw <0-17> on|off      SW0..SW17
+ *   <ms> keys <word>           the pressed keys, e.g. 0x8 = KEY3
+ *   <ms> switches <word>       the switches that are on
+ *   <ms> end                   ends the run
+ *
+ * Trace, one line for every write that changes an output PIO, the HEX
+ * words decoded into their four digits, the leftmost first:
+ *
+ *   #  time_ms  register    value       display
+ *      120.000  REDLED18    0x00001001
+ *      120.000  HEX_LOW28   0x10204079  "0001"
+ *
+ * With an expected trace the lines are compared as they are written
+ * ('#' lines of the expected trace are skipped) and the run ends with
+ * status 1 at the first difference, or if the expected trace is longer.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "system.h"
+#include "sys/alt_alarm.h"
+#include "host.h"
+
+#define BOARD_LINE      128
+
+enum board_event_kind { EV_KEY, EV_SW, EV_KEYS, EV_SWITCHES, EV_END };
+
+typedef struct {
+    alt_u32                 tick;
+    enum board_event_kind   kind;
+    alt_u32                 bit;
+    alt_u32                 value;
+} board_event_t;
+
+static board_event_t *events;
+static int nevents, next_event;
+
+static alt_u32 keys_pressed, switches_on;
+
+static FILE *trace_file;
+static FILE *expect_file;
+static const char *expect_name;
+static int expect_line, failed;
+
+/* Segments of the DE2 displays, active low, as in b2sLUT of cruise.c */
+static const struct {
+    alt_u8  segments;
+    char    c;
+} sevenseg[] = {
+    { 0x40, '0' }, { 0x79, '1' }, { 0x24, '2' }, { 0x30, '3' },
+    { 0x19, '4' }, { 0x12, '5' }, { 0x02, '6' }, { 0x78, '7' },
+    { 0x00, '8' }, { 0x18, '9' }, { 0x10, '9' }, { 0x08, 'A' },
+    { 0x03, 'b' }, { 0x46, 'C' }, { 0x21, 'd' }, { 0x06, 'E' },
+    { 0x0E, 'F' }, { 0x3F, '-' }, { 0x7F, ' ' },
+};
+
+static char sevenseg_char(alt_u32 segments)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(sevenseg) / sizeof(sevenseg[0]); i++)
+    {
+        if (sevenseg[i].segments == segments)
+        {
+            return sevenseg[i].c;
+        }
+    }
+    return '?';
+}
+
+/*
+ * Script
+ */
+static int board_error(const char *file, int line, const char *msg)
+{
+    fprintf(stderr, "board: %s:%d: %s\n", file, line, msg);
+    return -1;
+}
+
+static int parse_event(char *text, board_event_t *ev)
+{
+    char *what, *arg, *state, *end;
+    double ms;
+
+    ms = strtod(text, &end);
+    if (end == text || ms < 0)
+    {
+        return -1;
+    }
+    // First tick at or after the time
+    ev->tick = (alt_u32) ((ms * alt_ticks_per_second() + 999.999) / 1000);
+    what = strtok(end, " \t\r\n");
+    arg = strtok(NULL, " \t\r\n");
+    state = strtok(NULL, " \t\r\n");
+    if (what == NULL || strtok(NULL, " \t\r\n") != NULL)
+    {
+        return -1;
+    }
+    if (strcmp(what, "end") == 0 && arg == NULL)
+    {
+        ev->kind = EV_END;
+        return 0;
+    }
+    if (arg == NULL)
+    {
+        return -1;
+    }
+    ev->value = (alt_u32) strtoul(arg, &end, 0);
+    if (*end != '\0')
+    {
+        return -1;
+    }
+    if ((strcmp(what, "key") == 0 && ev->value < 4) || (strcmp(what, "sw") == 0 && ev->value < 18))
+    {
+        ev->kind = what[0] == 'k' ? EV_KEY : EV_SW;
+        ev->bit = 1u << ev->value;
+        if (state && (strcmp(state, "down") == 0 || strcmp(state, "on") == 0))
+        {
+            ev->value = 1;
+        }
+        else if (state && (strcmp(state, "up") == 0 || strcmp(state, "off") == 0))
+        {
+            ev->value = 0;
+        }
+        else
+        {
+            return -1;
+        }
+        return 0;
+    }
+    if (strcmp(what, "keys") == 0 && state == NULL)
+    {
+        ev->kind = EV_KEYS;
+        return 0;
+    }
+    if (strcmp(what, "switches") == 0 && state == NULL)
+    {
+        ev->kind = EV_SWITCHES;
+        return 0;
+    }
+    return -1;
+}
+
+static int load_script(const char *file)
+{
+    char text[BOARD_LINE], *p;
+    board_event_t ev;
+    FILE *f;
+    int line = 0, size = 0;
+
+    if ((f = fopen(file, "r")) == NULL)
+    {
+        return board_error(file, 0, "cannot open");
+    }
+    while (fgets(text, sizeof(text), f))
+    {
+        line++;
+        if ((p = strchr(text, '#')) != NULL)
+        {
+            *p = '\0';
+        }
+        for (p = text; isspace((unsigned char) *p); p++)
+            ;
+        if (*p == '\0')
+        {
+            continue;
+        }
+        memset(&ev, 0, sizeof(ev));
+        if (parse_event(p, &ev) < 0)
+        {
+            fclose(f);
+            return board_error(file, line, "bad event");
+        }
+        if (nevents > 0 && ev.tick < events[nevents - 1].tick)
+        {
+            fclose(f);
+            return board_error(file, line, "event before the one above");
+        }
+        if (nevents == size)
+        {
+            size = size ? 2 * size : 32;
+            events = realloc(events, size * sizeof(*events));
+        }
+        events[nevents++] = ev;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void set_inputs(void)
+{
+#ifdef D2_PIO_KEYS4_BASE
+    host_pio_input(D2_PIO_KEYS4_BASE, ~keys_pressed);
+#endif
+#ifdef DE2_PIO_TOGGLES18_BASE
+    host_pio_input(DE2_PIO_TOGGLES18_BASE, switches_on);
+#endif
+}
+
+void host_board_tick(void)
+{
+    board_event_t *ev;
+    int changed = 0;
+
+    // Before alt_tick() counts the tick being taken
+    while (next_event < nevents && events[next_event].tick <= alt_nticks() + 1)
+    {
+        ev = &events[next_event++];
+        switch (ev->kind)
+        {
+        case EV_KEY:
+            keys_pressed = ev->value ? keys_pressed | ev->bit : keys_pressed & ~ev->bit;
+            break;
+        case EV_SW:
+            switches_on = ev->value ? switches_on | ev->bit : switches_on & ~ev->bit;
+            break;
+        case EV_KEYS:
+            keys_pressed = ev->value;
+            break;
+        case EV_SWITCHES:
+            switches_on = ev->value;
+            break;
+        case EV_END:
+            host_exit(0);
+            break;
+        }
+        changed = 1;
+    }
+    if (changed)
+    {
+        set_inputs();
+    }
+}
+
+/*
+ * Trace
+ */
+static int next_expected(char *text, int size)
+{
+    while (fgets(text, size, expect_file))
+    {
+        expect_line++;
+        if (text[0] != '#' && text[0] != '\n')
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void host_board_output(const char *name, alt_u32 value)
+{
+    char line[BOARD_LINE], expected[BOARD_LINE];
+    const char *reg;
+    int n, digit;
+
+    if (trace_file == NULL && expect_file == NULL)
+    {
+        return;
+    }
+    reg = strstr(name, "PIO_") ? strstr(name, "PIO_") + 4 : name;
+    n = snprintf(line, sizeof(line), "%12.3f  %-10s  0x%08x",
+                 alt_nticks() * 1000.0 / alt_ticks_per_second(), reg, (unsigned int) value);
+    if (strncmp(reg, "HEX", 3) == 0)
+    {
+        n += snprintf(line + n, sizeof(line) - n, "  \"");
+        for (digit = 3; digit >= 0; digit--)
+        {
+            line[n++] = sevenseg_char((value >> (7 * digit)) & 0x7F);
+        }
+        line[n++] = '"';
+        line[n] = '\0';
+    }
+    strcat(line, "\n");
+
+    if (trace_file)
+    {
+        fputs(line, trace_file);
+    }
+    if (expect_file && !failed)
+    {
+        if (!next_expected(expected, sizeof(expected)))
+        {
+            fprintf(stderr, "board: trace longer than %s\n  got:      %s", expect_name, line);
+            failed = 1;
+        }
+        else if (strcmp(line, expected) != 0)
+        {
+            fprintf(stderr, "board: trace differs from %s:%d\n  expected: %s  got:      %s",
+                    expect_name, expect_line, expected, line);
+            failed = 1;
+        }
+        if (failed)
+        {
+            host_exit(1);
+        }
+    }
+}
+
+int host_board_open(const char *script, const char *trace, const char *expect)
+{
+    if (script && load_script(script) < 0)
+    {
+        return -1;
+    }
+    if (trace)
+    {
+        trace_file = strcmp(trace, "-") == 0 ? stderr : fopen(trace, "w");
+        if (trace_file == NULL)
+        {
+            return board_error(trace, 0, "cannot create");
+        }
+        fprintf(trace_file, "#%11s  %-10s  %-10s  %s\n", "time_ms", "register", "value", "display");
+    }
+    if (expect)
+    {
+        if ((expect_file = fopen(expect, "r")) == NULL)
+        {
+            return board_error(expect, 0, "cannot open");
+        }
+        expect_name = expect;
+    }
+    set_inputs();
+    return 0;
+}
+
+int host_board_close(int status)
+{
+    char expected[BOARD_LINE];
+
+    if (trace_file && trace_file != stderr)
+    {
+        fclose(trace_file);
+    }
+    trace_file = NULL;
+    if (expect_file)
+    {
+        if (!failed && next_expected(expected, sizeof(expected)))
+        {
+            fprintf(stderr, "board: trace shorter than %s\n  expected: %s", expect_name, expected);
+            failed = 1;
+        }
+        fclose(expect_file);
+        expect_file = NULL;
+    }
+    return failed ? 1 : status;
+}
@@ -0,0 +1,460 @@
+/* HAL of the POSIX host port
+ *
+ * In place of alt_main() and alt_sys_init() of the Nios II HAL: initializes
+ * the kernel with ALT_OS_INIT(), the system clock and the timestamp timer
+ * of system.h and the devices (host_io.c), starts the tick and calls main()
+ * of the application, which the Makefile builds as app_main().
+ *
+ * The tick is SIGALRM of an ITIMER_REAL interval timer at the rate of the
+ * system clock timer. Its handler is the interrupt handler of the HAL: it
+ * takes the pending interrupts by number like alt_irq_handler(), the
+ * system clock (alt_tick()) and the ISRs registered by the application.
+ *
+ * In virtual time the clock only runs while a task does: when all tasks
+ * are blocked the idle task takes the next tick at once (host_idle()), like
+ * a discrete event simulation, and restarts the interval timer, so a busy
+ * task is still preempted, after HOST_VIRTUAL_SLACK ticks of host time to
+ * ride out the scheduling of the host. host_cycles() and so the timers
+ * count the ticks and the time since the last one. A run goes as fast as
+ * the host allows, with the tasks run tick by tick in the same order as in
+ * real time as long as they do not overrun a tick; a saturated CPU runs
+ * HOST_VIRTUAL_SLACK times slower than real time.
+ *
+ * usage: <app> [--virtual] [--time <seconds>] [--script <file>]
+ *              [--trace <file>] [--expect <file>] [--region <name>=<funcs>]
+ *
+ *   --virtual  runs in virtual time
+ *   --time     ends the run after that many seconds, otherwise it runs until
+ *              it is stopped (Ctrl-C) or the script ends it
+ *   --script   keys and switches of the virtual board (host_board.c)
+ *   --trace    writes the trace of the LEDs and displays ('-' = stderr)
+ *   --expect   compares the trace with this one, status 1 if it differs
+ *   --region   counts the calls of the functions in basic blocks, printed
+ *              at the end as a BENCH line (host_region.c, REGIONS=1 only)
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <ucontext.h>
+#include <sys/time.h>
+
+#include "includes.h"
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_alarm.h"
+#include "os/alt_hooks.h"
+#include "altera_avalon_timer.h"
+#include "host.h"
+
+#define __HOST_CLK(name, x)     name##x
+#define HOST_CLK(name, x)       __HOST_CLK(name, x)
+
+#define HOST_SYS_CLK_IRQ        HOST_CLK(ALT_SYS_CLK, _IRQ)
+
+/* Host time of a virtual tick of a busy task, in ticks */
+#ifndef HOST_VIRTUAL_SLACK
+#define HOST_VIRTUAL_SLACK      2
+#endif
+
+int app_main(void);
+
+OS_EVENT *alt_envsem;
+OS_EVENT *alt_heapsem;
+
+alt_u32 host_irq_pc;
+volatile alt_u32 host_irq_pending;
+alt_u32 host_irq_enabled;
+volatile int host_irq_off;
+
+static struct {
+    alt_isr_func    handler;
+    void           *context;
+} host_isr[ALT_NIRQ];
+
+static struct timespec host_start;
+static alt_u64 host_end;                /* cycle the run ends, 0 = never */
+
+static int host_virtual;
+static struct itimerval host_tick_timer;
+static alt_u32 host_tick_cycles;        /* CPU cycles of a tick */
+static alt_u64 host_vtick;              /* virtual cycle of the last tick */
+static struct timespec host_vlast;      /* host time of the last tick */
+
+static void host_tick(void);
+
+/*
+ * Time
+ */
+static alt_u64 host_ns_since(const struct timespec *since)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (alt_u64) (now.tv_sec - since->tv_sec) * 1000000000u
+           + now.tv_nsec - since->tv_nsec;
+}
+
+alt_u64 host_cycles(void)
+{
+    alt_u64 cycles;
+
+    if (host_virtual)
+    {
+        // Within the tick, the tick after it has not been taken yet
+        cycles = host_ns_since(&host_vlast) * (ALT_CPU_FREQ / 1000000) / 1000 / HOST_VIRTUAL_SLACK;
+        return host_vtick + (cycles < host_tick_cycles ? cycles : host_tick_cycles - 1);
+    }
+    return host_ns_since(&host_start) * (ALT_CPU_FREQ / 1000000) / 1000;
+}
+
+int host_virtual_time(void)
+{
+    return host_virtual;
+}
+
+void host_idle(void)
+{
+    alt_irq_context context;
+    sigset_t none;
+
+    if (host_virtual)
+    {
+        // The next tick now, and a whole tick to the one after
+        context = alt_irq_disable_all();
+        setitimer(ITIMER_REAL, &host_tick_timer, NULL);
+        host_tick();
+        alt_irq_enable_all(context);
+    }
+    else
+    {
+        sigemptyset(&none);
+        sigsuspend(&none);
+    }
+}
+
+void host_exit(int status)
+{
+    status = host_board_close(status);
+#ifdef HOST_REGIONS
+    host_region_report();
+#endif
+    fflush(stdout);
+    exit(status);
+}
+
+/*
+ * Interrupts, the enhanced API of the HAL with one interrupt controller
+ */
+int alt_ic_isr_register(alt_u32 ic_id, alt_u32 irq, alt_isr_func isr,
+                        void *isr_context, void *flags)
+{
+    alt_irq_context context;
+
+    (void) ic_id;
+    (void) flags;
+    if (irq >= ALT_NIRQ)
+    {
+        return -1;
+    }
+    context = alt_irq_disable_all();
+    host_isr[irq].handler = isr;
+    host_isr[irq].context = isr_context;
+    if (isr)
+    {
+        host_irq_enabled |= 1u << irq;
+    }
+    else
+    {
+        host_irq_enabled &= ~(1u << irq);
+    }
+    alt_irq_enable_all(context);
+    return 0;
+}
+
+int alt_ic_irq_enable(alt_u32 ic_id, alt_u32 irq)
+{
+    alt_irq_context context;
+
+    (void) ic_id;
+    context = alt_irq_disable_all();
+    host_irq_enabled |= 1u << irq;
+    alt_irq_enable_all(context);
+    return 0;
+}
+
+int alt_ic_irq_disable(alt_u32 ic_id, alt_u32 irq)
+{
+    alt_irq_context context;
+
+    (void) ic_id;
+    context = alt_irq_disable_all();
+    host_irq_enabled &= ~(1u << irq);
+    alt_irq_enable_all(context);
+    return 0;
+}
+
+alt_u32 alt_ic_irq_enabled(alt_u32 ic_id, alt_u32 irq)
+{
+    (void) ic_id;
+    return (host_irq_enabled >> irq) & 1;
+}
+
+#ifndef ALT_ENHANCED_INTERRUPT_API_PRESENT
+int alt_irq_register(alt_u32 id, void *context, alt_isr_func handler)
+{
+    return alt_ic_isr_register(0, id, handler, context, NULL);
+}
+#endif
+
+void alt_irq_init(const void *base)
+{
+    (void) base;
+}
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void host_sysclk_irq(void *context)
+#else
+static void host_sysclk_irq(void *context, alt_u32 id)
+#endif
+{
+    host_irq_set(HOST_SYS_CLK_IRQ, 0);
+    host_board_tick();
+    alt_tick();
+    if (host_end && host_cycles() >= host_end)
+    {
+        host_exit(0);
+    }
+}
+
+static alt_u32 host_pc(void *uc)
+{
+#if defined(__x86_64__)
+    return (alt_u32) ((ucontext_t *) uc)->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+    return (alt_u32) ((ucontext_t *) uc)->uc_mcontext.pc;
+#else
+    (void) uc;
+    return 0;
+#endif
+}
+
+/*
+ * The interrupt, with interrupts disabled like the exception of the Nios II,
+ * until no enabled one is pending
+ */
+static void host_irq_service(void)
+{
+    alt_u32 active, mask;
+    int i;
+
+    do
+    {
+        host_irq_off = 1;
+        HOST_IRQ_BARRIER();
+        OSIntEnter();
+        while ((active = host_irq_pending & host_irq_enabled) != 0)
+        {
+            for (i = 0, mask = 1; i < ALT_NIRQ; i++, mask <<= 1)
+            {
+                if (active & mask)
+                {
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+                    host_isr[i].handler(host_isr[i].context);
+#else
+                    host_isr[i].handler(host_isr[i].context, i);
+#endif
+                    break;
+                }
+            }
+        }
+        OSIntExit();
+        HOST_IRQ_BARRIER();
+        host_irq_off = 0;
+    } while (host_irq_pending & host_irq_enabled);
+}
+
+/* The interrupts pending when alt_irq_enable_all() enables them, taken
+ * where it returns to */
+void __attribute__ ((noinline)) host_irq_take(void)
+{
+    host_irq_pc = (alt_u32) (uintptr_t) __builtin_return_address(0);
+    host_irq_service();
+}
+
+/* The request of the system clock timer */
+static void host_tick(void)
+{
+    host_irq_set(HOST_SYS_CLK_IRQ, 1);
+    if (host_virtual)
+    {
+        host_vtick += host_tick_cycles;
+        clock_gettime(CLOCK_MONOTONIC, &host_vlast);
+    }
+}
+
+/*
+ * SIGALRM, the tick. The signal is blocked while the handler runs; with
+ * interrupts disabled it only leaves the request.
+ */
+static void host_irq_handler(int sig, siginfo_t *info, void *uc)
+{
+    (void) sig;
+    (void) info;
+    host_tick();
+    if (!host_irq_off)
+    {
+        host_irq_pc = host_pc(uc);
+        host_irq_service();
+    }
+}
+
+/*
+ * stdio with the tick blocked (includes.h)
+ */
+int host_printf(const char *fmt, ...)
+{
+    alt_irq_context context;
+    va_list ap;
+    int n;
+
+    context = alt_irq_disable_all();
+    va_start(ap, fmt);
+    n = vprintf(fmt, ap);
+    va_end(ap);
+    alt_irq_enable_all(context);
+    return n;
+}
+
+int host_puts(const char *s)
+{
+    alt_irq_context context;
+    int n;
+
+    context = alt_irq_disable_all();
+    n = fputs(s, stdout);
+    if (n >= 0)
+    {
+        n = fputc('\n', stdout);
+    }
+    alt_irq_enable_all(context);
+    return n;
+}
+
+int host_putchar(int c)
+{
+    alt_irq_context context;
+    int n;
+
+    context = alt_irq_disable_all();
+    n = fputc(c, stdout);
+    alt_irq_enable_all(context);
+    return n;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [--virtual] [--time <seconds>] [--script <file>]"
+            " [--trace <file>] [--expect <file>]"
+#ifdef HOST_REGIONS
+            " [--region <name>=<funcs>]"
+#endif
+            "\n", prog);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    struct sigaction sa;
+    alt_u32 tick_rate, period_us;
+    const char *script = NULL, *trace = NULL, *expect = NULL;
+    double seconds = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--virtual") == 0)
+        {
+            host_virtual = 1;
+        }
+        else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+        {
+            script = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            trace = argv[++i];
+        }
+        else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc)
+        {
+            expect = argv[++i];
+        }
+#ifdef HOST_REGIONS
+        else if (strcmp(argv[i], "--region") == 0 && i + 1 < argc)
+        {
+            if (host_region_add(argv[++i]) < 0)
+            {
+                exit(2);
+            }
+        }
+#endif
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+
+    // Output like the JTAG UART, not held back in a buffer
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    clock_gettime(CLOCK_MONOTONIC, &host_start);
+    host_vlast = host_start;
+    if (seconds > 0)
+    {
+        host_end = (alt_u64) (seconds * ALT_CPU_FREQ);
+    }
+
+    // alt_main(): interrupts off until OSStart(), the kernel, the drivers
+    alt_irq_disable_all();
+    ALT_OS_INIT();
+    host_io_init();
+    tick_rate = ALTERA_AVALON_TIMER_FREQ(HOST_CLK(ALT_SYS_CLK, _FREQ),
+                                         HOST_CLK(ALT_SYS_CLK, _PERIOD),
+                                         HOST_CLK(ALT_SYS_CLK, _PERIOD_UNITS));
+    alt_sysclk_init(tick_rate);
+    host_tick_cycles = ALT_CPU_FREQ / tick_rate;
+    if (host_board_open(script, trace, expect) < 0)
+    {
+        exit(2);
+    }
+    alt_ic_isr_register(0, HOST_SYS_CLK_IRQ, host_sysclk_irq, NULL, NULL);
+#if (ALT_TIMESTAMP_CLK_BASE != none_BASE)
+    altera_avalon_timer_ts_base = (void *) ALT_TIMESTAMP_CLK_BASE;
+    altera_avalon_timer_ts_freq = HOST_CLK(ALT_TIMESTAMP_CLK, _FREQ);
+#endif
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = host_irq_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(HOST_IRQ_SIGNAL, &sa, NULL);
+    period_us = 1000000 / tick_rate * (host_virtual ? HOST_VIRTUAL_SLACK : 1);
+    host_tick_timer.it_interval.tv_sec = period_us / 1000000;
+    host_tick_timer.it_interval.tv_usec = period_us % 1000000;
+    host_tick_timer.it_value = host_tick_timer.it_interval;
+    setitimer(ITIMER_REAL, &host_tick_timer, NULL);
+    host_io_sysclk_start(host_virtual ? 0 : host_cycles());
+
+    // The HAL enables interrupts before main(), the tick runs before OSStart()
+    alt_irq_enable_all(ALT_IRQ_ENABLED);
+    app_main();
+    host_exit(0);
+    return 0;
+}
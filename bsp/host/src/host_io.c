@@ -0,0 +1,535 @@
+/* Devices of the POSIX host port
+ *
+ * The registers behind IORD/IOWR (io.h) for the peripherals of system.h,
+ * with the behaviour of tools/niossim.c:
+ *
+ *   altera_avalon_pio                 data, direction, interruptmask, edgecapture
+ *   altera_avalon_timer               32-bit, status/control/period/snap
+ *   altera_avalon_jtag_uart           output on stdout, no input
+ *   altera_avalon_performance_counter sections, time and event counters
+ *   altera_up_avalon_character_lcd    2x16 characters
+ *
+ * The timers and the performance counter count host_cycles(), the host
+ * clock scaled to the CPU clock, so timestamps keep their unit. The timer
+ * of the system clock counts its period in step with the tick of
+ * host_hal.c, so a snapshot tells how long ago the tick came; it leaves
+ * the interrupt to the tick. Nothing drives the input PIOs but
+ * host_pio_input(): the keys are released, the switches are off until the
+ * script of the virtual board (host_board.c) changes them, and the board
+ * traces the changes of the output PIOs. Device interrupts are requested
+ * with host_irq_set() and taken at the next tick.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "system.h"
+#include "io.h"
+#include "sys/alt_irq.h"
+#include "host.h"
+
+#define UART_FIFO       64
+
+#define __HOST_CLK(name, x)     name##x
+#define HOST_CLK(name, x)       __HOST_CLK(name, x)
+
+enum host_dev_kind { DEV_PIO, DEV_TIMER, DEV_UART, DEV_PERF, DEV_LCD };
+
+enum host_edge { EDGE_NONE, EDGE_RISING, EDGE_FALLING, EDGE_ANY };
+
+typedef struct {
+    enum host_dev_kind  kind;
+    const char         *name;
+    alt_u32             base, span;
+    int                 irq;            /* -1 = none */
+    int                 width;          /* PIO data bits */
+    int                 has_in;
+    int                 bit_clear;
+    const char         *edge_type;
+} host_dev_cfg_t;
+
+typedef struct {
+    const host_dev_cfg_t *cfg;
+    union {
+        struct {
+            alt_u32  in, out, dir, mask, edge, width;
+            int      edge_type;
+        } pio;
+        struct {
+            alt_u32  period, snap, control, value;
+            int      to, running, sysclk;
+            alt_u64  start;             /* cycle the counter was 'value' */
+        } tmr;
+        struct {
+            alt_u32  control;
+        } uart;
+        struct {
+            alt_u64  time[16], start[16];
+            alt_u32  events[16];
+            int      running[16], sections;
+        } perf;
+        struct {
+            alt_u8   ddram[128];
+            int      addr;
+        } lcd;
+    } u;
+} host_dev_t;
+
+#define HOST_PIO(name) \
+    { DEV_PIO, #name, name##_BASE, 16, name##_IRQ, name##_DATA_WIDTH, \
+      name##_HAS_IN, name##_BIT_CLEARING_EDGE_REGISTER, name##_EDGE_TYPE }
+#define HOST_DEV(kind, name, span) \
+    { kind, #name, name##_BASE, span, name##_IRQ, 0, 0, 0, "NONE" }
+
+static const host_dev_cfg_t host_dev_cfg[] = {
+#ifdef D2_PIO_KEYS4_BASE
+    HOST_PIO(D2_PIO_KEYS4),
+#endif
+#ifdef DE2_PIO_TOGGLES18_BASE
+    HOST_PIO(DE2_PIO_TOGGLES18),
+#endif
+#ifdef DE2_PIO_REDLED18_BASE
+    HOST_PIO(DE2_PIO_REDLED18),
+#endif
+#ifdef DE2_PIO_GREENLED9_BASE
+    HOST_PIO(DE2_PIO_GREENLED9),
+#endif
+#ifdef DE2_PIO_HEX_LOW28_BASE
+    HOST_PIO(DE2_PIO_HEX_LOW28),
+#endif
+#ifdef DE2_PIO_HEX_HIGH28_BASE
+    HOST_PIO(DE2_PIO_HEX_HIGH28),
+#endif
+#ifdef TIMER_0_BASE
+    HOST_DEV(DEV_TIMER, TIMER_0, 32),
+#endif
+#ifdef TIMER_1_BASE
+    HOST_DEV(DEV_TIMER, TIMER_1, 32),
+#endif
+#ifdef JTAG_UART_0_BASE
+    HOST_DEV(DEV_UART, JTAG_UART_0, 8),
+#endif
+#ifdef PERFORMANCE_COUNTER_BASE
+    HOST_DEV(DEV_PERF, PERFORMANCE_COUNTER, 128),
+#endif
+#ifdef DE2_LCD_BASE
+    HOST_DEV(DEV_LCD, DE2_LCD, 2),
+#endif
+};
+
+#define HOST_NDEVS (sizeof(host_dev_cfg) / sizeof(host_dev_cfg[0]))
+
+static host_dev_t devs[HOST_NDEVS];
+
+static host_dev_t *find_dev(alt_u32 addr)
+{
+    unsigned int i;
+
+    for (i = 0; i < HOST_NDEVS; i++)
+    {
+        if (addr >= devs[i].cfg->base && addr < devs[i].cfg->base + devs[i].cfg->span)
+        {
+            return &devs[i];
+        }
+    }
+    return NULL;
+}
+
+static void unmapped(alt_u32 addr)
+{
+    static alt_u32 last = 0xFFFFFFFF;
+
+    if (addr != last)
+    {
+        fprintf(stderr, "host_io: no device at 0x%08x\n", (unsigned int) addr);
+        last = addr;
+    }
+}
+
+/*
+ * PIO
+ */
+static void pio_update(host_dev_t *d)
+{
+    host_irq_set(d->cfg->irq, (d->u.pio.edge & d->u.pio.mask) != 0);
+}
+
+static void pio_set(host_dev_t *d, alt_u32 value)
+{
+    alt_u32 old = d->u.pio.in, rise, fall;
+
+    value &= d->u.pio.width;
+    rise = ~old & value;
+    fall = old & ~value;
+    d->u.pio.in = value;
+    switch (d->u.pio.edge_type)
+    {
+    case EDGE_RISING:   d->u.pio.edge |= rise; break;
+    case EDGE_FALLING:  d->u.pio.edge |= fall; break;
+    case EDGE_ANY:      d->u.pio.edge |= rise | fall; break;
+    }
+    pio_update(d);
+}
+
+int host_pio_input(alt_u32 base, alt_u32 value)
+{
+    host_dev_t *d = find_dev(base);
+    alt_irq_context context;
+
+    if (d == NULL || d->cfg->kind != DEV_PIO || !d->cfg->has_in)
+    {
+        return -1;
+    }
+    context = alt_irq_disable_all();
+    pio_set(d, value);
+    alt_irq_enable_all(context);
+    return 0;
+}
+
+/*
+ * Timer, counts down from the period at the CPU clock
+ */
+static alt_u32 tmr_counter(host_dev_t *d)
+{
+    if (!d->u.tmr.running)
+    {
+        return d->u.tmr.value;
+    }
+    return d->u.tmr.value - (alt_u32) (host_cycles() - d->u.tmr.start);
+}
+
+static void tmr_expire(host_dev_t *d)
+{
+    alt_u64 now = host_cycles(), at;
+
+    while (d->u.tmr.running && now >= (at = d->u.tmr.start + d->u.tmr.value + 1))
+    {
+        d->u.tmr.to = 1;
+        d->u.tmr.start = at;
+        d->u.tmr.value = d->u.tmr.period;
+        if (!(d->u.tmr.control & 0x2))
+        {
+            d->u.tmr.running = 0;
+        }
+    }
+    if (!d->u.tmr.sysclk)
+    {
+        host_irq_set(d->cfg->irq, d->u.tmr.to && (d->u.tmr.control & 0x1));
+    }
+}
+
+/*
+ * Performance counter, sections count while the global counter (0) runs
+ */
+static alt_u64 perf_time(host_dev_t *d, int n)
+{
+    alt_u64 t = d->u.perf.time[n];
+
+    if (d->u.perf.running[n] && d->u.perf.running[0])
+    {
+        t += host_cycles() - d->u.perf.start[n];
+    }
+    return t;
+}
+
+static void perf_write(host_dev_t *d, int reg, alt_u32 value)
+{
+    int n = reg / 4, i;
+
+    if (n >= d->u.perf.sections)
+    {
+        return;
+    }
+    if (reg == 0 && value == 1)
+    {
+        memset(&d->u.perf.time, 0, sizeof(d->u.perf.time));
+        memset(&d->u.perf.events, 0, sizeof(d->u.perf.events));
+        memset(&d->u.perf.running, 0, sizeof(d->u.perf.running));
+    }
+    else if (reg % 4 == 1 && !d->u.perf.running[n])
+    {
+        if (n == 0)
+        {
+            for (i = 1; i < d->u.perf.sections; i++)
+            {
+                d->u.perf.start[i] = host_cycles();
+            }
+        }
+        d->u.perf.start[n] = host_cycles();
+        d->u.perf.running[n] = 1;
+        d->u.perf.events[n]++;
+    }
+    else if (reg % 4 == 0 && d->u.perf.running[n])
+    {
+        if (n == 0)
+        {
+            for (i = 1; i < d->u.perf.sections; i++)
+            {
+                if (d->u.perf.running[i])
+                {
+                    d->u.perf.time[i] = perf_time(d, i);
+                }
+            }
+        }
+        d->u.perf.time[n] = perf_time(d, n);
+        d->u.perf.running[n] = 0;
+    }
+}
+
+void host_io_init(void)
+{
+    host_dev_t *d;
+    unsigned int i;
+
+    memset(devs, 0, sizeof(devs));
+    for (i = 0; i < HOST_NDEVS; i++)
+    {
+        d = &devs[i];
+        d->cfg = &host_dev_cfg[i];
+        switch (d->cfg->kind)
+        {
+        case DEV_PIO:
+            d->u.pio.width = d->cfg->width >= 32 ? 0xFFFFFFFF : (1u << d->cfg->width) - 1;
+            if (strcmp(d->cfg->edge_type, "RISING") == 0)
+                d->u.pio.edge_type = EDGE_RISING;
+            else if (strcmp(d->cfg->edge_type, "FALLING") == 0)
+                d->u.pio.edge_type = EDGE_FALLING;
+            else if (strcmp(d->cfg->edge_type, "ANY") == 0)
+                d->u.pio.edge_type = EDGE_ANY;
+            // Nothing pressed on an active low input
+            if (d->u.pio.edge_type == EDGE_FALLING)
+                d->u.pio.in = d->u.pio.width;
+            break;
+        case DEV_TIMER:
+            d->u.tmr.period = 0xFFFFFFFF;
+            d->u.tmr.value = d->u.tmr.period;
+#ifdef ALT_SYS_CLK
+            // Started by host_io_sysclk_start()
+            if (d->cfg->base == HOST_CLK(ALT_SYS_CLK, _BASE))
+            {
+                d->u.tmr.sysclk = 1;
+                d->u.tmr.period = HOST_CLK(ALT_SYS_CLK, _LOAD_VALUE);
+                d->u.tmr.value = d->u.tmr.period;
+            }
+#endif
+            break;
+        case DEV_PERF:
+#ifdef PERFORMANCE_COUNTER_HOW_MANY_SECTIONS
+            d->u.perf.sections = PERFORMANCE_COUNTER_HOW_MANY_SECTIONS;
+#else
+            d->u.perf.sections = 3;
+#endif
+            if (d->u.perf.sections > 16)
+                d->u.perf.sections = 16;
+            break;
+        case DEV_LCD:
+            memset(d->u.lcd.ddram, ' ', sizeof(d->u.lcd.ddram));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void host_io_sysclk_start(alt_u64 cycle)
+{
+    unsigned int i;
+
+    for (i = 0; i < HOST_NDEVS; i++)
+    {
+        if (devs[i].cfg->kind == DEV_TIMER && devs[i].u.tmr.sysclk)
+        {
+            devs[i].u.tmr.control = 0x6;    /* CONT | START */
+            devs[i].u.tmr.running = 1;
+            devs[i].u.tmr.start = cycle;
+        }
+    }
+}
+
+static alt_u32 io_read(alt_u32 addr)
+{
+    host_dev_t *d = find_dev(addr);
+    int reg, n;
+
+    if (d == NULL)
+    {
+        unmapped(addr);
+        return 0;
+    }
+    reg = (addr - d->cfg->base) / 4;
+    switch (d->cfg->kind)
+    {
+    case DEV_PIO:
+        switch (reg)
+        {
+        case 0: return d->cfg->has_in ? d->u.pio.in : d->u.pio.out;
+        case 1: return d->u.pio.dir;
+        case 2: return d->u.pio.mask;
+        case 3: return d->u.pio.edge;
+        }
+        return 0;
+    case DEV_TIMER:
+        tmr_expire(d);
+        switch (reg)
+        {
+        case 0: return d->u.tmr.to | (d->u.tmr.running << 1);
+        case 1: return d->u.tmr.control & 0xF;
+        case 2: return d->u.tmr.period & 0xFFFF;
+        case 3: return d->u.tmr.period >> 16;
+        case 4: return d->u.tmr.snap & 0xFFFF;
+        case 5: return d->u.tmr.snap >> 16;
+        }
+        return 0;
+    case DEV_UART:
+        // Nothing to read, the write FIFO is always empty
+        return reg == 0 ? 0 : (d->u.uart.control & 0x3) | 0x400 | ((alt_u32) UART_FIFO << 16);
+    case DEV_PERF:
+        n = reg / 4;
+        if (n >= d->u.perf.sections)
+        {
+            return 0;
+        }
+        switch (reg % 4)
+        {
+        case 0: return (alt_u32) perf_time(d, n);
+        case 1: return (alt_u32) (perf_time(d, n) >> 32);
+        case 2: return d->u.perf.events[n];
+        }
+        return 0;
+    case DEV_LCD:
+        // Never busy, the address counter in the status
+        return (addr - d->cfg->base) == 0 ? (alt_u32) d->u.lcd.addr : 0;
+    }
+    return 0;
+}
+
+static void io_write(alt_u32 addr, alt_u32 value)
+{
+    host_dev_t *d = find_dev(addr);
+    int reg;
+
+    if (d == NULL)
+    {
+        unmapped(addr);
+        return;
+    }
+    reg = (addr - d->cfg->base) / 4;
+    switch (d->cfg->kind)
+    {
+    case DEV_PIO:
+        switch (reg)
+        {
+        case 0:
+            value &= d->u.pio.width;
+            if (!d->cfg->has_in && value != d->u.pio.out)
+                host_board_output(d->cfg->name, value);
+            d->u.pio.out = value;
+            break;
+        case 1: d->u.pio.dir = value; break;
+        case 2: d->u.pio.mask = value & d->u.pio.width; break;
+        case 3:
+            if (d->cfg->bit_clear)
+                d->u.pio.edge &= ~value;
+            else
+                d->u.pio.edge = 0;
+            break;
+        }
+        pio_update(d);
+        break;
+    case DEV_TIMER:
+        tmr_expire(d);
+        value &= 0xFFFF;
+        switch (reg)
+        {
+        case 0:
+            d->u.tmr.to = 0;
+            break;
+        case 1:
+            d->u.tmr.control = value & 0x3;
+            if ((value & 0x8) && d->u.tmr.running)
+            {
+                d->u.tmr.value = tmr_counter(d);
+                d->u.tmr.running = 0;
+            }
+            else if ((value & 0x4) && !d->u.tmr.running)
+            {
+                d->u.tmr.start = host_cycles();
+                d->u.tmr.running = 1;
+            }
+            break;
+        case 2:
+        case 3:
+            // Stops the counter and loads the new period
+            if (reg == 2)
+                d->u.tmr.period = (d->u.tmr.period & 0xFFFF0000) | value;
+            else
+                d->u.tmr.period = (d->u.tmr.period & 0xFFFF) | (value << 16);
+            d->u.tmr.running = 0;
+            d->u.tmr.value = d->u.tmr.period;
+            break;
+        case 4:
+        case 5:
+            d->u.tmr.snap = tmr_counter(d);
+            break;
+        }
+        tmr_expire(d);
+        break;
+    case DEV_UART:
+        if (reg == 0)
+            putc(value & 0xFF, stdout);
+        else
+            d->u.uart.control = value & 0x3;
+        host_irq_set(d->cfg->irq, d->u.uart.control & 0x2);
+        break;
+    case DEV_PERF:
+        perf_write(d, reg, value);
+        break;
+    case DEV_LCD:
+        if (addr - d->cfg->base == 0)
+        {
+            value &= 0xFF;
+            if (value == 0x01)
+            {
+                memset(d->u.lcd.ddram, ' ', sizeof(d->u.lcd.ddram));
+                d->u.lcd.addr = 0;
+            }
+            else if (value == 0x02 || value == 0x03)
+            {
+                d->u.lcd.addr = 0;
+            }
+            else if (value & 0x80)
+            {
+                d->u.lcd.addr = value & 0x7F;
+            }
+        }
+        else
+        {
+            d->u.lcd.ddram[d->u.lcd.addr] = value;
+            d->u.lcd.addr = (d->u.lcd.addr + 1) & 0x7F;
+        }
+        break;
+    }
+}
+
+/*
+ * Accesses are atomic to the tick, which runs device interrupts too
+ */
+alt_u32 host_io_read(alt_u32 addr, int size)
+{
+    alt_irq_context context;
+    alt_u32 value;
+
+    (void) size;
+    context = alt_irq_disable_all();
+    value = io_read(addr);
+    alt_irq_enable_all(context);
+    return value;
+}
+
+void host_io_write(alt_u32 addr, alt_u32 value, int size)
+{
+    alt_irq_context context;
+
+    (void) size;
+    context = alt_irq_disable_all();
+    io_write(addr, value);
+    alt_irq_enable_all(context);
+}
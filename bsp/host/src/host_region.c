@@ -0,0 +1,157 @@
+/* Regions of the POSIX host port, the cost of functions in basic blocks
+ *
+ * Like --region of tools/niossim.c: a call of the functions of a region is
+ * counted from its entry to the return of one of them, whatever runs in
+ * between (interrupts, other tasks after a switch). So the region
+ * OSCtxSw,OSIntCtxSw ends in the task it switched to, which returns from
+ * the switch it left with. A call inside an open region is not counted on
+ * its own. At the end of the run each region is printed as a "BENCH " JSON
+ * line, see tools/bench_budget.py.
+ *
+ * The unit is the basic block, not the cycle: the build with REGIONS=1
+ * (Makefile) instruments the application, the kernel and the HAL with
+ * -fsanitize-coverage=trace-pc, which calls __sanitizer_cov_trace_pc() at
+ * every block, and -finstrument-functions for the entry and the return.
+ * The C library is not instrumented, so a printf() counts as its call. In
+ * virtual time a run depends only on the build and the script, not on the
+ * load of the host, as long as no task overruns a tick.
+ *
+ * This file is built without the instrumentation, it has the hooks. The
+ * functions are found by name with dlsym(), the build links with -rdynamic;
+ * static functions cannot be regions.
+ *
+ * usage: <app> --virtual --script drive.script --region tick=alt_avalon_timer_sc_irq
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include "host.h"
+
+#define MAX_REGIONS     16
+#define MAX_PROBES      32
+
+typedef struct {
+    const char         *name;
+    const char         *funcs;
+    int                 open;
+    unsigned long long  t0;
+    unsigned long long  samples, min, max, sum;
+} host_region_t;
+
+/* A function of a region */
+typedef struct {
+    void               *fn;
+    host_region_t      *region;
+} host_probe_t;
+
+static host_region_t regions[MAX_REGIONS];
+static int nregions;
+
+static host_probe_t probes[MAX_PROBES];
+static int nprobes;
+
+/* Basic blocks run so far */
+static volatile unsigned long long blocks;
+
+int host_region_add(const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    char *funcs, *name, *save;
+    host_region_t *r;
+    void *fn;
+
+    if (eq == NULL || eq == arg || nregions == MAX_REGIONS)
+    {
+        fprintf(stderr, "host_region: bad region %s, NAME=FUNC[,FUNC...]\n", arg);
+        return -1;
+    }
+    r = &regions[nregions++];
+    r->name = strndup(arg, eq - arg);
+    r->funcs = eq + 1;
+    funcs = strdup(eq + 1);
+    for (name = strtok_r(funcs, ",", &save); name; name = strtok_r(NULL, ",", &save))
+    {
+        fn = dlsym(RTLD_DEFAULT, name);
+        if (fn == NULL)
+        {
+            // Not timed, the region is reported without samples
+            fprintf(stderr, "host_region: region %s: no function %s\n", r->name, name);
+            continue;
+        }
+        if (nprobes == MAX_PROBES)
+        {
+            fprintf(stderr, "host_region: more than %d region functions\n", MAX_PROBES);
+            return -1;
+        }
+        probes[nprobes].fn = fn;
+        probes[nprobes].region = r;
+        nprobes++;
+    }
+    free(funcs);
+    return 0;
+}
+
+void host_region_report(void)
+{
+    host_region_t *r;
+    int i;
+
+    for (i = 0; i < nregions; i++)
+    {
+        r = &regions[i];
+        printf("BENCH {\"bench\":\"region\",\"region\":\"%s\",\"functions\":\"%s\","
+               "\"unit\":\"blocks\",\"samples\":%llu,\"min\":%llu,\"avg\":%llu,\"max\":%llu}\n",
+               r->name, r->funcs, r->samples, r->min,
+               r->samples ? r->sum / r->samples : 0, r->max);
+    }
+}
+
+void __sanitizer_cov_trace_pc(void)
+{
+    blocks++;
+}
+
+void __cyg_profile_func_enter(void *fn, void *site)
+{
+    int i;
+
+    (void) site;
+    for (i = 0; i < nprobes; i++)
+    {
+        if (probes[i].fn == fn && !probes[i].region->open)
+        {
+            probes[i].region->open = 1;
+            probes[i].region->t0 = blocks;
+        }
+    }
+}
+
+void __cyg_profile_func_exit(void *fn, void *site)
+{
+    host_region_t *r;
+    unsigned long long n;
+    int i;
+
+    (void) site;
+    for (i = 0; i < nprobes; i++)
+    {
+        r = probes[i].region;
+        if (probes[i].fn == fn && r->open)
+        {
+            r->open = 0;
+            n = blocks - r->t0;
+            if (!r->samples || n < r->min)
+            {
+                r->min = n;
+            }
+            if (n > r->max)
+            {
+                r->max = n;
+            }
+            r->sum += n;
+            r->samples++;
+        }
+    }
+}
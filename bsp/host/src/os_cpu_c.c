@@ -0,0 +1,298 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*
+*                                         POSIX (Linux) host port
+*
+* Native builds of the IL 2206 lab applications on Linux, to run and measure control and kernel
+* changes in seconds without the board. The kernel, the applications and the common modules are the
+* same sources as for the DE2 system, see the Makefile.
+*
+* Tasks:       every task runs on a ucontext of its own with a host stack (HOST_TASK_STACKSIZE, the C
+*              library runs on it). The stack passed to OSTaskCreate() only holds a start frame with
+*              the task and its argument, OSTCBStkPtr points to it like to the saved context on the
+*              board. The context of a task is found by the index of its TCB in OSTCBTbl[], so
+*              OSTCBStkPtr can be rewritten like basic_task.c does.
+*
+* Switches:    OSCtxSw() and OSIntCtxSw() are swapcontext(). Tasks switch with interrupts disabled
+*              only and resume in that critical section, so the interrupt enable flag goes with them.
+*
+* Tick:        SIGALRM of an interval timer at OS_TICKS_PER_SEC (host_hal.c). Its handler is the
+*              interrupt, OSIntEnter(), alt_tick(), the device ISRs and OSIntExit(), which switches
+*              tasks from inside the handler, or from alt_irq_enable_all() for a tick that came in a
+*              critical section. The handler frame stays on the stack of the interrupted
+*              task and returns when that task runs again, like its saved registers on the board.
+*              In virtual time (--virtual) the idle task takes the next tick at once, the time the CPU
+*              would idle is skipped.
+*
+* Critical     OS_ENTER_CRITICAL() clears the interrupt enable flag of sys/alt_irq.h, the signal
+* sections:    is left unblocked and only requests the tick then.
+*
+* The stack of a task is not used, so stack checks (OSTaskStkChk(), stack_mon) report the start frame
+* only; stack sizes are measured on the board or with tools/stackdepth.py.
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <ucontext.h>
+
+#define  OS_CPU_GLOBALS
+#include "includes.h"                   /* Standard includes for uC/OS-II */
+#include "system.h"
+#include "host.h"
+
+/* Host stack of each task, for the task, the C library and the tick handler */
+#ifndef HOST_TASK_STACKSIZE
+#define HOST_TASK_STACKSIZE (128 * 1024)
+#endif
+
+/* Start frame on the task stack, built by OSTaskStkInit() */
+typedef struct {
+    void  (*task)(void *pd);
+    void   *pdata;
+} host_frame_t;
+
+typedef struct {
+    ucontext_t   uc;
+    void        *stack;
+    void       (*task)(void *pd);
+    void        *pdata;
+} host_task_t;
+
+static host_task_t host_task[OS_MAX_TASKS + OS_N_SYS_TASKS];
+
+#if OS_TMR_EN > 0
+static  INT16U  OSTmrCtr;
+#endif
+
+static host_task_t *host_task_of(OS_TCB *ptcb)
+{
+    return &host_task[ptcb - OSTCBTbl];
+}
+
+/*
+ * First code of every task, like OSStartTsk of the Nios II port: a task
+ * starts with interrupts enabled, one that returns is deleted
+ */
+static void host_task_start(void)
+{
+    host_task_t *ht = host_task_of(OSTCBCur);
+
+    alt_irq_enable_all(ALT_IRQ_ENABLED);
+    ht->task(ht->pdata);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/*
+ * Sets up the context of 'ptcb' to start at 'task'. The host stack of a TCB
+ * is kept when its task is deleted and taken by the next one.
+ */
+static void host_task_init(OS_TCB *ptcb, void (*task)(void *pd), void *pdata)
+{
+    host_task_t *ht = host_task_of(ptcb);
+    alt_irq_context context;
+
+    // malloc() must not be interrupted by a task that allocates too
+    context = alt_irq_disable_all();
+    if (ht->stack == NULL)
+    {
+        ht->stack = malloc(HOST_TASK_STACKSIZE);
+        if (ht->stack == NULL)
+        {
+            perror("os_cpu_c: task stack");
+            exit(1);
+        }
+    }
+    getcontext(&ht->uc);
+    ht->uc.uc_stack.ss_sp = ht->stack;
+    ht->uc.uc_stack.ss_size = HOST_TASK_STACKSIZE;
+    ht->uc.uc_link = NULL;
+    sigdelset(&ht->uc.uc_sigmask, HOST_IRQ_SIGNAL);
+    makecontext(&ht->uc, host_task_start, 0);
+    ht->task = task;
+    ht->pdata = pdata;
+    alt_irq_enable_all(context);
+}
+
+static void host_switch(void)
+{
+    host_task_t *from = host_task_of(OSTCBCur);
+
+    OSTaskSwHook();
+    OSPrioCur = OSPrioHighRdy;
+    OSTCBCur = OSTCBHighRdy;
+    swapcontext(&from->uc, &host_task_of(OSTCBHighRdy)->uc);
+}
+
+/*
+*********************************************************************************************************
+*                                        START MULTITASKING
+*
+* Called by OSStart() with OSTCBCur = OSTCBHighRdy. The context of main() is not kept.
+*********************************************************************************************************
+*/
+void OSStartHighRdy(void)
+{
+    OSTaskSwHook();
+    OSRunning = OS_TRUE;
+    setcontext(&host_task_of(OSTCBHighRdy)->uc);
+}
+
+/*
+*********************************************************************************************************
+*                                   TASK LEVEL AND INTERRUPT LEVEL SWITCH
+*
+* Both are called with interrupts disabled; in OSIntCtxSw() the interrupted context is the one of the
+* handler, saved by swapcontext() like the other.
+*********************************************************************************************************
+*/
+void OSCtxSw(void)
+{
+    host_switch();
+}
+
+void OSIntCtxSw(void)
+{
+    host_switch();
+}
+
+/*
+*********************************************************************************************************
+*                                        INITIALIZE A TASK'S STACK
+*
+* Only the start frame goes onto the task stack, below 'pstk' like the frame of the Nios II port. The
+* context is set up from it by OSTCBInitHook(), once the TCB is known.
+*********************************************************************************************************
+*/
+OS_STK *OSTaskStkInit(void (*task)(void *pd), void *pdata, OS_STK *pstk, INT16U opt)
+{
+    host_frame_t *frame;
+
+    frame = (host_frame_t *) ((((uintptr_t) pstk) & ~(uintptr_t) 0x7) - sizeof(host_frame_t));
+    frame->task = task;
+    frame->pdata = pdata;
+    (void) opt;
+    return (OS_STK *) frame;
+}
+
+/*
+ * Restarts the task of 'ptcb', which is not running, at 'task' with a new
+ * start frame below 'ptos'. Replaces the frame surgery of basic_task.c.
+ */
+OS_STK *OSTaskStkRestart(OS_TCB *ptcb, OS_STK *ptos, void (*task)(void *pd), void *pdata)
+{
+    OS_STK *frame;
+
+    frame = OSTaskStkInit(task, pdata, ptos, 0);
+    host_task_init(ptcb, task, pdata);
+    return frame;
+}
+
+/*
+*********************************************************************************************************
+*                                          DEFAULT APPLICATION HOOKS
+*
+* For the applications that do not define them (app_hooks.c), the Nios II port of those does not call
+* them.
+*********************************************************************************************************
+*/
+#if OS_APP_HOOKS_EN > 0
+void ALT_WEAK App_TaskCreateHook(OS_TCB *ptcb) { (void) ptcb; }
+void ALT_WEAK App_TaskDelHook(OS_TCB *ptcb) { (void) ptcb; }
+void ALT_WEAK App_TaskIdleHook(void) { }
+void ALT_WEAK App_TaskStatHook(void) { }
+void ALT_WEAK App_TaskSwHook(void) { }
+void ALT_WEAK App_TCBInitHook(OS_TCB *ptcb) { (void) ptcb; }
+void ALT_WEAK App_TimeTickHook(void) { }
+#endif
+
+/*
+*********************************************************************************************************
+*                                           HOOKS
+*
+* The same as the Nios II port of the cruise control application.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN
+void OSTaskCreateHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskCreateHook(ptcb);
+#else
+    ptcb = ptcb;                       /* Prevent compiler warning */
+#endif
+}
+
+void OSTaskDelHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskDelHook(ptcb);
+#else
+    ptcb = ptcb;                       /* Prevent compiler warning */
+#endif
+}
+
+void OSTaskSwHook (void)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskSwHook();
+#endif
+}
+
+void OSTaskStatHook (void)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskStatHook();
+#endif
+}
+
+void OSTimeTickHook (void)
+{
+#if OS_TMR_EN > 0
+    OSTmrCtr++;
+    if (OSTmrCtr >= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC)) {
+        OSTmrCtr = 0;
+        OSTmrSignal();
+    }
+#endif
+#if OS_APP_HOOKS_EN > 0
+    App_TimeTickHook();
+#endif
+}
+
+void OSInitHookBegin(void)
+{
+#if OS_TMR_EN > 0
+    OSTmrCtr = 0;
+#endif
+}
+
+void OSInitHookEnd(void)
+{
+}
+
+/*
+ * The idle task waits for the next tick instead of spinning (host_idle()),
+ * the idle counter then counts ticks without another task
+ */
+void OSTaskIdleHook(void)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskIdleHook();
+#endif
+    host_idle();
+}
+
+void OSTCBInitHook(OS_TCB *ptcb)
+{
+    host_frame_t *frame = (host_frame_t *) ptcb->OSTCBStkPtr;
+
+    host_task_init(ptcb, frame->task, frame->pdata);
+#if OS_APP_HOOKS_EN > 0
+    App_TCBInitHook(ptcb);
+#endif
+}
+#endif
@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""Checks the cost of code regions of the applications against their budgets.
+
+Every application with a bench.json next to its run.sh is built, then run
+for a fixed time with the input events of its scenario on the executor
+of its bench.json:
+
+  niossim   the instruction-set simulator (tools/niossim.c) on the ELF of
+            the board build in bin/; counts the cycles of the Nios II/e
+            model
+  host      the build of the POSIX host port with REGIONS=1 (bsp/host,
+            src/host_region.c) in virtual time; counts the basic blocks
+            run in the application, the kernel and the HAL
+
+Either count depends only on the build and the scenario, not on the
+machine, so a change in the numbers is a change in the code. The budgets
+are in the unit of the executor that measured them.
+
+The regions are named groups of functions, timed from the call to the
+return (see --region in niossim.c and host_region.c), for instance:
+
+  tick          alt_tick, the system clock interrupt
+  ctx_switch    OSCtxSw (and OSIntCtxSw on the host), from the switch to
+                the return into the next task
+  sw_hook       OSTaskSwHook, the monitors of App_TaskSwHook() in a switch
+  control_step  cruise_control_step, the law of ControlTask
+  vehicle_step  cruise_vehicle_step, the model of VehicleTask
+  display       show_velocity_on_sevenseg, show_target_velocity, show_position
+
+bench.json of an application:
+
+  {
+   "executor": "niossim",
+   "time": "15s",
+   "events": ["0 sw 0x1", "0.5s key 0x8"],
+   "regions": {"tick": "alt_avalon_timer_sc_irq", "display": "show_position"},
+   "budgets": {"tick": {"avg": 5149, "max": 7057}},
+   "measured": {"executor": "niossim", "binary": "app/.../bin/cruisecontrol.elf", ...}
+  }
+
+The events are the ones of niossim (sw and key words, times in s or ms);
+for the host they become a script of the virtual board (host_board.c).
+
+The avg and max of every region are compared with its budget: the exit
+status is 1 when one of them is over by more than the threshold, when a
+region has no samples (renamed, not called, or an ELF older than the
+sources) or when it has no budget yet. --update writes the current numbers
+as the budgets, from a build of the current sources: budgets measured on
+an older ELF would pass code they have never seen. It records what
+measured them in "measured": the executor, the binary and the commit
+(-dirty with uncommitted changes). --json writes the
+results with the commit they were measured on, --history appends them as
+one line to a file to follow the trend across commits.
+
+usage: bench_budget.py [app/DONE_cruise_control ...] [--threshold 5] [--no-build]
+       bench_budget.py --update
+       bench_budget.py --json results.json --history bench_history.jsonl
+"""
+import argparse
+import glob
+import json
+import os
+import stat
+import subprocess
+import sys
+import tempfile
+import time
+
+PREFIX = "BENCH "
+METRICS = ("avg", "max")
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TOOLS = os.path.join(ROOT, "tools")
+NIOSSIM = os.path.join(TOOLS, "niossim")
+HOST = os.path.join(ROOT, "bsp", "host")
+EXECUTORS = ("niossim", "host")
+
+
+def build_sim():
+    """Compiles niossim when it is older than its source, like run.sh sim."""
+    source = NIOSSIM + ".c"
+    if os.path.exists(NIOSSIM) and os.path.getmtime(NIOSSIM) >= os.path.getmtime(source):
+        return
+    subprocess.check_call(["cc", "-O2", "-o", NIOSSIM, source])
+
+
+def host_app(app):
+    """The name of the application for the host Makefile (APP=)."""
+    name = os.path.basename(os.path.normpath(app))
+    return name[len("DONE_"):] if name.startswith("DONE_") else name
+
+
+def build_app(app, executor):
+    """Builds the application with the makefile run.sh generated in gen/,
+    or the host port with the regions."""
+    if executor == "host":
+        if subprocess.call(["make", "-C", HOST, "REGIONS=1", "APP=" + host_app(app)],
+                           stdout=subprocess.DEVNULL) != 0:
+            sys.exit("%s: host build failed" % app)
+        return
+    gen = os.path.join(app, "gen")
+    if not os.path.exists(os.path.join(gen, "Makefile")):
+        sys.exit("%s: no gen/Makefile, run ./run.sh once to generate it" % app)
+    if subprocess.call(["make", "-C", gen], stdout=subprocess.DEVNULL) != 0:
+        sys.exit("%s: build failed" % app)
+
+
+def find_elf(app):
+    elfs = glob.glob(os.path.join(app, "bin", "*.elf"))
+    if len(elfs) != 1:
+        sys.exit("%s: expected one ELF in bin/, found %d" % (app, len(elfs)))
+    return elfs[0]
+
+
+def find_host_binary(app):
+    build = os.path.join(HOST, "build", host_app(app) + "-regions")
+    binaries = [p for p in glob.glob(os.path.join(build, "*"))
+                if os.path.isfile(p) and os.stat(p).st_mode & stat.S_IXUSR]
+    if len(binaries) != 1:
+        sys.exit("%s: expected one program in %s, found %d" % (app, build, len(binaries)))
+    return binaries[0]
+
+
+def seconds(text):
+    """A time of niossim (s, ms, us or no unit for s) in seconds."""
+    for unit, scale in (("ms", 1e-3), ("us", 1e-6), ("s", 1.0)):
+        if text.endswith(unit):
+            return float(text[:-len(unit)]) * scale
+    return float(text)
+
+
+def host_script(app, config):
+    """Writes the events as a script of the virtual board, returns its path."""
+    kinds = {"sw": "switches", "key": "keys"}
+    script = tempfile.NamedTemporaryFile("w", prefix="bench_", suffix=".script", delete=False)
+    with script:
+        for event in config.get("events", []):
+            time_, kind, value = (event.split(None, 2) + ["", ""])[:3]
+            if kind not in kinds:
+                sys.exit("%s: event '%s' has no host equivalent" % (app, event))
+            script.write("%d %s %s\n" % (round(seconds(time_) * 1000), kinds[kind], value))
+    return script.name
+
+
+def run(app, config):
+    """Runs the scenario, returns {region: result} from the BENCH lines."""
+    regions = []
+    for name, funcs in sorted(config["regions"].items()):
+        regions += ["--region", "%s=%s" % (name, funcs)]
+    script = None
+    if config.get("executor", "niossim") == "host":
+        script = host_script(app, config)
+        cmd = [find_host_binary(app), "--virtual", "--script", script,
+               "--time", "%g" % seconds(config.get("time", "10s"))] + regions
+    else:
+        cmd = [NIOSSIM, find_elf(app), "--time", config.get("time", "10s"), "--quiet"]
+        for event in config.get("events", []):
+            cmd += ["--event", event]
+        cmd += regions
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True, errors="replace")
+    if script:
+        os.unlink(script)
+    if proc.returncode != 0:
+        sys.exit("%s: %s failed\n%s" % (app, os.path.basename(cmd[0]), proc.stderr))
+    for line in proc.stderr.splitlines():
+        print("  " + line)
+    results = {}
+    for line in proc.stdout.splitlines():
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        try:
+            obj = json.loads(line[pos + len(PREFIX):])
+        except ValueError:
+            continue
+        if obj.get("bench") == "region":
+            results[obj["region"]] = obj
+    return results
+
+
+def check(app, config, results, threshold):
+    """Prints the regions against their budgets, returns (rows, regressions)."""
+    budgets = config.get("budgets", {})
+    rows = []
+    regressions = 0
+    for name in sorted(config["regions"]):
+        result = results.get(name, {})
+        budget = budgets.get(name)
+        row = {"app": os.path.basename(os.path.normpath(app)), "region": name,
+               "functions": config["regions"][name], "budget": budget}
+        for key in ("samples", "min", "avg", "max"):
+            row[key] = result.get(key, 0)
+        if not row["samples"]:
+            row["status"] = "missing"
+            regressions += 1
+        elif not budget:
+            row["status"] = "new"
+            regressions += 1
+        else:
+            row["status"] = "ok"
+            for metric in METRICS:
+                limit = budget[metric] * (1 + threshold / 100.0)
+                if row[metric] > limit:
+                    row["status"] = "OVER"
+            regressions += row["status"] == "OVER"
+        rows.append(row)
+
+        if row["samples"] and budget:
+            print("%-10s %-14s %6d samples  avg %8d / %-8d  max %8d / %d"
+                  % (row["status"], name, row["samples"], row["avg"], budget["avg"],
+                     row["max"], budget["max"]))
+        else:
+            print("%-10s %-14s %6d samples  avg %8d  max %8d"
+                  % (row["status"], name, row["samples"], row["avg"], row["max"]))
+    return rows, regressions
+
+
+def commit(dirty=False):
+    try:
+        head = subprocess.check_output(["git", "-C", ROOT, "rev-parse", "--short", "HEAD"],
+                                       universal_newlines=True).strip()
+        if dirty and subprocess.check_output(["git", "-C", ROOT, "status", "--porcelain",
+                                              "--untracked-files=no"]).strip():
+            head += "-dirty"
+        return head
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("apps", nargs="*",
+                        help="application directories (default every app with a bench.json)")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="allowed excess over the budget in percent (default 5)")
+    parser.add_argument("--no-build", action="store_true",
+                        help="run the ELFs in bin/ as they are")
+    parser.add_argument("--update", action="store_true",
+                        help="store the current numbers as the budgets")
+    parser.add_argument("--json", help="write the results to this file")
+    parser.add_argument("--history", help="append the results as one line to this file")
+    args = parser.parse_args()
+
+    apps = args.apps or sorted(os.path.dirname(p) for p in
+                               glob.glob(os.path.join(ROOT, "app", "*", "bench.json")))
+
+    rows = []
+    regressions = 0
+    for app in apps:
+        path = os.path.join(app, "bench.json")
+        with open(path) as stored:
+            config = json.load(stored)
+        executor = config.get("executor", "niossim")
+        if executor not in EXECUTORS:
+            sys.exit("%s: unknown executor %s" % (path, executor))
+        if executor == "niossim":
+            build_sim()
+        if not args.no_build:
+            build_app(app, executor)
+        print("%s (%s):" % (os.path.basename(os.path.normpath(app)), executor))
+        results = run(app, config)
+        app_rows, app_regressions = check(app, config, results, args.threshold)
+        rows += app_rows
+        regressions += app_regressions
+        if args.update:
+            config["budgets"] = {r["region"]: {m: r[m] for m in METRICS}
+                                 for r in app_rows if r["samples"]}
+            binary = find_host_binary(app) if executor == "host" else find_elf(app)
+            config["measured"] = {"executor": executor,
+                                  "binary": os.path.relpath(os.path.abspath(binary), ROOT),
+                                  "unit": "blocks" if executor == "host" else "cycles",
+                                  "commit": commit(dirty=True),
+                                  "date": time.strftime("%Y-%m-%d")}
+            with open(path, "w") as out:
+                json.dump(config, out, indent=1, sort_keys=True)
+                out.write("\n")
+
+    report = {"commit": commit(), "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+              "threshold": args.threshold, "results": rows}
+    if args.json:
+        with open(args.json, "w") as out:
+            json.dump(report, out, indent=1, sort_keys=True)
+            out.write("\n")
+    if args.history:
+        with open(args.history, "a") as out:
+            out.write(json.dumps(report, sort_keys=True) + "\n")
+
+    print("%d region(s) over budget by more than %.1f%%, without samples or without a budget"
+          % (regressions, args.threshold))
+    return 0 if args.update else (1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
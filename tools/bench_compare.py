@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Compares two benchmark logs captured from nios2-terminal.
+
+Every result line of the benchmark applications starts with "BENCH " followed
+by a JSON object. Results are matched on their identifying keys (everything
+that is not a number) and the numeric metrics of the new run are compared with
+the baseline. The exit status is 1 if any metric got slower by more than the
+threshold.
+
+usage: bench_compare.py baseline.log new.log [--threshold 10] [--metric p50 ...]
+"""
+import argparse
+import json
+import sys
+
+PREFIX = "BENCH "
+DEFAULT_METRICS = ["p50", "p99", "rt_p50"]
+
+
+def load(path):
+    """Returns {key: result} for all result lines of a log."""
+    results = {}
+    with open(path, errors="replace") as log:
+        for line in log:
+            pos = line.find(PREFIX)
+            if pos < 0:
+                continue
+            try:
+                obj = json.loads(line[pos + len(PREFIX):])
+            except ValueError:
+                continue
+            key = tuple(sorted((k, v) for k, v in obj.items()
+                               if isinstance(v, str) or k in ("waiters", "load", "n")))
+            if key:
+                results[key] = obj
+    return results
+
+
+def describe(key):
+    return " ".join("%s=%s" % kv for kv in key)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    parser.add_argument("--metric", action="append",
+                        help="metric to compare, may be repeated (default %s)"
+                        % ", ".join(DEFAULT_METRICS))
+    args = parser.parse_args()
+    metrics = args.metric or DEFAULT_METRICS
+
+    base = load(args.baseline)
+    new = load(args.new)
+    regressions = 0
+
+    for key in sorted(base):
+        if key not in new:
+            print("missing   %s" % describe(key))
+            continue
+        for metric in metrics:
+            old_value = base[key].get(metric)
+            new_value = new[key].get(metric)
+            if not isinstance(old_value, (int, float)) or not isinstance(new_value, (int, float)):
+                continue
+            change = 100.0 * (new_value - old_value) / old_value if old_value else 0.0
+            status = "ok"
+            if change > args.threshold:
+                status = "SLOWER"
+                regressions += 1
+            elif change < -args.threshold:
+                status = "faster"
+            print("%-7s %-40s %-7s %8d -> %8d (%+.1f%%)"
+                  % (status, describe(key), metric, old_value, new_value, change))
+
+    for key in sorted(set(new) - set(base)):
+        print("new       %s" % describe(key))
+
+    print("%d regression(s) above %.1f%%" % (regressions, args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
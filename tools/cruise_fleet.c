@@ -0,0 +1,497 @@
+/* Fleet simulator of the cruise control on the host
+ *
+ * Steps N vehicles, each with its own mass, wind factor and track, through
+ * the drive of tools/cruise_sweep.c (gas in top gear up to --engage, then
+ * the cruise key) with the physics of VehicleTask and the laws of
+ * ControlTask (app/DONE_cruise_control/src/cruise_law.c). The state is kept
+ * structure-of-arrays, one array per variable, and every law is a loop
+ * without branches over a block of vehicles that the compiler vectorizes:
+ *
+ *   position, velocity     int32, like the INT16U/INT16S of the task
+ *   throttle, target       int32, wrapped to 8 bits like the INT8U
+ *   wind, 1 / mass         float, the forces are truncated to integral
+ *                          accelerations like the INT16S of the task
+ *   phase                  gas pedal, cruising, or coasting
+ *
+ * The vehicles are grouped by track so the grades are loop invariants, and
+ * a block of BLOCK vehicles runs all the steps while it is in the cache.
+ * The blocks are shared among --threads threads, one per core by default.
+ *
+ * A vehicle of mass 1 and wind factor 1 is the vehicle of the lab: --check
+ * steps such a fleet next to the scalar cruise_law.c on every track and
+ * stops at the first difference. The 16-bit wrap of the task's velocity
+ * and position is not modelled, the drive does not reach it.
+ *
+ * Output: the drive of the fleet and the throughput in vehicle-steps per
+ * second; --scale runs fleets of 1, 10, ... up to --vehicles vehicles on
+ * one thread and on --threads threads instead.
+ *
+ * Build: cc -O3 -march=native -fno-trapping-math -pthread -Iapp/DONE_cruise_control/src \
+ *            -o tools/cruise_fleet tools/cruise_fleet.c app/DONE_cruise_control/src/cruise_law.c
+ *
+ * usage: cruise_fleet [--vehicles 100000] [--mass 0.8:1.5] [--wind 0.5:1.5]
+ *                     [--kp 1] [--kp-div 1] [--dt 1] [--min-target 29]
+ *                     [--period 300] [--engage 25] [--time 120] [--band 1]
+ *                     [--seed S] [--threads N] [--scale] [--check]
+ */
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cruise_law.h"
+#include "cruise_tracks.h"
+
+/* Vehicles stepped together, the state of a block fits the L1 cache */
+#define BLOCK 1024
+
+enum { PHASE_GAS, PHASE_CRUISE, PHASE_COAST };
+
+/* The fleet, structure-of-arrays; vehicles [first[t], first[t + 1]) drive track t */
+typedef struct {
+    long     n;
+    long     first[NTRACKS + 1];
+    int32_t *position, *velocity;
+    float   *wind, *inv_mass;
+    int32_t *throttle, *target, *phase;
+} fleet_t;
+
+/* Drive and law, the same for the whole fleet */
+static cruise_gains_t gains = CRUISE_GAINS_DEFAULT;
+static int    opt_period = 300;
+static double opt_engage = 25, opt_time = 120, opt_band = 1;
+static double mass_min = 0.8, mass_max = 1.5, wind_min = 0.5, wind_max = 1.5;
+static unsigned long long opt_seed = 1;
+
+static void die(const char *msg, const char *arg)
+{
+    fprintf(stderr, "cruise_fleet: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(2);
+}
+
+static double seconds(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static unsigned long long splitmix(unsigned long long *s)
+{
+    unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double uniform(unsigned long long *s, double min, double max)
+{
+    return min + (max - min) * (splitmix(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void *array(long n, size_t size)
+{
+    void *p;
+
+    if (posix_memalign(&p, 64, n > 0 ? n * size : 64) != 0)
+        die("out of memory", NULL);
+    return p;
+}
+
+/*
+ * A fleet of 'n' at rest with the engine on, the tracks drawn at random
+ * (all of them lab vehicles of mass and wind 1 with 'lab')
+ */
+static void fleet_init(fleet_t *f, long n, int lab)
+{
+    static const cruise_control_t control = CRUISE_CONTROL_INIT;
+    unsigned long long s = opt_seed, r;
+    long count[NTRACKS] = { 0 }, next[NTRACKS], i, j;
+    int t;
+
+    memset(f, 0, sizeof(*f));
+    f->n = n;
+    f->position = array(n, sizeof(int32_t));
+    f->velocity = array(n, sizeof(int32_t));
+    f->wind = array(n, sizeof(float));
+    f->inv_mass = array(n, sizeof(float));
+    f->throttle = array(n, sizeof(int32_t));
+    f->target = array(n, sizeof(int32_t));
+    f->phase = array(n, sizeof(int32_t));
+
+    for (i = 0; i < n; i++)
+        count[lab ? i % NTRACKS : (long) (splitmix(&s) % NTRACKS)]++;
+    for (t = 0; t < NTRACKS; t++) {
+        f->first[t + 1] = f->first[t] + count[t];
+        next[t] = f->first[t];
+    }
+    s = opt_seed;
+    for (i = 0; i < n; i++) {
+        t = lab ? i % NTRACKS : (int) (splitmix(&s) % NTRACKS);
+        r = opt_seed + i * 0x100000001B3ULL;
+        j = next[t]++;
+        f->position[j] = 0;
+        f->velocity[j] = 0;
+        f->wind[j] = lab ? 1 : uniform(&r, wind_min, wind_max);
+        f->inv_mass[j] = lab ? 1 : 1 / uniform(&r, mass_min, mass_max);
+        f->throttle[j] = control.throttle;
+        f->target[j] = 0;
+        f->phase[j] = PHASE_GAS;
+    }
+}
+
+static void fleet_free(fleet_t *f)
+{
+    free(f->position);
+    free(f->velocity);
+    free(f->wind);
+    free(f->inv_mass);
+    free(f->throttle);
+    free(f->target);
+    free(f->phase);
+}
+
+/*
+ * One period of VehicleTask and then of ControlTask for the vehicles
+ * [b, e) of track 't'
+ */
+static void fleet_step(fleet_t *f, long b, long e, const cruise_track_t *t)
+{
+    int32_t *restrict position = f->position + b, *restrict velocity = f->velocity + b;
+    const float *restrict wind = f->wind + b, *restrict inv_mass = f->inv_mass + b;
+    int32_t *restrict throttle = f->throttle + b, *restrict target = f->target + b;
+    int32_t *restrict phase = f->phase + b;
+    float force[BLOCK], gravity;
+    const int32_t length = t->length, period = opt_period;
+    const int32_t engage = (int32_t) ceil(opt_engage), min_target = gains.min_target;
+    const int32_t min_velocity = gains.min_velocity, kp = gains.kp, law_dt = gains.dt;
+    const int32_t gas = gains.gas_top;
+    const float kp_div = gains.kp_div;
+    int32_t from, to;
+    long n = e - b, i;
+    int g;
+
+    // VehicleTask: the throttle is capped, the engine is on
+    for (i = 0; i < n; i++) {
+        throttle[i] = throttle[i] > CRUISE_THROTTLE_MAX ? CRUISE_THROTTLE_MAX : throttle[i];
+        force[i] = throttle[i] - wind[i] * velocity[i];
+    }
+    for (g = 0; g < t->grades; g++) {
+        from = t->grade[g].from;
+        to = t->grade[g].to;
+        gravity = t->grade[g].gravity;
+        for (i = 0; i < n; i++)
+            force[i] += ((position[i] >= from) & (position[i] < to)) ? gravity : 0.0f;
+    }
+    // The divisions by 1000 in float truncate like the integer and the
+    // double ones of the task for these magnitudes, and vectorize
+    for (i = 0; i < n; i++) {
+        int32_t acceleration = (int32_t) (force[i] * inv_mass[i]);
+        int32_t p = position[i] + (int32_t) ((float) (velocity[i] * period) / 1000.0f);
+
+        position[i] = ((p > length) | (p < 0)) ? 0 : p;
+        velocity[i] = (int32_t) ((float) (velocity[i] * 1000 + acceleration * period) / 1000.0f);
+    }
+
+    // ControlTask: gas, the cruise key at --engage, then laws 2 and 3
+    for (i = 0; i < n; i++) {
+        int32_t v = velocity[i], v8 = v & 0xFF, th = throttle[i], tg = target[i], ph = phase[i];
+        int32_t gassing = ph == PHASE_GAS;
+        int32_t engaging = gassing & (v >= engage);
+        int32_t cruising = ((ph == PHASE_CRUISE) | engaging) & (v >= min_velocity);
+        int32_t lowest = v8 < min_target ? min_target : v8, delta;
+
+        tg = engaging ? lowest : tg;
+        delta = (int32_t) ((float) (kp * (tg - v8)) / kp_div);
+        delta = (int16_t) delta;
+        gassing &= !engaging;
+        th = gassing ? gas : th;
+        throttle[i] = cruising ? (th + delta * law_dt) & 0xFF : th;
+        target[i] = cruising ? tg : 0;
+        phase[i] = cruising ? PHASE_CRUISE : gassing ? PHASE_GAS : PHASE_COAST;
+    }
+}
+
+/*
+ * Threads: the blocks of all tracks form a work queue, a block runs all
+ * the steps at once
+ */
+typedef struct {
+    fleet_t *fleet;
+    long     steps;
+    long     next;      /* block */
+    pthread_mutex_t lock;
+} run_t;
+
+static int block_of(const fleet_t *f, long k, long *b, long *e)
+{
+    long blocks;
+    int t;
+
+    for (t = 0; t < NTRACKS; t++) {
+        blocks = (f->first[t + 1] - f->first[t] + BLOCK - 1) / BLOCK;
+        if (k < blocks) {
+            *b = f->first[t] + k * BLOCK;
+            *e = *b + BLOCK < f->first[t + 1] ? *b + BLOCK : f->first[t + 1];
+            return t;
+        }
+        k -= blocks;
+    }
+    return -1;
+}
+
+static void *worker(void *arg)
+{
+    run_t *r = arg;
+    long k, b, e, s;
+    int t;
+
+    for (;;) {
+        pthread_mutex_lock(&r->lock);
+        k = r->next++;
+        pthread_mutex_unlock(&r->lock);
+        if ((t = block_of(r->fleet, k, &b, &e)) < 0)
+            return NULL;
+        for (s = 0; s < r->steps; s++)
+            fleet_step(r->fleet, b, e, tracks[t]);
+    }
+}
+
+static double fleet_run(fleet_t *f, long steps, int threads)
+{
+    pthread_t pool[256];
+    run_t r;
+    double t0;
+    int i;
+
+    r.fleet = f;
+    r.steps = steps;
+    r.next = 0;
+    pthread_mutex_init(&r.lock, NULL);
+    t0 = seconds();
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&pool[i], NULL, worker, &r) != 0)
+            die("cannot create the threads", NULL);
+    }
+    for (i = 0; i < threads; i++)
+        pthread_join(pool[i], NULL);
+    t0 = seconds() - t0;
+    pthread_mutex_destroy(&r.lock);
+    return t0;
+}
+
+/*
+ * --check: a lab fleet against cruise_law.c, step by step
+ */
+static int check(long steps)
+{
+    cruise_control_t c;
+    cruise_vehicle_t v;
+    fleet_t f;
+    long i, s, b, e;
+    int t, inputs, phase;
+    int16_t acceleration;
+
+    fleet_init(&f, 64 * NTRACKS, 1);
+    for (t = 0; t < NTRACKS; t++) {
+        b = f.first[t];
+        e = f.first[t + 1];
+        // Different engagement velocities along the block
+        for (i = b; i < e; i++)
+            f.velocity[i] = i - b;
+        for (i = b; i < e; i++) {
+            c = (cruise_control_t) CRUISE_CONTROL_INIT;
+            v.position = 0;
+            v.velocity = (int16_t) (i - b);
+            phase = PHASE_GAS;
+            for (s = 0; s < steps; s++) {
+                if (c.throttle > CRUISE_THROTTLE_MAX)
+                    c.throttle = CRUISE_THROTTLE_MAX;
+                acceleration = cruise_vehicle_accel(&v, tracks[t], c.throttle, 0, 1);
+                cruise_vehicle_move(&v, tracks[t], acceleration, opt_period);
+                inputs = CRUISE_ENGINE | CRUISE_TOP_GEAR;
+                if (phase == PHASE_GAS && v.velocity >= opt_engage)
+                    inputs |= CRUISE_BUTTON;
+                else if (phase == PHASE_GAS)
+                    inputs |= CRUISE_GAS;
+                if (cruise_control_step(&c, &gains, v.velocity, inputs) & CRUISE_CRUISING)
+                    phase = PHASE_CRUISE;
+                else if (phase != PHASE_GAS || (inputs & CRUISE_BUTTON))
+                    phase = PHASE_COAST;
+                fleet_step(&f, i, i + 1, tracks[t]);
+                if (f.position[i] != v.position || f.velocity[i] != v.velocity
+                    || f.throttle[i] != c.throttle || f.target[i] != c.target_velocity) {
+                    printf("check: %s vehicle %ld differs at step %ld: position %d/%u, velocity %d/%d, "
+                           "throttle %d/%u, target %d/%u (fleet/law)\n", tracks[t]->name, i - b, s,
+                           f.position[i], v.position, f.velocity[i], v.velocity,
+                           f.throttle[i], c.throttle, f.target[i], c.target_velocity);
+                    fleet_free(&f);
+                    return 1;
+                }
+            }
+        }
+    }
+    printf("check: %ld vehicles, %ld steps, the fleet steps like cruise_law.c\n", f.n, steps);
+    fleet_free(&f);
+    return 0;
+}
+
+/*
+ * Runs of at least 0.2 s, the fastest of three
+ */
+static double throughput(long n, long steps, int threads)
+{
+    fleet_t f;
+    double best = 0, t, rate;
+    long reps, r;
+    int k;
+
+    fleet_init(&f, n, 0);
+    t = fleet_run(&f, steps, threads);
+    reps = t > 0 ? (long) (0.2 / t) + 1 : 1000;
+    for (k = 0; k < 3; k++) {
+        t = 0;
+        for (r = 0; r < reps; r++) {
+            fleet_free(&f);
+            fleet_init(&f, n, 0);
+            t += fleet_run(&f, steps, threads);
+        }
+        rate = (double) n * steps * reps / t;
+        best = rate > best ? rate : best;
+    }
+    fleet_free(&f);
+    return best;
+}
+
+static void report(const fleet_t *f, long steps, int threads, double t)
+{
+    long i, cruising, settled;
+    double error;
+    int tr;
+
+    printf("# track  vehicles  cruising  within_band  mean_error\n");
+    for (tr = 0; tr < NTRACKS; tr++) {
+        cruising = settled = 0;
+        error = 0;
+        for (i = f->first[tr]; i < f->first[tr + 1]; i++) {
+            if (f->phase[i] != PHASE_CRUISE)
+                continue;
+            cruising++;
+            settled += abs(f->target[i] - f->velocity[i]) <= opt_band;
+            error += abs(f->target[i] - f->velocity[i]);
+        }
+        printf("  %-5s  %8ld  %8ld  %11ld  %10.2f\n", tracks[tr]->name, f->first[tr + 1] - f->first[tr],
+               cruising, settled, cruising ? error / cruising : 0.0);
+    }
+    printf("cruise_fleet: %ld vehicles, %ld steps of %d ms, %d threads, %.3f s, %.3g vehicle-steps/s\n",
+           f->n, steps, opt_period, threads, t, t > 0 ? f->n * steps / t : 0.0);
+}
+
+static void range(const char *text, double *min, double *max)
+{
+    char *end;
+
+    *min = *max = strtod(text, &end);
+    if (*end == ':')
+        *max = strtod(end + 1, &end);
+    if (end == text || *end != '\0' || *min <= 0 || *max < *min)
+        die("bad range", text);
+}
+
+static int byte(const char *text, int min)
+{
+    char *end;
+    long v = strtol(text, &end, 0);
+
+    if (end == text || *end != '\0' || v < min || v > 255)
+        die("bad value", text);
+    return (int) v;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: cruise_fleet [--vehicles N] [--mass MIN:MAX] [--wind MIN:MAX]\n"
+            "                    [--kp N] [--kp-div N] [--dt N] [--min-target M/S]\n"
+            "                    [--period MS] [--engage M/S] [--time S] [--band M/S]\n"
+            "                    [--seed S] [--threads N] [--scale] [--check]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        { "vehicles",   required_argument, NULL, 'n' },
+        { "mass",       required_argument, NULL, 'm' },
+        { "wind",       required_argument, NULL, 'w' },
+        { "kp",         required_argument, NULL, 'k' },
+        { "kp-div",     required_argument, NULL, 'K' },
+        { "dt",         required_argument, NULL, 'd' },
+        { "min-target", required_argument, NULL, 'M' },
+        { "period",     required_argument, NULL, 'p' },
+        { "engage",     required_argument, NULL, 'e' },
+        { "time",       required_argument, NULL, 't' },
+        { "band",       required_argument, NULL, 'b' },
+        { "seed",       required_argument, NULL, 's' },
+        { "threads",    required_argument, NULL, 'j' },
+        { "scale",      no_argument,       NULL, 'S' },
+        { "check",      no_argument,       NULL, 'c' },
+        { NULL, 0, NULL, 0 }
+    };
+    long vehicles = 100000, steps, n;
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN), scale = 0, checking = 0, opt;
+    fleet_t f;
+    double t;
+
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (opt) {
+        case 'n': vehicles = atol(optarg); break;
+        case 'm': range(optarg, &mass_min, &mass_max); break;
+        case 'w': range(optarg, &wind_min, &wind_max); break;
+        case 'k': gains.kp = byte(optarg, 1); break;
+        case 'K': gains.kp_div = byte(optarg, 1); break;
+        case 'd': gains.dt = byte(optarg, 1); break;
+        case 'M': gains.min_target = byte(optarg, 0); break;
+        case 'p': opt_period = atoi(optarg); break;
+        case 'e': opt_engage = atof(optarg); break;
+        case 't': opt_time = atof(optarg); break;
+        case 'b': opt_band = atof(optarg); break;
+        case 's': opt_seed = strtoull(optarg, NULL, 0); break;
+        case 'j': threads = atoi(optarg); break;
+        case 'S': scale = 1; break;
+        case 'c': checking = 1; break;
+        default: usage();
+        }
+    }
+    if (optind != argc || vehicles < 1 || opt_period < 1 || opt_time <= 0)
+        usage();
+    threads = threads < 1 ? 1 : threads > 256 ? 256 : threads;
+    steps = (long) (opt_time * 1000 / opt_period);
+    if (steps < 1)
+        usage();
+    if (checking)
+        return check(steps);
+
+    if (scale) {
+        printf("# vehicles  vehicle-steps/s  (1 thread)  vehicle-steps/s  (%d threads)\n", threads);
+        for (n = 1; n <= vehicles; n *= 10) {
+            printf("  %8ld  %15.3g  %28.3g\n", n, throughput(n, steps, 1),
+                   throughput(n, steps, threads));
+            fflush(stdout);
+        }
+        return 0;
+    }
+
+    fleet_init(&f, vehicles, 0);
+    t = fleet_run(&f, steps, threads);
+    report(&f, steps, threads, t);
+    fleet_free(&f);
+    return 0;
+}
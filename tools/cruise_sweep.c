@@ -0,0 +1,447 @@
+/* Parameter sweep of the cruise control laws on the host
+ *
+ * Runs the vehicle model and the control law of the cruise control
+ * (app/DONE_cruise_control/src/cruise_law.c, the code of the tasks) as a
+ * pure step function for every configuration of a grid, or a random sample
+ * of it, on a pool of threads, one per core by default. A configuration is
+ * the gains of the law, the periods of ControlTask and VehicleTask and the
+ * track; all of them run the same drive:
+ *
+ *   engine on, top gear, gas pedal down until the velocity reaches
+ *   --engage, then the cruise key for one activation of the control, and
+ *   --time seconds of cruising from there
+ *
+ * and are measured from the activation of the cruise control:
+ *
+ *   settle     s until the velocity stays within --band m/s of the target,
+ *              "-" if it does not by the end
+ *   overshoot  largest velocity above the target, m/s
+ *   error      mean |target - velocity|, m/s
+ *   effort     mean throttle (0..80)
+ *   activity   mean |throttle change| per second
+ *
+ * A list of values is a comma separated list of numbers or ranges,
+ * FIRST:LAST or FIRST:LAST:STEP, e.g. --kp 1:8 --kp-div 1,2,4. The grid is
+ * every combination of the lists; --random N draws N configurations from
+ * them instead, the same ones for the same --seed whatever the threads.
+ *
+ * Output, one CSV line per configuration in grid order (or the --best N by
+ * --sort), and the throughput on stderr:
+ *
+ *   kp,kp_div,dt,min_target,control_ms,vehicle_ms,track,target,settle_s,overshoot,error,effort,activity
+ *   1,1,1,29,300,300,lab,29,4.5,13,0.23,30.8,0.78
+ *
+ * Build: cc -O2 -pthread -Iapp/DONE_cruise_control/src -o tools/cruise_sweep \
+ *            tools/cruise_sweep.c app/DONE_cruise_control/src/cruise_law.c
+ *
+ * usage: cruise_sweep [--kp 1:8] [--kp-div 1,2,4] [--dt 1] [--min-target 29]
+ *                     [--control-period 100:500:100] [--vehicle-period 300]
+ *                     [--track lab,flat,hills,steep|all] [--random N [--seed S]]
+ *                     [--engage 25] [--time 120] [--band 1]
+ *                     [--best N [--sort settle|overshoot|error|effort|activity]]
+ *                     [--threads N]
+ */
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cruise_law.h"
+#include "cruise_tracks.h"
+
+/* Swept parameters, in the order of the CSV columns */
+enum { P_KP, P_KP_DIV, P_DT, P_MIN_TARGET, P_CONTROL, P_VEHICLE, P_TRACK, NPARAMS };
+
+/* getopt codes of the lists, past the characters */
+#define OPT_PARAM 256
+
+static const struct {
+    const char *option;
+    int         min, max;
+    const char *def;
+} param_info[NPARAMS] = {
+    { "kp",             1,   255, "1" },
+    { "kp-div",         1,   255, "1" },
+    { "dt",             1,   255, "1" },
+    { "min-target",     0,   255, "29" },
+    { "control-period", 1, 10000, "300" },
+    { "vehicle-period", 1, 10000, "300" },
+    { "track",          0, NTRACKS - 1, "lab" },
+};
+
+typedef struct {
+    int *v;
+    int  n;
+} list_t;
+
+static list_t params[NPARAMS];
+
+typedef struct {
+    int    target;
+    double settle, overshoot, error, effort, activity;
+} result_t;
+
+enum { S_SETTLE, S_OVERSHOOT, S_ERROR, S_EFFORT, S_ACTIVITY };
+static const char *sort_names[] = { "settle", "overshoot", "error", "effort", "activity" };
+
+static double opt_engage = 25, opt_time = 120, opt_band = 1;
+static long   opt_random;
+static unsigned long long opt_seed = 1;
+
+static long      nconfigs;
+static result_t *results;
+
+/* Work queue of the pool: configurations are taken in chunks */
+#define CHUNK 256
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static long next_config;
+
+static void die(const char *msg, const char *arg)
+{
+    fprintf(stderr, "cruise_sweep: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(2);
+}
+
+/*
+ * Lists
+ */
+static void list_add(list_t *l, int v)
+{
+    if ((l->n & (l->n - 1)) == 0)
+        l->v = realloc(l->v, (l->n ? 2 * l->n : 1) * sizeof(*l->v));
+    l->v[l->n++] = v;
+}
+
+static int track_index(const char *name)
+{
+    int i;
+
+    for (i = 0; i < NTRACKS; i++) {
+        if (strcmp(tracks[i]->name, name) == 0)
+            return i;
+    }
+    die("unknown track", name);
+    return -1;
+}
+
+static void parse_list(int p, const char *text)
+{
+    char *copy = strdup(text), *item, *save, *end;
+    long first, last, step;
+    list_t *l = &params[p];
+
+    l->n = 0;
+    for (item = strtok_r(copy, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        if (p == P_TRACK) {
+            if (strcmp(item, "all") == 0) {
+                for (first = 0; first < NTRACKS; first++)
+                    list_add(l, first);
+            } else {
+                list_add(l, track_index(item));
+            }
+            continue;
+        }
+        first = last = strtol(item, &end, 0);
+        step = 1;
+        if (*end == ':') {
+            last = strtol(end + 1, &end, 0);
+            if (*end == ':')
+                step = strtol(end + 1, &end, 0);
+        }
+        if (end == item || *end != '\0' || step <= 0 || last < first)
+            die("bad list", text);
+        if (first < param_info[p].min || last > param_info[p].max)
+            die("value out of range", text);
+        for (; first <= last; first += step)
+            list_add(l, first);
+    }
+    free(copy);
+    if (l->n == 0)
+        die("empty list", text);
+}
+
+/*
+ * Configurations: an index of the grid, digits of mixed radix, or a draw
+ * of the random sample seeded by the index
+ */
+static unsigned long long splitmix(unsigned long long *s)
+{
+    unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void config_of(long index, int *cfg)
+{
+    unsigned long long s = opt_seed * 0x100000001B3ULL + (unsigned long long) index;
+    int p;
+
+    for (p = NPARAMS - 1; p >= 0; p--) {
+        if (opt_random) {
+            cfg[p] = params[p].v[splitmix(&s) % params[p].n];
+        } else {
+            cfg[p] = params[p].v[index % params[p].n];
+            index /= params[p].n;
+        }
+    }
+}
+
+/*
+ * One drive, times in ms. The vehicle moves before the control runs when
+ * both are due, like VehicleTask has the higher priority.
+ */
+static void simulate(const int *cfg, result_t *r)
+{
+    cruise_gains_t gains = CRUISE_GAINS_DEFAULT;
+    cruise_control_t control = CRUISE_CONTROL_INIT;
+    cruise_vehicle_t vehicle = { 0, 0 };
+    const cruise_track_t *track = tracks[cfg[P_TRACK]];
+    int control_ms = cfg[P_CONTROL], vehicle_ms = cfg[P_VEHICLE];
+    long t = 0, next_control = 0, next_vehicle = 0, engaged = -1, end = -1, outside = 0;
+    long steps = 0, changes = 0;
+    int inputs = CRUISE_ENGINE | CRUISE_TOP_GEAR | CRUISE_GAS;
+    int engine = 1, last_throttle = control.throttle, error;
+    int16_t acceleration;
+    double err_sum = 0, effort_sum = 0;
+
+    gains.kp = cfg[P_KP];
+    gains.kp_div = cfg[P_KP_DIV];
+    gains.dt = cfg[P_DT];
+    gains.min_target = cfg[P_MIN_TARGET];
+    memset(r, 0, sizeof(*r));
+
+    /* Gas until --engage, at most ten minutes */
+    while (end < 0 || t < end) {
+        if (t == next_vehicle) {
+            if (control.throttle > CRUISE_THROTTLE_MAX)
+                control.throttle = CRUISE_THROTTLE_MAX;
+            acceleration = cruise_vehicle_accel(&vehicle, track, control.throttle, 0, engine);
+            cruise_vehicle_move(&vehicle, track, acceleration, vehicle_ms);
+            next_vehicle += vehicle_ms;
+            if (engaged >= 0) {
+                error = r->target - vehicle.velocity;
+                if (-error > r->overshoot)
+                    r->overshoot = -error;
+                if (abs(error) > opt_band)
+                    outside = t + vehicle_ms;
+                err_sum += abs(error);
+                effort_sum += control.throttle;
+                changes += abs(control.throttle - last_throttle);
+                last_throttle = control.throttle;
+                steps++;
+            }
+        }
+        if (t == next_control) {
+            if (engaged < 0 && vehicle.velocity >= opt_engage) {
+                inputs = CRUISE_ENGINE | CRUISE_TOP_GEAR | CRUISE_BUTTON;
+            } else if (engaged < 0 && t > 600000) {
+                break;
+            }
+            engine = !!(cruise_control_step(&control, &gains, vehicle.velocity, inputs) & CRUISE_ENGINE);
+            if (inputs & CRUISE_BUTTON) {
+                inputs &= ~CRUISE_BUTTON;
+                engaged = t;
+                end = t + (long) (opt_time * 1000);
+                r->target = control.target_velocity;
+                last_throttle = control.throttle;
+                outside = t;
+            }
+            next_control += control_ms;
+        }
+        t = next_vehicle < next_control ? next_vehicle : next_control;
+    }
+
+    if (engaged < 0 || steps == 0) {
+        r->settle = r->error = r->effort = r->activity = NAN;
+        return;
+    }
+    r->settle = outside >= end ? NAN : (outside - engaged) / 1000.0;
+    r->error = err_sum / steps;
+    r->effort = effort_sum / steps;
+    r->activity = changes / ((end - engaged) / 1000.0);
+}
+
+static void *worker(void *arg)
+{
+    int cfg[NPARAMS];
+    long first, i;
+
+    (void) arg;
+    for (;;) {
+        pthread_mutex_lock(&queue_lock);
+        first = next_config;
+        next_config += CHUNK;
+        pthread_mutex_unlock(&queue_lock);
+        if (first >= nconfigs)
+            return NULL;
+        for (i = first; i < first + CHUNK && i < nconfigs; i++) {
+            config_of(i, cfg);
+            simulate(cfg, &results[i]);
+        }
+    }
+}
+
+/*
+ * Output
+ */
+static int sort_key;
+
+static double key_of(long i)
+{
+    const result_t *r = &results[i];
+    double k;
+
+    switch (sort_key) {
+    case S_SETTLE:    k = r->settle; break;
+    case S_OVERSHOOT: k = r->overshoot; break;
+    case S_ERROR:     k = r->error; break;
+    case S_EFFORT:    k = r->effort; break;
+    default:          k = r->activity; break;
+    }
+    return isnan(k) ? INFINITY : k;
+}
+
+static int rank_compare(const void *a, const void *b)
+{
+    long i = *(const long *) a, j = *(const long *) b;
+    double ki = key_of(i), kj = key_of(j);
+
+    if (ki != kj)
+        return ki < kj ? -1 : 1;
+    return i < j ? -1 : i > j;
+}
+
+static void print_result(long i)
+{
+    const result_t *r = &results[i];
+    int cfg[NPARAMS];
+
+    config_of(i, cfg);
+    printf("%d,%d,%d,%d,%d,%d,%s,%d,", cfg[P_KP], cfg[P_KP_DIV], cfg[P_DT], cfg[P_MIN_TARGET],
+           cfg[P_CONTROL], cfg[P_VEHICLE], tracks[cfg[P_TRACK]]->name, r->target);
+    if (isnan(r->settle))
+        printf("-,");
+    else
+        printf("%.1f,", r->settle);
+    printf("%g,%.2f,%.1f,%.2f\n", r->overshoot, r->error, r->effort, r->activity);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: cruise_sweep [--kp LIST] [--kp-div LIST] [--dt LIST] [--min-target LIST]\n"
+            "                    [--control-period LIST] [--vehicle-period LIST] [--track LIST|all]\n"
+            "                    [--random N [--seed S]] [--engage M/S] [--time S] [--band M/S]\n"
+            "                    [--best N [--sort settle|overshoot|error|effort|activity]]\n"
+            "                    [--threads N]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        { "kp",             required_argument, NULL, OPT_PARAM + P_KP },
+        { "kp-div",         required_argument, NULL, OPT_PARAM + P_KP_DIV },
+        { "dt",             required_argument, NULL, OPT_PARAM + P_DT },
+        { "min-target",     required_argument, NULL, OPT_PARAM + P_MIN_TARGET },
+        { "control-period", required_argument, NULL, OPT_PARAM + P_CONTROL },
+        { "vehicle-period", required_argument, NULL, OPT_PARAM + P_VEHICLE },
+        { "track",          required_argument, NULL, OPT_PARAM + P_TRACK },
+        { "random",         required_argument, NULL, 'r' },
+        { "seed",           required_argument, NULL, 's' },
+        { "engage",         required_argument, NULL, 'e' },
+        { "time",           required_argument, NULL, 't' },
+        { "band",           required_argument, NULL, 'w' },
+        { "best",           required_argument, NULL, 'b' },
+        { "sort",           required_argument, NULL, 'o' },
+        { "threads",        required_argument, NULL, 'j' },
+        { NULL, 0, NULL, 0 }
+    };
+    long best = 0, i, *order;
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN), opt, p;
+    pthread_t *pool;
+    struct timespec t0, t1;
+    double host;
+
+    for (p = 0; p < NPARAMS; p++)
+        parse_list(p, param_info[p].def);
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        if (opt >= OPT_PARAM && opt < OPT_PARAM + NPARAMS) {
+            parse_list(opt - OPT_PARAM, optarg);
+            continue;
+        }
+        switch (opt) {
+        case 'r': opt_random = atol(optarg); break;
+        case 's': opt_seed = strtoull(optarg, NULL, 0); break;
+        case 'e': opt_engage = atof(optarg); break;
+        case 't': opt_time = atof(optarg); break;
+        case 'w': opt_band = atof(optarg); break;
+        case 'b': best = atol(optarg); break;
+        case 'j': threads = atoi(optarg); break;
+        case 'o':
+            for (sort_key = 0; sort_key < (int) (sizeof(sort_names) / sizeof(sort_names[0])); sort_key++) {
+                if (strcmp(optarg, sort_names[sort_key]) == 0)
+                    break;
+            }
+            if (sort_key == (int) (sizeof(sort_names) / sizeof(sort_names[0])))
+                die("unknown sort key", optarg);
+            break;
+        default: usage();
+        }
+    }
+    if (optind != argc || opt_time <= 0 || opt_random < 0 || best < 0)
+        usage();
+    if (threads < 1)
+        threads = 1;
+
+    if (opt_random) {
+        nconfigs = opt_random;
+    } else {
+        nconfigs = 1;
+        for (p = 0; p < NPARAMS; p++) {
+            if (nconfigs > 100000000L / params[p].n)
+                die("grid larger than 100000000 configurations, use --random", NULL);
+            nconfigs *= params[p].n;
+        }
+    }
+    if ((results = calloc(nconfigs, sizeof(*results))) == NULL)
+        die("out of memory", NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pool = calloc(threads, sizeof(*pool));
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&pool[i], NULL, worker, NULL) != 0)
+            die("cannot create the threads", NULL);
+    }
+    for (i = 0; i < threads; i++)
+        pthread_join(pool[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    host = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("kp,kp_div,dt,min_target,control_ms,vehicle_ms,track,target,"
+           "settle_s,overshoot,error,effort,activity\n");
+    if (best) {
+        order = malloc(nconfigs * sizeof(*order));
+        for (i = 0; i < nconfigs; i++)
+            order[i] = i;
+        qsort(order, nconfigs, sizeof(*order), rank_compare);
+        for (i = 0; i < best && i < nconfigs; i++)
+            print_result(order[i]);
+        free(order);
+    } else {
+        for (i = 0; i < nconfigs; i++)
+            print_result(i);
+    }
+    fprintf(stderr, "cruise_sweep: %ld configurations, %d threads, %.2f s (%.0f configurations/s)\n",
+            nconfigs, threads, host, host > 0 ? nconfigs / host : 0.0);
+    free(pool);
+    free(results);
+    return 0;
+}
@@ -0,0 +1,27 @@
+/* Tracks of the host tools of the cruise control, cruise_sweep.c and
+ * cruise_fleet.c: the lab one of the application and three made up ones
+ */
+#ifndef __CRUISE_TRACKS_H__
+#define __CRUISE_TRACKS_H__
+
+#include "cruise_law.h"
+
+static const cruise_grade_t hills_grades[] = {
+    {    0,  200, -2 }, {  200,  400,  2 }, {  400,  600, -2 }, {  600,  800,  2 },
+    {  800, 1000, -4 }, { 1000, 1200,  4 }, { 1200, 1400, -4 }, { 1400, 1600,  4 },
+    { 1600, 1800, -2 }, { 1800, 2000,  2 }, { 2000, 2200, -4 }, { 2200, 2401,  4 },
+};
+static const cruise_grade_t steep_grades[] = {
+    {  400, 1600, -6 }, { 1600, 2401, 6 },
+};
+static const cruise_track_t flat_track = { "flat", 2400, 0, NULL };
+static const cruise_track_t hills_track = {
+    "hills", 2400, sizeof(hills_grades) / sizeof(hills_grades[0]), hills_grades
+};
+static const cruise_track_t steep_track = {
+    "steep", 2400, sizeof(steep_grades) / sizeof(steep_grades[0]), steep_grades
+};
+static const cruise_track_t *tracks[] = { &cruise_track_lab, &flat_track, &hills_track, &steep_track };
+#define NTRACKS (int) (sizeof(tracks) / sizeof(tracks[0]))
+
+#endif /* __CRUISE_TRACKS_H__ */
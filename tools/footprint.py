@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+"""Breaks down the memory footprint of an application from its linker map.
+
+Reads the GNU ld map (bin/<app>.map, written by every build) and prints the
+bytes per output section and per object file, split into ROM and RAM:
+
+  ROM   what the image loads: code (.entry, .exceptions, .text, on-chip
+        code), .rodata and the initial values of .rwdata
+  RAM   what is written at run time: .rwdata, .bss and .noinit
+
+On the DE2 boards everything is downloaded into SRAM/SDRAM, so ROM is the
+download image, not flash. The memory left between the end of the image
+and the top of the memory the stack starts in is the heap and the stack of
+main(). Task stacks (*_Stack, *_stk, *Stk) and the uC/OS-II object tables
+are listed on their own; the entries of a table come from the OS_MAX_*
+values in the system.h of the BSP, or in os_cfg_trim.h when ostrim.py has
+cut them.
+
+--save stores the breakdown as JSON, --baseline compares against a stored
+one and prints what grew or shrank; with --fail-over N the exit status is 1
+when ROM or RAM grew by more than N bytes.
+
+usage: footprint.py bin/cruisecontrol.map [--baseline footprint.json] [--save footprint.json]
+       footprint.py bin/cruisecontrol.map --by lib --top 10
+"""
+import argparse
+import json
+import os
+import re
+import sys
+
+CODE = (".entry", ".exceptions", ".text", ".onchip_memory")
+RODATA = (".rodata",)
+DATA = (".rwdata",)
+BSS = (".bss", ".noinit")
+KINDS = (("code", CODE), ("rodata", RODATA), ("data", DATA), ("bss", BSS))
+
+# uC/OS-II tables and the configuration that sizes them
+KERNEL_TABLES = [
+    ("OSEventTbl", "OS_MAX_EVENTS"),
+    ("OSQTbl", "OS_MAX_QS"),
+    ("OSMemTbl", "OS_MAX_MEM_PART"),
+    ("OSFlagTbl", "OS_MAX_FLAGS"),
+    ("OSTCBTbl", "OS_MAX_TASKS"),
+    ("OSTmrTbl", "OS_TMR_CFG_MAX"),
+    ("OSTmrWheelTbl", "OS_TMR_CFG_WHEEL_SIZE"),
+    ("OSTCBPrioTbl", "OS_LOWEST_PRIO"),
+    ("OSTaskIdleStk", None),
+    ("OSTaskStatStk", None),
+    ("OSTmrTaskStk", None),
+]
+
+STACK = re.compile(r"(_stack|_stk|Stk)$", re.I)
+
+OUT_SECTION = re.compile(r"^(\.[\w.]+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+))?")
+IN_SECTION = re.compile(r"^ (\.[\w.]+|COMMON|\*fill\*)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)(?:\s+(.+))?)?$")
+CONTINUATION = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)(?:\s+(.+))?$")
+SYMBOL = re.compile(r"^\s+0x([0-9a-f]+)\s+([A-Za-z_][\w.$]*)$")
+PROVIDED = re.compile(r"^\s+0x([0-9a-f]+)\s+(?:PROVIDE \()?(\w+)[ ,=)]")
+MEMORY = re.compile(r"^(\w+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)")
+
+
+def short(path):
+    """libc.a(lib_a-printf.o) for a library member, cruise.o for an object."""
+    m = re.match(r"^(.*?)([^/]+\.a)\((.+)\)$", path)
+    if m:
+        return "%s(%s)" % (m.group(2), m.group(3))
+    return os.path.basename(path)
+
+
+def library(name):
+    return name.split("(", 1)[0]
+
+
+def kind_of(section):
+    for kind, names in KINDS:
+        if section in names:
+            return kind
+    return None
+
+
+def parse(path):
+    """Returns the memories, output sections, input pieces and symbols of a map."""
+    memories = {}
+    sections = {}           # name: (address, size)
+    pieces = []             # (output section, object, address, size)
+    symbols = {}            # name: (address, section)
+    common = {}             # name: size
+    provided = {}           # name: address
+    state = "head"
+    out = None
+    pending = None          # input section waiting for its address line
+    with open(path, errors="replace") as mapfile:
+        for line in mapfile:
+            line = line.rstrip("\n")
+            if line.startswith("Allocating common symbols"):
+                state = "common"
+                continue
+            if line.startswith("Memory Configuration"):
+                state = "memory"
+                continue
+            if line.startswith("Linker script and memory map"):
+                state = "map"
+                continue
+            if state == "common":
+                f = line.split()
+                if len(f) == 3 and f[1].startswith("0x"):
+                    common[f[0]] = int(f[1], 16)
+                continue
+            if state == "memory":
+                m = MEMORY.match(line)
+                if m and m.group(1) != "Name":
+                    memories[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+                continue
+            if state != "map":
+                continue
+
+            if line.startswith("."):
+                m = OUT_SECTION.match(line)
+                out = m.group(1)
+                if m.group(2):
+                    sections[out] = (int(m.group(2), 16), int(m.group(3), 16))
+                else:
+                    pending = ("out", out)
+                continue
+            if pending:
+                m = CONTINUATION.match(line)
+                if m:
+                    if pending[0] == "out":
+                        sections[pending[1]] = (int(m.group(1), 16), int(m.group(2), 16))
+                    else:
+                        pieces.append((out, short(m.group(3) or "(linker)"),
+                                       int(m.group(1), 16), int(m.group(2), 16)))
+                    pending = None
+                    continue
+                pending = None
+            m = IN_SECTION.match(line)
+            if m and out:
+                if m.group(2) is None:
+                    pending = ("in", m.group(1))
+                elif m.group(1) == "*fill*":
+                    pieces.append((out, "(fill)", int(m.group(2), 16), int(m.group(3), 16)))
+                else:
+                    pieces.append((out, short(m.group(4) or "(linker)"),
+                                   int(m.group(2), 16), int(m.group(3), 16)))
+                continue
+            m = SYMBOL.match(line)
+            if m and out:
+                symbols[m.group(2)] = (int(m.group(1), 16), out)
+                continue
+            m = PROVIDED.match(line)
+            if m:
+                provided[m.group(2)] = int(m.group(1), 16)
+    return memories, sections, pieces, symbols, common, provided
+
+
+def symbol_sizes(pieces, symbols, common):
+    """Sizes of the data symbols: from the common table, else up to the next symbol."""
+    sizes = dict(common)
+    ordered = sorted((addr, name) for name, (addr, _sec) in symbols.items())
+    ends = sorted(addr + size for _o, _f, addr, size in pieces if size)
+    starts = [addr for addr, _name in ordered]
+    for i, (addr, name) in enumerate(ordered):
+        if name in sizes:
+            continue
+        nxt = starts[i + 1] if i + 1 < len(starts) else None
+        end = next((e for e in ends if e > addr), None)
+        if nxt is not None and (end is None or nxt < end):
+            end = nxt
+        if end is not None:
+            sizes[name] = end - addr
+    return sizes
+
+
+def read_config(path):
+    """OS_* values of system.h, with the os_cfg_trim.h overlay of ostrim.py."""
+    config = {}
+    if not path:
+        return config
+    overlay = os.path.join(os.path.dirname(path), "UCOSII", "inc", "os_cfg_trim.h")
+    for header_path in (path, overlay):
+        if os.path.exists(header_path):
+            with open(header_path, errors="replace") as header:
+                for line in header:
+                    m = re.match(r"#define\s+(OS_\w+)\s+(\d+)", line)
+                    if m:
+                        config[m.group(1)] = int(m.group(2))
+    return config
+
+
+def breakdown(map_path, config_path, by_lib):
+    memories, sections, pieces, symbols, common, provided = parse(map_path)
+    config = read_config(config_path)
+
+    result = {"app": os.path.splitext(os.path.basename(map_path))[0],
+              "sections": {}, "objects": {}, "kernel": {}, "stacks": {}, "totals": {}}
+    totals = {"code": 0, "rodata": 0, "data": 0, "bss": 0}
+    for name, (_addr, size) in sections.items():
+        kind = kind_of(name)
+        if kind and size:
+            result["sections"][name] = size
+            totals[kind] += size
+    for out, obj, _addr, size in pieces:
+        kind = kind_of(out)
+        if not kind or not size:
+            continue
+        key = library(obj) if by_lib else obj
+        entry = result["objects"].setdefault(key, {"code": 0, "rodata": 0, "data": 0, "bss": 0})
+        entry[kind] += size
+    for entry in result["objects"].values():
+        entry["rom"] = entry["code"] + entry["rodata"] + entry["data"]
+        entry["ram"] = entry["data"] + entry["bss"]
+
+    sizes = symbol_sizes(pieces, symbols, common)
+    for name, macro in KERNEL_TABLES:
+        if name in sizes:
+            count = config.get(macro) if macro else None
+            if name == "OSTCBTbl" and count is not None:
+                count += 2 if config.get("OS_TASK_STAT_EN", 1) else 1
+            if name == "OSTCBPrioTbl" and count is not None:
+                count += 1
+            result["kernel"][name] = {"bytes": sizes[name], "entries": count, "macro": macro}
+    for name, size in sizes.items():
+        if STACK.search(name) and name not in result["kernel"]:
+            result["stacks"][name] = size
+
+    totals["rom"] = totals["code"] + totals["rodata"] + totals["data"]
+    totals["ram"] = totals["data"] + totals["bss"]
+    heap = provided.get("__alt_heap_start")
+    limit = provided.get("__alt_heap_limit")
+    if heap is not None and limit is not None:
+        totals["heap_stack"] = limit - heap
+    result["totals"] = totals
+    return result
+
+
+def table(title, header, rows):
+    widths = [max(len(str(r[i])) for r in [header] + rows) for i in range(len(header))]
+    rule = "+" + "+".join("-" * (w + 2) for w in widths) + "+"
+    print(title)
+    print(rule)
+    print("| " + " | ".join(str(h).ljust(w) if i == 0 else str(h).rjust(w)
+                            for i, (h, w) in enumerate(zip(header, widths))) + " |")
+    print(rule)
+    for r in rows:
+        print("| " + " | ".join(str(c).ljust(w) if i == 0 else str(c).rjust(w)
+                                for i, (c, w) in enumerate(zip(r, widths))) + " |")
+    print(rule)
+
+
+def report(fp, top):
+    t = fp["totals"]
+    print("%s: ROM %d bytes, RAM %d bytes, heap + main stack %s bytes\n"
+          % (fp["app"], t["rom"], t["ram"], t.get("heap_stack", "?")))
+    table("--Sections--", ["Section", "Bytes"],
+          sorted(fp["sections"].items(), key=lambda kv: -kv[1]))
+    objects = sorted(fp["objects"].items(), key=lambda kv: -(kv[1]["rom"] + kv[1]["bss"]))
+    if top:
+        objects = objects[:top]
+    print()
+    table("--Objects--", ["Object", "Code", "Rodata", "Data", "Bss", "ROM", "RAM"],
+          [(n, o["code"], o["rodata"], o["data"], o["bss"], o["rom"], o["ram"]) for n, o in objects])
+    if fp["kernel"]:
+        print()
+        rows = []
+        for name, k in fp["kernel"].items():
+            if k["entries"]:
+                entries = "%d x %d" % (k["entries"], k["bytes"] // k["entries"])
+            else:
+                entries = "-"
+            rows.append((name, k["bytes"], entries, k["macro"] or "-"))
+        table("--Kernel Tables--", ["Table", "Bytes", "Entries", "Sized by"], rows)
+    if fp["stacks"]:
+        print()
+        rows = sorted(fp["stacks"].items(), key=lambda kv: -kv[1])
+        rows.append(("(total)", sum(fp["stacks"].values())))
+        table("--Task Stacks--", ["Stack", "Bytes"], rows)
+
+
+def diff(base, fp, top):
+    """Prints the changes from base to fp, returns the growth of ROM and RAM."""
+    print()
+    rows = []
+    for key in ("rom", "ram", "code", "rodata", "data", "bss", "heap_stack"):
+        old, new = base["totals"].get(key), fp["totals"].get(key)
+        if old is not None and new is not None:
+            rows.append((key, old, new, "%+d" % (new - old)))
+    table("--Change against baseline--", ["Total", "Baseline", "Now", "Delta"], rows)
+
+    changes = []
+    for name in set(base["objects"]) | set(fp["objects"]):
+        old = base["objects"].get(name, {"rom": 0, "ram": 0})
+        new = fp["objects"].get(name, {"rom": 0, "ram": 0})
+        if old["rom"] != new["rom"] or old["ram"] != new["ram"]:
+            changes.append((name, "%+d" % (new["rom"] - old["rom"]), "%+d" % (new["ram"] - old["ram"]),
+                            abs(new["rom"] - old["rom"]) + abs(new["ram"] - old["ram"])))
+    for name in set(base.get("kernel", {})) | set(fp.get("kernel", {})):
+        old = base.get("kernel", {}).get(name, {"bytes": 0})["bytes"]
+        new = fp.get("kernel", {}).get(name, {"bytes": 0})["bytes"]
+        if old != new:
+            changes.append(("[kernel] " + name, "0", "%+d" % (new - old), abs(new - old)))
+    if changes:
+        changes.sort(key=lambda c: -c[3])
+        if top:
+            changes = changes[:top]
+        print()
+        table("--Changed objects--", ["Object", "ROM", "RAM"], [c[:3] for c in changes])
+    return (fp["totals"]["rom"] - base["totals"]["rom"],
+            fp["totals"]["ram"] - base["totals"]["ram"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map")
+    parser.add_argument("--config", help="system.h with the OS_MAX_* values "
+                        "(default ../bsp/system.h next to the map)")
+    parser.add_argument("--by", choices=("object", "lib"), default="object",
+                        help="group by object file or by library")
+    parser.add_argument("--top", type=int, default=25,
+                        help="objects to list (default %(default)s, 0 for all)")
+    parser.add_argument("--baseline", help="compare with this stored breakdown")
+    parser.add_argument("--save", help="store the breakdown as JSON")
+    parser.add_argument("--fail-over", type=int, metavar="BYTES",
+                        help="exit with 1 if ROM or RAM grew by more than BYTES")
+    args = parser.parse_args()
+
+    config = args.config or os.path.join(os.path.dirname(os.path.abspath(args.map)),
+                                         "..", "bsp", "system.h")
+    fp = breakdown(args.map, config, args.by == "lib")
+    report(fp, args.top)
+
+    status = 0
+    if args.baseline:
+        with open(args.baseline) as stored:
+            base = json.load(stored)
+        rom, ram = diff(base, fp, args.top)
+        if args.fail_over is not None and (rom > args.fail_over or ram > args.fail_over):
+            print("\nFootprint grew by more than %d bytes" % args.fail_over)
+            status = 1
+    if args.save:
+        with open(args.save, "w") as out:
+            json.dump(fp, out, indent=1, sort_keys=True)
+            out.write("\n")
+    sys.exit(status)
+
+
+if __name__ == "__main__":
+    main()
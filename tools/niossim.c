@@ -0,0 +1,1600 @@
+/* Nios II instruction-set simulator for the IL 2206 lab applications
+ *
+ * Runs an application ELF (bin/<app>.elf) of the DE2 system on Linux, with
+ * the peripherals at the addresses of the BSP's system.h:
+ *
+ *   altera_avalon_pio                 data, direction, interruptmask, edgecapture
+ *   altera_avalon_timer               32-bit, status/control/period/snap
+ *   altera_avalon_jtag_uart           output on stdout, input from the script
+ *   altera_avalon_performance_counter sections, time and event counters
+ *   altera_up_avalon_character_lcd    2x16 characters
+ *   memories                          on-chip, SRAM and SDRAM
+ *
+ * The CPU is a Nios II/e ("tiny"): Nios II R1 without caches, without
+ * hardware multiply or divide (those trap to the HAL emulation like on the
+ * board), with the internal interrupt controller. Cycles are counted with
+ * the instruction timing of the core (CYC_* below) plus the bus transfer of
+ * every fetch, load and store, taken from the memory timing table (--wait).
+ * The timers count these cycles, so timestamps, the tick and everything the
+ * applications measure (hot_bench, trace, task_acct, pc_prof) come out in
+ * cycles of the model. A run depends only on the ELF, the system.h and the
+ * input script, it gives the same output on any machine.
+ *
+ * Input script, one event per line, '#' starts a comment:
+ *
+ *   <time> <device> <value>
+ *
+ *   time     seconds, or with a unit: 1.5s, 300ms, 20us, 1000cyc
+ *   device   sw, key, uart, stop, or a PIO name of system.h (de2_pio_toggles18)
+ *   value    sw: switch word; key: pressed keys as a bit mask (the keys are
+ *            active low, the PIO reads the inverted mask), 0 releases them;
+ *            uart: a "string" with \n escapes; stop: ends the run
+ *
+ *   0      sw    0x00001           # engine on
+ *   2s     key   0x2               # KEY1 down
+ *   2.1s   key   0                 #      and up
+ *
+ * Regions (--region NAME=FUNC[,FUNC...]) time every call of the functions
+ * in cycles, from the jump to the first instruction to the ret or eret
+ * inside the function, whatever runs in between (interrupts, other tasks
+ * after a switch). Symbols without a size end at the next symbol, so
+ * OSCtxSw ends with the ret into the task it switched to. A recursive call
+ * is not timed on its own. At the end of the run each region is printed as
+ * a "BENCH " JSON line, see tools/bench_budget.py.
+ *
+ * Spans (--span NAME=FROM,TO) time code that is no function of its own,
+ * like the job in the loop of a task: from the instruction at FROM to the
+ * next one at TO, whatever runs in between, with the addresses given as
+ * SYMBOL[+OFFSET] or in hex. They are printed like the regions.
+ *
+ * Hot functions (--hot FUNC[,FUNC...]) are fetched with the timing of the
+ * on-chip memory wherever the ELF has them, as if ALT_HOT (alt_types.h)
+ * had linked them there; their data accesses keep the timing of where the
+ * data is. So the placement can be compared on one ELF.
+ *
+ * Build: cc -O2 -o tools/niossim tools/niossim.c
+ *
+ * usage: niossim bin/cruisecontrol.elf [--time 20s] [--input drive.txt]
+ *        niossim bin/contextsw.elf --system bsp/system.h --event "1s sw 3" --io
+ *        niossim bin/cruisecontrol.elf --wait sram=1,2,2 --time 1s --trace
+ *        niossim bin/contextsw.elf --region ctx_switch=OSCtxSw --region tick=alt_tick
+ *        niossim bin/cruisecontrol.elf --span control=ControlTask+0x2e8,ControlTask+0x2e4
+ *        niossim bin/cruisecontrol.elf --region tick=alt_avalon_timer_sc_irq --hot alt_tick,OSTimeTick
+ */
+#define _GNU_SOURCE
+#include <elf.h>
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Nios II/e instruction timing in cycles (Nios II Processor Reference
+ * Handbook, core implementation details); loads and stores add the bus
+ * transfer, shifts and rotates one cycle per bit position */
+#define CYC_ALU         6
+#define CYC_LDST_W      6
+#define CYC_LDST_H      9
+#define CYC_LDST_B      10
+#define CYC_SHIFT       7
+
+#define MAX_REGIONS     8
+#define MAX_DEVS        24
+#define MAX_DEFINES     1024
+#define MAX_EVENTS      4096
+#define MAX_BENCH       16
+#define MAX_PROBES      32
+#define MAX_HOT         64
+#define UART_FIFO       64
+
+/* Control registers */
+enum { CTL_STATUS, CTL_ESTATUS, CTL_BSTATUS, CTL_IENABLE, CTL_IPENDING, CTL_CPUID };
+
+#define STATUS_PIE      0x1
+
+/* Registers with a role */
+#define REG_ET          24
+#define REG_BA          30
+#define REG_EA          29
+#define REG_RA          31
+
+struct region {
+    char            name[48];
+    uint32_t        base, size;
+    uint8_t        *mem;
+    int             fetch;              /* extra cycles per instruction fetch */
+    int             read, write;        /* cycles of a data transfer */
+};
+
+enum dev_kind { DEV_PIO, DEV_TIMER, DEV_UART, DEV_PERF, DEV_LCD };
+
+enum edge { EDGE_NONE, EDGE_RISING, EDGE_FALLING, EDGE_ANY };
+
+struct dev {
+    enum dev_kind   kind;
+    char            name[48];
+    uint32_t        base, span;
+    int             irq;                /* -1 = none */
+    union {
+        struct {
+            uint32_t in, out, dir, mask, edge, width;
+            int      edge_type, bit_clear, has_in, has_out;
+        } pio;
+        struct {
+            uint32_t period, snap, control;
+            int      to, running;
+            uint64_t start;             /* cycle the counter was 'value' */
+            uint32_t value;
+        } tmr;
+        struct {
+            uint8_t  rx[UART_FIFO];
+            int      rx_in, rx_out;
+            uint32_t control;
+        } uart;
+        struct {
+            uint64_t time[16], start[16];
+            uint32_t events[16];
+            int      running[16], sections;
+        } perf;
+        struct {
+            uint8_t  ddram[128];
+            int      addr;
+        } lcd;
+    } u;
+};
+
+struct event {
+    uint64_t        cycle;
+    struct dev     *dev;                /* NULL = stop */
+    uint32_t        value;
+    char           *text;               /* uart input */
+};
+
+struct symbol {
+    uint32_t        addr, size;
+    char           *name;
+};
+
+/* A timed region and the functions it times */
+struct bench {
+    char            name[32];
+    char            funcs[128];
+    uint64_t        samples, min, max, sum;
+    int             span;               /* funcs is FROM,TO */
+    uint32_t        from, to;
+    int             open;
+    uint64_t        t0;
+};
+
+struct probe {
+    uint32_t        start, end;
+    struct bench   *bench;
+    int             open;
+    uint64_t        t0;
+};
+
+static struct region  regions[MAX_REGIONS];
+static int            nregions;
+static struct dev     devs[MAX_DEVS];
+static int            ndevs;
+static struct event   events[MAX_EVENTS];
+static int            nevents, next_ev;
+static struct symbol *syms;
+static int            nsyms;
+static struct bench   benches[MAX_BENCH];
+static int            nbenches;
+static struct probe   probes[MAX_PROBES];
+static int            nprobes;
+static int            nspans;
+static char           hot_funcs[1024];
+static uint32_t       hot_start[MAX_HOT], hot_end[MAX_HOT];
+static int            nhots;
+static struct region *onchip;
+
+static struct {
+    char name[64];
+    char value[128];
+} defines[MAX_DEFINES];
+static int            ndefines;
+
+/* CPU state */
+static uint32_t       r[32], ctl[16], pc;
+static uint64_t       cycles, insns, next_event, stop_cycle;
+static uint32_t       irq_lines;
+static uint32_t       exception_addr;
+static double         cpu_freq = 50e6;
+static const char    *cpu_impl = "tiny";
+static int            halted;
+static uint64_t       unmapped;
+
+/* Options */
+static int            opt_trace, opt_io;
+
+static struct region *fetch_region;
+
+static void die(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    fprintf(stderr, "niossim: ");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+    exit(2);
+}
+
+static double now_seconds(void)
+{
+    return (double) cycles / cpu_freq;
+}
+
+/*
+ * Symbols, for messages and the trace
+ */
+static int sym_compare(const void *a, const void *b)
+{
+    const struct symbol *sa = a, *sb = b;
+
+    return sa->addr < sb->addr ? -1 : sa->addr > sb->addr;
+}
+
+static const char *sym_name(uint32_t addr, uint32_t *offset)
+{
+    int lo = 0, hi = nsyms - 1, mid;
+
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if (syms[mid].addr <= addr)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    if (hi < 0 || (syms[hi].size && addr >= syms[hi].addr + syms[hi].size))
+        return NULL;
+    *offset = addr - syms[hi].addr;
+    return syms[hi].name;
+}
+
+static const char *where(uint32_t addr)
+{
+    static char buf[160];
+    uint32_t offset;
+    const char *name = sym_name(addr, &offset);
+
+    if (name)
+        snprintf(buf, sizeof(buf), "0x%08x <%s+0x%x>", addr, name, offset);
+    else
+        snprintf(buf, sizeof(buf), "0x%08x", addr);
+    return buf;
+}
+
+/*
+ * system.h
+ */
+static const char *define(const char *prefix, const char *suffix)
+{
+    char name[64];
+    int i;
+
+    snprintf(name, sizeof(name), "%s%s", prefix, suffix);
+    for (i = 0; i < ndefines; i++) {
+        if (strcmp(defines[i].name, name) == 0)
+            return defines[i].value;
+    }
+    return NULL;
+}
+
+static long define_int(const char *prefix, const char *suffix, long fallback)
+{
+    const char *value = define(prefix, suffix);
+
+    return value ? strtol(value, NULL, 0) : fallback;
+}
+
+static int define_is(const char *prefix, const char *suffix, const char *string)
+{
+    const char *value = define(prefix, suffix);
+    char quoted[64];
+
+    snprintf(quoted, sizeof(quoted), "\"%s\"", string);
+    return value && strcmp(value, quoted) == 0;
+}
+
+static void add_region(const char *name, uint32_t base, uint32_t size,
+                       int fetch, int read, int write)
+{
+    struct region *m;
+
+    if (nregions == MAX_REGIONS)
+        die("too many memories in system.h");
+    m = &regions[nregions++];
+    snprintf(m->name, sizeof(m->name), "%s", name);
+    m->base = base;
+    m->size = size;
+    m->mem = calloc(1, size);
+    m->fetch = fetch;
+    m->read = read;
+    m->write = write;
+    if (!m->mem)
+        die("out of memory for %s", name);
+}
+
+static struct dev *add_dev(enum dev_kind kind, const char *prefix)
+{
+    struct dev *d;
+
+    if (ndevs == MAX_DEVS)
+        die("too many peripherals in system.h");
+    d = &devs[ndevs++];
+    memset(d, 0, sizeof(*d));
+    d->kind = kind;
+    snprintf(d->name, sizeof(d->name), "%s", prefix);
+    d->base = define_int(prefix, "_BASE", 0);
+    d->span = define_int(prefix, "_SPAN", 4);
+    d->irq = define_int(prefix, "_IRQ", -1);
+    return d;
+}
+
+static void load_system(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[512], prefix[64], *type;
+    struct dev *d;
+    const char *value;
+    int i, n;
+
+    if (!f)
+        die("cannot open %s (see --system)", path);
+    while (fgets(line, sizeof(line), f) && ndefines < MAX_DEFINES) {
+        if (sscanf(line, "#define %63s %127[^\n]", defines[ndefines].name,
+                   defines[ndefines].value) == 2)
+            ndefines++;
+    }
+    fclose(f);
+
+    if ((value = define("NIOS2_CPU_FREQ", "")))
+        cpu_freq = strtod(value, NULL);
+    if ((value = define("NIOS2_CPU_IMPLEMENTATION", "")))
+        cpu_impl = strcmp(value, "\"tiny\"") == 0 ? "tiny" : value;
+    exception_addr = define_int("NIOS2_EXCEPTION_ADDR", "", 0x20);
+    if (strcmp(cpu_impl, "tiny") != 0)
+        fprintf(stderr, "niossim: %s core, timed as tiny\n", cpu_impl);
+
+    for (i = 0; i < ndefines; i++) {
+        n = strlen(defines[i].name);
+        if (n < 6 || strcmp(defines[i].name + n - 5, "_TYPE") != 0
+            || defines[i].value[0] != '"' || strncmp(defines[i].name, "ALT_", 4) == 0)
+            continue;
+        snprintf(prefix, sizeof(prefix), "%.*s", n - 5, defines[i].name);
+        if (!define(prefix, "_BASE"))
+            continue;
+        type = defines[i].value;
+
+        /* Default memory timing, see --wait; the SRAM is fitted to the
+         * context switch times of the ContextSwitch board log (2483 and
+         * 2867 cycles, simulated 2467 and 2848), the SDRAM is a guess */
+        if (strcmp(type, "\"altera_avalon_onchip_memory2\"") == 0) {
+            add_region(prefix, define_int(prefix, "_BASE", 0),
+                       define_int(prefix, "_SPAN", 0), 0, 1, 1);
+            if (!onchip)
+                onchip = &regions[nregions - 1];
+        } else if (strcmp(type, "\"altera_up_avalon_sram\"") == 0) {
+            add_region(prefix, define_int(prefix, "_BASE", 0),
+                       define_int(prefix, "_SPAN", 0), 3, 4, 3);
+        } else if (strcmp(type, "\"altera_avalon_new_sdram_controller\"") == 0) {
+            add_region(prefix, define_int(prefix, "_BASE", 0),
+                       define_int(prefix, "_SPAN", 0), 4, 5, 2);
+        } else if (strcmp(type, "\"altera_avalon_pio\"") == 0) {
+            d = add_dev(DEV_PIO, prefix);
+            n = define_int(prefix, "_DATA_WIDTH", 32);
+            d->u.pio.width = n >= 32 ? 0xFFFFFFFF : (1u << n) - 1;
+            d->u.pio.has_in = define_int(prefix, "_HAS_IN", 0);
+            d->u.pio.has_out = define_int(prefix, "_HAS_OUT", 0);
+            d->u.pio.bit_clear = define_int(prefix, "_BIT_CLEARING_EDGE_REGISTER", 0);
+            d->u.pio.out = define_int(prefix, "_RESET_VALUE", 0);
+            if (define_is(prefix, "_EDGE_TYPE", "RISING"))
+                d->u.pio.edge_type = EDGE_RISING;
+            else if (define_is(prefix, "_EDGE_TYPE", "FALLING"))
+                d->u.pio.edge_type = EDGE_FALLING;
+            else if (define_is(prefix, "_EDGE_TYPE", "ANY"))
+                d->u.pio.edge_type = EDGE_ANY;
+            /* Nothing pressed on an active low input */
+            if (d->u.pio.edge_type == EDGE_FALLING)
+                d->u.pio.in = d->u.pio.width;
+        } else if (strcmp(type, "\"altera_avalon_timer\"") == 0) {
+            d = add_dev(DEV_TIMER, prefix);
+            d->u.tmr.period = define_int(prefix, "_LOAD_VALUE", 0);
+            d->u.tmr.value = d->u.tmr.period;
+        } else if (strcmp(type, "\"altera_avalon_jtag_uart\"") == 0) {
+            add_dev(DEV_UART, prefix);
+        } else if (strcmp(type, "\"altera_avalon_performance_counter\"") == 0) {
+            d = add_dev(DEV_PERF, prefix);
+            d->u.perf.sections = define_int(prefix, "_HOW_MANY_SECTIONS", 3);
+            if (d->u.perf.sections > 16)
+                d->u.perf.sections = 16;
+        } else if (strcmp(type, "\"altera_up_avalon_character_lcd\"") == 0) {
+            d = add_dev(DEV_LCD, prefix);
+            memset(d->u.lcd.ddram, ' ', sizeof(d->u.lcd.ddram));
+        } else {
+            fprintf(stderr, "niossim: %s (%s) not modelled\n", prefix, type);
+        }
+    }
+    if (nregions == 0)
+        die("no memory in %s", path);
+}
+
+/* --wait REGION=FETCH,READ,WRITE */
+static void set_wait(const char *arg)
+{
+    char name[48];
+    int fetch, read, write, i, n;
+
+    if (sscanf(arg, "%47[^=]=%d,%d,%d", name, &fetch, &read, &write) != 4)
+        die("--wait wants REGION=FETCH,READ,WRITE, not '%s'", arg);
+    n = strlen(name);
+    for (i = 0; i < nregions; i++) {
+        if (strncasecmp(regions[i].name, name, n) == 0) {
+            regions[i].fetch = fetch;
+            regions[i].read = read;
+            regions[i].write = write;
+            return;
+        }
+    }
+    die("no memory '%s' in system.h", name);
+}
+
+/*
+ * ELF
+ */
+static void load_elf(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    Elf32_Ehdr eh;
+    Elf32_Phdr ph;
+    Elf32_Shdr *sh;
+    Elf32_Sym *st;
+    char *strtab;
+    long size;
+    uint8_t *image;
+    int i, j, k;
+
+    if (!f)
+        die("cannot open %s", path);
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    rewind(f);
+    image = malloc(size);
+    if (!image || fread(image, 1, size, f) != (size_t) size)
+        die("cannot read %s", path);
+    fclose(f);
+
+    memcpy(&eh, image, sizeof(eh));
+    if (memcmp(eh.e_ident, ELFMAG, SELFMAG) != 0 || eh.e_machine != EM_ALTERA_NIOS2)
+        die("%s is not a Nios II ELF", path);
+
+    /* Loadable segments at their load address, like nios2-download */
+    for (i = 0; i < eh.e_phnum; i++) {
+        memcpy(&ph, image + eh.e_phoff + i * eh.e_phentsize, sizeof(ph));
+        if (ph.p_type != PT_LOAD || ph.p_filesz == 0)
+            continue;
+        for (j = 0; j < nregions; j++) {
+            if (ph.p_paddr >= regions[j].base
+                && ph.p_paddr + ph.p_filesz <= regions[j].base + regions[j].size)
+                break;
+        }
+        if (j == nregions)
+            die("segment at 0x%08x is outside the memories of system.h", ph.p_paddr);
+        memcpy(regions[j].mem + ph.p_paddr - regions[j].base,
+               image + ph.p_offset, ph.p_filesz);
+    }
+    pc = eh.e_entry;
+
+    /* Function symbols */
+    sh = (Elf32_Shdr *) (image + eh.e_shoff);
+    for (i = 0; i < eh.e_shnum; i++) {
+        if (sh[i].sh_type != SHT_SYMTAB)
+            continue;
+        st = (Elf32_Sym *) (image + sh[i].sh_offset);
+        strtab = (char *) image + sh[sh[i].sh_link].sh_offset;
+        k = sh[i].sh_size / sizeof(Elf32_Sym);
+        syms = calloc(k, sizeof(*syms));
+        for (j = 0; j < k; j++) {
+            /* Functions, and the global labels of the assembly code */
+            if (ELF32_ST_TYPE(st[j].st_info) != STT_FUNC
+                && (ELF32_ST_TYPE(st[j].st_info) != STT_NOTYPE
+                    || ELF32_ST_BIND(st[j].st_info) != STB_GLOBAL
+                    || st[j].st_shndx == SHN_UNDEF || st[j].st_shndx >= eh.e_shnum
+                    || !(sh[st[j].st_shndx].sh_flags & SHF_EXECINSTR)))
+                continue;
+            syms[nsyms].addr = st[j].st_value;
+            syms[nsyms].size = st[j].st_size;
+            syms[nsyms].name = strdup(strtab + st[j].st_name);
+            nsyms++;
+        }
+    }
+    qsort(syms, nsyms, sizeof(*syms), sym_compare);
+    free(image);
+}
+
+/*
+ * Peripherals
+ */
+static void dev_irq(struct dev *d, int level)
+{
+    if (d->irq < 0)
+        return;
+    if (level)
+        irq_lines |= 1u << d->irq;
+    else
+        irq_lines &= ~(1u << d->irq);
+}
+
+static void pio_update(struct dev *d)
+{
+    dev_irq(d, (d->u.pio.edge & d->u.pio.mask) != 0);
+}
+
+static void pio_input(struct dev *d, uint32_t value)
+{
+    uint32_t old = d->u.pio.in, rise, fall;
+
+    value &= d->u.pio.width;
+    rise = ~old & value;
+    fall = old & ~value;
+    d->u.pio.in = value;
+    switch (d->u.pio.edge_type) {
+    case EDGE_RISING:   d->u.pio.edge |= rise; break;
+    case EDGE_FALLING:  d->u.pio.edge |= fall; break;
+    case EDGE_ANY:      d->u.pio.edge |= rise | fall; break;
+    }
+    pio_update(d);
+}
+
+static uint32_t tmr_counter(struct dev *d)
+{
+    if (!d->u.tmr.running)
+        return d->u.tmr.value;
+    return d->u.tmr.value - (uint32_t) (cycles - d->u.tmr.start);
+}
+
+/* First cycle the counter reads zero and then reloads */
+static uint64_t tmr_timeout(struct dev *d)
+{
+    return d->u.tmr.start + d->u.tmr.value + 1;
+}
+
+static void tmr_stop(struct dev *d)
+{
+    d->u.tmr.value = tmr_counter(d);
+    d->u.tmr.running = 0;
+}
+
+static void tmr_start(struct dev *d)
+{
+    d->u.tmr.start = cycles;
+    d->u.tmr.running = 1;
+}
+
+static void tmr_expire(struct dev *d)
+{
+    uint64_t at;
+
+    while (d->u.tmr.running && cycles >= (at = tmr_timeout(d))) {
+        d->u.tmr.to = 1;
+        d->u.tmr.start = at;
+        d->u.tmr.value = d->u.tmr.period;
+        if (!(d->u.tmr.control & 0x2))
+            d->u.tmr.running = 0;
+    }
+    dev_irq(d, d->u.tmr.to && (d->u.tmr.control & 0x1));
+}
+
+static int uart_rx_count(struct dev *d)
+{
+    return (d->u.uart.rx_in - d->u.uart.rx_out + UART_FIFO) % UART_FIFO;
+}
+
+/* The write FIFO drains at once, the host terminal is always attached */
+static void uart_update(struct dev *d)
+{
+    dev_irq(d, ((d->u.uart.control & 0x1) && uart_rx_count(d))
+               || (d->u.uart.control & 0x2));
+}
+
+static void uart_input(struct dev *d, const char *text)
+{
+    for (; *text && uart_rx_count(d) < UART_FIFO - 1; text++) {
+        d->u.uart.rx[d->u.uart.rx_in] = *text;
+        d->u.uart.rx_in = (d->u.uart.rx_in + 1) % UART_FIFO;
+    }
+    uart_update(d);
+}
+
+static uint64_t perf_time(struct dev *d, int n)
+{
+    uint64_t t = d->u.perf.time[n];
+
+    if (d->u.perf.running[n] && d->u.perf.running[0])
+        t += cycles - d->u.perf.start[n];
+    return t;
+}
+
+static void perf_write(struct dev *d, int reg, uint32_t value)
+{
+    int n = reg / 4, i;
+
+    if (n >= d->u.perf.sections)
+        return;
+    if (reg == 0 && value == 1) {
+        memset(&d->u.perf.time, 0, sizeof(d->u.perf.time));
+        memset(&d->u.perf.events, 0, sizeof(d->u.perf.events));
+        memset(&d->u.perf.running, 0, sizeof(d->u.perf.running));
+    } else if (reg % 4 == 1 && !d->u.perf.running[n]) {
+        /* Sections count only while the global counter (0) runs */
+        if (n == 0) {
+            for (i = 1; i < d->u.perf.sections; i++)
+                d->u.perf.start[i] = cycles;
+        }
+        d->u.perf.start[n] = cycles;
+        d->u.perf.running[n] = 1;
+        d->u.perf.events[n]++;
+    } else if (reg % 4 == 0 && d->u.perf.running[n]) {
+        if (n == 0) {
+            for (i = 1; i < d->u.perf.sections; i++) {
+                if (d->u.perf.running[i])
+                    d->u.perf.time[i] = perf_time(d, i);
+            }
+        }
+        d->u.perf.time[n] = perf_time(d, n);
+        d->u.perf.running[n] = 0;
+    }
+}
+
+static void lcd_log(struct dev *d)
+{
+    fprintf(stderr, "[%12.6f] %s \"%.16s\" \"%.16s\"\n", now_seconds(), d->name,
+            (char *) d->u.lcd.ddram, (char *) d->u.lcd.ddram + 0x40);
+}
+
+static void io_log(struct dev *d, uint32_t value)
+{
+    fprintf(stderr, "[%12.6f] %s 0x%08x\n", now_seconds(), d->name, value);
+}
+
+static struct dev *find_dev(uint32_t addr)
+{
+    int i;
+
+    for (i = 0; i < ndevs; i++) {
+        if (addr >= devs[i].base && addr < devs[i].base + devs[i].span)
+            return &devs[i];
+    }
+    return NULL;
+}
+
+static uint32_t io_read(struct dev *d, uint32_t addr)
+{
+    int reg = (addr - d->base) / 4, n;
+    uint32_t data, c;
+
+    switch (d->kind) {
+    case DEV_PIO:
+        switch (reg) {
+        case 0: return d->u.pio.has_in ? d->u.pio.in : d->u.pio.out;
+        case 1: return d->u.pio.dir;
+        case 2: return d->u.pio.mask;
+        case 3: return d->u.pio.edge;
+        }
+        return 0;
+    case DEV_TIMER:
+        switch (reg) {
+        case 0: return d->u.tmr.to | (d->u.tmr.running << 1);
+        case 1: return d->u.tmr.control & 0x3;
+        case 2: return d->u.tmr.period & 0xFFFF;
+        case 3: return d->u.tmr.period >> 16;
+        case 4: return d->u.tmr.snap & 0xFFFF;
+        case 5: return d->u.tmr.snap >> 16;
+        }
+        return 0;
+    case DEV_UART:
+        if (reg == 0) {
+            n = uart_rx_count(d);
+            if (n == 0)
+                return 0;
+            data = d->u.uart.rx[d->u.uart.rx_out];
+            d->u.uart.rx_out = (d->u.uart.rx_out + 1) % UART_FIFO;
+            uart_update(d);
+            return data | 0x8000 | ((uint32_t) (n - 1) << 16);
+        }
+        c = d->u.uart.control & 0x3;
+        if ((c & 0x1) && uart_rx_count(d))
+            c |= 0x100;
+        if (c & 0x2)
+            c |= 0x200;
+        return c | 0x400 | ((uint32_t) UART_FIFO << 16);
+    case DEV_PERF:
+        n = reg / 4;
+        if (n >= d->u.perf.sections)
+            return 0;
+        switch (reg % 4) {
+        case 0: return (uint32_t) perf_time(d, n);
+        case 1: return (uint32_t) (perf_time(d, n) >> 32);
+        case 2: return d->u.perf.events[n];
+        }
+        return 0;
+    case DEV_LCD:
+        /* Never busy, the address counter in the status */
+        return (addr - d->base) == 0 ? (uint32_t) d->u.lcd.addr : 0;
+    }
+    return 0;
+}
+
+static void io_write(struct dev *d, uint32_t addr, uint32_t value)
+{
+    int reg = (addr - d->base) / 4;
+    uint32_t old;
+
+    switch (d->kind) {
+    case DEV_PIO:
+        switch (reg) {
+        case 0:
+            old = d->u.pio.out;
+            d->u.pio.out = value & d->u.pio.width;
+            if (opt_io && d->u.pio.out != old)
+                io_log(d, d->u.pio.out);
+            break;
+        case 1: d->u.pio.dir = value; break;
+        case 2: d->u.pio.mask = value & d->u.pio.width; break;
+        case 3:
+            if (d->u.pio.bit_clear)
+                d->u.pio.edge &= ~value;
+            else
+                d->u.pio.edge = 0;
+            break;
+        }
+        pio_update(d);
+        break;
+    case DEV_TIMER:
+        value &= 0xFFFF;
+        switch (reg) {
+        case 0:
+            d->u.tmr.to = 0;
+            break;
+        case 1:
+            d->u.tmr.control = value & 0x3;
+            if ((value & 0x8) && d->u.tmr.running)
+                tmr_stop(d);
+            else if ((value & 0x4) && !d->u.tmr.running)
+                tmr_start(d);
+            break;
+        case 2:
+        case 3:
+            /* Stops the counter and loads the new period */
+            if (reg == 2)
+                d->u.tmr.period = (d->u.tmr.period & 0xFFFF0000) | value;
+            else
+                d->u.tmr.period = (d->u.tmr.period & 0xFFFF) | (value << 16);
+            d->u.tmr.running = 0;
+            d->u.tmr.value = d->u.tmr.period;
+            break;
+        case 4:
+        case 5:
+            d->u.tmr.snap = tmr_counter(d);
+            break;
+        }
+        tmr_expire(d);
+        break;
+    case DEV_UART:
+        if (reg == 0)
+            putchar(value & 0xFF);
+        else
+            d->u.uart.control = value & 0x3;
+        uart_update(d);
+        break;
+    case DEV_PERF:
+        perf_write(d, reg, value);
+        break;
+    case DEV_LCD:
+        if (addr - d->base == 0) {
+            value &= 0xFF;
+            if (value == 0x01) {
+                memset(d->u.lcd.ddram, ' ', sizeof(d->u.lcd.ddram));
+                d->u.lcd.addr = 0;
+            } else if (value == 0x02 || value == 0x03) {
+                d->u.lcd.addr = 0;
+            } else if (value & 0x80) {
+                d->u.lcd.addr = value & 0x7F;
+            }
+        } else {
+            d->u.lcd.ddram[d->u.lcd.addr] = value;
+            d->u.lcd.addr = (d->u.lcd.addr + 1) & 0x7F;
+            if (opt_io)
+                lcd_log(d);
+        }
+        break;
+    }
+}
+
+/*
+ * Events: timer timeouts and the input script
+ */
+static void update_next_event(void)
+{
+    uint64_t at;
+    int i;
+
+    next_event = stop_cycle;
+    for (i = 0; i < ndevs; i++) {
+        if (devs[i].kind == DEV_TIMER && devs[i].u.tmr.running) {
+            at = tmr_timeout(&devs[i]);
+            if (at < next_event)
+                next_event = at;
+        }
+    }
+    if (next_ev < nevents && events[next_ev].cycle < next_event)
+        next_event = events[next_ev].cycle;
+}
+
+static void run_events(void)
+{
+    struct event *e;
+    int i;
+
+    for (i = 0; i < ndevs; i++) {
+        if (devs[i].kind == DEV_TIMER)
+            tmr_expire(&devs[i]);
+    }
+    while (next_ev < nevents && events[next_ev].cycle <= cycles) {
+        e = &events[next_ev++];
+        if (!e->dev)
+            stop_cycle = cycles;
+        else if (e->dev->kind == DEV_UART)
+            uart_input(e->dev, e->text);
+        else
+            pio_input(e->dev, e->value);
+    }
+    update_next_event();
+}
+
+static int event_compare(const void *a, const void *b)
+{
+    const struct event *ea = a, *eb = b;
+
+    if (ea->cycle != eb->cycle)
+        return ea->cycle < eb->cycle ? -1 : 1;
+    return ea < eb ? -1 : 1;
+}
+
+static uint64_t parse_time(const char *text)
+{
+    char *unit;
+    double t = strtod(text, &unit);
+
+    if (unit == text)
+        die("bad time '%s'", text);
+    if (*unit == '\0' || strcmp(unit, "s") == 0)
+        return (uint64_t) (t * cpu_freq + 0.5);
+    if (strcmp(unit, "ms") == 0)
+        return (uint64_t) (t * cpu_freq / 1e3 + 0.5);
+    if (strcmp(unit, "us") == 0)
+        return (uint64_t) (t * cpu_freq / 1e6 + 0.5);
+    if (strcmp(unit, "cyc") == 0)
+        return (uint64_t) t;
+    die("bad time unit in '%s'", text);
+    return 0;
+}
+
+/* The input PIO a script name refers to */
+static struct dev *input_dev(const char *name)
+{
+    const char *match = NULL;
+    int i;
+
+    if (strcmp(name, "sw") == 0)
+        match = "TOGGLE";
+    else if (strcmp(name, "key") == 0)
+        match = "KEY";
+    for (i = 0; i < ndevs; i++) {
+        if (devs[i].kind != DEV_PIO || !devs[i].u.pio.has_in)
+            continue;
+        if (match ? strstr(devs[i].name, match) != NULL
+                  : strcasecmp(devs[i].name, name) == 0)
+            return &devs[i];
+    }
+    return NULL;
+}
+
+static char *unescape(const char *text)
+{
+    char *out = malloc(strlen(text) + 1), *o = out;
+
+    for (; *text && *text != '"'; text++) {
+        if (*text == '\\' && text[1]) {
+            text++;
+            *o++ = *text == 'n' ? '\n' : *text == 'r' ? '\r' : *text == 't' ? '\t' : *text;
+        } else {
+            *o++ = *text;
+        }
+    }
+    *o = '\0';
+    return out;
+}
+
+static void add_event(const char *line, const char *origin, int lineno)
+{
+    char time[32], name[64], value[256];
+    struct event *e;
+    const char *quote;
+    int i, n;
+
+    n = sscanf(line, " %31s %63s %255[^\n]", time, name, value);
+    if (n <= 0 || time[0] == '#')
+        return;
+    if (nevents == MAX_EVENTS)
+        die("%s:%d: too many events", origin, lineno);
+    e = &events[nevents];
+    e->cycle = parse_time(time);
+    if (strcmp(name, "stop") == 0) {
+        e->dev = NULL;
+    } else if (strcmp(name, "uart") == 0) {
+        for (i = 0; i < ndevs && devs[i].kind != DEV_UART; i++)
+            ;
+        quote = n == 3 ? strchr(value, '"') : NULL;
+        if (i == ndevs || !quote)
+            die("%s:%d: uart wants a \"string\"", origin, lineno);
+        e->dev = &devs[i];
+        e->text = unescape(quote + 1);
+    } else {
+        e->dev = input_dev(name);
+        if (!e->dev || n != 3)
+            die("%s:%d: no input '%s' or no value", origin, lineno, name);
+        e->value = strtoul(value, NULL, 0);
+        if (e->dev->u.pio.edge_type == EDGE_FALLING)
+            e->value = ~e->value;
+    }
+    nevents++;
+}
+
+static void load_script(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+    int lineno = 0;
+
+    if (!f)
+        die("cannot open %s", path);
+    while (fgets(line, sizeof(line), f))
+        add_event(line, path, ++lineno);
+    fclose(f);
+}
+
+/*
+ * Memory
+ */
+static inline struct region *find_region(uint32_t addr)
+{
+    int i;
+
+    for (i = 0; i < nregions; i++) {
+        if (addr - regions[i].base < regions[i].size)
+            return &regions[i];
+    }
+    return NULL;
+}
+
+static uint32_t load(uint32_t addr, int size)
+{
+    struct region *m;
+    struct dev *d;
+    uint32_t value = 0, word;
+
+    addr &= 0x7FFFFFFF;                 /* bit 31 bypasses the (absent) cache */
+    addr &= ~(uint32_t) (size - 1);
+    m = find_region(addr);
+    if (m) {
+        cycles += m->read;
+        memcpy(&value, m->mem + addr - m->base, size);
+        return value;
+    }
+    cycles += 2;
+    d = find_dev(addr);
+    if (!d) {
+        if (unmapped++ < 8)
+            fprintf(stderr, "niossim: load from 0x%08x at %s\n", addr, where(pc));
+        return 0;
+    }
+    /* Byte lanes of a 32-bit slave */
+    if (d->kind == DEV_LCD)
+        return io_read(d, addr) & 0xFF;
+    word = io_read(d, addr & ~3u);
+    return (word >> (8 * (addr & 3))) & (size == 4 ? 0xFFFFFFFF : size == 2 ? 0xFFFF : 0xFF);
+}
+
+static void store(uint32_t addr, uint32_t value, int size)
+{
+    struct region *m;
+    struct dev *d;
+
+    addr &= 0x7FFFFFFF;
+    addr &= ~(uint32_t) (size - 1);
+    m = find_region(addr);
+    if (m) {
+        cycles += m->write;
+        memcpy(m->mem + addr - m->base, &value, size);
+        return;
+    }
+    cycles += 2;
+    d = find_dev(addr);
+    if (!d) {
+        if (unmapped++ < 8)
+            fprintf(stderr, "niossim: store to 0x%08x at %s\n", addr, where(pc));
+        return;
+    }
+    if (d->kind == DEV_LCD)
+        io_write(d, addr, value & 0xFF);
+    else
+        io_write(d, addr & ~3u, value << (8 * (addr & 3)));
+    if (d->kind == DEV_TIMER || d->kind == DEV_UART)
+        update_next_event();
+}
+
+/*
+ * CPU
+ */
+static const char *op_names[64] = {
+    "call", "jmpi", "?", "ldbu", "addi", "stb", "br", "ldb",
+    "cmpgei", "?", "?", "ldhu", "andi", "sth", "bge", "ldh",
+    "cmplti", "?", "?", "initda", "ori", "stw", "blt", "ldw",
+    "cmpnei", "?", "?", "flushda", "xori", "?", "bne", "?",
+    "cmpeqi", "?", "?", "ldbuio", "muli", "stbio", "beq", "ldbio",
+    "cmpgeui", "?", "?", "ldhuio", "andhi", "sthio", "bgeu", "ldhio",
+    "cmpltui", "?", "custom", "initd", "orhi", "stwio", "bltu", "ldwio",
+    "rdprs", "?", "R", "flushd", "xorhi", "?", "?", "?",
+};
+
+static const char *opx_names[64] = {
+    "?", "eret", "roli", "rol", "flushp", "ret", "nor", "mulxuu",
+    "cmpge", "bret", "?", "ror", "flushi", "jmp", "and", "?",
+    "cmplt", "?", "slli", "sll", "wrprs", "?", "or", "mulxsu",
+    "cmpne", "?", "srli", "srl", "nextpc", "callr", "xor", "mulxss",
+    "cmpeq", "?", "?", "?", "divu", "div", "rdctl", "mul",
+    "cmpgeu", "initi", "?", "?", "?", "trap", "wrctl", "?",
+    "cmpltu", "add", "?", "?", "break", "?", "sync", "?",
+    "?", "sub", "srai", "sra", "?", "?", "?", "?",
+};
+
+/*
+ * Regions
+ */
+static void add_bench(const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    struct bench *b;
+
+    if (!eq || eq == arg || !eq[1] || eq - arg >= (int) sizeof(b->name)
+        || strlen(eq + 1) >= sizeof(b->funcs))
+        die("bad --region %s, NAME=FUNC[,FUNC...]", arg);
+    if (nbenches == MAX_BENCH)
+        die("more than %d regions", MAX_BENCH);
+    b = &benches[nbenches++];
+    snprintf(b->name, sizeof(b->name), "%.*s", (int) (eq - arg), arg);
+    strcpy(b->funcs, eq + 1);
+}
+
+static void add_span(const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+
+    if (!eq || !strchr(eq, ','))
+        die("bad --span %s, NAME=FROM,TO", arg);
+    add_bench(arg);
+    benches[nbenches - 1].span = 1;
+    nspans++;
+}
+
+static void add_hot(const char *arg)
+{
+    size_t n = strlen(hot_funcs);
+
+    if (n + strlen(arg) + 2 > sizeof(hot_funcs))
+        die("too many --hot functions");
+    snprintf(hot_funcs + n, sizeof(hot_funcs) - n, "%s%s", n ? "," : "", arg);
+}
+
+/* Symbols without a size end at the next symbol */
+static int find_function(const char *name, uint32_t *start, uint32_t *end)
+{
+    int j, k;
+
+    for (j = 0; j < nsyms && strcmp(syms[j].name, name) != 0; j++)
+        ;
+    if (j == nsyms)
+        return 0;
+    *start = syms[j].addr;
+    *end = syms[j].addr + syms[j].size;
+    if (!syms[j].size) {
+        for (k = j + 1; k < nsyms && syms[k].addr <= syms[j].addr; k++)
+            ;
+        *end = k < nsyms ? syms[k].addr : syms[j].addr + 4;
+    }
+    return 1;
+}
+
+/* SYMBOL[+OFFSET] or a hex address */
+static uint32_t parse_addr(const char *arg)
+{
+    char name[128], *plus, *rest;
+    uint32_t start, end, offset = 0;
+
+    snprintf(name, sizeof(name), "%s", arg);
+    if ((plus = strchr(name, '+')) != NULL) {
+        *plus = 0;
+        offset = strtoul(plus + 1, &rest, 0);
+        if (*rest)
+            die("bad offset in %s", arg);
+    }
+    if (!find_function(name, &start, &end)) {
+        start = strtoul(name, &rest, 16);
+        if (!*name || *rest)
+            die("no symbol %s", name);
+    }
+    return start + offset;
+}
+
+/* After load_elf(), a function that is not in the ELF is left out */
+static void resolve_benches(void)
+{
+    char funcs[1024], *name, *save;
+    uint32_t start, end;
+    int i;
+
+    for (i = 0; i < nbenches; i++) {
+        strcpy(funcs, benches[i].funcs);
+        if (benches[i].span) {
+            name = strtok_r(funcs, ",", &save);
+            benches[i].from = parse_addr(name);
+            benches[i].to = parse_addr(save);
+            continue;
+        }
+        for (name = strtok_r(funcs, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+            if (!find_function(name, &start, &end)) {
+                fprintf(stderr, "niossim: region %s: no function %s\n", benches[i].name, name);
+                continue;
+            }
+            if (nprobes == MAX_PROBES)
+                die("more than %d region functions", MAX_PROBES);
+            probes[nprobes].start = start;
+            probes[nprobes].end = end;
+            probes[nprobes].bench = &benches[i];
+            nprobes++;
+        }
+    }
+
+    strcpy(funcs, hot_funcs);
+    for (name = strtok_r(funcs, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+        if (!onchip)
+            die("--hot without an on-chip memory in system.h");
+        if (!find_function(name, &start, &end)) {
+            fprintf(stderr, "niossim: hot: no function %s\n", name);
+            continue;
+        }
+        if (nhots == MAX_HOT)
+            die("more than %d hot functions", MAX_HOT);
+        hot_start[nhots] = start;
+        hot_end[nhots] = end;
+        nhots++;
+    }
+}
+
+/* Extra cycles of an instruction fetch at addr from memory m, the range
+ * around the last address that is either all hot or not at all is kept */
+static inline int fetch_cycles(struct region *m, uint32_t addr)
+{
+    static uint32_t lo, hi;
+    static int hot;
+    int i;
+
+    if (addr - lo >= hi - lo) {
+        lo = 0;
+        hi = 0xFFFFFFFF;
+        hot = 0;
+        for (i = 0; i < nhots; i++) {
+            if (addr - hot_start[i] < hot_end[i] - hot_start[i]) {
+                lo = hot_start[i];
+                hi = hot_end[i];
+                hot = 1;
+                break;
+            }
+            if (hot_end[i] <= addr && hot_end[i] > lo)
+                lo = hot_end[i];
+            if (hot_start[i] > addr && hot_start[i] < hi)
+                hi = hot_start[i];
+        }
+    }
+    return hot ? onchip->fetch : m->fetch;
+}
+
+static void span_step(uint32_t addr)
+{
+    struct bench *b;
+    uint64_t n;
+    int i;
+
+    for (i = 0; i < nbenches; i++) {
+        b = &benches[i];
+        if (!b->span)
+            continue;
+        if (b->open && addr == b->to) {
+            b->open = 0;
+            n = cycles - b->t0;
+            if (!b->samples || n < b->min)
+                b->min = n;
+            if (n > b->max)
+                b->max = n;
+            b->sum += n;
+            b->samples++;
+        }
+        if (!b->open && addr == b->from) {
+            b->open = 1;
+            b->t0 = cycles;
+        }
+    }
+}
+
+static void probe_enter(uint32_t addr)
+{
+    int i;
+
+    for (i = 0; i < nprobes; i++) {
+        if (probes[i].start == addr && !probes[i].open) {
+            probes[i].open = 1;
+            probes[i].t0 = cycles;
+        }
+    }
+}
+
+static void probe_leave(uint32_t addr)
+{
+    struct bench *b;
+    uint64_t n;
+    int i;
+
+    for (i = 0; i < nprobes; i++) {
+        if (probes[i].open && addr - probes[i].start < probes[i].end - probes[i].start) {
+            probes[i].open = 0;
+            n = cycles - probes[i].t0;
+            b = probes[i].bench;
+            if (!b->samples || n < b->min)
+                b->min = n;
+            if (n > b->max)
+                b->max = n;
+            b->sum += n;
+            b->samples++;
+        }
+    }
+}
+
+static void bench_report(void)
+{
+    struct bench *b;
+    int i;
+
+    for (i = 0; i < nbenches; i++) {
+        b = &benches[i];
+        printf("BENCH {\"bench\":\"region\",\"region\":\"%s\",\"functions\":\"%s\","
+               "\"samples\":%llu,\"min\":%llu,\"avg\":%llu,\"max\":%llu}\n",
+               b->name, b->funcs, (unsigned long long) b->samples,
+               (unsigned long long) b->min,
+               (unsigned long long) (b->samples ? b->sum / b->samples : 0),
+               (unsigned long long) b->max);
+    }
+}
+
+/* Traps, unimplemented instructions and interrupts go to the HAL handler */
+static void probe_enter(uint32_t addr);
+
+static void exception(uint32_t ea)
+{
+    ctl[CTL_ESTATUS] = ctl[CTL_STATUS];
+    ctl[CTL_STATUS] &= ~STATUS_PIE;
+    r[REG_EA] = ea;
+    pc = exception_addr;
+    if (nprobes)
+        probe_enter(pc);
+}
+
+static void halt(const char *why)
+{
+    fprintf(stderr, "niossim: %s at %s\n", why, where(pc));
+    halted = 1;
+}
+
+static void run(void)
+{
+    struct region *m;
+    uint32_t insn, a, b, c, imm, npc, ipending;
+    int32_t simm;
+    int op, opx;
+
+    update_next_event();
+    while (cycles < stop_cycle && !halted) {
+        if (cycles >= next_event) {
+            run_events();
+            if (cycles >= stop_cycle)
+                break;
+        }
+        ipending = irq_lines & ctl[CTL_IENABLE];
+        if (ipending && (ctl[CTL_STATUS] & STATUS_PIE)) {
+            /* The handler resumes at ea - 4 */
+            exception(pc + 4);
+            cycles += CYC_ALU;
+        }
+
+        m = fetch_region;
+        if (!m || pc - m->base >= m->size) {
+            m = fetch_region = find_region(pc);
+            if (!m) {
+                halt("fetch outside memory");
+                break;
+            }
+        }
+        memcpy(&insn, m->mem + pc - m->base, 4);
+        if (nspans)
+            span_step(pc);
+        cycles += CYC_ALU + (nhots ? fetch_cycles(m, pc) : m->fetch);
+        insns++;
+
+        op = insn & 0x3F;
+        a = (insn >> 27) & 0x1F;
+        b = (insn >> 22) & 0x1F;
+        imm = (insn >> 6) & 0xFFFF;
+        simm = (int16_t) imm;
+        npc = pc + 4;
+
+        if (opt_trace) {
+            fprintf(stderr, "%12llu %s %08x %s\n", (unsigned long long) cycles,
+                    where(pc), insn, op == 0x3A ? opx_names[(insn >> 11) & 0x3F] : op_names[op]);
+        }
+
+        switch (op) {
+        case 0x00: r[REG_RA] = npc;     /* call */
+                   /* fall through */
+        case 0x01: npc = (pc & 0xF0000000) | ((insn >> 6) << 2); break;
+        case 0x03: case 0x23: r[b] = load(r[a] + simm, 1); cycles += CYC_LDST_B - CYC_ALU; break;
+        case 0x07: case 0x27: r[b] = (int8_t) load(r[a] + simm, 1); cycles += CYC_LDST_B - CYC_ALU; break;
+        case 0x0B: case 0x2B: r[b] = load(r[a] + simm, 2); cycles += CYC_LDST_H - CYC_ALU; break;
+        case 0x0F: case 0x2F: r[b] = (int16_t) load(r[a] + simm, 2); cycles += CYC_LDST_H - CYC_ALU; break;
+        case 0x17: case 0x37: r[b] = load(r[a] + simm, 4); break;
+        case 0x05: case 0x25: store(r[a] + simm, r[b] & 0xFF, 1); cycles += CYC_LDST_B - CYC_ALU; break;
+        case 0x0D: case 0x2D: store(r[a] + simm, r[b] & 0xFFFF, 2); cycles += CYC_LDST_H - CYC_ALU; break;
+        case 0x15: case 0x35: store(r[a] + simm, r[b], 4); break;
+        case 0x04: r[b] = r[a] + simm; break;
+        case 0x0C: r[b] = r[a] & imm; break;
+        case 0x14: r[b] = r[a] | imm; break;
+        case 0x1C: r[b] = r[a] ^ imm; break;
+        case 0x2C: r[b] = r[a] & (imm << 16); break;
+        case 0x34: r[b] = r[a] | (imm << 16); break;
+        case 0x3C: r[b] = r[a] ^ (imm << 16); break;
+        case 0x08: r[b] = (int32_t) r[a] >= simm; break;
+        case 0x10: r[b] = (int32_t) r[a] < simm; break;
+        case 0x18: r[b] = r[a] != (uint32_t) simm; break;
+        case 0x20: r[b] = r[a] == (uint32_t) simm; break;
+        case 0x28: r[b] = r[a] >= imm; break;
+        case 0x30: r[b] = r[a] < imm; break;
+        case 0x06: npc += simm; break;
+        case 0x0E: if ((int32_t) r[a] >= (int32_t) r[b]) npc += simm; break;
+        case 0x16: if ((int32_t) r[a] < (int32_t) r[b]) npc += simm; break;
+        case 0x1E: if (r[a] != r[b]) npc += simm; break;
+        case 0x26: if (r[a] == r[b]) npc += simm; break;
+        case 0x2E: if (r[a] >= r[b]) npc += simm; break;
+        case 0x36: if (r[a] < r[b]) npc += simm; break;
+        case 0x13: case 0x1B: case 0x33: case 0x3B:     /* no data cache */
+            break;
+        case 0x38: r[b] = r[a] + simm; break;           /* rdprs, one register set */
+        case 0x24:                                      /* muli */
+            exception(npc);
+            continue;
+        case 0x3A:
+            c = (insn >> 17) & 0x1F;
+            opx = (insn >> 11) & 0x3F;
+            imm = (insn >> 6) & 0x1F;
+            switch (opx) {
+            case 0x31: r[c] = r[a] + r[b]; break;
+            case 0x39: r[c] = r[a] - r[b]; break;
+            case 0x0E: r[c] = r[a] & r[b]; break;
+            case 0x16: r[c] = r[a] | r[b]; break;
+            case 0x1E: r[c] = r[a] ^ r[b]; break;
+            case 0x06: r[c] = ~(r[a] | r[b]); break;
+            case 0x08: r[c] = (int32_t) r[a] >= (int32_t) r[b]; break;
+            case 0x10: r[c] = (int32_t) r[a] < (int32_t) r[b]; break;
+            case 0x18: r[c] = r[a] != r[b]; break;
+            case 0x20: r[c] = r[a] == r[b]; break;
+            case 0x28: r[c] = r[a] >= r[b]; break;
+            case 0x30: r[c] = r[a] < r[b]; break;
+            case 0x02: r[c] = imm ? (r[a] << imm) | (r[a] >> (32 - imm)) : r[a];
+                       cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x03: imm = r[b] & 0x1F;
+                       r[c] = imm ? (r[a] << imm) | (r[a] >> (32 - imm)) : r[a];
+                       cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x0B: imm = r[b] & 0x1F;
+                       r[c] = imm ? (r[a] >> imm) | (r[a] << (32 - imm)) : r[a];
+                       cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x12: r[c] = r[a] << imm; cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x13: imm = r[b] & 0x1F; r[c] = r[a] << imm;
+                       cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x1A: r[c] = r[a] >> imm; cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x1B: imm = r[b] & 0x1F; r[c] = r[a] >> imm;
+                       cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x3A: r[c] = (int32_t) r[a] >> imm; cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x3B: imm = r[b] & 0x1F; r[c] = (int32_t) r[a] >> imm;
+                       cycles += CYC_SHIFT - CYC_ALU + imm; break;
+            case 0x05: npc = r[REG_RA]; break;          /* ret */
+            case 0x0D: npc = r[a]; break;               /* jmp */
+            case 0x1D: npc = r[a]; r[REG_RA] = pc + 4; break;   /* callr */
+            case 0x1C: r[c] = npc; break;               /* nextpc */
+            case 0x01:                                  /* eret */
+                ctl[CTL_STATUS] = ctl[CTL_ESTATUS];
+                npc = r[REG_EA];
+                break;
+            case 0x09:                                  /* bret */
+                ctl[CTL_STATUS] = ctl[CTL_BSTATUS];
+                npc = r[REG_BA];
+                break;
+            case 0x26:                                  /* rdctl */
+                r[c] = imm == CTL_IPENDING ? ipending : imm < 16 ? ctl[imm] : 0;
+                break;
+            case 0x2E:                                  /* wrctl */
+                if (imm < CTL_IPENDING)
+                    ctl[imm] = r[a];
+                break;
+            case 0x2D:                                  /* trap */
+                exception(npc);
+                continue;
+            case 0x34:                                  /* break */
+                ctl[CTL_BSTATUS] = ctl[CTL_STATUS];
+                r[REG_BA] = npc;
+                halt("break");
+                continue;
+            case 0x07: case 0x17: case 0x1F:            /* no multiplier */
+            case 0x24: case 0x25: case 0x27:            /* and no divider */
+                exception(npc);
+                continue;
+            case 0x04: case 0x0C: case 0x29: case 0x36: /* no caches, no pipeline */
+                break;
+            case 0x14: r[c] = r[a]; break;              /* wrprs, one register set */
+            default:
+                halt("illegal instruction");
+                continue;
+            }
+            break;
+        default:
+            halt("illegal instruction");
+            continue;
+        }
+        r[0] = 0;
+
+        /* Regions start and end at jumps */
+        if (nprobes && npc != pc + 4) {
+            if (op == 0x3A && (opx == 0x05 || opx == 0x01))
+                probe_leave(pc);
+            probe_enter(npc);
+        }
+
+        /* A branch to itself with interrupts off never ends */
+        if (npc == pc && !(ctl[CTL_STATUS] & STATUS_PIE)) {
+            halt("stopped");
+            break;
+        }
+        pc = npc;
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: niossim ELF [--system bsp/system.h] [--time T] [--input FILE]\n"
+            "               [--event \"T DEVICE VALUE\"] [--wait REGION=FETCH,READ,WRITE]\n"
+            "               [--region NAME=FUNC[,FUNC...]] [--span NAME=FROM,TO]\n"
+            "               [--hot FUNC[,FUNC...]] [--io] [--trace] [--quiet]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        { "system", required_argument, NULL, 's' },
+        { "time",   required_argument, NULL, 't' },
+        { "input",  required_argument, NULL, 'i' },
+        { "event",  required_argument, NULL, 'e' },
+        { "wait",   required_argument, NULL, 'w' },
+        { "io",     no_argument,       NULL, 'o' },
+        { "trace",  no_argument,       NULL, 'T' },
+        { "region", required_argument, NULL, 'r' },
+        { "span",   required_argument, NULL, 'S' },
+        { "hot",    required_argument, NULL, 'H' },
+        { "quiet",  no_argument,       NULL, 'q' },
+        { NULL, 0, NULL, 0 }
+    };
+    const char *system = NULL, *time = "10", *elf, *slash;
+    const char *waits[16];
+    int nwaits = 0, quiet = 0, opt, i;
+    char path[1024];
+    struct timespec t0, t1;
+    double host;
+
+    while ((opt = getopt_long(argc, argv, "s:t:i:e:w:q", options, NULL)) != -1) {
+        switch (opt) {
+        case 's': system = optarg; break;
+        case 't': time = optarg; break;
+        case 'i': case 'e': break;              /* once system.h is read */
+        case 'w':
+            if (nwaits == 16)
+                usage();
+            waits[nwaits++] = optarg;
+            break;
+        case 'o': opt_io = 1; break;
+        case 'T': opt_trace = 1; break;
+        case 'r': add_bench(optarg); break;
+        case 'S': add_span(optarg); break;
+        case 'H': add_hot(optarg); break;
+        case 'q': quiet = 1; break;
+        default: usage();
+        }
+    }
+    if (optind != argc - 1)
+        usage();
+    elf = argv[optind];
+
+    /* The BSP next to bin/ by default */
+    if (!system) {
+        slash = strrchr(elf, '/');
+        snprintf(path, sizeof(path), "%.*s%s../bsp/system.h",
+                 slash ? (int) (slash - elf + 1) : 0, elf, slash ? "" : "");
+        system = path;
+    }
+    load_system(system);
+    for (i = 0; i < nwaits; i++)
+        set_wait(waits[i]);
+    load_elf(elf);
+    resolve_benches();
+
+    /* Scripts and single events, in command line order */
+    optind = 0;
+    while ((opt = getopt_long(argc, argv, "s:t:i:e:w:q", options, NULL)) != -1) {
+        if (opt == 'i')
+            load_script(optarg);
+        else if (opt == 'e')
+            add_event(optarg, "--event", 1);
+    }
+    qsort(events, nevents, sizeof(events[0]), event_compare);
+    stop_cycle = parse_time(time);
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    run();
+    bench_report();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fflush(stdout);
+
+    host = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (opt_io) {
+        for (i = 0; i < ndevs; i++) {
+            if (devs[i].kind == DEV_LCD)
+                lcd_log(&devs[i]);
+        }
+    }
+    if (!quiet) {
+        fprintf(stderr, "niossim: %.6f s, %llu cycles, %llu instructions (CPI %.2f), "
+                "%.2f s host (%.1f MIPS)\n", now_seconds(),
+                (unsigned long long) cycles, (unsigned long long) insns,
+                insns ? (double) cycles / insns : 0.0, host,
+                host > 0 ? insns / host / 1e6 : 0.0);
+        if (unmapped)
+            fprintf(stderr, "niossim: %llu accesses outside system.h\n",
+                    (unsigned long long) unmapped);
+    }
+    return halted;
+}
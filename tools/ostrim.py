@@ -0,0 +1,611 @@
+#!/usr/bin/env python3
+"""Cuts the uC/OS-II configuration of an application to what it uses.
+
+The BSP builds the kernel with the defaults of the BSP editor: 60 events,
+20 flag groups, 60 memory partitions, 20 queues, 16 timers, 32-byte names
+and every service compiled in. This scans the sources of the application
+(src/ and the C_SRCS of gen/Makefile, i.e. app/common) for the kernel
+calls and objects it uses, adds what the HAL, the drivers and the kernel
+create themselves, and writes:
+
+  --header   os_cfg_trim.h, included at the end of os_cfg.h of the BSP; it
+             overrides system.h and os_cfg.h, so no nios2-bsp run is needed
+  --settings the same as "--set <setting> <value>" lines for nios2-bsp, to
+             make it permanent in settings.bsp (the os_cfg.h only options
+             are not BSP settings and stay in the header)
+
+Objects are counted per create call: a create in a function that is itself
+called (e.g. basic_task_create) counts once per call of that function. A
+create in a loop counts once, add the rest with --extra sem=N.
+Priorities are not resolved, OS_LOWEST_PRIO is kept.
+
+The report gives the savings the new configuration should bring:
+
+  RAM   the kernel tables and system task stacks, sized from the kernel
+        structures for Nios II (they match the sizes in the symbol table)
+  ROM   the functions of the services that are left out, from the symbol
+        table in bin/<app>.objdump of the current build
+  tick  the TCBs OSTimeTick() walks, the tick step check, and the timers
+        OSTmr_Task() walks per timer tick (OS_TMR_CFG_WHEEL_SIZE is made
+        the power of 2 above the number of timers)
+
+The measured numbers come from building again: footprint.py against the
+untrimmed map, and the tick stage of hot_bench. ./run.sh trim does both,
+after the driving scenarios of the host port (bsp/host) passed with the
+trimmed header: a count that is too low only fails at run time, a task
+that is not created or an event that is not allocated.
+
+usage: ostrim.py app/DONE_cruise_control [--header os_cfg_trim.h] [--settings trim.args]
+       ostrim.py app/DONE_cruise_control --header os_cfg_trim.h --full
+"""
+import argparse
+import glob
+import os
+import re
+import sys
+
+# Object kind of every create call
+CREATES = {
+    "OSSemCreate": "sem",
+    "OSMboxCreate": "mbox",
+    "OSQCreate": "q",
+    "OSMutexCreate": "mutex",
+    "OSFlagCreate": "flag",
+    "OSMemCreate": "mem",
+    "OSTmrCreate": "tmr",
+    "OSTaskCreate": "task",
+    "OSTaskCreateExt": "task",
+}
+
+# What the HAL, the drivers and the kernel use on their own:
+# (condition, who, objects, calls)
+PLATFORM = [
+    (None, "newlib env/heap locks (alt_hooks.h)", {"sem": 2},
+     ["OSSemCreate", "OSSemPend", "OSSemPost"]),
+    ("OS_THREAD_SAFE_NEWLIB", "newlib locks (alt_env_lock.c, alt_malloc_lock.c)", {},
+     ["OSSemQuery", "OSTaskQuery"]),
+    (None, "fd list lock (alt_main.c)", {"sem": 1},
+     ["OSSemCreate", "OSSemPend", "OSSemPost"]),
+    ("jtag", "JTAG UART driver (altera_avalon_jtag_uart_init.c)", {"sem": 2, "flag": 1},
+     ["OSSemCreate", "OSSemPend", "OSSemPost", "OSFlagCreate", "OSFlagPend", "OSFlagPost"]),
+    # OSTmr_Task() takes a TCB of OS_MAX_TASKS, OS_N_SYS_TASKS only counts
+    # the idle and statistics tasks
+    ("tmr", "timer manager (os_tmr.c)", {"sem": 2, "task": 1},
+     ["OSSemCreate", "OSSemPend", "OSSemPost"]),
+]
+
+# Service options and the identifiers that need them
+SERVICES = [
+    ("OS_SEM_EN", r"OSSem\w+"),
+    ("OS_SEM_ACCEPT_EN", r"OSSemAccept"),
+    ("OS_SEM_DEL_EN", r"OSSemDel"),
+    ("OS_SEM_QUERY_EN", r"OSSemQuery"),
+    ("OS_SEM_SET_EN", r"OSSemSet"),
+    ("OS_SEM_PEND_ABORT_EN", r"OSSemPendAbort"),
+    ("OS_MBOX_EN", r"OSMbox\w+"),
+    ("OS_MBOX_ACCEPT_EN", r"OSMboxAccept"),
+    ("OS_MBOX_DEL_EN", r"OSMboxDel"),
+    ("OS_MBOX_POST_EN", r"OSMboxPost"),
+    ("OS_MBOX_POST_OPT_EN", r"OSMboxPostOpt"),
+    ("OS_MBOX_QUERY_EN", r"OSMboxQuery"),
+    ("OS_MBOX_PEND_ABORT_EN", r"OSMboxPendAbort"),
+    ("OS_Q_EN", r"OSQ[A-Z]\w*"),
+    ("OS_Q_ACCEPT_EN", r"OSQAccept"),
+    ("OS_Q_DEL_EN", r"OSQDel"),
+    ("OS_Q_FLUSH_EN", r"OSQFlush"),
+    ("OS_Q_POST_EN", r"OSQPost"),
+    ("OS_Q_POST_FRONT_EN", r"OSQPostFront"),
+    ("OS_Q_POST_OPT_EN", r"OSQPostOpt"),
+    ("OS_Q_QUERY_EN", r"OSQQuery"),
+    ("OS_Q_PEND_ABORT_EN", r"OSQPendAbort"),
+    ("OS_FLAG_EN", r"OSFlag\w+"),
+    ("OS_FLAG_ACCEPT_EN", r"OSFlagAccept"),
+    ("OS_FLAG_DEL_EN", r"OSFlagDel"),
+    ("OS_FLAG_QUERY_EN", r"OSFlagQuery"),
+    ("OS_FLAG_WAIT_CLR_EN", r"OS_FLAG_WAIT_CLR_\w+"),
+    ("OS_MUTEX_EN", r"OSMutex\w+"),
+    ("OS_MUTEX_ACCEPT_EN", r"OSMutexAccept"),
+    ("OS_MUTEX_DEL_EN", r"OSMutexDel"),
+    ("OS_MUTEX_QUERY_EN", r"OSMutexQuery"),
+    ("OS_MEM_EN", r"OSMem\w+"),
+    ("OS_MEM_QUERY_EN", r"OSMemQuery"),
+    ("OS_TMR_EN", r"OSTmr\w+"),
+    ("OS_TASK_CHANGE_PRIO_EN", r"OSTaskChangePrio"),
+    ("OS_TASK_CREATE_EN", r"OSTaskCreate"),
+    ("OS_TASK_CREATE_EXT_EN", r"OSTaskCreateExt|OSTaskStkChk|OSTCBStkBottom|OSTCBStkSize|OSTCBExtPtr"),
+    ("OS_TASK_DEL_EN", r"OSTaskDel\w*"),
+    ("OS_TASK_QUERY_EN", r"OSTaskQuery"),
+    ("OS_TASK_SUSPEND_EN", r"OSTaskSuspend|OSTaskResume"),
+    ("OS_TASK_PROFILE_EN", r"OSTCBCtxSwCtr|OSTCBCyclesTot|OSTCBCyclesStart|OSTCBStkBase|OSTCBStkUsed"),
+    ("OS_TASK_STAT_EN", r"OSStatInit|OSCPUUsage|OSIdleCtrMax|OSIdleCtrRun|OSStatRdy|task_acct_stat|stack_mon_sample"),
+    ("OS_TIME_DLY_HMSM_EN", r"OSTimeDlyHMSM"),
+    ("OS_TIME_DLY_RESUME_EN", r"OSTimeDlyResume"),
+    ("OS_TIME_GET_SET_EN", r"OSTimeGet|OSTimeSet"),
+    ("OS_SCHED_LOCK_EN", r"OSSchedLock|OSSchedUnlock"),
+    ("OS_EVENT_MULTI_EN", r"OSEventPendMulti"),
+    # Only read by debuggers and uC/OS-View
+    ("OS_DEBUG_EN", r"OSDebugInit"),
+    ("OS_TICK_STEP_EN", r"OSTickStepState"),
+]
+
+# Names: size option, calls that name or read the object, argument with
+# the name, shortest name the kernel gives its own objects of that kind
+NAMES = [
+    ("OS_TASK_NAME_SIZE", r"OSTaskName(Set|Get)", {"OSTaskNameSet": 1}, 8),
+    ("OS_EVENT_NAME_SIZE", r"OSEventName(Set|Get)", {"OSEventNameSet": 1}, 11),
+    ("OS_FLAG_NAME_SIZE", r"OSFlagName(Set|Get)", {"OSFlagNameSet": 1}, 0),
+    ("OS_MEM_NAME_SIZE", r"OSMemName(Set|Get)", {"OSMemNameSet": 1}, 0),
+    ("OS_TMR_CFG_NAME_SIZE", r"OSTmrNameGet", {"OSTmrCreate": 5}, 0),
+]
+
+# Functions left out with a service option, matched on the symbol table
+FUNCTIONS = {
+    "OS_SEM_EN": r"OSSem\w+",
+    "OS_MBOX_EN": r"OSMbox\w+",
+    "OS_Q_EN": r"OSQ[A-Z]\w*|OS_QInit",
+    "OS_FLAG_EN": r"OSFlag\w+|OS_Flag\w+",
+    "OS_MUTEX_EN": r"OSMutex\w+",
+    "OS_MEM_EN": r"OSMem\w+|OS_MemInit",
+    "OS_TMR_EN": r"OSTmr\w+",
+    "OS_TASK_STAT_EN": r"OS_TaskStat\w*|OSStatInit",
+    "OS_TASK_DEL_EN": r"OSTaskDel\w*",
+    "OS_TASK_SUSPEND_EN": r"OSTaskSuspend|OSTaskResume",
+    "OS_EVENT_MULTI_EN": r"OSEventPendMulti",
+    "OS_DEBUG_EN": r"OSDebugInit",
+    "OS_TASK_NAME_SIZE": r"OSTaskName(Get|Set)",
+    "OS_EVENT_NAME_SIZE": r"OSEventName(Get|Set)",
+    "OS_FLAG_NAME_SIZE": r"OSFlagName(Get|Set)",
+    "OS_MEM_NAME_SIZE": r"OSMemName(Get|Set)",
+    "OS_TMR_CFG_NAME_SIZE": r"OSTmrNameGet",
+}
+FUNCTIONS.update((knob, pattern) for knob, pattern in SERVICES if knob not in FUNCTIONS)
+
+TOKEN = re.compile(r"\"(?:\\.|[^\"\\])*\"|'(?:\\.|[^'\\])*'|[{};]|\b[A-Za-z_]\w*(?=\s*\()")
+COMMENT = re.compile(r"//[^\n]*|/\*.*?\*/|(\"(?:\\.|[^\"\\])*\"|'(?:\\.|[^'\\])*')", re.S)
+DIRECTIVE = re.compile(r"^[ \t]*#(?:[^\n]*\\\n)*[^\n]*", re.M)
+LITERAL = re.compile(r"\"((?:\\.|[^\"\\])*)\"")
+SYMBOL = re.compile(r"^([0-9a-f]{8}) (.{7}) (\S+)\t([0-9a-f]+) (.+)$")
+KEYWORDS = {"if", "while", "for", "switch", "return", "sizeof", "defined"}
+
+
+def strip_comments(text):
+    return COMMENT.sub(lambda m: m.group(1) or " ", text)
+
+
+def arguments(text, pos):
+    """Splits the argument list that starts at text[pos] == '('."""
+    args, depth, start, i = [], 0, pos + 1, pos
+    while i < len(text):
+        c = text[i]
+        if c in "\"'":
+            m = re.compile(r"%s(?:\\.|[^%s\\])*%s" % (c, c, c)).match(text, i)
+            i = m.end() if m else i + 1
+            continue
+        if c == "(":
+            depth += 1
+        elif c == ")":
+            depth -= 1
+            if depth == 0:
+                args.append(text[start:i].strip())
+                break
+        elif c == "," and depth == 1:
+            args.append(text[start:i].strip())
+            start = i + 1
+        i += 1
+    return args
+
+
+def scan(path):
+    """Returns the calls [(function, callee, args)] and the identifiers of a C file."""
+    with open(path, errors="replace") as source:
+        text = DIRECTIVE.sub("", strip_comments(source.read()))
+    calls = []
+    depth, current, pending = 0, None, None
+    for m in TOKEN.finditer(text):
+        token = m.group(0)
+        if token[0] in "\"'":
+            continue
+        if token == "{":
+            if depth == 0:
+                current = pending
+            depth += 1
+        elif token == "}":
+            depth = max(depth - 1, 0)
+            if depth == 0:
+                current = pending = None
+        elif token == ";":
+            if depth == 0:
+                pending = None
+        elif depth == 0:
+            # The first name with arguments, not those of a parameter
+            if pending is None:
+                pending = token
+        elif token not in KEYWORDS:
+            paren = text.index("(", m.end())
+            calls.append((current, token, arguments(text, paren)))
+    idents = set(re.findall(r"\b[A-Za-z_]\w*\b", LITERAL.sub("", text)))
+    return calls, idents
+
+
+def sources(app, extra):
+    """src/ of the application and the C_SRCS of its gen/Makefile."""
+    paths = sorted(glob.glob(os.path.join(app, "src", "*.[ch]")))
+    makefile = os.path.join(app, "gen", "Makefile")
+    if os.path.exists(makefile):
+        with open(makefile, errors="replace") as mk:
+            for line in mk:
+                m = re.match(r"^C_SRCS\s*\+=\s*(\S+)", line)
+                if m:
+                    path = os.path.normpath(os.path.join(app, "gen", m.group(1)))
+                    paths.append(path)
+                    header = os.path.splitext(path)[0] + ".h"
+                    if os.path.exists(header):
+                        paths.append(header)
+    return paths + list(extra)
+
+
+def read_defines(path):
+    values = {}
+    if os.path.exists(path):
+        with open(path, errors="replace") as header:
+            for line in header:
+                m = re.match(r"#define\s+(\w+)(?:\s+(\S+))?", line)
+                if m:
+                    values[m.group(1)] = m.group(2) or ""
+    return values
+
+
+def read_settings(path):
+    """{identifier: setting name} of the uC/OS-II options in settings.bsp."""
+    names = {}
+    if os.path.exists(path):
+        with open(path, errors="replace") as settings:
+            text = settings.read()
+        for block in re.findall(r"<Setting>(.*?)</Setting>", text, re.S):
+            name = re.search(r"<SettingName>(.*?)</SettingName>", block)
+            ident = re.search(r"<Identifier>(.*?)</Identifier>", block)
+            if name and ident and name.group(1).startswith("ucosii."):
+                names[ident.group(1)] = name.group(1)
+    return names
+
+
+def read_symbols(path):
+    """{name: (kind, size)} from the symbol table of an objdump listing."""
+    symbols = {}
+    if path and os.path.exists(path):
+        with open(path, errors="replace") as listing:
+            for line in listing:
+                m = SYMBOL.match(line.rstrip("\n"))
+                if m and m.group(2)[6] in "FO":
+                    symbols[m.group(5)] = (m.group(2)[6], int(m.group(4), 16))
+    return symbols
+
+
+def weight(function, callers, seen=()):
+    """How often a call in 'function' runs: once per call of the function."""
+    sites = callers.get(function, [])
+    if not sites or function in seen:
+        return 1
+    return sum(weight(caller, callers, seen + (function,)) for caller in sites)
+
+
+def round4(n):
+    return (n + 3) // 4 * 4
+
+
+def trim(calls, idents, defines, extra):
+    """Returns the trimmed configuration and the reason for every option."""
+    callers = {}
+    for function, callee, _args in calls:
+        callers.setdefault(callee, []).append(function)
+
+    counts = {}
+    for function, callee, _args in calls:
+        if callee in CREATES:
+            kind = CREATES[callee]
+            counts[kind] = counts.get(kind, 0) + weight(function, callers)
+    used = set(idents) | {callee for _f, callee, _a in calls}
+
+    jtag = "__ALTERA_AVALON_JTAG_UART" in defines and "ALTERA_AVALON_JTAG_UART_SMALL" not in defines
+    # OS_TMR_EN stays on for any OSTmr call (SERVICES), and OSInit() then creates the timer task
+    tmr = counts.get("tmr", 0) > 0 or any(re.match(r"^OSTmr\w+$", u) for u in used)
+    has = {"jtag": jtag, "tmr": tmr,
+           "OS_THREAD_SAFE_NEWLIB": defines.get("OS_THREAD_SAFE_NEWLIB", "0") != "0"}
+    platform = {}
+    for cond, _who, objects, needs in PLATFORM:
+        if cond is None or has[cond]:
+            for kind, n in objects.items():
+                platform[kind] = platform.get(kind, 0) + n
+            used.update(needs)
+    for kind, n in extra.items():
+        platform[kind] = platform.get(kind, 0) + n
+
+    def total(kind):
+        return counts.get(kind, 0) + platform.get(kind, 0)
+
+    def because(kinds):
+        parts = ["%d %s" % (counts[k], k) for k in kinds if counts.get(k)]
+        hal = sum(platform.get(k, 0) for k in kinds)
+        if hal:
+            parts.append("%d HAL/kernel" % hal)
+        return ", ".join(parts) or "none used"
+
+    cfg, why = {}, {}
+    for knob, pattern in SERVICES:
+        rx = re.compile(r"^(%s)$" % pattern)
+        users = sorted(u for u in used if rx.match(u))
+        cfg[knob] = 1 if users else 0
+        why[knob] = ", ".join(users[:3]) + (" ..." if len(users) > 3 else "") if users else "not used"
+
+    events = total("sem") + total("mbox") + total("q") + total("mutex")
+    cfg["OS_MAX_EVENTS"], why["OS_MAX_EVENTS"] = max(events, 1), because(("sem", "mbox", "q", "mutex"))
+    cfg["OS_MAX_QS"], why["OS_MAX_QS"] = max(total("q"), 1), because(("q",))
+    cfg["OS_MAX_FLAGS"], why["OS_MAX_FLAGS"] = max(total("flag"), 1), because(("flag",))
+    cfg["OS_MAX_MEM_PART"], why["OS_MAX_MEM_PART"] = max(total("mem"), 1), because(("mem",))
+    cfg["OS_MAX_TASKS"], why["OS_MAX_TASKS"] = max(total("task"), 1), because(("task",))
+    cfg["OS_TMR_CFG_MAX"], why["OS_TMR_CFG_MAX"] = max(total("tmr"), 1), because(("tmr",))
+    wheel = 1
+    while wheel < total("tmr"):
+        wheel *= 2
+    cfg["OS_TMR_CFG_WHEEL_SIZE"] = wheel
+    why["OS_TMR_CFG_WHEEL_SIZE"] = "about 1 timer per spoke"
+
+    for knob, pattern, setters, kernel in NAMES:
+        rx = re.compile(r"^(%s)$" % pattern)
+        names, unknown = [], False
+        for _f, callee, args in calls:
+            if callee in setters and len(args) > setters[callee]:
+                literal = LITERAL.search(args[setters[callee]])
+                if literal:
+                    names.append(literal.group(1))
+                elif not re.match(r"^\(?\s*(NULL|0|\(void\s*\*\)\s*0)\s*\)?$", args[setters[callee]]):
+                    unknown = True
+        read = any(rx.match(u) for u in used)
+        if unknown:
+            cfg[knob], why[knob] = int(defines.get(knob, "32")), "name not a literal, kept"
+        elif names or read:
+            longest = max([len(n) + 1 for n in names] + [kernel if read else 0])
+            cfg[knob] = round4(longest)
+            why[knob] = "longest %d chars" % (longest - 1)
+        else:
+            cfg[knob], why[knob] = 1, "no names used"
+    return cfg, why, counts, platform
+
+
+def current(defines, osconfig):
+    cfg = {}
+    for source in (osconfig, defines):
+        for name, value in source.items():
+            if name.startswith("OS_") and re.match(r"^\d+$", value):
+                cfg[name] = int(value)
+    return cfg
+
+
+def layout(fields):
+    """Size of a struct of (size, alignment) fields on Nios II."""
+    offset, align = 0, 1
+    for size, a in fields:
+        offset = (offset + a - 1) // a * a + size
+        align = max(align, a)
+    return (offset + align - 1) // align * align
+
+
+def ram(cfg):
+    """{table: bytes} of the kernel tables and system task stacks."""
+    c = lambda name, default=0: cfg.get(name, default)
+    small = c("OS_LOWEST_PRIO", 63) <= 63
+    tbl = (c("OS_LOWEST_PRIO") // 8 + 1) if small else 2 * (c("OS_LOWEST_PRIO") // 16 + 1)
+    grp = (1, 1) if small else (2, 2)
+    flags = c("OS_FLAGS_NBITS", 16) // 8
+    name = lambda knob: [(c(knob), 1)] if c(knob) > 1 else []
+    event_en = ((c("OS_Q_EN") and c("OS_MAX_QS")) or c("OS_MBOX_EN") or c("OS_SEM_EN")
+                or c("OS_MUTEX_EN"))
+    flag_en = c("OS_FLAG_EN") and c("OS_MAX_FLAGS")
+
+    tables = {}
+    if event_en:
+        event = layout([(1, 1), (4, 4), (2, 2), grp, (tbl, grp[1])] + name("OS_EVENT_NAME_SIZE"))
+        tables["OSEventTbl"] = event * c("OS_MAX_EVENTS")
+    if flag_en:
+        tables["OSFlagTbl"] = layout([(1, 1), (4, 4), (flags, flags)]
+                                     + name("OS_FLAG_NAME_SIZE")) * c("OS_MAX_FLAGS")
+    if c("OS_MEM_EN") and c("OS_MAX_MEM_PART"):
+        tables["OSMemTbl"] = layout([(4, 4)] * 5 + name("OS_MEM_NAME_SIZE")) * c("OS_MAX_MEM_PART")
+    if c("OS_Q_EN") and c("OS_MAX_QS"):
+        tables["OSQTbl"] = layout([(4, 4)] * 5 + [(2, 2)] * 2) * c("OS_MAX_QS")
+
+    tcb = [(4, 4)]
+    if c("OS_TASK_CREATE_EXT_EN"):
+        tcb += [(4, 4)] * 3 + [(2, 2)] * 2
+    tcb += [(4, 4)] * 2
+    if event_en or c("OS_FLAG_EN"):
+        tcb.append((4, 4))
+    if event_en and c("OS_EVENT_MULTI_EN"):
+        tcb.append((4, 4))
+    if (c("OS_Q_EN") and c("OS_MAX_QS")) or c("OS_MBOX_EN"):
+        tcb.append((4, 4))
+    if flag_en:
+        if c("OS_TASK_DEL_EN"):
+            tcb.append((4, 4))
+        tcb.append((flags, flags))
+    tcb += [(2, 2)] + [(1, 1)] * 5 + [grp] * 2
+    if c("OS_TASK_DEL_EN"):
+        tcb.append((1, 1))
+    if c("OS_TASK_PROFILE_EN"):
+        tcb += [(4, 4)] * 5
+    tcb += name("OS_TASK_NAME_SIZE")
+    sys_tasks = 2 if c("OS_TASK_STAT_EN") else 1
+    tables["OSTCBTbl"] = layout(tcb) * (c("OS_MAX_TASKS") + sys_tasks)
+    if c("OS_TASK_STAT_EN"):
+        tables["OSTaskStatStk"] = 4 * c("OS_TASK_STAT_STK_SIZE")
+
+    if c("OS_TMR_EN"):
+        tmr = [(1, 1)] + [(4, 4)] * 7
+        if c("OS_TMR_CFG_NAME_SIZE") > 0:
+            tmr.append((c("OS_TMR_CFG_NAME_SIZE"), 1))
+        tmr += [(1, 1)] * 2
+        tables["OSTmrTbl"] = layout(tmr) * c("OS_TMR_CFG_MAX")
+        tables["OSTmrWheelTbl"] = 8 * c("OS_TMR_CFG_WHEEL_SIZE")
+        tables["OSTmrTaskStk"] = 4 * c("OS_TASK_TMR_STK_SIZE")
+    return tables
+
+
+def rom(full, trimmed, symbols, dbg_names):
+    """{option: (bytes, functions)} of the code and constants left out."""
+    dropped = {}
+    for knob, pattern in FUNCTIONS.items():
+        if not (full.get(knob, 0) > 1 if knob.endswith("_SIZE") else full.get(knob, 0)):
+            continue
+        if knob.endswith("_SIZE") and trimmed.get(knob, 0) > 1:
+            continue
+        if not knob.endswith("_SIZE") and trimmed.get(knob, 0):
+            continue
+        rx = re.compile(r"^(%s)$" % pattern)
+        names = [n for n, (kind, _s) in symbols.items() if kind == "F" and rx.match(n)]
+        if knob == "OS_DEBUG_EN":
+            names += [n for n in dbg_names if n in symbols]
+        if names:
+            dropped[knob] = (sum(symbols[n][1] for n in names), sorted(names))
+    # A whole service takes its options with it
+    for knob in list(dropped):
+        prefix = knob[:-3] + "_" if knob.endswith("_EN") else None
+        for other in list(dropped):
+            if prefix and other != knob and other.startswith(prefix):
+                del dropped[other]
+    return dropped
+
+
+def table(title, header, rows):
+    widths = [max(len(str(r[i])) for r in [header] + rows) for i in range(len(header))]
+    rule = "+" + "+".join("-" * (w + 2) for w in widths) + "+"
+    print(title)
+    print(rule)
+    print("| " + " | ".join(str(h).ljust(w) if i == 0 else str(h).rjust(w)
+                            for i, (h, w) in enumerate(zip(header, widths))) + " |")
+    print(rule)
+    for r in rows:
+        print("| " + " | ".join(str(c).ljust(w) if i == 0 else str(c).rjust(w)
+                                for i, (c, w) in enumerate(zip(r, widths))) + " |")
+    print(rule)
+
+
+def write_header(path, app, changes, why):
+    with open(path, "w") as out:
+        out.write("/*\n * uC/OS-II configuration of %s cut to what it uses\n *\n" % app)
+        if changes:
+            out.write(" * Written by tools/ostrim.py, do not edit. Included at the end of\n"
+                      " * os_cfg.h, after system.h; write it with --full to go back to the\n"
+                      " * full configuration.\n */\n")
+        else:
+            out.write(" * Nothing is cut: the configuration of system.h and os_cfg.h is used.\n"
+                      " * tools/ostrim.py --header writes the cut one (./run.sh trim).\n */\n")
+        out.write("#ifndef __OS_CFG_TRIM_H__\n#define __OS_CFG_TRIM_H__\n")
+        if changes:
+            out.write("\n")
+        width = max([len(k) for k, _v in changes] + [0]) + 1
+        for knob, value in changes:
+            out.write("#undef  %s\n" % knob)
+            out.write("#define %s %-4d /* %s */\n" % (knob.ljust(width), value, why[knob]))
+        out.write("\n#endif /* __OS_CFG_TRIM_H__ */\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("app", help="application folder, e.g. app/DONE_cruise_control")
+    parser.add_argument("--src", action="append", default=[], metavar="FILE",
+                        help="another source file to scan")
+    parser.add_argument("--bsp", help="BSP folder (default <app>/bsp)")
+    parser.add_argument("--symbols", help="objdump listing with the symbol table "
+                        "(default <app>/bin/*.objdump)")
+    parser.add_argument("--extra", action="append", default=[], metavar="KIND=N",
+                        help="objects the scan misses, KIND is sem, mbox, q, mutex, "
+                        "flag, mem, tmr or task")
+    parser.add_argument("--header", help="write the os_cfg_trim.h overlay")
+    parser.add_argument("--settings", help="write the nios2-bsp --set arguments")
+    parser.add_argument("--full", action="store_true",
+                        help="write an overlay that cuts nothing")
+    args = parser.parse_args()
+
+    bsp = args.bsp or os.path.join(args.app, "bsp")
+    defines = read_defines(os.path.join(bsp, "system.h"))
+    osconfig = read_defines(os.path.join(bsp, "UCOSII", "inc", "os_cfg.h"))
+    if not defines:
+        sys.exit("no system.h in %s" % bsp)
+    symbols_path = args.symbols or next(iter(glob.glob(os.path.join(args.app, "bin", "*.objdump"))), None)
+    extra = {}
+    for item in args.extra:
+        kind, _eq, n = item.partition("=")
+        extra[kind] = extra.get(kind, 0) + int(n)
+
+    calls, idents = [], set()
+    paths = sources(args.app, args.src)
+    for path in paths:
+        c, i = scan(path)
+        calls += c
+        idents |= i
+
+    full = current(defines, osconfig)
+    cfg, why, counts, platform = trim(calls, idents, defines, extra)
+    trimmed = dict(full)
+    trimmed.update(cfg)
+    changes = [(k, cfg[k]) for k in sorted(cfg) if k in full and full[k] != cfg[k]]
+    app = os.path.basename(os.path.normpath(args.app))
+
+    print("%s: %d source files, objects created: %s; by the HAL/kernel: %s\n"
+          % (app, len(paths),
+             ", ".join("%d %s" % (n, k) for k, n in sorted(counts.items())) or "none",
+             ", ".join("%d %s" % (n, k) for k, n in sorted(platform.items())) or "none"))
+    table("--Configuration--", ["Option", "Now", "Trimmed", "Why"],
+          [(k, full[k], v, why[k]) for k, v in changes])
+
+    before, after = ram(full), ram(trimmed)
+    print()
+    rows = []
+    for name in sorted(set(before) | set(after), key=lambda n: -before.get(n, 0)):
+        old, new = before.get(name, 0), after.get(name, 0)
+        rows.append((name, old, new, "%+d" % (new - old)))
+    rows.append(("(total)", sum(before.values()), sum(after.values()),
+                 "%+d" % (sum(after.values()) - sum(before.values()))))
+    table("--RAM, kernel tables and system stacks--", ["Table", "Now", "Trimmed", "Delta"], rows)
+
+    symbols = read_symbols(symbols_path)
+    dbg = set()
+    dbg_path = os.path.join(bsp, "UCOSII", "src", "os_dbg.c")
+    if os.path.exists(dbg_path):
+        with open(dbg_path, errors="replace") as src:
+            dbg = set(re.findall(r"\bconst\s+(OS\w+)\s*=", src.read()))
+    dropped = rom(full, trimmed, symbols, dbg)
+    print()
+    if symbols:
+        rows = [(k, n, ", ".join(f[:4]) + (" ..." if len(f) > 4 else ""))
+                for k, (n, f) in sorted(dropped.items(), key=lambda kv: -kv[1][0])]
+        rows.append(("(total)", sum(n for n, _f in dropped.values()), ""))
+        table("--ROM, code left out (%s)--" % os.path.basename(symbols_path),
+              ["Option", "Bytes", "Functions"], rows)
+    else:
+        print("No symbol table, give --symbols for the ROM estimate")
+
+    timers = counts.get("tmr", 0) + platform.get("tmr", 0)
+    tasks = lambda cfg: counts.get("task", 0) + 1 + (1 if cfg.get("OS_TASK_STAT_EN") else 0) \
+        + (1 if cfg.get("OS_TMR_EN") else 0)
+    spoke = lambda cfg: (float(timers) / cfg["OS_TMR_CFG_WHEEL_SIZE"]
+                         if cfg.get("OS_TMR_EN") and cfg.get("OS_TMR_CFG_WHEEL_SIZE") else 0.0)
+    print()
+    table("--Tick cost--", ["Per", "Now", "Trimmed"], [
+        ("tick: TCBs OSTimeTick() walks", tasks(full), tasks(trimmed)),
+        ("tick: OS_TICK_STEP_EN check", full.get("OS_TICK_STEP_EN", 0), trimmed.get("OS_TICK_STEP_EN", 0)),
+        ("timer tick: timers per spoke", "%.2f" % spoke(full), "%.2f" % spoke(trimmed)),
+    ])
+
+    if args.header:
+        write_header(args.header, app, [] if args.full else changes, why)
+    if args.settings:
+        settings = read_settings(os.path.join(bsp, "settings.bsp"))
+        with open(args.settings, "w") as out:
+            for knob, value in ([] if args.full else changes):
+                if knob in settings:
+                    out.write("--set %s %d\n" % (settings[knob], value))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Symbolizes a PC sampling profile into a flat profile per function.
+
+The profile is printed by pc_prof_dump() (app/common/pc_prof.c) on the JTAG
+UART. Capture the terminal output (e.g. nios2-terminal | tee run.log) and
+give the ELF of the same build; its symbol table is read with
+nios2-elf-objdump -t. Without the toolchain, --symbols reads a listing that
+contains the symbol table instead, e.g. bin/cruisecontrol.objdump.
+
+A bucket that spans two functions is split between them by the number of
+bytes each one has in it.
+
+usage: pcprof.py run.log --elf bin/cruisecontrol.elf [--top N] [--dump N]
+       pcprof.py run.log --symbols bin/cruisecontrol.objdump --annotate ControlTask
+"""
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+CODE_SECTIONS = (".text", ".exceptions", ".onchip_memory", ".entry")
+
+SYMBOL = re.compile(r"^([0-9a-f]{8}) (.{7}) (\S+)\t([0-9a-f]+) (.+)$")
+
+
+def parse(path):
+    """Returns the list of dumps found in a log, each a dict."""
+    dumps = []
+    current = None
+    with open(path, errors="replace") as log:
+        for line in log:
+            fields = line.split()
+            if not fields:
+                continue
+            tag = fields[0]
+            if tag == "PCPROF-BEGIN":
+                current = {"header": dict(f.split("=", 1) for f in fields[1:] if "=" in f),
+                           "regions": [], "tasks": {}, "buckets": {}}
+            elif current is None:
+                continue
+            elif tag == "PCPROF-REGION" and len(fields) == 5:
+                current["regions"].append((fields[1], int(fields[2], 16),
+                                           int(fields[3], 16), int(fields[4])))
+            elif tag == "PCPROF-TASK" and len(fields) >= 4:
+                current["tasks"][int(fields[1])] = (int(fields[2]), " ".join(fields[3:]))
+            elif tag == "PS" and len(fields) == 3:
+                try:
+                    current["buckets"][int(fields[1])] = int(fields[2])
+                except ValueError:
+                    pass        # line garbled by other output
+            elif tag == "PCPROF-END":
+                dumps.append(current)
+                current = None
+    return dumps
+
+
+def read_symbols(lines):
+    """Returns the code symbols as a sorted list of (address, name)."""
+    by_addr = {}
+    for line in lines:
+        m = SYMBOL.match(line.rstrip("\n"))
+        if not m:
+            continue
+        addr, flags, section, _size, name = m.groups()
+        if section not in CODE_SECTIONS or flags[5] == "d" or flags[6] == "f":
+            continue
+        addr = int(addr, 16)
+        # Prefer functions and global names for aliases
+        rank = (flags[6] == "F", flags[0] == "g")
+        if addr not in by_addr or rank > by_addr[addr][0]:
+            by_addr[addr] = (rank, name)
+    return sorted((addr, name) for addr, (_rank, name) in by_addr.items())
+
+
+def load_symbols(args):
+    if args.symbols:
+        with open(args.symbols, errors="replace") as listing:
+            return read_symbols(listing)
+    out = subprocess.run([args.objdump, "-t", args.elf], check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return read_symbols(out.splitlines())
+
+
+def bucket_ranges(dump):
+    """Yields (low, high, count) for every bucket of the dump."""
+    shift = int(dump["header"]["shift"])
+    regions = sorted(dump["regions"], key=lambda r: r[3])
+    firsts = [r[3] for r in regions]
+    for b, count in sorted(dump["buckets"].items()):
+        i = bisect.bisect_right(firsts, b) - 1
+        if i < 0:
+            continue
+        _name, low, high, first = regions[i]
+        start = low + ((b - first) << shift)
+        yield start, min(start + (1 << shift), high), count
+
+
+def attribute(dump, symbols):
+    """Returns {function: samples} and per bucket detail {function: [(low, high, count)]}."""
+    addrs = [s[0] for s in symbols]
+    flat = {}
+    detail = {}
+    for low, high, count in bucket_ranges(dump):
+        i = bisect.bisect_right(addrs, low) - 1
+        pos = low
+        while pos < high:
+            name = symbols[i][1] if i >= 0 else "<unknown>"
+            end = symbols[i + 1][0] if i + 1 < len(symbols) else high
+            end = min(end, high)
+            share = count * (end - pos) / (high - low)
+            flat[name] = flat.get(name, 0.0) + share
+            detail.setdefault(name, []).append((pos, end, share))
+            pos = end
+            i += 1
+    return flat, detail
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log")
+    parser.add_argument("--elf", help="ELF of the profiled build")
+    parser.add_argument("--symbols", help="objdump listing with the symbol table instead of --elf")
+    parser.add_argument("--objdump", default="nios2-elf-objdump",
+                        help="objdump to read --elf with (default %(default)s)")
+    parser.add_argument("--dump", type=int, default=-1,
+                        help="which dump of the log to use (default the last)")
+    parser.add_argument("--top", type=int, default=30,
+                        help="functions to list (default %(default)s, 0 for all)")
+    parser.add_argument("--annotate", action="append", default=[], metavar="FUNC",
+                        help="also list the buckets of FUNC")
+    args = parser.parse_args()
+
+    if not args.elf and not args.symbols:
+        parser.error("give --elf or --symbols")
+
+    dumps = parse(args.log)
+    if not dumps:
+        sys.exit("no PCPROF-BEGIN ... PCPROF-END dump in %s" % args.log)
+    dump = dumps[args.dump]
+    header = dump["header"]
+    rate = int(header.get("rate", "0")) or 1
+    samples = int(header.get("samples", "0"))
+
+    flat, detail = attribute(dump, load_symbols(args))
+    counted = sum(flat.values())
+
+    print("Flat profile: %d samples at %d Hz (%s), %d in the histogram, "
+          "%s outside, %s saturated, filter %s"
+          % (samples, rate, header.get("source", "?"), round(counted),
+             header.get("outside", "?"), header.get("saturated", "?"),
+             header.get("filter", "all")))
+    print()
+    print("  %time   samples   seconds  function")
+    ranked = sorted(flat.items(), key=lambda kv: kv[1], reverse=True)
+    if args.top:
+        ranked = ranked[:args.top]
+    for name, count in ranked:
+        print("%7.2f %9.1f %9.3f  %s" % (100.0 * count / counted if counted else 0.0,
+                                         count, count / rate, name))
+
+    if dump["tasks"]:
+        print()
+        print("  %time   samples  prio  task")
+        for prio, (count, name) in sorted(dump["tasks"].items(),
+                                          key=lambda kv: kv[1][0], reverse=True):
+            print("%7.2f %9d %5d  %s" % (100.0 * count / samples if samples else 0.0,
+                                         count, prio, name))
+
+    for name in args.annotate:
+        print()
+        print("%s:" % name)
+        for low, high, count in detail.get(name, []):
+            print("  %08x-%08x %9.1f" % (low, high, count))
+
+
+if __name__ == "__main__":
+    main()
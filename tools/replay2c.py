@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Converts an input log dump into a C table for replay.
+
+The dump is printed by replay_dump() (app/common/replay.c) on the JTAG UART.
+Capture the terminal output (e.g. nios2-terminal | tee run.log) and convert
+it; the result is included by the application and passed to replay_play(),
+see REPLAY_MODE in cruise.c.
+
+usage: replay2c.py run.log [-o replay_log.h] [--dump N]
+"""
+import argparse
+import sys
+
+CHANNELS = {"keys": "REPLAY_KEYS", "switches": "REPLAY_SWITCHES", "throttle": "REPLAY_THROTTLE"}
+
+
+def parse(path):
+    """Returns the list of dumps found in a log, each a dict."""
+    dumps = []
+    current = None
+    with open(path, errors="replace") as log:
+        for line in log:
+            fields = line.split()
+            if not fields:
+                continue
+            tag = fields[0]
+            if tag == "REPLAY-BEGIN":
+                current = {"header": dict(f.split("=", 1) for f in fields[1:] if "=" in f),
+                           "entries": []}
+            elif current is None:
+                continue
+            elif tag == "RP" and len(fields) == 4 and fields[2] in CHANNELS:
+                try:
+                    current["entries"].append((int(fields[1]), fields[2], int(fields[3], 16)))
+                except ValueError:
+                    pass
+            elif tag == "REPLAY-END":
+                dumps.append(current)
+                current = None
+    return dumps
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="terminal log with a replay dump")
+    parser.add_argument("-o", "--output", default="replay_log.h", help="C table to write")
+    parser.add_argument("--dump", type=int, default=-1,
+                        help="which dump of the log, 0 = first (default: the last)")
+    args = parser.parse_args()
+
+    dumps = parse(args.log)
+    if not dumps:
+        sys.exit("replay2c: no complete REPLAY-BEGIN ... REPLAY-END dump in %s" % args.log)
+    try:
+        dump = dumps[args.dump]
+    except IndexError:
+        sys.exit("replay2c: the log has %d dumps" % len(dumps))
+
+    header = dump["header"]
+    if header.get("lost", "0") != "0":
+        print("replay2c: %s changes were not recorded, the replay ends early" % header["lost"],
+              file=sys.stderr)
+    with open(args.output, "w") as out:
+        out.write("/* Input log for replay_play(), made by tools/replay2c.py from %s\n" % args.log)
+        out.write(" * ticks=%s entries=%d lost=%s */\n"
+                  % (header.get("ticks", "?"), len(dump["entries"]), header.get("lost", "?")))
+        for tick, chan, value in dump["entries"]:
+            out.write("REPLAY_ENTRY(%u, %s, 0x%08x),\n" % (tick, CHANNELS[chan], value))
+    print("%s: %d entries" % (args.output, len(dump["entries"])))
+
+
+if __name__ == "__main__":
+    main()
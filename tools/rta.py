@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""Response-time and schedulability analysis of an application's task set.
+
+Reads the task description of an application (tasks.json next to its
+run.sh) and computes the worst-case response time of every task with the
+fixed-priority preemptive analysis of uC/OS-II (one task per priority, a
+lower number is a higher priority):
+
+  R = J + w,  w = B + C' + sum over the higher tasks j of ceil((w + J_j) / T_j) * C_j'
+                         + ceil(w / T_tick) * C_tick
+
+C' is the WCET of a job plus two context switches (preempting and
+resuming), B the blocking by lower tasks and J the release jitter. Tasks
+released by a software timer ("timer": true) inherit the response time of
+the timer task as their jitter. The tick interrupt interferes with every
+task, the timer task is an ordinary task at OS_TASK_TMR_PRIO.
+
+The kernel overheads are part of the description:
+
+  tick          rate (OS_TICKS_PER_SEC) and WCET of the tick interrupt,
+                the tick region of niossim (tools/bench_budget.py)
+  ctx_switch_us WCET of a context switch, the ctx_switch region
+  timer_task    priority, period and WCET of OSTmr_Task
+
+Priorities, periods and rates may be given as macros (or expressions of
+macros) of the application's sources and of bsp/system.h, so the analysis
+follows the code. Times are microseconds, periods milliseconds; a task's
+deadline is its period unless "deadline_ms" is given.
+
+"overload" names the task whose WCET grows with overload_percentage (the
+ExtraLoadTask of the cruise control busy-waits 3 ticks per percent). The
+sensitivity analysis searches the highest percentage, in its steps, at
+which every task still meets its deadline, the slack of every task (how
+much its WCET may grow) and the factor all WCETs may be scaled by.
+
+--wcet takes the WCETs from a log with the "BENCH " lines of
+job_wcet_report() (app/common/job_wcet.h) instead, matched by priority;
+the longest job of all reports in the log counts.
+
+usage: rta.py app/DONE_cruise_control/tasks.json [--overload 30]
+       rta.py app/DONE_cruise_control/tasks.json --wcet run.log
+"""
+import argparse
+import glob
+import json
+import math
+import os
+import re
+import sys
+
+DEFINE = re.compile(r"^\s*#define\s+(\w+)\s+([^/\n]+?)\s*(?://.*|/\*.*)?$")
+MAX_ITERATIONS = 1000
+PREFIX = "BENCH "
+
+
+def read_macros(app):
+    """#define NAME value of the application's sources and system.h."""
+    macros = {}
+    paths = (glob.glob(os.path.join(app, "src", "*.[ch]")) +
+             [os.path.join(app, "bsp", "system.h")])
+    for path in paths:
+        if not os.path.exists(path):
+            continue
+        with open(path, errors="replace") as source:
+            for line in source:
+                m = DEFINE.match(line)
+                if m and m.group(1) not in macros:
+                    macros[m.group(1)] = m.group(2)
+    return macros
+
+
+def evaluate(value, macros, depth=0):
+    """A number, or a macro expression such as "1000 / OS_TMR_CFG_TICKS_PER_SEC"."""
+    if isinstance(value, (int, float)):
+        return value
+    if depth > 16:
+        sys.exit("macro loop in %s" % value)
+
+    def expand(m):
+        name = m.group(0)
+        if name not in macros:
+            sys.exit("unknown macro %s" % name)
+        return "(%s)" % evaluate(macros[name], macros, depth + 1)
+    expr = re.sub(r"[A-Za-z_]\w*", expand, str(value))
+    if not re.match(r"^[\d\s.()+\-*/]+$", expr):
+        sys.exit("cannot evaluate %s" % value)
+    return eval(expr)
+
+
+class Task:
+    def __init__(self, name, prio, period_ms, wcet_us, deadline_ms=None,
+                 blocking_us=0, jitter_us=0, timer=False):
+        self.name = name
+        self.prio = prio
+        self.period = period_ms * 1000.0
+        self.deadline = (deadline_ms if deadline_ms is not None else period_ms) * 1000.0
+        self.wcet = float(wcet_us)
+        self.blocking = float(blocking_us)
+        self.jitter = float(jitter_us)
+        self.timer = timer
+
+
+def load(path):
+    """Returns the system: tick, switch, the timer task and the tasks by priority."""
+    with open(path) as stored:
+        desc = json.load(stored)
+    macros = read_macros(os.path.dirname(os.path.abspath(path)))
+
+    def num(value):
+        return evaluate(value, macros)
+
+    system = {
+        "tick_period": 1e6 / num(desc["tick"]["hz"]),
+        "tick_wcet": float(desc["tick"]["wcet_us"]),
+        "switch": float(desc.get("ctx_switch_us", 0)),
+        "overload": desc.get("overload"),
+        "tasks": [],
+    }
+    timer = desc.get("timer_task")
+    if timer:
+        system["tasks"].append(Task("OSTmr_Task", num(timer["prio"]), num(timer["period_ms"]),
+                                    timer["wcet_us"]))
+    for t in desc["tasks"]:
+        system["tasks"].append(Task(t["name"], num(t["prio"]), num(t["period_ms"]), t["wcet_us"],
+                                    num(t["deadline_ms"]) if "deadline_ms" in t else None,
+                                    t.get("blocking_us", 0), t.get("jitter_us", 0),
+                                    t.get("timer", False)))
+    system["tasks"].sort(key=lambda task: task.prio)
+    prios = [task.prio for task in system["tasks"]]
+    if len(set(prios)) != len(prios):
+        sys.exit("%s: two tasks at the same priority" % path)
+    return system
+
+
+def read_wcets(path):
+    """{prio: longest job in us} of the job_wcet BENCH lines of a log."""
+    measured = {}
+    with open(path, errors="replace") as log:
+        for line in log:
+            pos = line.find(PREFIX)
+            if pos < 0:
+                continue
+            try:
+                obj = json.loads(line[pos + len(PREFIX):])
+            except ValueError:
+                continue
+            if obj.get("bench") == "wcet":
+                measured[obj["prio"]] = max(measured.get(obj["prio"], 0), obj["max_us"])
+    return measured
+
+
+def analyse(system, wcet):
+    """Response times for the WCETs in 'wcet' (by name), None when a task misses."""
+    tick_period, tick_wcet = system["tick_period"], system["tick_wcet"]
+    if tick_wcet >= tick_period:
+        return {task.name: None for task in system["tasks"]}
+    timer_response = 0.0
+    responses = {}
+    higher = []
+    for task in system["tasks"]:
+        cost = wcet[task.name] + 2 * system["switch"]
+        jitter = task.jitter + (timer_response if task.timer else 0.0)
+        w = task.blocking + cost
+        response = None
+        for _ in range(MAX_ITERATIONS):
+            nxt = (task.blocking + cost +
+                   sum(math.ceil((w + j) / t) * c for t, j, c in higher) +
+                   math.ceil(w / tick_period) * tick_wcet)
+            if jitter + nxt > task.deadline:
+                break
+            if nxt == w:
+                response = jitter + w
+                break
+            w = nxt
+        responses[task.name] = response
+        if task.name == "OSTmr_Task" and response is not None:
+            timer_response = response
+        higher.append((task.period, jitter, cost))
+    return responses
+
+
+def schedulable(responses):
+    return all(r is not None for r in responses.values())
+
+
+def wcets(system, percentage):
+    """WCETs with the overload task at 'percentage'."""
+    wcet = {task.name: task.wcet for task in system["tasks"]}
+    overload = system["overload"]
+    if overload and percentage:
+        wcet[overload["task"]] += overload["us_per_percent"] * percentage
+    return wcet
+
+
+def max_overload(system):
+    """Highest overload_percentage in its steps at which the set is schedulable."""
+    overload = system["overload"]
+    best = None
+    for percentage in range(0, overload.get("max", 100) + 1, overload.get("step", 1)):
+        if not schedulable(analyse(system, wcets(system, percentage))):
+            break
+        best = percentage
+    return best
+
+
+def search(ok, lo, hi, resolution):
+    """Largest x in [lo, hi] with ok(x), for ok monotonic and ok(lo) true."""
+    if ok(hi):
+        return hi
+    while hi - lo > resolution:
+        mid = (lo + hi) / 2.0
+        if ok(mid):
+            lo = mid
+        else:
+            hi = mid
+    return lo
+
+
+def slack(system, wcet, name):
+    """How many us the WCET of one task may grow."""
+    def ok(extra):
+        grown = dict(wcet)
+        grown[name] += extra
+        return schedulable(analyse(system, grown))
+    return search(ok, 0.0, max(task.deadline for task in system["tasks"]), 1.0)
+
+
+def scaling(system, wcet):
+    """Factor all WCETs may be multiplied by."""
+    def ok(factor):
+        return schedulable(analyse(system, {n: c * factor for n, c in wcet.items()}))
+    return search(ok, 1.0, 1000.0, 0.001)
+
+
+def table(title, header, rows):
+    widths = [max(len(str(r[i])) for r in [header] + rows) for i in range(len(header))]
+    rule = "+" + "+".join("-" * (w + 2) for w in widths) + "+"
+    print(title)
+    print(rule)
+    print("| " + " | ".join(str(h).ljust(w) if i == 0 else str(h).rjust(w)
+                            for i, (h, w) in enumerate(zip(header, widths))) + " |")
+    print(rule)
+    for r in rows:
+        print("| " + " | ".join(str(c).ljust(w) if i == 0 else str(c).rjust(w)
+                                for i, (c, w) in enumerate(zip(r, widths))) + " |")
+    print(rule)
+
+
+def report(system, percentage):
+    wcet = wcets(system, percentage)
+    responses = analyse(system, wcet)
+    tick_util = system["tick_wcet"] / system["tick_period"]
+    util = tick_util + sum((wcet[t.name] + 2 * system["switch"]) / t.period
+                           for t in system["tasks"])
+    title = "--Response Times--"
+    if system["overload"]:
+        title += " (overload_percentage %d %%)" % percentage
+    rows = []
+    for task in system["tasks"]:
+        r = responses[task.name]
+        if r is None:
+            rows.append((task.name, task.prio, "%.0f" % (task.period / 1000),
+                         "%.0f" % wcet[task.name], "MISS", "%.0f" % (task.deadline / 1000), "-"))
+        else:
+            rows.append((task.name, task.prio, "%.0f" % (task.period / 1000),
+                         "%.0f" % wcet[task.name], "%.0f" % r,
+                         "%.0f" % (task.deadline / 1000),
+                         "%.0f" % slack(system, wcet, task.name)))
+    table(title, ["Task", "Prio", "Period ms", "WCET us", "Response us", "Deadline ms",
+                  "Slack us"], rows)
+    print("Utilization: %.1f %% (tick %.1f %%)" % (100 * util, 100 * tick_util))
+    if schedulable(responses):
+        print("Schedulable, the WCETs may be scaled by %.2f" % scaling(system, wcet))
+    else:
+        print("NOT schedulable")
+    return schedulable(responses)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("tasks", help="task description (tasks.json)")
+    parser.add_argument("--overload", type=int,
+                        help="analyse at this overload_percentage (default the highest safe one)")
+    parser.add_argument("--wcet", help="log with the job_wcet BENCH lines of a run")
+    args = parser.parse_args()
+
+    system = load(args.tasks)
+    if args.wcet:
+        measured = read_wcets(args.wcet)
+        for task in system["tasks"]:
+            if task.prio in measured:
+                task.wcet = float(measured[task.prio])
+    percentage = args.overload
+    if system["overload"]:
+        best = max_overload(system)
+        if best is None:
+            print("Not schedulable even without overload\n")
+            percentage = 0 if percentage is None else percentage
+        else:
+            print("Maximum safe overload_percentage: %d %% (%s, step %d %%)\n"
+                  % (best, system["overload"]["task"], system["overload"].get("step", 1)))
+            percentage = best if percentage is None else percentage
+    return 0 if report(system, percentage or 0) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
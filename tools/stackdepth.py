@@ -0,0 +1,431 @@
+#!/usr/bin/env python3
+"""Computes the worst-case stack depth of every task from the disassembly.
+
+Reads a Nios II objdump listing (bin/<app>.objdump, objdump -d) and builds
+the call graph from the call and jmpi instructions. The frame of a function
+is what its addi/sub on sp allocate; the depth of a function is its frame
+plus the deepest of its callees.
+
+Roots are found in the code: the first argument of OSTaskCreate() and
+OSTaskCreateExt() is a task. Indirect calls (callr) are resolved the same
+way where the HAL, the kernel or app/common call registered functions:
+
+  alt_irq_handler    handlers given to alt_ic_isr_register()/alt_irq_register()
+  alt_tick           callbacks given to alt_alarm_start()
+  OSTmr_Task         callbacks given to OSTmrCreate()
+  basic_task_entry   jobs given to basic_task_create()
+
+plus the device and stdio hooks of the HAL and newlib by name. Other
+indirect calls are listed as unresolved; add them with --indirect.
+
+Interrupts run on the stack of the task they interrupt (there is no
+separate exception stack in these BSPs) and do not nest, so the depth of
+alt_exception is added to every task. The basic tasks share one stack on
+which every job can be preempted by every job of higher priority, so it
+needs the sum of the jobs.
+
+A task that reaches recursion or an unresolved indirect call has no proven
+bound; its depth is marked with '+' and the reason is listed. Recursion
+with a known limit is given with --recursion: newlib's vfprintf() calls
+itself once for an unbuffered stream (__sbprintf, inlined), with a
+buffered copy of it, so ___vfprintf_internal_r=1.
+
+--header writes the sizes, with --margin, as OS_STK word counts for the
+application. A task without a proven bound gets no size there, only a
+comment: the application keeps its standard size for it. The header also
+lists the bounds the listing alone does not prove, i.e. every resolved
+indirect call and bounded recursion the sizes rest on, and the options it
+was written with. --check HEADER writes it again with those options and
+fails if it differs: the header is stale against the listing.
+
+usage: stackdepth.py bin/cruisecontrol.objdump [--task FUNC] [--path]
+       stackdepth.py bin/cruisecontrol.objdump --header src/stack_depth.h \
+                     --recursion ___vfprintf_internal_r=1
+       stackdepth.py bin/cruisecontrol.objdump --check src/stack_depth.h
+"""
+import argparse
+import re
+import shlex
+import sys
+import textwrap
+
+FUNC = re.compile(r"^([0-9a-f]+) <(.+)>:$")
+INSN = re.compile(r"^\s*([0-9a-f]+):\t[0-9a-f]{8} \t(\S+)\t?(.*)$")
+TARGET = re.compile(r"^([0-9a-f]+) <([^+>]+)(\+0x[0-9a-f]+)?>$")
+
+ISR_ENTRY = ("alt_exception", "alt_irq_entry")
+SHARED_STACK = "basic_task_entry"
+
+# Function whose argument register is a function pointer: group, register
+REGISTRATIONS = {
+    "OSTaskCreate":         ("task", "r4"),
+    "OSTaskCreateExt":      ("task", "r4"),
+    "alt_ic_isr_register":  ("isr", "r6"),
+    "alt_irq_register":     ("isr", "r6"),
+    "alt_alarm_start":      ("alarm", "r6"),
+    "OSTmrCreate":          ("tmr", "r7"),
+    "basic_task_create":    ("job", "r5"),
+}
+
+# Indirect calls in these functions call a registered group
+GROUP_CALLERS = {
+    "alt_irq_handler":  "isr",
+    "alt_tick":         "alarm",
+    "OSTmr_Task":       "tmr",
+    "OSTmrStop":        "tmr",
+    "basic_task_entry": "job",
+    "OSStartTsk":       "task",
+}
+
+# Indirect calls resolved by the names of the possible targets
+NAMED_CALLERS = [
+    (r"^write$", r"_write_fd$"),
+    (r"^read$", r"_read_fd$"),
+    (r"^close$", r"_close_fd$"),
+    # Not alt_open_fd() of alt_io_redirect(), it is no device hook
+    (r"^(lseek|fstat|isatty|open)$", r"^(?!alt_open_fd$)\w+_(ioctl|open|close)_fd$"),
+    (r"^(__sfvwrite_r|_fflush_r|__sflush_r|_fclose_r|__srefill_r|__srget_r)$",
+     r"^__s(read|write|seek|close)$"),
+    (r"^(_fwalk|_fwalk_reent)$", r"^(_fflush_r|_fclose_r|__sflush_r|__fp_lock|__fp_unlock|lflush)$"),
+]
+
+MASK = 0xFFFFFFFF
+MARGIN = 20
+
+
+class Function:
+    def __init__(self, name, addr):
+        self.name = name
+        self.addr = addr
+        self.frame = 0
+        self.dynamic = False
+        self.calls = set()
+        self.indirect = []          # addresses of unresolved callr
+        self.resolved = None        # (how, targets) of the resolved callr
+
+
+def signed(value):
+    value &= MASK
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def parse(path):
+    """Returns {name: Function} and the registrations {group: set of addresses}."""
+    functions = {}
+    registered = {}
+    current = None
+    regs = {}
+    with open(path, errors="replace") as listing:
+        for line in listing:
+            line = line.rstrip("\n")
+            m = FUNC.match(line)
+            if m:
+                current = Function(m.group(2), int(m.group(1), 16))
+                functions[current.name] = current
+                regs = {}
+                continue
+            m = INSN.match(line)
+            if not m or current is None:
+                continue
+            op, args = m.group(2), [a.strip() for a in m.group(3).split(",")] if m.group(3) else []
+            track(current, op, args, regs, registered)
+    return functions, registered
+
+
+def immediate(text):
+    try:
+        return int(text, 0)
+    except ValueError:
+        return None
+
+
+def track(fn, op, args, regs, registered):
+    """Follows one instruction: frame, calls and constants in registers."""
+    if op in ("call", "jmpi") and args:
+        m = TARGET.match(args[0])
+        if m:
+            target = m.group(2)
+            if op == "call" or not m.group(3):
+                fn.calls.add(target)
+            if target in REGISTRATIONS:
+                group, reg = REGISTRATIONS[target]
+                if reg in regs:
+                    registered.setdefault(group, set()).add(regs[reg])
+        if op == "call":
+            for r in ("r2", "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10",
+                      "r11", "r12", "r13", "r14", "r15", "ra"):
+                regs.pop(r, None)
+        return
+    if op == "callr":
+        fn.indirect.append(args[0] if args else "?")
+        return
+    if not args or op.startswith(("st", "b", "jmp", "ret", "eret", "wrctl", "trap")):
+        return
+
+    dest = args[0]
+    value = None
+    if op == "movhi" and len(args) == 2:
+        imm = immediate(args[1])
+        value = None if imm is None else (imm << 16) & MASK
+    elif op in ("movi", "movui") and len(args) == 2:
+        imm = immediate(args[1])
+        value = None if imm is None else imm & MASK
+    elif op == "mov" and len(args) == 2:
+        value = 0 if args[1] == "zero" else regs.get(args[1])
+    elif op in ("addi", "ori") and len(args) == 3:
+        imm = immediate(args[2])
+        base = 0 if args[1] == "zero" else regs.get(args[1])
+        if imm is not None and base is not None:
+            value = (base + imm) & MASK if op == "addi" else (base | (imm & 0xFFFF))
+
+    if dest == "sp":
+        if op == "addi" and args[1] == "sp":
+            imm = immediate(args[2])
+            if imm is not None and imm < 0:
+                fn.frame += -imm
+        elif op == "sub" and args[1] == "sp" and args[2] in regs:
+            fn.frame += signed(regs[args[2]])
+        elif op == "add" and args[1] == "sp" and args[2] in regs and signed(regs[args[2]]) < 0:
+            fn.frame += -signed(regs[args[2]])
+        elif not (op == "mov" and args[1] == "fp") and op != "addi" and op != "ldw":
+            fn.dynamic = True
+        return
+
+    if value is None:
+        regs.pop(dest, None)
+    else:
+        regs[dest] = value
+
+
+def resolve(functions, registered, extra):
+    """Turns the indirect calls that can be resolved into call edges."""
+    by_addr = {fn.addr: fn.name for fn in functions.values()}
+    groups = {g: {by_addr[a] for a in addrs if a in by_addr} for g, addrs in registered.items()}
+    for fn in functions.values():
+        if not fn.indirect:
+            continue
+        targets = None
+        if fn.name in extra:
+            targets, how = set(extra[fn.name]), "the functions given with --indirect"
+        elif fn.name in GROUP_CALLERS:
+            group = GROUP_CALLERS[fn.name]
+            targets = groups.get(group, set())
+            how = "the functions given to " + " or ".join(sorted(r for r, (g, _reg) in REGISTRATIONS.items()
+                                                if g == group))
+        else:
+            for caller, pattern in NAMED_CALLERS:
+                if re.search(caller, fn.name):
+                    targets = {n for n in functions if re.search(pattern, n)}
+                    how = "the hooks matched by name"
+                    break
+        if targets is not None:
+            fn.calls |= {t for t in targets if t in functions}
+            fn.indirect = []
+            fn.resolved = (how, sorted(t for t in targets if t in functions))
+    return groups
+
+
+class Analysis:
+    def __init__(self, functions, assume, recursion):
+        self.functions = functions
+        self.assume = assume
+        self.recursion = recursion
+        self.memo = {}
+        self.seen = set()
+
+    def depth(self, name, active=()):
+        """Returns (depth, path, problems) of the deepest call chain from name."""
+        if name in self.assume:
+            return self.assume[name], [name], set()
+        # The depth below a bounded recursion depends on the levels left
+        key = (name,) + tuple(active.count(r) for r in sorted(self.recursion))
+        if key in self.memo:
+            return self.memo[key]
+        fn = self.functions.get(name)
+        if fn is None:
+            return 0, [name], {"no code for %s" % name}
+        self.seen.add(name)
+        if name in self.recursion and active.count(name) > self.recursion[name]:
+            return 0, [], set()     # deeper than it goes
+        if name in active and name not in self.recursion:
+            return 0, [name], {"recursion through %s" % name}
+        problems = set()
+        if fn.dynamic:
+            problems.add("%s moves sp by a computed amount" % name)
+        for site in fn.indirect:
+            problems.add("%s has an unresolved indirect call (callr %s)" % (name, site))
+        best, best_path = 0, []
+        for callee in sorted(fn.calls):
+            d, path, p = self.depth(callee, active + (name,))
+            problems |= p
+            if d > best:
+                best, best_path = d, path
+        result = (fn.frame + best, [name] + best_path, problems)
+        if not any(p.startswith("recursion") for p in problems):
+            self.memo[key] = result
+        return result
+
+
+def words(nbytes, margin):
+    """OS_STK words for nbytes plus margin percent, rounded up to 8 words."""
+    n = (int(nbytes * (100 + margin) / 100) + 3) // 4
+    return (n + 7) // 8 * 8
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("objdump")
+    parser.add_argument("--task", action="append", default=[], metavar="FUNC",
+                        help="analyze FUNC as a task too (default the tasks found)")
+    parser.add_argument("--indirect", action="append", default=[], metavar="CALLER=F1,F2",
+                        help="targets of the indirect calls in CALLER")
+    parser.add_argument("--assume", action="append", default=[], metavar="FUNC=BYTES",
+                        help="use BYTES as the whole depth of FUNC")
+    parser.add_argument("--recursion", action="append", default=[], metavar="FUNC=LEVELS",
+                        help="FUNC calls itself at most LEVELS deep")
+    parser.add_argument("--margin", type=int, default=MARGIN,
+                        help="percent added to the sizes (default %(default)s)")
+    parser.add_argument("--path", action="store_true", help="print the deepest call chains")
+    parser.add_argument("--header", help="write the sizes as a C header")
+    parser.add_argument("--check", metavar="HEADER",
+                        help="fail if HEADER differs from what --header writes with its options")
+    args = parser.parse_args()
+    if args.check:
+        # The options the header was written with, instead of the given ones
+        with open(args.check) as old:
+            m = re.search(r"^ \* Options: (.*)$", old.read(), re.M)
+        if m and m.group(1) != "none":
+            args = parser.parse_args([args.objdump, "--check", args.check]
+                                     + shlex.split(m.group(1)))
+
+    extra = {}
+    for item in args.indirect:
+        caller, _, targets = item.partition("=")
+        extra[caller] = [t for t in targets.split(",") if t]
+    assume = {}
+    for item in args.assume:
+        name, _, nbytes = item.partition("=")
+        assume[name] = int(nbytes, 0)
+    recursion = {}
+    for item in args.recursion:
+        name, _, levels = item.partition("=")
+        recursion[name] = int(levels, 0)
+
+    functions, registered = parse(args.objdump)
+    groups = resolve(functions, registered, extra)
+    analysis = Analysis(functions, assume, recursion)
+
+    tasks = sorted(groups.get("task", set()) | set(args.task))
+    if not tasks:
+        sys.exit("no task found, give --task")
+    isr_name = next((n for n in ISR_ENTRY if n in functions), None)
+    isr = analysis.depth(isr_name) if isr_name else (0, [], {"no exception entry found"})
+
+    rows = []
+    for task in tasks:
+        depth, path, problems = analysis.depth(task)
+        if task == SHARED_STACK:
+            # Every job may sit on the stack below the ones preempting it
+            depth = 0
+            for job in sorted(groups.get("job", set())):
+                d, p, q = analysis.depth(job)
+                depth += functions[SHARED_STACK].frame + d
+                problems |= q
+                if len(p) > len(path) - 1:
+                    path = [SHARED_STACK] + p
+        rows.append((task, depth, path, problems))
+
+    print("Exception entry %s: %d bytes%s" % (isr_name, isr[0], " +" if isr[2] else ""))
+    print("+--------------------------+----------+----------+----------+---------+")
+    print("| Task                     |     Task |  + Intr. | + Margin |   Words |")
+    print("+--------------------------+----------+----------+----------+---------+")
+    for task, depth, _path, problems in rows:
+        total = depth + isr[0]
+        mark = "+" if problems or isr[2] else " "
+        print("| %-24.24s | %8d | %7d%s | %8d | %7d |"
+              % (task, depth, total, mark, words(total, args.margin) * 4,
+                 words(total, args.margin)))
+    print("+--------------------------+----------+----------+----------+---------+")
+    if SHARED_STACK in tasks:
+        print("%s is the shared stack of the basic tasks (sum of the jobs)" % SHARED_STACK)
+
+    problems = set(isr[2])
+    for row in rows:
+        problems |= row[3]
+    if problems:
+        print("\nNo proven bound where marked '+':")
+        for p in sorted(problems):
+            print("  " + p)
+
+    if args.path:
+        for task, depth, path, _problems in rows + [(isr_name, isr[0], isr[1], isr[2])]:
+            print("\n%s (%d bytes):" % (task, depth))
+            for name in path:
+                fn = functions.get(name)
+                print("  %6d  %s" % (fn.frame if fn else assume.get(name, 0), name))
+
+    if args.header or args.check:
+        text = header(args, rows, isr, isr_name, functions, analysis)
+        if args.check:
+            with open(args.check) as old:
+                if old.read() != text:
+                    sys.exit("%s is stale against %s, write it again with --header"
+                             % (args.check, args.objdump))
+        else:
+            with open(args.header, "w") as out:
+                out.write(text)
+
+
+def options(args):
+    """The options that change the sizes, as given on the command line."""
+    opts = []
+    for name in ("task", "indirect", "assume", "recursion"):
+        opts += ["--%s %s" % (name, value) for value in getattr(args, name)]
+    if args.margin != MARGIN:
+        opts.append("--margin %d" % args.margin)
+    return " ".join(opts) or "none"
+
+
+def header(args, rows, isr, isr_name, functions, analysis):
+    """Returns the text of the C header with the sizes of the tasks."""
+    lines = ["/* Worst-case stack use of the tasks in OS_STK words, with %d%% margin" % args.margin,
+             " *",
+             " * Generated by tools/stackdepth.py from %s, do not edit." % args.objdump.split("/")[-1],
+             " * Options: %s" % options(args),
+             " * Includes %d bytes for the exception entry (%s)." % (isr[0], isr_name),
+             " *",
+             " * Bounds the listing alone does not prove:"]
+    for name in sorted(analysis.recursion):
+        if name in analysis.seen:
+            levels = analysis.recursion[name]
+            lines.append(" *   %s calls itself at most %d level%s deep"
+                         % (name, levels, "" if levels == 1 else "s"))
+    for name in sorted(analysis.assume):
+        lines.append(" *   %s uses at most %d bytes" % (name, analysis.assume[name]))
+    for name in sorted(analysis.seen):
+        fn = functions[name]
+        if fn.resolved:
+            how, targets = fn.resolved
+            lines += textwrap.wrap("callr in %s: %s" % (name, how), 74,
+                                   initial_indent=" *   ", subsequent_indent=" *     ")
+            lines += textwrap.wrap(" ".join(targets) or "(none registered)", 74,
+                                   initial_indent=" *       ", subsequent_indent=" *       ")
+    lines += [" *",
+              " * A task that is not listed keeps the standard size of the application.",
+              " */",
+              "#ifndef __STACK_DEPTH_H__",
+              "#define __STACK_DEPTH_H__",
+              ""]
+    for task, depth, _path, problems in rows:
+        macro = "STACK_DEPTH_" + re.sub(r"\W", "_", task).upper()
+        if problems or isr[2]:
+            # A partial depth would be too small, worse than no size
+            lines.append("/* %s: no proven bound */" % macro)
+        else:
+            lines.append("#define %-40s %d" % (macro, words(depth + isr[0], args.margin)))
+    lines += ["", "#endif /* __STACK_DEPTH_H__ */", ""]
+    return "\n".join(lines)
+
+
+if __name__ == "__main__":
+    main()
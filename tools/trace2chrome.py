@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Converts a kernel event trace dump into a Chrome trace.
+
+The dump is printed by trace_dump() (app/common/trace.c) on the JTAG UART.
+Capture the terminal output (e.g. nios2-terminal | tee run.log) and convert
+it; the result opens in chrome://tracing or https://ui.perfetto.dev.
+
+Every task becomes one thread showing when it was running; interrupt
+handlers get a thread of their own. Posts, pends and timer expiries are
+instant events on the thread that caused them.
+
+usage: trace2chrome.py run.log [-o trace.json] [--dump N]
+"""
+import argparse
+import json
+import sys
+
+EV_SWITCH = 1
+EV_ISR_ENTER = 2
+EV_ISR_EXIT = 3
+EV_SEM_POST = 4
+EV_SEM_PEND = 5
+EV_MBOX_POST = 6
+EV_MBOX_PEND = 7
+EV_TMR_EXPIRE = 8
+
+INSTANT_NAMES = {
+    EV_SEM_POST: "OSSemPost",
+    EV_SEM_PEND: "OSSemPend",
+    EV_MBOX_POST: "OSMboxPost",
+    EV_MBOX_PEND: "OSMboxPend",
+}
+
+PRIO_ISR = 0xFF
+TID_ISR = 1000
+PID = 1
+
+
+def parse(path):
+    """Returns the list of dumps found in a log, each a dict."""
+    dumps = []
+    current = None
+    with open(path, errors="replace") as log:
+        for line in log:
+            fields = line.split()
+            if not fields:
+                continue
+            tag = fields[0]
+            if tag == "TRACE-BEGIN":
+                current = {"header": dict(f.split("=", 1) for f in fields[1:] if "=" in f),
+                           "tasks": {}, "objects": {}, "events": []}
+            elif current is None:
+                continue
+            elif tag == "TRACE-TASK" and len(fields) >= 3:
+                current["tasks"][int(fields[1])] = " ".join(fields[2:])
+            elif tag == "TRACE-EVENT" and len(fields) >= 3:
+                current["objects"][int(fields[-1])] = " ".join(fields[1:-1])
+            elif tag == "TE" and len(fields) == 5:
+                try:
+                    current["events"].append((int(fields[1], 16), int(fields[2]),
+                                              int(fields[3]), int(fields[4])))
+                except ValueError:
+                    continue
+            elif tag == "TRACE-END":
+                dumps.append(current)
+                current = None
+    return dumps
+
+
+def unwrap(events):
+    """Makes the 32 bit timestamps monotonic."""
+    result = []
+    base = 0
+    last = None
+    for ts, typ, prio, arg in events:
+        if last is not None and ts < last:
+            base += 1 << 32
+        last = ts
+        result.append((ts + base, typ, prio, arg))
+    return result
+
+
+def convert(dump):
+    freq = float(dump["header"].get("freq", "50000000")) or 50e6
+    tasks = dump["tasks"]
+    objects = dump["objects"]
+    events = unwrap(dump["events"])
+    if not events:
+        return {"traceEvents": []}
+    t0 = events[0][0]
+
+    def us(ts):
+        return (ts - t0) * 1e6 / freq
+
+    def task_name(prio):
+        return tasks.get(prio, "Task %d" % prio)
+
+    out = []
+    for prio, name in sorted(tasks.items()):
+        out.append({"ph": "M", "pid": PID, "tid": prio, "name": "thread_name",
+                    "args": {"name": "%s (%d)" % (name, prio)}})
+        out.append({"ph": "M", "pid": PID, "tid": prio, "name": "thread_sort_index",
+                    "args": {"sort_index": prio}})
+    out.append({"ph": "M", "pid": PID, "tid": TID_ISR, "name": "thread_name",
+                "args": {"name": "ISR"}})
+    out.append({"ph": "M", "pid": PID, "tid": TID_ISR, "name": "thread_sort_index",
+                "args": {"sort_index": -1}})
+
+    running = None
+    isr_depth = 0
+    for ts, typ, prio, arg in events:
+        t = us(ts)
+        if typ == EV_SWITCH:
+            if running is not None:
+                out.append({"ph": "E", "pid": PID, "tid": running, "ts": t})
+            running = prio
+            out.append({"ph": "B", "pid": PID, "tid": prio, "ts": t, "name": task_name(prio),
+                        "args": {"from": task_name(arg)}})
+        elif typ == EV_ISR_ENTER:
+            isr_depth += 1
+            out.append({"ph": "B", "pid": PID, "tid": TID_ISR, "ts": t, "name": "ISR",
+                        "args": {"nesting": arg}})
+        elif typ == EV_ISR_EXIT:
+            if isr_depth > 0:
+                isr_depth -= 1
+                out.append({"ph": "E", "pid": PID, "tid": TID_ISR, "ts": t})
+        else:
+            tid = TID_ISR if prio == PRIO_ISR else prio
+            if typ in INSTANT_NAMES:
+                name = "%s %s" % (INSTANT_NAMES[typ], objects.get(arg, "#%d" % arg))
+            elif typ == EV_TMR_EXPIRE:
+                name = "Timer #%d" % arg
+            else:
+                name = "user %d" % typ
+            out.append({"ph": "i", "s": "t", "pid": PID, "tid": tid, "ts": t, "name": name,
+                        "args": {"arg": arg}})
+
+    # Close what is still open at the end of the ring
+    t = us(events[-1][0])
+    if running is not None:
+        out.append({"ph": "E", "pid": PID, "tid": running, "ts": t})
+    for _ in range(isr_depth):
+        out.append({"ph": "E", "pid": PID, "tid": TID_ISR, "ts": t})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns",
+            "otherData": {"freq": freq, "lost": dump["header"].get("lost"),
+                          "overhead_cycles": dump["header"].get("overhead")}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log")
+    parser.add_argument("-o", "--output", help="output file (default stdout)")
+    parser.add_argument("--dump", type=int, default=-1,
+                        help="which dump of the log to convert (default: the last one)")
+    args = parser.parse_args()
+
+    dumps = parse(args.log)
+    if not dumps:
+        sys.stderr.write("no complete TRACE-BEGIN ... TRACE-END dump in %s\n" % args.log)
+        return 1
+    trace = convert(dumps[args.dump])
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    sys.stderr.write("%d events, %s lost, %s cycles/event\n"
+                     % (len(dumps[args.dump]["events"]), dumps[args.dump]["header"].get("lost"),
+                        dumps[args.dump]["header"].get("overhead")))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())